@@ -199,6 +199,13 @@
 
 	monsterSpawnWalkback = false
 	allowBlockSpawn = true
+
+	-- Monster AI level of detail
+	-- monsters without a target, or whose target is further than monsterLodRange,
+	-- search targets, walk and yell only every monsterLodThinkInterval ms (0 disables)
+	-- monster files can override the interval with <flag lodthinkinterval="..."/>
+	monsterLodThinkInterval = 2000
+	monsterLodRange = 4
 	
 	classicEquipmentSlots = true
 
@@ -225,10 +232,13 @@
 	onePlayerOnlinePerAccount = false
 	allowClones = 0
 	statusTimeout = 1000
+	statusCacheTime = 5 * 1000
 	replaceKickOnLogin = true
 	forceSlowConnectionsToDisconnect = false
 	premiumPlayerSkipWaitList = false
 	packetsPerSecond = 1000
+	-- pending actions (walk, use, look...) a single player may queue for the game thread, the rest is dropped
+	playerCommandQueueSize = 64
 	loginProtectionTime = 5
 	tibiaClassicSlots = true
 
@@ -271,6 +281,13 @@
 	mapAuthor = "@eoluxX featured Alex and Flamearcixt"
 	randomizeTiles = true
 	houseDataStorage = "binary-tilebased"
+	-- re-serializes every loaded house tile and reports the ones that differ from the stored data
+	houseDataVerify = false
+	-- "relational" or "binary"; binary keeps skills, spells, items, depots, storages and vips in players.snapshot
+	-- (ALTER TABLE `players` ADD `snapshot` LONGBLOB DEFAULT NULL) and writes them with the players row
+	playerDataStorage = "relational"
+	-- binary storage only: also writes the relational tables when a player logs out, for websites and highscores
+	playerSnapshotExport = true
 	storeTrash = true
 	cleanProtectedZones = true
 	mapName = "forgotten.otbm"
@@ -284,6 +301,15 @@
 	defaultPriority = "higher"
 	niceLevel = 5
 	serviceThreads = 1
+	-- threads decrypting login handshakes, 0 decrypts them on the network thread
+	rsaThreads = 2
+	-- threads parsing data files during startup, 0 uses all cores
+	loadThreads = 0
+	-- milliseconds between reloads of the ban cache from the database, 0 only loads it on startup
+	banCacheRefreshInterval = 60000
+	-- directory receiving a capture of every game session for later replay (otx --replay=dir), empty disables
+	-- account manager and namelock sessions are never captured, chat of other sessions is stored as typed
+	packetCaptureDirectory = ""
 	coresUsed = "-1"
 	startupDatabaseOptimization = true
 	removePremiumOnInit = true
@@ -304,6 +330,8 @@
 	savePlayerData = true
 	monsterLootMessage = 3
 	monsterLootMessageType = 25
+	-- fixed seed for the loot rolls of the game thread, the same seed drops the same loot for the same kills; 0 seeds randomly
+	lootRandomSeed = 0
 	separateViplistPerCharacter = false
 	vipListDefaultLimit = 20
 	vipListDefaultPremiumLimit = 100
@@ -399,12 +427,24 @@
 	teleportPlayerSummons = true
 
 	disableLuaErrors = false
+	-- push items and creatures to scripts as userdata instead of tables (less garbage)
+	-- NOTE: scripts using type(thing) == "table", pairs(thing) or rawget on
+	-- creatures and items stop working when enabled, check them before turning it on
+	luaThingUserdata = false
 	adminLogs = true
 	displayPlayersLogging = true
 	prefixChannelLogs = ""
 	runFile = "server/run.log"
 	outputLog = "server/out.log"
 	truncateLogOnStartup = false
+	-- log lines are buffered and written by a background thread,
+	-- logBufferSize = 0 writes them straight from the game thread
+	logBufferSize = 4096
+	logFlushInterval = 1000
+	-- rotate logs once they grow past logRotateSize megabytes or
+	-- are older than logRotateTime hours, 0 disables
+	logRotateSize = 0
+	logRotateTime = 0
 	logPlayersStatements = false
 
 	managerPort = 7171
@@ -70,6 +70,7 @@ CREATE TABLE IF NOT EXISTS `players`
 	`broadcasting` TINYINT NOT NULL DEFAULT '0',
 	`offlinetraining_time` INT NOT NULL DEFAULT '0',
 	`offlinetraining_skill` INT NOT NULL DEFAULT '0',
+	`snapshot` LONGBLOB DEFAULT NULL,
 	PRIMARY KEY (`id`),
 	UNIQUE KEY `name` (`name`),
 	FOREIGN KEY (`account_id`) REFERENCES `accounts`(`id`) ON DELETE CASCADE
@@ -33,7 +33,7 @@ Attr_ReadValue BedItem::readAttr(AttrTypes_t attr, PropStream& propStream)
 				return ATTR_READ_ERROR;
 			}
 
-			if (m_sleeperGUID != 0) {
+			if (m_sleeperGUID != 0 && !Item::loadingDetached) {
 				std::string name;
 				if (IOLoginData::getInstance()->getNameByGuid(m_sleeperGUID, name)) {
 					setSpecialDescription(name + " is sleeping there.");
@@ -24,6 +24,7 @@
 #include "ioguild.h"
 #include "iologindata.h"
 #include "player.h"
+#include "textlogger.h"
 
 #include "otx/util.hpp"
 
@@ -110,8 +111,8 @@ ChatChannel::ChatChannel(uint16_t id, const std::string& name, uint16_t flags) :
 	m_flags(flags)
 {
 	if (hasFlag(CHANNELFLAG_LOGGED)) {
-		m_file.reset(new std::ofstream(getFilePath(FILE_TYPE_LOG, "chat/" + otx::config::getString(otx::config::PREFIX_CHANNEL_LOGS) + m_name + ".log").c_str(), std::ios::app | std::ios::out));
-		if (!m_file->is_open()) {
+		m_logFile = "chat/" + otx::config::getString(otx::config::PREFIX_CHANNEL_LOGS) + m_name + ".log";
+		if (!std::ofstream(getFilePath(FILE_TYPE_LOG, m_logFile).c_str(), std::ios::app | std::ios::out).is_open()) {
 			m_flags &= ~CHANNELFLAG_LOGGED;
 		}
 	}
@@ -196,8 +197,8 @@ bool ChatChannel::talk(Player* player, MessageType_t type, const std::string& te
 		it->second->sendCreatureChannelSay(player, ntype, text, m_id, statementId, fakeChat);
 	}
 
-	if (hasFlag(CHANNELFLAG_LOGGED) && m_file->is_open()) {
-		*m_file << "[" << formatDate() << "] " << player->getName() << ": " << text << std::endl;
+	if (hasFlag(CHANNELFLAG_LOGGED)) {
+		Logger::getInstance()->eFile(m_logFile, player->getName() + ": " + text, true);
 	}
 	return true;
 }
@@ -208,8 +209,8 @@ bool ChatChannel::talk(std::string nick, MessageType_t type, const std::string&
 		it.second->sendChannelMessage(nick, text, type, m_id, fakeChat, ip);
 	}
 
-	if (hasFlag(CHANNELFLAG_LOGGED) && m_file->is_open()) {
-		*m_file << "[" << formatDate() << "] " << nick << ": " << text << std::endl;
+	if (hasFlag(CHANNELFLAG_LOGGED)) {
+		Logger::getInstance()->eFile(m_logFile, nick + ": " + text, true);
 	}
 	return true;
 }
@@ -94,7 +94,7 @@ private:
 	std::string m_name;
 	std::string m_conditionMessage;
 	std::unique_ptr<VocationMap> m_vocationMap;
-	std::shared_ptr<std::ofstream> m_file;
+	std::string m_logFile;
 	std::unique_ptr<Condition> m_condition;
 	int32_t m_conditionId = -1;
 	uint32_t m_access = 0;
@@ -654,13 +654,8 @@ bool Combat::doCombat(Creature* caster, Creature* target) const
 		if (!m_params.isAggressive || (caster != target && Combat::canDoCombat(caster, target, true) == RET_NOERROR)) {
 			for (const Condition* condition : m_params.conditionList) {
 				if (caster == target || !target->isImmune(condition->getType())) {
-					auto conditionClone = condition->clone();
-					if (caster) {
-						conditionClone->setParam(CONDITIONPARAM_OWNER, caster->getID());
-					}
-
 					//TODO: infight condition until all aggressive conditions has ended [?]
-					target->addCombatCondition(std::move(conditionClone));
+					target->addCombatCondition(condition, caster ? caster->getID() : 0);
 				}
 			}
 
@@ -761,13 +756,8 @@ void Combat::doCombat(Creature* caster, const Position& pos) const
 					if (!m_params.isAggressive || (caster != creature && Combat::canDoCombat(caster, creature, true) == RET_NOERROR)) {
 						for (const Condition* condition : m_params.conditionList) {
 							if (caster == creature || !creature->isImmune(condition->getType())) {
-								Condition* conditionClone = condition->clone();
-								if (caster) {
-									conditionClone->setParam(CONDITIONPARAM_OWNER, caster->getID());
-								}
-
 								//TODO: infight condition until all aggressive conditions has ended [?]
-								creature->addCombatCondition(conditionClone);
+								creature->addCombatCondition(condition, caster ? caster->getID() : 0);
 							}
 						}
 
@@ -834,13 +824,8 @@ void Combat::doTargetCombat(Creature* caster, Creature* target, CombatDamage& da
 	if (success) {
 		for (const Condition* condition : params.conditionList) {
 			if (caster == target || !target->isImmune(condition->getType())) {
-				Condition* conditionClone = condition->clone();
-				if (caster) {
-					conditionClone->setParam(CONDITIONPARAM_OWNER, caster->getID());
-				}
-
 				//TODO: infight condition until all aggressive conditions has ended?
-				target->addCombatCondition(conditionClone);
+				target->addCombatCondition(condition, caster ? caster->getID() : 0);
 			}
 		}
 
@@ -866,13 +851,8 @@ void Combat::doTargetCombat(Creature* caster, Creature* target, const CombatPara
 
 	for (const Condition* condition : params.conditionList) {
 		if (caster == target || !target->isImmune(condition->getType())) {
-			Condition* conditionClone = condition->clone();
-			if (caster) {
-				conditionClone->setParam(CONDITIONPARAM_OWNER, caster->getID());
-			}
-
 			//TODO: infight condition until all aggressive conditions has ended?
-			target->addCombatCondition(conditionClone);
+			target->addCombatCondition(condition, caster ? caster->getID() : 0);
 		}
 	}
 
@@ -972,13 +952,8 @@ void Combat::doAreaCombat(Creature* caster, const Position& pos,
 		if (success) {
 			for (const Condition* condition : params.conditionList) {
 				if (caster == creature || !creature->isImmune(condition->getType())) {
-					Condition* conditionClone = condition->clone();
-					if (caster) {
-						conditionClone->setParam(CONDITIONPARAM_OWNER, caster->getID());
-					}
-
 					//TODO: infight condition until all aggressive conditions has ended [?]
-					creature->addCombatCondition(conditionClone);
+					creature->addCombatCondition(condition, caster ? caster->getID() : 0);
 				}
 			}
 
@@ -1054,13 +1029,8 @@ void Combat::doAreaCombat(Creature* caster, const Position& pos,
 	for (Creature* creature : toDamageCreatures) {
 		for (const Condition* condition : params.conditionList) {
 			if (caster == creature || !creature->isImmune(condition->getType())) {
-				Condition* conditionClone = condition->clone();
-				if (caster) {
-					conditionClone->setParam(CONDITIONPARAM_OWNER, caster->getID());
-				}
-
 				//TODO: infight condition until all aggressive conditions has ended [?]
-				creature->addCombatCondition(conditionClone);
+				creature->addCombatCondition(condition, caster ? caster->getID() : 0);
 			}
 		}
 
@@ -1400,7 +1370,7 @@ void CombatArea::setupExtArea(const std::vector<uint8_t>& vec, uint32_t rows)
 //
 MagicField::MagicField(uint16_t type) :
 	Item(type),
-	createTime(otx::util::mstime())
+	createTime(otx::util::ticks())
 {
 	//
 }
@@ -1465,7 +1435,7 @@ void MagicField::onStepInField(Creature* creature)
 				}
 			}
 
-			if (!harmful || (otx::util::mstime() - createTime) <= otx::config::getInteger(otx::config::FIELD_OWNERSHIP) || creature->hasBeenAttacked(ownerId)) {
+			if (!harmful || (otx::util::ticks() - createTime) <= otx::config::getInteger(otx::config::FIELD_OWNERSHIP) || creature->hasBeenAttacked(ownerId)) {
 				condition->setParam(CONDITIONPARAM_OWNER, ownerId);
 			}
 		}
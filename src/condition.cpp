@@ -156,14 +156,14 @@ void Condition::setTicks(int32_t _ticks)
 {
 	ticks = _ticks;
 	if (_ticks > 0) {
-		endTime = otx::util::mstime() + _ticks;
+		endTime = otx::util::ticks() + _ticks;
 	}
 }
 
 bool Condition::startCondition(Creature*)
 {
 	if (ticks > 0) {
-		endTime = otx::util::mstime() + ticks;
+		endTime = otx::util::ticks() + ticks;
 	}
 
 	return true;
@@ -181,7 +181,7 @@ bool Condition::executeCondition(Creature* creature, int32_t interval)
 	}
 
 	ticks = std::max<int32_t>(0, ticks - interval);
-	return (endTime >= otx::util::mstime());
+	return (endTime >= otx::util::ticks());
 }
 
 Condition* Condition::createCondition(ConditionId_t _id, ConditionType_t _type, int32_t _ticks, int32_t param /* = 0*/, bool _buff /* = false*/, uint32_t _subId /* = 0*/)
@@ -292,7 +292,7 @@ Condition* Condition::createCondition(PropStream& propStream)
 bool Condition::updateCondition(const Condition* addCondition)
 {
 	return conditionType == addCondition->getType() && (ticks != -1 || addCondition->getTicks() < 1)
-		&& (addCondition->getTicks() < 0 || endTime <= (otx::util::mstime() + addCondition->getTicks()));
+		&& (addCondition->getTicks() < 0 || endTime <= (otx::util::ticks() + addCondition->getTicks()));
 }
 
 Icons_t Condition::getIcons() const
@@ -1227,6 +1227,13 @@ bool ConditionDamage::doDamage(Creature* creature, int32_t damage)
 }
 
 void ConditionDamage::addCondition(Creature* creature, const Condition* addCondition)
+{
+	if (addCondition->getType() == conditionType) {
+		mergeCondition(creature, addCondition, static_cast<const ConditionDamage*>(addCondition)->owner);
+	}
+}
+
+void ConditionDamage::mergeCondition(Creature* creature, const Condition* addCondition, uint32_t ownerId)
 {
 	if (addCondition->getType() != conditionType) {
 		return;
@@ -1238,7 +1245,7 @@ void ConditionDamage::addCondition(Creature* creature, const Condition* addCondi
 	}
 
 	setTicks(addCondition->getTicks());
-	owner = conditionDamage.owner;
+	owner = ownerId;
 	maxDamage = conditionDamage.maxDamage;
 	minDamage = conditionDamage.minDamage;
 	startDamage = conditionDamage.startDamage;
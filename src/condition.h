@@ -19,6 +19,7 @@
 
 #include "const.h"
 #include "fileloader.h"
+#include "lockfree.h"
 
 class Creature;
 class Player;
@@ -112,6 +113,8 @@ public:
 	virtual bool executeCondition(Creature* creature, int32_t interval);
 	virtual void endCondition(Creature*, ConditionEnd_t) {}
 	virtual void addCondition(Creature*, const Condition*) {}
+	// the same with the owner given apart, combat merges its shared template without a clone
+	virtual void mergeCondition(Creature* creature, const Condition* condition, uint32_t) { addCondition(creature, condition); }
 
 	virtual Icons_t getIcons() const;
 	ConditionId_t getId() const { return id; }
@@ -136,6 +139,10 @@ public:
 
 	bool isPersistent() const { return (ticks > 0 && (id == CONDITIONID_DEFAULT || id != CONDITIONID_COMBAT)); }
 
+	// unique while the condition is on a creature, pooled addresses are reused
+	uint64_t getSerial() const { return serial; }
+	void setSerial(uint64_t newSerial) { serial = newSerial; }
+
 protected:
 	virtual bool updateCondition(const Condition* addCondition);
 
@@ -147,6 +154,8 @@ protected:
 
 	ConditionType_t conditionType;
 	bool buff;
+
+	uint64_t serial = 0;
 };
 
 class ConditionGeneric : public Condition
@@ -155,6 +164,10 @@ public:
 	ConditionGeneric(ConditionId_t _id, ConditionType_t _type, int32_t _ticks, bool _buff, uint32_t _subId);
 	virtual ~ConditionGeneric() {}
 
+	using Pool = ObjectPool<ConditionGeneric, 4096>;
+	static void* operator new(size_t size) { return Pool::allocate(size); }
+	static void operator delete(void* p, size_t size) { Pool::deallocate(p, size); }
+
 	virtual void addCondition(Creature* creature, const Condition* condition);
 
 	virtual Icons_t getIcons() const;
@@ -168,6 +181,10 @@ public:
 	ConditionManaShield(ConditionId_t _id, ConditionType_t _type, int32_t _ticks, bool _buff, uint32_t _subId);
 	virtual ~ConditionManaShield() {}
 
+	using Pool = ObjectPool<ConditionManaShield, 1024>;
+	static void* operator new(size_t size) { return Pool::allocate(size); }
+	static void operator delete(void* p, size_t size) { Pool::deallocate(p, size); }
+
 	virtual Icons_t getIcons() const;
 
 	virtual ConditionManaShield* clone() const { return new ConditionManaShield(*this); }
@@ -179,6 +196,10 @@ public:
 	ConditionAttributes(ConditionId_t _id, ConditionType_t _type, int32_t _ticks, bool _buff, uint32_t _subId);
 	virtual ~ConditionAttributes() {}
 
+	using Pool = ObjectPool<ConditionAttributes, 2048>;
+	static void* operator new(size_t size) { return Pool::allocate(size); }
+	static void operator delete(void* p, size_t size) { Pool::deallocate(p, size); }
+
 	virtual bool startCondition(Creature* creature);
 	virtual bool executeCondition(Creature* creature, int32_t interval);
 	virtual void endCondition(Creature* creature, ConditionEnd_t reason);
@@ -208,6 +229,10 @@ public:
 	ConditionRegeneration(ConditionId_t _id, ConditionType_t _type, int32_t _ticks, bool _buff, uint32_t _subId);
 	virtual ~ConditionRegeneration() {}
 
+	using Pool = ObjectPool<ConditionRegeneration, 2048>;
+	static void* operator new(size_t size) { return Pool::allocate(size); }
+	static void operator delete(void* p, size_t size) { Pool::deallocate(p, size); }
+
 	virtual void addCondition(Creature* creature, const Condition* addCondition);
 	virtual bool executeCondition(Creature* creature, int32_t interval);
 
@@ -229,6 +254,10 @@ public:
 	ConditionSoul(ConditionId_t _id, ConditionType_t _type, int32_t _ticks, bool _buff, uint32_t _subId);
 	virtual ~ConditionSoul() {}
 
+	using Pool = ObjectPool<ConditionSoul, 1024>;
+	static void* operator new(size_t size) { return Pool::allocate(size); }
+	static void operator delete(void* p, size_t size) { Pool::deallocate(p, size); }
+
 	virtual void addCondition(Creature* creature, const Condition* addCondition);
 	virtual bool executeCondition(Creature* creature, int32_t interval);
 
@@ -250,11 +279,16 @@ public:
 	ConditionDamage(ConditionId_t _id, ConditionType_t _type, bool _buff, uint32_t _subId);
 	virtual ~ConditionDamage() {}
 
+	using Pool = ObjectPool<ConditionDamage, 8192>;
+	static void* operator new(size_t size) { return Pool::allocate(size); }
+	static void operator delete(void* p, size_t size) { Pool::deallocate(p, size); }
+
 	static void generateDamageList(int32_t amount, int32_t start, std::list<int32_t>& list);
 
 	virtual bool startCondition(Creature* creature);
 	virtual bool executeCondition(Creature* creature, int32_t interval);
 	virtual void addCondition(Creature* creature, const Condition* condition);
+	virtual void mergeCondition(Creature* creature, const Condition* condition, uint32_t ownerId);
 
 	virtual Icons_t getIcons() const;
 
@@ -291,6 +325,10 @@ public:
 	ConditionOutfit(ConditionId_t _id, ConditionType_t _type, int32_t _ticks, bool _buff, uint32_t _subId);
 	virtual ~ConditionOutfit() = default;
 
+	using Pool = ObjectPool<ConditionOutfit, 1024>;
+	static void* operator new(size_t size) { return Pool::allocate(size); }
+	static void operator delete(void* p, size_t size) { Pool::deallocate(p, size); }
+
 	bool startCondition(Creature* creature) override;
 	void endCondition(Creature* creature, ConditionEnd_t reason) override;
 	void addCondition(Creature* creature, const Condition* condition) override;
@@ -316,6 +354,10 @@ public:
 	ConditionSpeed(ConditionId_t _id, ConditionType_t _type, int32_t _ticks, bool _buff, uint32_t _subId, int32_t changeSpeed);
 	virtual ~ConditionSpeed() {}
 
+	using Pool = ObjectPool<ConditionSpeed, 4096>;
+	static void* operator new(size_t size) { return Pool::allocate(size); }
+	static void operator delete(void* p, size_t size) { Pool::deallocate(p, size); }
+
 	virtual bool startCondition(Creature* creature);
 	virtual void endCondition(Creature* creature, ConditionEnd_t reason);
 	virtual void addCondition(Creature* creature, const Condition* condition);
@@ -345,6 +387,10 @@ public:
 	ConditionLight(ConditionId_t _id, ConditionType_t _type, int32_t _ticks, bool _buff, uint32_t _subId, int32_t lightLevel, int32_t lightColor);
 	virtual ~ConditionLight() {}
 
+	using Pool = ObjectPool<ConditionLight, 1024>;
+	static void* operator new(size_t size) { return Pool::allocate(size); }
+	static void operator delete(void* p, size_t size) { Pool::deallocate(p, size); }
+
 	virtual bool startCondition(Creature* creature);
 	virtual bool executeCondition(Creature* creature, int32_t interval);
 	virtual void endCondition(Creature* creature, ConditionEnd_t reason);
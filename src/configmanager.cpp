@@ -196,14 +196,22 @@ bool otx::config::load()
 		string_array[SQL_PASS] = getConfigString(L, "sqlPass", "");
 		string_array[SQL_DB] = getConfigString(L, "sqlDatabase", "theotxserver");
 		string_array[DEFAULT_PRIORITY] = getConfigString(L, "defaultPriority", "high");
+		string_array[PLAYER_STORAGE] = getConfigString(L, "playerDataStorage", "relational");
+		string_array[PACKET_CAPTURE] = getConfigString(L, "packetCaptureDirectory", "");
 
 		integer_array[SQL_PORT] = getConfigInteger(L, "sqlPort", 3306);
+		integer_array[RSA_THREADS] = getConfigInteger(L, "rsaThreads", 2);
+		integer_array[LOG_BUFFER_SIZE] = getConfigInteger(L, "logBufferSize", 4096);
+		integer_array[LOAD_THREADS] = getConfigInteger(L, "loadThreads", 0);
+		integer_array[BAN_CACHE_REFRESH] = getConfigInteger(L, "banCacheRefreshInterval", 60000);
 		integer_array[GLOBALSAVE_H] = getConfigInteger(L, "globalSaveHour", 8);
 		integer_array[GLOBALSAVE_M] = getConfigInteger(L, "globalSaveMinute", 0);
 
 		bool_array[GLOBALSAVE_ENABLED] = getConfigBoolean(L, "globalSaveEnabled", true);
 		bool_array[LOGIN_ONLY_LOGINSERVER] = getConfigBoolean(L, "loginOnlyWithLoginServer", false);
 		bool_array[OPTIMIZE_DATABASE] = getConfigBoolean(L, "startupDatabaseOptimization", true);
+		bool_array[HOUSE_DATA_VERIFY] = getConfigBoolean(L, "houseDataVerify", false);
+		bool_array[PLAYER_SNAPSHOT_EXPORT] = getConfigBoolean(L, "playerSnapshotExport", true);
 		bool_array[STORE_TRASH] = getConfigBoolean(L, "storeTrash", true);
 		bool_array[TRUNCATE_LOG] = getConfigBoolean(L, "truncateLogOnStartup", true);
 		bool_array[GUILD_HALLS] = getConfigBoolean(L, "guildHalls", false);
@@ -277,6 +285,10 @@ bool otx::config::load()
 	integer_array[CUSTOM_ACTIONS_DELAY_INTERVAL] = getConfigInteger(L, "timeBetweenCustomActions", 500);
 	integer_array[PROTECTION_LEVEL] = getConfigInteger(L, "protectionLevel", 1);
 	integer_array[STATUSQUERY_TIMEOUT] = getConfigInteger(L, "statusTimeout", 300000);
+	integer_array[STATUS_CACHE_TIME] = getConfigInteger(L, "statusCacheTime", 5000);
+	integer_array[LOG_FLUSH_INTERVAL] = getConfigInteger(L, "logFlushInterval", 1000);
+	integer_array[LOG_ROTATE_SIZE] = getConfigInteger(L, "logRotateSize", 0);
+	integer_array[LOG_ROTATE_TIME] = getConfigInteger(L, "logRotateTime", 0);
 	integer_array[LEVEL_TO_FORM_GUILD] = getConfigInteger(L, "levelToFormGuild", 8);
 	integer_array[MIN_GUILDNAME] = getConfigInteger(L, "guildNameMinLength", 4);
 	integer_array[MAX_GUILDNAME] = getConfigInteger(L, "guildNameMaxLength", 20);
@@ -338,7 +350,10 @@ bool otx::config::load()
 	integer_array[TRADE_LIMIT] = getConfigInteger(L, "tradeLimit", 100);
 	integer_array[SQUARE_COLOR] = getConfigInteger(L, "squareColor", 0);
 	integer_array[LOOT_MESSAGE] = getConfigInteger(L, "monsterLootMessage", 3);
+	integer_array[MONSTER_LOD_THINK_INTERVAL] = getConfigInteger(L, "monsterLodThinkInterval", 2000);
+	integer_array[MONSTER_LOD_RANGE] = getConfigInteger(L, "monsterLodRange", 4);
 	integer_array[LOOT_MESSAGE_TYPE] = getConfigInteger(L, "monsterLootMessageType", 19);
+	integer_array[RANDOM_SEED] = getConfigInteger(L, "lootRandomSeed", 0);
 	integer_array[NAME_REPORT_TYPE] = getConfigInteger(L, "violationNameReportActionType", 2);
 	integer_array[HOUSE_CLEAN_OLD] = getConfigInteger(L, "houseCleanOld", 0);
 	integer_array[MAX_IP_CONNECTIONS] = getConfigInteger(L, "MaxIpConnections", 4);
@@ -356,6 +371,7 @@ bool otx::config::load()
 	integer_array[MAIL_BLOCK] = getConfigInteger(L, "mailBlockPeriod", 3600000);
 	integer_array[FOLLOW_EXHAUST] = getConfigInteger(L, "playerFollowExhaust", 2000);
 	integer_array[MAX_PACKETS_PER_SECOND] = getConfigInteger(L, "packetsPerSecond", 50);
+	integer_array[PLAYER_COMMAND_QUEUE] = getConfigInteger(L, "playerCommandQueueSize", 64);
 	integer_array[VERSION_MIN] = getConfigInteger(L, "versionMin", CLIENT_VERSION_MIN);
 	integer_array[VERSION_MAX] = getConfigInteger(L, "versionMax", CLIENT_VERSION_MAX);
 	integer_array[HIGHSCORES_TOP] = getConfigInteger(L, "highscoreDisplayPlayers", 10);
@@ -439,6 +455,7 @@ bool otx::config::load()
 	bool_array[DAEMONIZE] = getConfigBoolean(L, "daemonize", false);
 	bool_array[SKIP_ITEMS_VERSION] = getConfigBoolean(L, "skipItemsVersionCheck", false);
 	bool_array[SILENT_LUA] = getConfigBoolean(L, "disableLuaErrors", false);
+	bool_array[LUA_THING_USERDATA] = getConfigBoolean(L, "luaThingUserdata", false);
 	bool_array[HOUSE_SKIP_INIT_RENT] = getConfigBoolean(L, "houseSkipInitialRent", true);
 	bool_array[HOUSE_PROTECTION] = getConfigBoolean(L, "houseProtection", false);
 	bool_array[HOUSE_OWNED_BY_ACCOUNT] = getConfigBoolean(L, "houseOwnedByAccount", true);
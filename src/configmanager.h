@@ -25,6 +25,8 @@ namespace otx::config
 		MAP_NAME,
 		HOUSE_RENT_PERIOD,
 		HOUSE_STORAGE,
+		PLAYER_STORAGE,
+		PACKET_CAPTURE,
 		LOGIN_MSG,
 		SERVER_NAME,
 		OWNER_NAME,
@@ -200,6 +202,18 @@ namespace otx::config
 		HIGHSCORES_TOP,
 		HIGHSCORES_UPDATETIME,
 		LOGIN_PROTECTION_TIME,
+		RSA_THREADS,
+		STATUS_CACHE_TIME,
+		LOG_BUFFER_SIZE,
+		LOG_FLUSH_INTERVAL,
+		LOG_ROTATE_SIZE,
+		LOG_ROTATE_TIME,
+		LOAD_THREADS,
+		MONSTER_LOD_THINK_INTERVAL,
+		MONSTER_LOD_RANGE,
+		BAN_CACHE_REFRESH,
+		PLAYER_COMMAND_QUEUE,
+		RANDOM_SEED,
 		LAST_INTEGER_CONFIG /* this must be the last one */
 	};
 
@@ -309,6 +323,9 @@ namespace otx::config
 		MAXIP_USECONECT,
 		CAST_EXP_ENABLED,
 		PUSH_IN_PZ,
+		LUA_THING_USERDATA,
+		HOUSE_DATA_VERIFY,
+		PLAYER_SNAPSHOT_EXPORT,
 		LAST_BOOL_CONFIG /* this must be the last one */
 	};
 
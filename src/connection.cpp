@@ -23,6 +23,7 @@
 #include "dispatcher.h"
 #include "outputmessage.h"
 #include "protocol.h"
+#include "rsa.h"
 #include "server.h"
 #include "tools.h"
 
@@ -30,6 +31,8 @@
 uint32_t Connection::connectionCount = 0;
 #endif
 
+extern RSA g_RSA;
+
 constexpr uint32_t CONNECTION_READ_TIMEOUT = 30;
 constexpr uint32_t CONNECTION_WRITE_TIMEOUT = 30;
 
@@ -252,11 +255,38 @@ void Connection::parsePacket(const boost::system::error_code& error)
 			m_msg.skipBytes(1); // Skip protocol ID
 		}
 
+		const int32_t rsaOffset = m_protocol->getRSABlockOffset();
+		if (rsaOffset >= 0 && g_RSA.hasWorkers() && m_msg.getRemainingBufferLength() >= rsaOffset + 128) {
+			// decrypt off the network thread, nothing is read until the message is parsed
+			char* block = reinterpret_cast<char*>(m_msg.getBuffer()) + m_msg.getBufferPosition() + rsaOffset;
+			g_RSA.decryptAsync(block, [thisPtr = shared_from_this()]() {
+				boost::asio::post(thisPtr->m_socket.get_executor(), [thisPtr]() { thisPtr->parseFirstMessage(); });
+			});
+			return;
+		}
+
 		m_protocol->onRecvFirstMessage(m_msg);
 	} else {
 		m_protocol->onRecvMessage(m_msg); // Send the packet to the current protocol
 	}
 
+	readNextPacket();
+}
+
+void Connection::parseFirstMessage()
+{
+	std::lock_guard<std::recursive_mutex> lockClass(m_connectionLock);
+	if (m_closed) {
+		return;
+	}
+
+	m_protocol->m_rsaDecrypted = true;
+	m_protocol->onRecvFirstMessage(m_msg);
+	readNextPacket();
+}
+
+void Connection::readNextPacket()
+{
 	try {
 		m_readTimer.expires_after(std::chrono::seconds(CONNECTION_READ_TIMEOUT));
 		m_readTimer.async_wait(
@@ -271,7 +301,7 @@ void Connection::parsePacket(const boost::system::error_code& error)
 			thisPtr->parseHeader(error);
 		});
 	} catch (boost::system::system_error& e) {
-		std::cout << "[Network error - Connection::parsePacket] " << e.what() << std::endl;
+		std::cout << "[Network error - Connection::readNextPacket] " << e.what() << std::endl;
 		close(FORCE_CLOSE);
 	}
 }
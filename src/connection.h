@@ -87,6 +87,8 @@ public:
 private:
 	void parseHeader(const boost::system::error_code& error);
 	void parsePacket(const boost::system::error_code& error);
+	void parseFirstMessage();
+	void readNextPacket();
 
 	void onWriteOperation(const boost::system::error_code& error);
 
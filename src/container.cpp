@@ -64,6 +64,22 @@ Container* Container::getParentContainer()
 	return nullptr;
 }
 
+Player* Container::getIndexingPlayer()
+{
+	Player* player = getHoldingPlayer();
+	if (!player) {
+		return nullptr;
+	}
+
+	// the transfer container gets the player as parent, but its items are not carried
+	for (Container* container = this; container; container = container->getParentContainer()) {
+		if (container == &player->m_transferContainer) {
+			return nullptr;
+		}
+	}
+	return player;
+}
+
 void Container::addItem(Item* item)
 {
 	itemlist.push_back(item);
@@ -447,6 +463,9 @@ void Container::__addThing(Creature*, int32_t index, Thing* thing)
 	item->setParent(this);
 	itemlist.push_front(item);
 	updateItemWeight(item->getWeight());
+	if (Player* player = getIndexingPlayer()) {
+		player->getInventoryIndex().addItem(item);
+	}
 
 	// send change to client
 	Cylinder* parent = getParent();
@@ -467,10 +486,18 @@ void Container::__updateThing(Thing* thing, uint16_t itemId, uint32_t count)
 		return /*RET_NOTPOSSIBLE*/;
 	}
 
+	Player* player = getIndexingPlayer();
+	if (player) {
+		player->getInventoryIndex().removeItem(item, false);
+	}
+
 	const double oldWeight = item->getWeight();
 	item->setID(itemId);
 	item->setSubType(count);
 	updateItemWeight(-oldWeight + item->getWeight());
+	if (player) {
+		player->getInventoryIndex().addItem(item, false);
+	}
 
 	// send change to client
 	if (getParent()) {
@@ -493,6 +520,10 @@ void Container::__replaceThing(uint32_t index, Thing* thing)
 	itemlist[index] = item;
 	item->setParent(this);
 	updateItemWeight(-replacedItem->getWeight() + item->getWeight());
+	if (Player* player = getIndexingPlayer()) {
+		player->getInventoryIndex().removeItem(replacedItem);
+		player->getInventoryIndex().addItem(item);
+	}
 
 	// send change to client
 	if (getParent()) {
@@ -512,10 +543,18 @@ void Container::__removeThing(Thing* thing, uint32_t count)
 		return /*RETURNVALUE_NOTPOSSIBLE*/;
 	}
 
+	Player* player = getIndexingPlayer();
 	if (item->isStackable() && count != item->getItemCount()) {
+		if (player) {
+			player->getInventoryIndex().removeItem(item, false);
+		}
+
 		const double oldWeight = item->getWeight();
 		item->setItemCount(std::max<int32_t>(0, item->getItemCount() - count));
 		updateItemWeight(-oldWeight + item->getWeight());
+		if (player) {
+			player->getInventoryIndex().addItem(item, false);
+		}
 
 		// send change to client
 		if (getParent()) {
@@ -529,6 +568,10 @@ void Container::__removeThing(Thing* thing, uint32_t count)
 			onRemoveContainerItem(index, item);
 		}
 
+		if (player) {
+			player->getInventoryIndex().removeItem(item);
+		}
+
 		item->setParent(nullptr);
 		itemlist.erase(itemlist.begin() + index);
 	}
@@ -635,6 +678,9 @@ void Container::__internalAddThing(uint32_t, Thing* thing)
 	itemlist.push_front(item);
 	item->setParent(this);
 	updateItemWeight(item->getWeight());
+	if (Player* player = getIndexingPlayer()) {
+		player->getInventoryIndex().addItem(item);
+	}
 }
 
 void Container::__startDecaying()
@@ -47,6 +47,10 @@ public:
 	Container(uint16_t type, uint16_t size);
 	virtual ~Container();
 
+	using Pool = ObjectPool<Container, 8192>;
+	static void* operator new(size_t size) { return Pool::allocate(size); }
+	static void operator delete(void* p, size_t size) { Pool::deallocate(p, size); }
+
 	Item* clone() const override final;
 
 	Container* getContainer() override final { return this; }
@@ -62,6 +66,9 @@ public:
 	uint32_t getItemHoldingCount() const;
 	double getWeight() const override final;
 
+	// the player whose InventoryIndex covers this container, null inside the transfer container
+	Player* getIndexingPlayer();
+
 	uint32_t capacity() const { return maxSize; }
 	uint32_t size() const { return static_cast<uint32_t>(itemlist.size()); }
 	bool empty() const { return itemlist.empty(); }
@@ -140,4 +147,5 @@ protected:
 
 	friend class ContainerIterator;
 	friend class IOMapSerialize;
+	friend class IOLoginData;
 };
@@ -30,7 +30,7 @@
 #include <iomanip>
 
 Creature::CountBlock_t::CountBlock_t(uint32_t points) :
-	start(otx::util::mstime()),
+	start(otx::util::ticks()),
 	ticks(start),
 	total(points)
 {
@@ -97,6 +97,7 @@ Creature::~Creature()
 
 	m_summons.clear();
 	m_conditions.clear();
+	m_conditionTypes = 0;
 	m_eventsList.clear();
 }
 
@@ -153,7 +154,7 @@ bool Creature::canWalkthrough(const Creature* creature) const
 int64_t Creature::getTimeSinceLastMove() const
 {
 	if (m_lastStep) {
-		return otx::util::mstime() - m_lastStep;
+		return otx::util::ticks() - m_lastStep;
 	}
 
 	return 0x7FFFFFFFFFFFFFFFLL;
@@ -162,7 +163,7 @@ int64_t Creature::getTimeSinceLastMove() const
 int32_t Creature::getWalkDelay(Direction dir) const
 {
 	if (m_lastStep) {
-		return getStepDuration(dir) - (otx::util::mstime() - m_lastStep);
+		return getStepDuration(dir) - (otx::util::ticks() - m_lastStep);
 	}
 
 	return 0;
@@ -171,7 +172,7 @@ int32_t Creature::getWalkDelay(Direction dir) const
 int32_t Creature::getWalkDelay() const
 {
 	if (m_lastStep) {
-		return getStepDuration() - (otx::util::mstime() - m_lastStep);
+		return getStepDuration() - (otx::util::ticks() - m_lastStep);
 	}
 
 	return 0;
@@ -287,15 +288,14 @@ void Creature::onWalk()
 void Creature::onWalk(Direction& dir)
 {
 	int32_t drunk = -1;
-	if (!isSuppress(CONDITION_DRUNK)) {
-		Condition* condition = nullptr;
-		for (ConditionList::const_iterator it = m_conditions.begin(); it != m_conditions.end(); ++it) {
-			if (!(condition = *it) || condition->getType() != CONDITION_DRUNK) {
+	if (hasConditionType(CONDITION_DRUNK) && !isSuppress(CONDITION_DRUNK)) {
+		for (const Condition* condition : m_conditions) {
+			if (condition->getType() != CONDITION_DRUNK) {
 				continue;
 			}
 
 			int32_t subId = condition->getSubId();
-			if ((!condition->getEndTime() || condition->getEndTime() >= otx::util::mstime()) && subId > drunk) {
+			if ((!condition->getEndTime() || condition->getEndTime() >= otx::util::ticks()) && subId > drunk) {
 				drunk = subId;
 			}
 		}
@@ -524,7 +524,7 @@ void Creature::onCreatureMove(const Creature* creature, const Tile* newTile, con
 			setLastPosition(oldPos);
 		}
 
-		m_lastStep = otx::util::mstime();
+		m_lastStep = otx::util::ticks();
 		m_lastStepCost = 1;
 		if (!teleport) {
 			if (oldPos.z != newPos.z) {
@@ -822,7 +822,7 @@ DeathList Creature::getKillers()
 	}
 
 	int32_t requiredTime = otx::config::getInteger(otx::config::DEATHLIST_REQUIRED_TIME);
-	int64_t now = otx::util::mstime();
+	int64_t now = otx::util::ticks();
 
 	CountBlock_t cb;
 	for (it = m_damageMap.begin(); it != m_damageMap.end(); ++it) {
@@ -868,7 +868,7 @@ bool Creature::hasBeenAttacked(uint32_t attackerId) const
 {
 	CountMap::const_iterator it = m_damageMap.find(attackerId);
 	if (it != m_damageMap.end()) {
-		return (otx::util::mstime() - it->second.ticks) <= otx::config::getInteger(otx::config::PZ_LOCKED);
+		return (otx::util::ticks() - it->second.ticks) <= otx::config::getInteger(otx::config::PZ_LOCKED);
 	}
 
 	return false;
@@ -1048,7 +1048,7 @@ void Creature::getPathSearchParams(const Creature*, FindPathParams& fpp) const
 
 void Creature::goToFollowCreature()
 {
-	if (getPlayer() && (otx::util::mstime() - m_lastFailedFollow <= otx::config::getInteger(otx::config::FOLLOW_EXHAUST))) {
+	if (getPlayer() && (otx::util::ticks() - m_lastFailedFollow <= otx::config::getInteger(otx::config::FOLLOW_EXHAUST))) {
 		return;
 	}
 
@@ -1060,7 +1060,7 @@ void Creature::goToFollowCreature()
 			startAutoWalk(m_listWalkDir);
 		} else {
 			m_hasFollowPath = false;
-			m_lastFailedFollow = otx::util::mstime();
+			m_lastFailedFollow = otx::util::ticks();
 		}
 	}
 
@@ -1129,7 +1129,7 @@ void Creature::addDamagePoints(Creature* attacker, int32_t damagePoints)
 
 	CountMap::iterator it = m_damageMap.find(attackerId);
 	if (it != m_damageMap.end()) {
-		it->second.ticks = otx::util::mstime();
+		it->second.ticks = otx::util::ticks();
 		if (damagePoints > 0) {
 			it->second.total += damagePoints;
 		}
@@ -1155,7 +1155,7 @@ void Creature::addHealPoints(Creature* caster, int32_t healthPoints)
 
 	CountMap::iterator it = m_healMap.find(casterId);
 	if (it != m_healMap.end()) {
-		it->second.ticks = otx::util::mstime();
+		it->second.ticks = otx::util::ticks();
 		it->second.total += healthPoints;
 	} else {
 		m_healMap[casterId] = CountBlock_t(healthPoints);
@@ -1433,7 +1433,10 @@ bool Creature::addCondition(Condition* condition)
 	}
 
 	if (condition->startCondition(this)) {
+		static uint64_t conditionSerial = 0;
+		condition->setSerial(++conditionSerial);
 		m_conditions.push_back(condition);
+		m_conditionTypes |= condition->getType();
 		onAddCondition(condition->getType(), hadCondition);
 		return true;
 	}
@@ -1455,16 +1458,46 @@ bool Creature::addCombatCondition(Condition* condition)
 	return true;
 }
 
+bool Creature::addCombatCondition(const Condition* condition, uint32_t ownerId)
+{
+	bool hadCondition = hasCondition(condition->getType(), -1, false);
+	if (Condition* previous = getCondition(condition->getType(), condition->getId(), condition->getSubId())) {
+		previous->mergeCondition(this, condition, ownerId);
+		onAddCombatCondition(condition->getType(), hadCondition);
+		return true;
+	}
+
+	Condition* conditionClone = condition->clone();
+	if (ownerId) {
+		conditionClone->setParam(CONDITIONPARAM_OWNER, ownerId);
+	}
+	return addCombatCondition(conditionClone);
+}
+
+void Creature::eraseCondition(size_t index)
+{
+	m_conditions.erase(m_conditions.begin() + index);
+
+	m_conditionTypes = 0;
+	for (const Condition* condition : m_conditions) {
+		m_conditionTypes |= condition->getType();
+	}
+}
+
 void Creature::removeCondition(ConditionType_t type)
 {
-	for (ConditionList::iterator it = m_conditions.begin(); it != m_conditions.end();) {
-		if ((*it)->getType() != type) {
-			++it;
+	if (!hasConditionType(type)) {
+		return;
+	}
+
+	for (size_t i = 0; i < m_conditions.size();) {
+		Condition* condition = m_conditions[i];
+		if (condition->getType() != type) {
+			++i;
 			continue;
 		}
 
-		Condition* condition = *it;
-		it = m_conditions.erase(it);
+		eraseCondition(i);
 
 		condition->endCondition(this, CONDITIONEND_ABORT);
 		onEndCondition(condition->getType(), condition->getId());
@@ -1474,14 +1507,18 @@ void Creature::removeCondition(ConditionType_t type)
 
 void Creature::removeCondition(ConditionType_t type, ConditionId_t conditionId)
 {
-	for (ConditionList::iterator it = m_conditions.begin(); it != m_conditions.end();) {
-		if ((*it)->getType() != type || (*it)->getId() != conditionId) {
-			++it;
+	if (!hasConditionType(type)) {
+		return;
+	}
+
+	for (size_t i = 0; i < m_conditions.size();) {
+		Condition* condition = m_conditions[i];
+		if (condition->getType() != type || condition->getId() != conditionId) {
+			++i;
 			continue;
 		}
 
-		Condition* condition = *it;
-		it = m_conditions.erase(it);
+		eraseCondition(i);
 
 		condition->endCondition(this, CONDITIONEND_ABORT);
 		onEndCondition(condition->getType(), condition->getId());
@@ -1491,37 +1528,40 @@ void Creature::removeCondition(ConditionType_t type, ConditionId_t conditionId)
 
 void Creature::removeCondition(Condition* condition)
 {
-	ConditionList::iterator it = std::find(m_conditions.begin(), m_conditions.end(), condition);
+	auto it = std::find(m_conditions.begin(), m_conditions.end(), condition);
 	if (it != m_conditions.end()) {
-		Condition* tmpCondition = *it;
-		it = m_conditions.erase(it);
+		eraseCondition(it - m_conditions.begin());
 
-		tmpCondition->endCondition(this, CONDITIONEND_ABORT);
-		onEndCondition(tmpCondition->getType(), tmpCondition->getId());
-		delete tmpCondition;
+		condition->endCondition(this, CONDITIONEND_ABORT);
+		onEndCondition(condition->getType(), condition->getId());
+		delete condition;
 	}
 }
 
 void Creature::removeCondition(const Creature* attacker, ConditionType_t type)
 {
+	if (!hasConditionType(type)) {
+		return;
+	}
+
 	ConditionList tmpList = m_conditions;
-	for (ConditionList::iterator it = tmpList.begin(); it != tmpList.end(); ++it) {
-		if ((*it)->getType() == type) {
-			onCombatRemoveCondition(attacker, *it);
+	for (Condition* condition : tmpList) {
+		if (condition->getType() == type) {
+			onCombatRemoveCondition(attacker, condition);
 		}
 	}
 }
 
 void Creature::removeConditions(ConditionEnd_t reason, bool onlyPersistent /* = true*/)
 {
-	for (ConditionList::iterator it = m_conditions.begin(); it != m_conditions.end();) {
-		if (onlyPersistent && !(*it)->isPersistent()) {
-			++it;
+	for (size_t i = 0; i < m_conditions.size();) {
+		Condition* condition = m_conditions[i];
+		if (onlyPersistent && !condition->isPersistent()) {
+			++i;
 			continue;
 		}
 
-		Condition* condition = *it;
-		it = m_conditions.erase(it);
+		eraseCondition(i);
 
 		condition->endCondition(this, reason);
 		onEndCondition(condition->getType(), condition->getId());
@@ -1531,9 +1571,13 @@ void Creature::removeConditions(ConditionEnd_t reason, bool onlyPersistent /* =
 
 Condition* Creature::getCondition(ConditionType_t type, ConditionId_t conditionId, uint32_t subId /* = 0*/) const
 {
-	for (ConditionList::const_iterator it = m_conditions.begin(); it != m_conditions.end(); ++it) {
-		if ((*it)->getType() == type && (*it)->getId() == conditionId && (*it)->getSubId() == subId) {
-			return *it;
+	if (!hasConditionType(type)) {
+		return nullptr;
+	}
+
+	for (Condition* condition : m_conditions) {
+		if (condition->getType() == type && condition->getId() == conditionId && condition->getSubId() == subId) {
+			return condition;
 		}
 	}
 
@@ -1542,14 +1586,25 @@ Condition* Creature::getCondition(ConditionType_t type, ConditionId_t conditionI
 
 void Creature::executeConditions(uint32_t interval)
 {
-	for (ConditionList::iterator it = m_conditions.begin(); it != m_conditions.end();) {
-		if ((*it)->executeCondition(this, interval)) {
-			++it;
+	for (size_t i = 0; i < m_conditions.size();) {
+		Condition* condition = m_conditions[i];
+		const uint64_t serial = condition->getSerial();
+		if (condition->executeCondition(this, interval)) {
+			++i;
 			continue;
 		}
 
-		Condition* condition = *it;
-		it = m_conditions.erase(it);
+		// scripts or a death may have changed the list while it was executing, it is found again by serial
+		if (i >= m_conditions.size() || m_conditions[i]->getSerial() != serial) {
+			auto it = std::find_if(m_conditions.begin(), m_conditions.end(), [serial](const Condition* other) { return other->getSerial() == serial; });
+			if (it == m_conditions.end()) {
+				continue;
+			}
+
+			i = it - m_conditions.begin();
+		}
+
+		eraseCondition(i);
 
 		condition->endCondition(this, CONDITIONEND_TICKS);
 		onEndCondition(condition->getType(), condition->getId());
@@ -1559,17 +1614,16 @@ void Creature::executeConditions(uint32_t interval)
 
 bool Creature::hasCondition(ConditionType_t type, int32_t subId /* = 0*/, bool checkTime /* = true*/) const
 {
-	if (isSuppress(type)) {
+	if (!hasConditionType(type) || isSuppress(type)) {
 		return false;
 	}
 
-	Condition* condition = nullptr;
-	for (ConditionList::const_iterator it = m_conditions.begin(); it != m_conditions.end(); ++it) {
-		if (!(condition = *it) || condition->getType() != type || (subId != -1 && condition->getSubId() != static_cast<uint32_t>(subId))) {
+	for (const Condition* condition : m_conditions) {
+		if (condition->getType() != type || (subId != -1 && condition->getSubId() != static_cast<uint32_t>(subId))) {
 			continue;
 		}
 
-		if (!checkTime || !condition->getEndTime() || condition->getEndTime() >= otx::util::mstime()) {
+		if (!checkTime || !condition->getEndTime() || condition->getEndTime() >= otx::util::ticks()) {
 			return true;
 		}
 	}
@@ -110,7 +110,7 @@ struct DeathLessThan
 
 typedef std::vector<DeathEntry> DeathList;
 typedef std::list<CreatureEvent*> CreatureEventList;
-typedef std::list<Condition*> ConditionList;
+typedef std::vector<Condition*> ConditionList;
 typedef std::unordered_map<std::string, std::string> StorageMap;
 
 class Map;
@@ -302,6 +302,8 @@ public:
 
 	bool addCondition(Condition* condition);
 	bool addCombatCondition(Condition* condition);
+	// from a combat template: merged into a running condition, cloned only when it is new
+	bool addCombatCondition(const Condition* condition, uint32_t ownerId);
 	void removeCondition(ConditionType_t type);
 	void removeCondition(ConditionType_t type, ConditionId_t conditionId);
 	void removeCondition(Condition* condition);
@@ -310,6 +312,7 @@ public:
 	Condition* getCondition(ConditionType_t type, ConditionId_t conditionId, uint32_t subId = 0) const;
 	void executeConditions(uint32_t interval);
 	bool hasCondition(ConditionType_t type, int32_t subId = 0, bool checkTime = true) const;
+	bool hasConditionType(ConditionType_t type) const { return (m_conditionTypes & type) != 0; }
 	virtual bool isImmune(ConditionType_t type) const;
 	virtual bool isImmune(CombatType_t type) const;
 	virtual bool isSuppress(ConditionType_t type) const;
@@ -465,6 +468,9 @@ protected:
 
 	void updateMapCache();
 
+	// removes the condition from the list without ending it
+	void eraseCondition(size_t index);
+
 	void updateTileCache(const Tile* tile);
 	void updateTileCache(const Tile* tile, int32_t dx, int32_t dy);
 	void updateTileCache(const Tile* tile, const Position& pos);
@@ -521,6 +527,7 @@ protected:
 	GuildEmblems_t m_guildEmblem;
 	Direction m_direction;
 	ConditionList m_conditions;
+	uint32_t m_conditionTypes = 0; // ConditionType_t bits of m_conditions
 	LightInfo m_internalLight;
 
 	// summon variables
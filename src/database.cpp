@@ -23,6 +23,8 @@
 
 Database g_database;
 
+thread_local uint64_t Database::lastInsertId = 0;
+
 namespace
 {
 	MysqlPtr connectToDatabase(const bool retryIfError)
@@ -139,7 +141,12 @@ bool Database::commit()
 bool Database::executeQuery(std::string_view query)
 {
 	std::lock_guard<std::recursive_mutex> lockGuard(databaseLock);
-	return executeDatabaseQuery(handle, query, retryQueries);
+	if (!executeDatabaseQuery(handle, query, retryQueries)) {
+		return false;
+	}
+
+	lastInsertId = mysql_insert_id(handle.get());
+	return true;
 }
 
 bool Database::safeExecuteQuery(std::string_view query)
@@ -153,9 +160,16 @@ bool Database::safeExecuteQuery(std::string_view query)
 }
 
 DBResultPtr Database::storeQuery(std::string_view query)
+{
+	bool failed;
+	return storeQuery(query, failed);
+}
+
+DBResultPtr Database::storeQuery(std::string_view query, bool& failed)
 {
 	std::lock_guard<std::recursive_mutex> lockGuard(databaseLock);
 
+	failed = true;
 retry:
 	if (!executeDatabaseQuery(handle, query, retryQueries) && !retryQueries) {
 		return nullptr;
@@ -174,6 +188,7 @@ retry:
 	}
 
 	// retrieving results of query
+	failed = false;
 	DBResultPtr result = std::make_shared<DBResult>(std::move(res));
 	if (!result->hasNext()) {
 		return nullptr;
@@ -181,6 +196,34 @@ retry:
 	return result;
 }
 
+DBResultPtr Database::useQuery(std::string_view query)
+{
+	bool failed;
+	return useQuery(query, failed);
+}
+
+DBResultPtr Database::useQuery(std::string_view query, bool& failed)
+{
+	std::lock_guard<std::recursive_mutex> lockGuard(databaseLock);
+	failed = true;
+	if (!executeDatabaseQuery(handle, query, retryQueries)) {
+		return nullptr;
+	}
+
+	MysqlResultPtr res{ mysql_use_result(handle.get()) };
+	if (!res) {
+		std::clog << "[Error - Database::useQuery]\nQuery: " << query << "\nMessage: " << mysql_error(handle.get()) << " (" << mysql_errno(handle.get()) << ')' << std::endl;
+		return nullptr;
+	}
+
+	DBResultPtr result = std::make_shared<DBResult>(std::move(res), handle.get());
+	failed = result->hasFailed();
+	if (!result->hasNext()) {
+		return nullptr;
+	}
+	return result;
+}
+
 std::string Database::escapeString(const std::string& s) const
 {
 	return escapeBlob(s.data(), s.length());
@@ -239,67 +282,59 @@ bool Database::tableExists(const std::string& tableName)
 	return storeQuery(query.str()) != nullptr;
 }
 
-DBResult::DBResult(MysqlResultPtr&& res) :
-	handle(std::move(res))
+DBResult::DBResult(MysqlResultPtr&& res, MYSQL* stream /* = nullptr*/) :
+	handle(std::move(res)),
+	stream(stream)
 {
-	size_t i = 0;
 	MYSQL_FIELD* field = mysql_fetch_field(handle.get());
 	while (field) {
-		listNames[field->name] = i++;
+		listNames.emplace(field->name, columnCount++);
 		field = mysql_fetch_field(handle.get());
 	}
 
-	row = mysql_fetch_row(handle.get());
+	fetchRow();
 }
 
-bool DBResult::getBoolean(const std::string& s) const
+size_t DBResult::getColumnIndex(std::string_view s) const
 {
 	auto it = listNames.find(s);
 	if (it == listNames.end()) {
-		std::clog << "[Error - DBResult::getBoolean] Column '" << s << "' doesn't exist in the result set" << std::endl;
-		return false;
+		std::clog << "[Error - DBResult::getColumnIndex] Column '" << s << "' doesn't exist in the result set" << std::endl;
+		return INVALID_COLUMN;
 	}
 
-	if (!row[it->second]) {
+	return it->second;
+}
+
+bool DBResult::getBoolean(size_t column) const
+{
+	if (column >= columnCount || !row[column]) {
 		return false;
 	}
 
-	const char ch = *row[it->second];
+	const char ch = *row[column];
 	return (ch == '1' || ch == 'y' || ch == 'Y' || ch == 't' || ch == 'T');
 }
 
-std::string DBResult::getString(const std::string& s) const
+std::string DBResult::getString(size_t column) const
 {
-	auto it = listNames.find(s);
-	if (it == listNames.end()) {
-		std::clog << "[Error - DBResult::getString] Column '" << s << "' does not exist in result set." << std::endl;
-		return {};
-	}
-
-	if (!row[it->second]) {
+	if (column >= columnCount || !row[column]) {
 		return {};
 	}
 
-	unsigned long size = mysql_fetch_lengths(handle.get())[it->second];
-	return { row[it->second], size };
+	unsigned long size = mysql_fetch_lengths(handle.get())[column];
+	return { row[column], size };
 }
 
-const char* DBResult::getStream(const std::string& s, unsigned long& size) const
+const char* DBResult::getStream(size_t column, unsigned long& size) const
 {
-	auto it = listNames.find(s);
-	if (it == listNames.end()) {
-		std::clog << "[Error - DBResult::getStream] Column '" << s << "' does not exist in result set." << std::endl;
-		size = 0;
-		return nullptr;
-	}
-
-	if (!row[it->second]) {
+	if (column >= columnCount || !row[column]) {
 		size = 0;
 		return nullptr;
 	}
 
-	size = mysql_fetch_lengths(handle.get())[it->second];
-	return row[it->second];
+	size = mysql_fetch_lengths(handle.get())[column];
+	return row[column];
 }
 
 bool DBResult::hasNext() const
@@ -309,10 +344,20 @@ bool DBResult::hasNext() const
 
 bool DBResult::next()
 {
-	row = mysql_fetch_row(handle.get());
+	fetchRow();
 	return row != nullptr;
 }
 
+void DBResult::fetchRow()
+{
+	row = mysql_fetch_row(handle.get());
+	// a buffered result holds every row already, an unbuffered one may lose its connection midway
+	if (!row && stream && mysql_errno(stream) != 0) {
+		failed = true;
+		std::clog << "[Error - DBResult::next] Reading the rows failed: " << mysql_error(stream) << " (" << mysql_errno(stream) << ')' << std::endl;
+	}
+}
+
 DBInsert::DBInsert(std::string query) :
 	query(std::move(query))
 {
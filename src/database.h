@@ -68,6 +68,20 @@ public:
 	 * @return results object (nullptr on error)
 	 */
 	DBResultPtr storeQuery(std::string_view query);
+	// same, failed tells an error apart from an empty result
+	DBResultPtr storeQuery(std::string_view query, bool& failed);
+
+	/**
+	 * Queries database without buffering the result.
+	 *
+	 * Rows are transferred while they are read, nothing else may run on the connection until the
+	 * result is released, so it should be used on a connection of its own.
+	 *
+	 * @return results object (nullptr on error)
+	 */
+	DBResultPtr useQuery(std::string_view query);
+	// same, failed tells an error apart from an empty result
+	DBResultPtr useQuery(std::string_view query, bool& failed);
 
 	/**
 	 * Escapes string for query.
@@ -95,7 +109,7 @@ public:
 	 *
 	 * @return id on success, 0 if last query did not result on any rows with auto_increment keys
 	 */
-	uint64_t getLastInsertId() const { return static_cast<uint64_t>(mysql_insert_id(handle.get())); }
+	uint64_t getLastInsertId() const { return lastInsertId; }
 
 	/**
 	 * Get database engine version
@@ -131,6 +145,8 @@ private:
 	std::recursive_mutex databaseLock;
 	MysqlPtr handle;
 	uint64_t maxPacketSize = 1048576;
+	// captured under the lock, so a query from another thread cannot reset it before the caller reads it
+	static thread_local uint64_t lastInsertId;
 	// Do not retry queries if we are in the middle of a transaction
 	bool retryQueries = true;
 
@@ -142,42 +158,67 @@ extern Database g_database;
 class DBResult
 {
 public:
-	explicit DBResult(MysqlResultPtr&& res);
+	// stream is the connection of an unbuffered result, it tells a broken transfer apart from the last row
+	explicit DBResult(MysqlResultPtr&& res, MYSQL* stream = nullptr);
 
 	// non-copyable
 	DBResult(const DBResult&) = delete;
 	DBResult& operator=(const DBResult&) = delete;
 
+	static constexpr size_t INVALID_COLUMN = std::numeric_limits<size_t>::max();
+
+	/**
+	 * Resolves a column name to its index in the result set.
+	 *
+	 * Row loops should resolve their columns once before the loop and read them by index.
+	 *
+	 * @return column index, INVALID_COLUMN (reads as empty) if there is no such column
+	 */
+	size_t getColumnIndex(std::string_view s) const;
+
 	template<typename T>
 	std::enable_if_t<std::is_integral_v<T> || std::is_floating_point_v<T>, T>
-	getNumber(const std::string& s) const
+	getNumber(size_t column) const
 	{
-		auto it = listNames.find(s);
-		if (it == listNames.end()) {
-			std::clog << "[Error - DBResult::getNumber] Column '" << s << "' doesn't exist in the result set" << std::endl;
+		if (column >= columnCount || !row[column]) {
 			return {};
 		}
+		return otx::util::cast<T>(row[column]);
+	}
 
-		if (!row[it->second]) {
-			return {};
-		}
-		return otx::util::cast<T>(row[it->second]);
+	template<typename T>
+	std::enable_if_t<std::is_integral_v<T> || std::is_floating_point_v<T>, T>
+	getNumber(std::string_view s) const
+	{
+		return getNumber<T>(getColumnIndex(s));
 	}
 
+	bool getBoolean(size_t column) const;
+	std::string getString(size_t column) const;
+	const char* getStream(size_t column, unsigned long& size) const;
+
 	// returns true if first character is in '1tTyY'
-	bool getBoolean(const std::string& s) const;
-	std::string getString(const std::string& s) const;
-	const char* getStream(const std::string& s, unsigned long& size) const;
+	bool getBoolean(std::string_view s) const { return getBoolean(getColumnIndex(s)); }
+	std::string getString(std::string_view s) const { return getString(getColumnIndex(s)); }
+	const char* getStream(std::string_view s, unsigned long& size) const { return getStream(getColumnIndex(s), size); }
 
 	uint64_t getRowsCount() const { return mysql_num_rows(handle.get()); }
 
 	bool hasNext() const;
 	bool next();
 
+	// an unbuffered result stopped on an error rather than after its last row
+	bool hasFailed() const { return failed; }
+
 private:
-	std::map<std::string, size_t> listNames;
+	void fetchRow();
+
+	std::map<std::string, size_t, std::less<>> listNames;
 	MysqlResultPtr handle;
+	MYSQL* stream;
 	MYSQL_ROW row;
+	size_t columnCount = 0;
+	bool failed = false;
 
 	friend class Database;
 };
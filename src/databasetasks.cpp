@@ -0,0 +1,134 @@
+////////////////////////////////////////////////////////////////////////
+// OpenTibia - an opensource roleplaying game
+////////////////////////////////////////////////////////////////////////
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+////////////////////////////////////////////////////////////////////////
+
+#include "otpch.h"
+
+#include "databasetasks.h"
+
+#include "dispatcher.h"
+
+DatabaseTasks g_databaseTasks;
+
+void DatabaseTasks::threadMain()
+{
+	std::unique_lock<std::mutex> taskLockUnique(taskLock, std::defer_lock);
+	while (true) {
+		taskLockUnique.lock();
+		if (tasks.empty() && readTasks.empty()) {
+			if (getState() != THREAD_STATE_RUNNING) {
+				// the queue is drained before the thread exits, nothing written behind is lost
+				break;
+			}
+
+			taskSignal.wait(taskLockUnique);
+			taskLockUnique.unlock();
+			continue;
+		}
+
+		// writes go first, a read then never sees data older than what was queued before it
+		const bool read = tasks.empty();
+		std::list<DatabaseTask>& queue = read ? readTasks : tasks;
+		DatabaseTask task = std::move(queue.front());
+		queue.pop_front();
+		taskLockUnique.unlock();
+
+		runTask(db, task);
+
+		taskLockUnique.lock();
+		--pending;
+		if (!read && --pendingWrites == 0) {
+			flushSignal.notify_all();
+		}
+		taskLockUnique.unlock();
+	}
+
+	setState(THREAD_STATE_TERMINATED);
+}
+
+void DatabaseTasks::addTask(std::string query, DatabaseCallback callback /* = nullptr*/, bool store /* = false*/)
+{
+	addTask(DatabaseTask(std::move(query), std::move(callback), store), false);
+}
+
+void DatabaseTasks::addTask(DatabaseJob job, DatabaseCallback callback)
+{
+	addTask(DatabaseTask(std::move(job), std::move(callback)), false);
+}
+
+void DatabaseTasks::addReadTask(DatabaseJob job, DatabaseCallback callback)
+{
+	addTask(DatabaseTask(std::move(job), std::move(callback)), true);
+}
+
+void DatabaseTasks::addTask(DatabaseTask&& task, bool read)
+{
+	bool signal = false;
+
+	taskLock.lock();
+	if (getState() == THREAD_STATE_RUNNING) {
+		signal = tasks.empty() && readTasks.empty();
+		(read ? readTasks : tasks).push_back(std::move(task));
+		++pending;
+		if (!read) {
+			++pendingWrites;
+		}
+	} else {
+		// not started yet or already stopped, run it here so the write still happens in order
+		taskLock.unlock();
+		runTask(g_database, task);
+		return;
+	}
+	taskLock.unlock();
+
+	if (signal) {
+		taskSignal.notify_one();
+	}
+}
+
+void DatabaseTasks::runTask(Database& database, const DatabaseTask& task)
+{
+	bool success;
+	DBResultPtr result;
+	if (task.job) {
+		success = task.job(database);
+	} else if (task.store) {
+		result = database.storeQuery(task.query);
+		success = true;
+	} else {
+		success = database.executeQuery(task.query);
+	}
+
+	++executed;
+	if (task.callback) {
+		g_dispatcher.addTask(std::make_unique<Task>([callback = task.callback, result, success]() { callback(result, success); }));
+	}
+}
+
+void DatabaseTasks::flush()
+{
+	std::unique_lock<std::mutex> taskLockUnique(taskLock);
+	flushSignal.wait(taskLockUnique, [this]() { return pendingWrites == 0; });
+}
+
+void DatabaseTasks::shutdown()
+{
+	taskLock.lock();
+	stop();
+	taskLock.unlock();
+
+	taskSignal.notify_one();
+}
@@ -0,0 +1,83 @@
+////////////////////////////////////////////////////////////////////////
+// OpenTibia - an opensource roleplaying game
+////////////////////////////////////////////////////////////////////////
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "database.h"
+#include "thread_holder_base.h"
+
+using DatabaseCallback = std::function<void(DBResultPtr, bool)>;
+using DatabaseJob = std::function<bool(Database&)>;
+
+struct DatabaseTask
+{
+	DatabaseTask(std::string&& query, DatabaseCallback&& callback, bool store) :
+		query(std::move(query)),
+		callback(std::move(callback)),
+		store(store) {}
+	DatabaseTask(DatabaseJob&& job, DatabaseCallback&& callback) :
+		job(std::move(job)),
+		callback(std::move(callback)) {}
+
+	std::string query;
+	DatabaseJob job;
+	DatabaseCallback callback;
+	bool store = false;
+};
+
+// runs queries in order on its own connection; callbacks are posted back to the dispatcher
+class DatabaseTasks final : public ThreadHolder<DatabaseTasks>
+{
+public:
+	DatabaseTasks() = default;
+
+	// non-copyable
+	DatabaseTasks(const DatabaseTasks&) = delete;
+	DatabaseTasks& operator=(const DatabaseTasks&) = delete;
+
+	bool connect() { return db.connect(); }
+
+	void addTask(std::string query, DatabaseCallback callback = nullptr, bool store = false);
+	// runs several queries in a row on the worker connection, the callback gets its result and no rows
+	void addTask(DatabaseJob job, DatabaseCallback callback);
+	// same, for a job that only reads: it yields to every write and flush() does not wait for it
+	void addReadTask(DatabaseJob job, DatabaseCallback callback);
+
+	// blocks until every write queued so far has been executed
+	void flush();
+	void shutdown();
+
+	uint32_t getPending() const { return pending; }
+	uint64_t getExecuted() const { return executed; }
+
+	void threadMain();
+
+private:
+	void addTask(DatabaseTask&& task, bool read);
+	void runTask(Database& database, const DatabaseTask& task);
+
+	Database db;
+	std::mutex taskLock;
+	std::condition_variable taskSignal;
+	std::condition_variable flushSignal;
+
+	std::list<DatabaseTask> tasks, readTasks;
+	std::atomic<uint32_t> pending{ 0 }, pendingWrites{ 0 };
+	std::atomic<uint64_t> executed{ 0 };
+};
+
+extern DatabaseTasks g_databaseTasks;
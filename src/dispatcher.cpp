@@ -19,6 +19,10 @@
 
 #include "dispatcher.h"
 
+#include "outputmessage.h"
+
+#include "otx/util.hpp"
+
 Dispatcher g_dispatcher;
 
 void Dispatcher::threadMain()
@@ -42,11 +46,14 @@ void Dispatcher::threadMain()
 		for (auto& task : tmpTaskList) {
 			if (!task->hasExpired()) {
 				++dispatcherCycle;
+				otx::util::update_ticks();
 				// execute it
 				(*task)();
 			}
 		}
 
+		// whatever answers the commands of this batch goes out now, not with the next autosend
+		OutputMessagePool::getInstance().onBatchEnd();
 		tmpTaskList.clear();
 	}
 }
@@ -23,7 +23,7 @@
 #define addTimedDispatcherTask(delay, function) g_dispatcher.addTask(std::make_unique<Task>(delay, function))
 
 static constexpr uint32_t DISPATCHER_TASK_EXPIRATION = 2000;
-static constexpr auto SYSTEM_TIME_ZERO = std::chrono::system_clock::time_point(std::chrono::milliseconds(0));
+static constexpr auto TASK_TIME_ZERO = std::chrono::steady_clock::time_point(std::chrono::milliseconds(0));
 
 class Task;
 using TaskFunc = std::function<void(void)>;
@@ -36,23 +36,23 @@ public:
 		m_func(std::move(f)) {}
 	Task(uint32_t ms, TaskFunc&& f) :
 		m_func(std::move(f)),
-		m_expiration(std::chrono::system_clock::now() + std::chrono::milliseconds(ms)) {}
+		m_expiration(std::chrono::steady_clock::now() + std::chrono::milliseconds(ms)) {}
 	virtual ~Task() = default;
 
 	void operator()() { m_func(); }
 
-	void unsetExpiration() { m_expiration = SYSTEM_TIME_ZERO; }
+	void unsetExpiration() { m_expiration = TASK_TIME_ZERO; }
 	bool hasExpired() const
 	{
-		if (m_expiration == SYSTEM_TIME_ZERO) {
+		if (m_expiration == TASK_TIME_ZERO) {
 			return false;
 		}
-		return m_expiration < std::chrono::system_clock::now();
+		return m_expiration < std::chrono::steady_clock::now();
 	}
 
 private:
 	TaskFunc m_func;
-	std::chrono::system_clock::time_point m_expiration = SYSTEM_TIME_ZERO;
+	std::chrono::steady_clock::time_point m_expiration = TASK_TIME_ZERO;
 };
 
 class Dispatcher final : public ThreadHolder<Dispatcher>
@@ -37,6 +37,7 @@
 #include "monsters.h"
 #include "movement.h"
 #include "npc.h"
+#include "protocolstatus.h"
 #include "raids.h"
 #include "server.h"
 #include "spawn.h"
@@ -291,6 +292,9 @@ void Game::setGameState(GameState_t newState)
 					IOLoginData::getInstance()->updatePremiumDays();
 				}
 
+				// after the startup scripts, they may remove inactive guilds
+				IOGuild::getInstance()->load();
+
 				IOGuild::getInstance()->checkWars();
 				IOGuild::getInstance()->checkEndingWars();
 
@@ -1330,7 +1334,7 @@ bool Game::playerMoveCreature(const uint32_t playerId, const uint32_t movingCrea
 
 		internalTeleport(movingCreature, toTile->getPosition(), false);
 	} else if (Player* movingPlayer = movingCreature->getPlayer()) {
-		const uint64_t stepDelay = otx::util::mstime() + movingPlayer->getStepDuration();
+		const uint64_t stepDelay = otx::util::ticks() + movingPlayer->getStepDuration();
 		if (stepDelay > movingPlayer->getNextActionTime(false)) {
 			movingPlayer->setNextAction(stepDelay);
 		}
@@ -1602,7 +1606,7 @@ bool Game::playerMoveItem(const uint32_t playerId, const Position& fromPos,
 		return false;
 	}
 
-	player->setNextAction(otx::util::mstime() + otx::config::getInteger(otx::config::ACTIONS_DELAY_INTERVAL) - 10);
+	player->setNextAction(otx::util::ticks() + otx::config::getInteger(otx::config::ACTIONS_DELAY_INTERVAL) - 10);
 	return true;
 }
 
@@ -2240,6 +2244,13 @@ uint64_t Game::getMoney(const Cylinder* cylinder)
 		return 0;
 	}
 
+	// players keep a running total of what they carry
+	const Creature* creature = cylinder->getCreature();
+	if (const Player* player = (creature ? creature->getPlayer() : nullptr)) {
+		// CUSTOM: Discount Money to Bank
+		return player->getMoney() + player->m_balance;
+	}
+
 	std::list<Container*> listContainer;
 	Container* tmpContainer = nullptr;
 
@@ -2272,10 +2283,6 @@ uint64_t Game::getMoney(const Cylinder* cylinder)
 		}
 	}
 
-	// CUSTOM: Discount Money to Bank
-	if (const Player* p = dynamic_cast<const Player*>(cylinder)) {
-		moneyCount += p->m_balance;
-	}
 	return moneyCount;
 }
 
@@ -2484,6 +2491,21 @@ Item* Game::transformItem(Item* item, const uint16_t newId, const int32_t newCou
 
 		cylinder->postRemoveNotification(nullptr, item, cylinder, itemIndex, false);
 		uint16_t tmp = (curType.id != newId) ? newId : item->getID();
+
+		// __updateThing takes off the InventoryIndex what it finds, so the reset below is accounted for here
+		Player* indexPlayer = nullptr;
+		if (Item* parentItem = cylinder->getItem()) {
+			if (Container* container = parentItem->getContainer()) {
+				indexPlayer = container->getIndexingPlayer();
+			}
+		} else if (Creature* creature = cylinder->getCreature()) {
+			indexPlayer = creature->getPlayer();
+		}
+
+		if (indexPlayer) {
+			indexPlayer->getInventoryIndex().removeItem(item, false);
+		}
+
 		if (newType.group != curType.group) {
 			item->setDefaultSubtype();
 		}
@@ -2493,6 +2515,10 @@ Item* Game::transformItem(Item* item, const uint16_t newId, const int32_t newCou
 			item->resetCharges();
 		}
 
+		if (indexPlayer) {
+			indexPlayer->getInventoryIndex().addItem(item, false);
+		}
+
 		int32_t count = (newCount != -1 && newType.hasSubType()) ? newCount : item->getSubType();
 		cylinder->__updateThing(item, tmp, count);
 		cylinder->postAddNotification(nullptr, item, cylinder, itemIndex);
@@ -4256,7 +4282,7 @@ bool Game::playerSetFightModes(const uint32_t playerId, FightMode_t fightMode, b
 	player->setFightMode(fightMode);
 	player->setChaseMode(chaseMode);
 	player->setSecureMode(secureMode);
-	player->setLastAttack(otx::util::mstime());
+	player->setLastAttack(otx::util::ticks());
 	return true;
 }
 
@@ -4271,7 +4297,7 @@ bool Game::playerRequestAddVip(const uint32_t playerId, const std::string& vipNa
 	bool specialVip;
 	std::string name = vipName;
 
-	player->setNextExAction(otx::util::mstime() + otx::config::getInteger(otx::config::CUSTOM_ACTIONS_DELAY_INTERVAL) - 10);
+	player->setNextExAction(otx::util::ticks() + otx::config::getInteger(otx::config::CUSTOM_ACTIONS_DELAY_INTERVAL) - 10);
 	if (!IOLoginData::getInstance()->getGuidByNameEx(guid, specialVip, name)) {
 		player->sendTextMessage(MSG_STATUS_SMALL, "A player with that name does not exist.");
 		return false;
@@ -4959,6 +4985,13 @@ void Game::checkCreatures()
 		}
 	}
 
+#if ENABLE_SERVER_DIAGNOSTIC > 0
+	Monster::endThinkTick();
+#endif
+
+	// moves only invalidate the entries around them, so positions queried once in a quiet
+	// area would stay cached forever; start every tick with an empty cache instead
+	clearSpectatorCache();
 	cleanup();
 }
 
@@ -5660,6 +5693,7 @@ void Game::checkWars()
 {
 	// executes every EVENT_WARSINTERVAL
 	IOGuild::getInstance()->checkWars();
+	IOGuild::getInstance()->checkMembers();
 	if (checkEndingWars) {
 		// executes every EVENT_WARSINTERVAL*2
 		checkEndingWars = false;
@@ -7026,6 +7060,8 @@ void Game::globalSave()
 
 	// reload everything
 	reloadInfo(RELOAD_ALL);
+	// pick up guild changes made outside of the server
+	IOGuild::getInstance()->load();
 
 	// prepare for next global save after 24 hours
 	addSchedulerTask(((24 * 60 * 60) - (5 * 60)) * 1000, [this]() { prepareGlobalSave(5); });
@@ -7147,6 +7183,7 @@ void Game::addPlayer(Player* player)
 	mappedPlayerGuids[player->getGUID()] = player;
 	wildcardTree.insert(lowercase_name);
 	players[player->getID()] = player;
+	ProtocolStatus::invalidateCache();
 }
 
 void Game::removePlayer(Player* player)
@@ -7156,6 +7193,7 @@ void Game::removePlayer(Player* player)
 	mappedPlayerGuids.erase(player->getGUID());
 	wildcardTree.remove(lowercase_name);
 	players.erase(player->getID());
+	ProtocolStatus::invalidateCache();
 }
 
 void Game::addNpc(Npc* npc)
@@ -354,6 +354,12 @@ public:
 			map->clearSpectatorCache();
 		}
 	}
+	void invalidateSpectatorCache(const Position& pos)
+	{
+		if (map) {
+			map->invalidateSpectatorCache(pos);
+		}
+	}
 
 	ReturnValue internalMoveCreature(Creature* creature, const Direction& direction, uint32_t flags = 0);
 	ReturnValue internalMoveCreature(Creature* actor, Creature* creature, Cylinder* fromCylinder,
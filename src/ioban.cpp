@@ -19,50 +19,239 @@
 
 #include "ioban.h"
 
+#include "configmanager.h"
 #include "database.h"
 #include "game.h"
 #include "iologindata.h"
 
-bool IOBan::isIpBanished(uint32_t ip, uint32_t mask /* = 0xFFFFFFFF*/) const
+void IOBan::start()
 {
-	if (!ip) {
+	reload();
+
+	std::lock_guard<std::mutex> lockGuard(m_lock);
+	if (!m_running) {
+		m_running = true;
+		m_thread = std::thread(&IOBan::threadMain, this);
+	}
+}
+
+void IOBan::shutdown()
+{
+	{
+		std::lock_guard<std::mutex> lockGuard(m_lock);
+		if (!m_running) {
+			return;
+		}
+
+		m_running = false;
+	}
+
+	m_signal.notify_one();
+	m_thread.join();
+}
+
+void IOBan::threadMain()
+{
+	std::unique_lock<std::mutex> lock(m_lock);
+	while (m_running) {
+		const int64_t interval = otx::config::getInteger(otx::config::BAN_CACHE_REFRESH);
+		if (interval <= 0) {
+			m_signal.wait(lock, [this]() { return !m_running; });
+		} else if (m_signal.wait_for(lock, std::chrono::milliseconds(interval), [this]() { return !m_running; })) {
+			break;
+		}
+
+		if (m_running) {
+			lock.unlock();
+			reload();
+			lock.lock();
+		}
+	}
+}
+
+bool IOBan::reload()
+{
+	// the query runs without m_writeLock, a Lua transaction may hold the database while it bans someone
+	{
+		std::lock_guard<std::mutex> lockGuard(m_writeLock);
+		m_reloading = true;
+		m_reloadChanges.clear();
+	}
+
+	std::ostringstream query;
+	query << "SELECT `id`, `type`, `value`, `param`, `expires`, `added`, `admin_id`, `comment`, `reason`, `action`, `statement` FROM `bans` WHERE `type` IN ("
+		  << static_cast<int>(BAN_IP) << ", " << static_cast<int>(BAN_PLAYER) << ", " << static_cast<int>(BAN_ACCOUNT) << ") AND `active` = 1";
+
+	bool failed;
+	auto index = std::make_shared<BanIndex>();
+	if (DBResultPtr result = g_database.storeQuery(query.str(), failed)) {
+		const size_t idColumn = result->getColumnIndex("id"), typeColumn = result->getColumnIndex("type"),
+					 valueColumn = result->getColumnIndex("value"), paramColumn = result->getColumnIndex("param"),
+					 expiresColumn = result->getColumnIndex("expires"), addedColumn = result->getColumnIndex("added"),
+					 adminColumn = result->getColumnIndex("admin_id"), commentColumn = result->getColumnIndex("comment"),
+					 reasonColumn = result->getColumnIndex("reason"), actionColumn = result->getColumnIndex("action"),
+					 statementColumn = result->getColumnIndex("statement");
+		do {
+			Ban ban;
+			ban.id = result->getNumber<int32_t>(idColumn);
+			ban.type = static_cast<Ban_t>(result->getNumber<int32_t>(typeColumn));
+			ban.value = result->getNumber<int32_t>(valueColumn);
+			ban.param = result->getNumber<int32_t>(paramColumn);
+			ban.expires = result->getNumber<uint64_t>(expiresColumn);
+			ban.added = result->getNumber<uint64_t>(addedColumn);
+			ban.adminId = result->getNumber<int32_t>(adminColumn);
+			ban.comment = result->getString(commentColumn);
+			ban.reason = result->getNumber<int32_t>(reasonColumn);
+			ban.action = static_cast<ViolationAction_t>(result->getNumber<uint8_t>(actionColumn));
+			ban.statement = result->getString(statementColumn);
+			insertBan(*index, std::move(ban));
+		} while (result->next());
+	}
+
+	std::lock_guard<std::mutex> lockGuard(m_writeLock);
+	m_reloading = false;
+	if (failed) {
+		// an error is not an empty table, the bans we know of stay in force
+		m_reloadChanges.clear();
 		return false;
 	}
 
-	DBResultPtr result;
+	// bans issued or lifted while the query ran, the result may or may not contain them already
+	for (const auto& change : m_reloadChanges) {
+		change(*index);
+	}
+
+	m_reloadChanges.clear();
+	std::atomic_store(&m_index, BanIndexPtr(std::move(index)));
+	return true;
+}
 
+size_t IOBan::getCachedCount() const
+{
+	BanIndexPtr index = getIndex();
+	return index->ipBans.size() + index->bans.size();
+}
+
+void IOBan::insertBan(BanIndex& index, Ban ban)
+{
+	if (ban.type == BAN_IP) {
+		if (std::none_of(index.ipBans.begin(), index.ipBans.end(), [&ban](const Ban& other) { return other.id == ban.id; })) {
+			index.ipBans.push_back(std::move(ban));
+		}
+		return;
+	}
+
+	const uint64_t key = getKey(ban.type, ban.value);
+	auto range = index.bans.equal_range(key);
+	if (std::none_of(range.first, range.second, [&ban](const auto& entry) { return entry.second.id == ban.id; })) {
+		index.bans.emplace(key, std::move(ban));
+	}
+}
+
+void IOBan::updateIndex(const std::function<void(BanIndex&)>& function) const
+{
+	// m_writeLock is held by the caller
+	auto index = std::make_shared<BanIndex>(*getIndex());
+	function(*index);
+	std::atomic_store(&m_index, BanIndexPtr(std::move(index)));
+	if (m_reloading) {
+		m_reloadChanges.push_back(function);
+	}
+}
+
+void IOBan::addToIndex(Ban_t type, uint32_t value, uint32_t param, int64_t banTime, uint32_t reasonId, ViolationAction_t actionId,
+	const std::string& comment, uint32_t gamemaster, const std::string& statement) const
+{
+	Ban ban;
+	ban.id = g_database.getLastInsertId();
+	ban.type = type;
+	ban.value = value;
+	ban.param = param;
+	ban.expires = banTime;
+	ban.added = time(nullptr);
+	ban.adminId = gamemaster;
+	ban.comment = comment;
+	ban.reason = reasonId;
+	ban.action = actionId;
+	ban.statement = statement;
+
+	std::lock_guard<std::mutex> lockGuard(m_writeLock);
+	updateIndex([ban](BanIndex& index) { insertBan(index, ban); });
+}
+
+void IOBan::removeFromIndex(Ban_t type, uint32_t value, uint32_t id) const
+{
+	std::lock_guard<std::mutex> lockGuard(m_writeLock);
+	updateIndex([=](BanIndex& index) {
+		if (type == BAN_IP) {
+			index.ipBans.erase(std::remove_if(index.ipBans.begin(), index.ipBans.end(), [=](const Ban& ban) { return ban.id == id; }), index.ipBans.end());
+			return;
+		}
+
+		auto range = index.bans.equal_range(getKey(type, value));
+		auto it = std::find_if(range.first, range.second, [=](const auto& entry) { return entry.second.id == id; });
+		if (it != range.second) {
+			index.bans.erase(it);
+		}
+	});
+}
+
+bool IOBan::removeBan(Ban_t type, uint32_t value, const std::string& condition) const
+{
+	// the row is picked first, so the index loses the very ban the table deactivates
 	std::ostringstream query;
-	query << "SELECT `id`, `value`, `param`, `expires` FROM `bans` WHERE `type` = " << static_cast<int>(BAN_IP) << " AND `active` = 1";
+	query << "SELECT `id` FROM `bans` WHERE `value` = " << value << condition << " AND `type` = " << static_cast<int>(type)
+		  << " AND `active` = 1 LIMIT 1";
+
+	DBResultPtr result;
 	if (!(result = g_database.storeQuery(query.str()))) {
 		return false;
 	}
 
+	const uint32_t id = result->getNumber<uint32_t>("id");
+	query.str("");
+	query << "UPDATE `bans` SET `active` = 0 WHERE `id` = " << id;
+	if (!g_database.executeQuery(query.str())) {
+		return false;
+	}
+
+	removeFromIndex(type, value, id);
+	return true;
+}
+
+bool IOBan::isIpBanished(uint32_t ip, uint32_t mask /* = 0xFFFFFFFF*/) const
+{
+	if (!ip) {
+		return false;
+	}
+
+	const time_t now = time(nullptr);
+
 	bool ret = false;
-	do {
-		uint32_t value = result->getNumber<int32_t>("value"), param = result->getNumber<int32_t>("param");
-		if ((ip & mask & param) == (value & param & mask)) {
-			int32_t expires = result->getNumber<uint64_t>("expires");
-			if (expires > 0 && expires <= time(nullptr)) {
-				removeIpBanishment(value, param);
-			} else if (!ret) {
+	BanIndexPtr index = getIndex();
+	for (const Ban& ban : index->ipBans) {
+		if ((ip & mask & ban.param) == (ban.value & ban.param & mask)) {
+			if (isExpired(ban, now)) {
+				removeIpBanishment(ban.value, ban.param);
+			} else {
 				ret = true;
 			}
 		}
-	} while (result->next());
+	}
 	return ret;
 }
 
 bool IOBan::isPlayerBanished(uint32_t playerId, PlayerBan_t type) const
 {
-	DBResultPtr result;
-
-	std::ostringstream query;
-	query << "SELECT `id` FROM `bans` WHERE `type` = " << static_cast<int>(BAN_PLAYER) << " AND `value` = " << playerId << " AND `param` = " << static_cast<int>(type) << " AND `active` = 1 LIMIT 1";
-	if (!(result = g_database.storeQuery(query.str()))) {
-		return false;
+	BanIndexPtr index = getIndex();
+	auto range = index->bans.equal_range(getKey(BAN_PLAYER, playerId));
+	for (auto it = range.first; it != range.second; ++it) {
+		if (it->second.param == static_cast<uint32_t>(type)) {
+			return true;
+		}
 	}
 
-	return true;
+	return false;
 }
 
 bool IOBan::isPlayerBanished(std::string name, PlayerBan_t type) const
@@ -74,25 +263,27 @@ bool IOBan::isPlayerBanished(std::string name, PlayerBan_t type) const
 
 bool IOBan::isAccountBanished(uint32_t account, uint32_t playerId /* = 0*/) const
 {
-	DBResultPtr result;
+	const time_t now = time(nullptr);
+
+	bool expired = false;
+	BanIndexPtr index = getIndex();
+	auto range = index->bans.equal_range(getKey(BAN_ACCOUNT, account));
+	for (auto it = range.first; it != range.second; ++it) {
+		if (playerId > 0 && it->second.param != playerId) {
+			continue;
+		}
 
-	std::ostringstream query;
-	query << "SELECT `expires` FROM `bans` WHERE `type` = " << BAN_ACCOUNT << " AND `value` = " << account;
-	if (playerId > 0) {
-		query << " AND `param` = " << playerId;
-	}
+		if (!isExpired(it->second, now)) {
+			return true;
+		}
 
-	query << " AND `active` = 1 LIMIT 1";
-	if (!(result = g_database.storeQuery(query.str()))) {
-		return false;
+		expired = true;
 	}
 
-	const auto expires = result->getNumber<int32_t>("expires");
-	if (expires <= 0 || expires > time(nullptr)) {
-		return true;
+	if (expired) {
+		removeAccountBanishment(account);
 	}
 
-	removeAccountBanishment(account);
 	return false;
 }
 
@@ -112,7 +303,12 @@ bool IOBan::addIpBanishment(uint32_t ip, int64_t banTime, uint32_t reasonId,
 	query << "INSERT INTO `bans` (`id`, `type`, `value`, `param`, `expires`, `added`, `admin_id`, `comment`, `reason`, `statement`) ";
 	query << "VALUES (NULL, " << static_cast<int>(BAN_IP) << ", " << ip << ", " << mask << ", " << banTime << ", " << time(nullptr) << ", " << gamemaster;
 	query << ", " << g_database.escapeString(comment) << ", " << reasonId << ", " << g_database.escapeString(statement) << ")";
-	return g_database.executeQuery(query.str());
+	if (!g_database.executeQuery(query.str())) {
+		return false;
+	}
+
+	addToIndex(BAN_IP, ip, mask, banTime, reasonId, ACTION_PLACEHOLDER, comment, gamemaster, statement);
+	return true;
 }
 
 bool IOBan::addPlayerBanishment(uint32_t playerId, int64_t banTime, uint32_t reasonId, ViolationAction_t actionId,
@@ -127,7 +323,12 @@ bool IOBan::addPlayerBanishment(uint32_t playerId, int64_t banTime, uint32_t rea
 	query << "INSERT INTO `bans` (`id`, `type`, `value`, `param`, `expires`, `added`, `admin_id`, `comment`, `reason`, `action`, `statement`) ";
 	query << "VALUES (NULL, " << static_cast<int>(BAN_PLAYER) << ", " << playerId << ", " << static_cast<int>(type) << ", " << banTime << ", " << time(nullptr) << ", " << gamemaster;
 	query << ", " << g_database.escapeString(comment) << ", " << reasonId << ", " << actionId << ", " << g_database.escapeString(statement) << ")";
-	return g_database.executeQuery(query.str());
+	if (!g_database.executeQuery(query.str())) {
+		return false;
+	}
+
+	addToIndex(BAN_PLAYER, playerId, type, banTime, reasonId, actionId, comment, gamemaster, statement);
+	return true;
 }
 
 bool IOBan::addPlayerBanishment(std::string name, int64_t banTime, uint32_t reasonId, ViolationAction_t actionId, std::string comment, uint32_t gamemaster, PlayerBan_t type, std::string statement /* = ""*/) const
@@ -147,7 +348,12 @@ bool IOBan::addAccountBanishment(uint32_t account, int64_t banTime, uint32_t rea
 	query << "INSERT INTO `bans` (`id`, `type`, `value`, `param`, `expires`, `added`, `admin_id`, `comment`, `reason`, `action`, `statement`) ";
 	query << "VALUES (NULL, " << static_cast<int>(BAN_ACCOUNT) << ", " << account << ", " << playerId << ", " << banTime << ", " << time(nullptr) << ", " << gamemaster;
 	query << ", " << g_database.escapeString(comment) << ", " << reasonId << ", " << actionId << ", " << g_database.escapeString(statement) << ")";
-	return g_database.executeQuery(query.str());
+	if (!g_database.executeQuery(query.str())) {
+		return false;
+	}
+
+	addToIndex(BAN_ACCOUNT, account, playerId, banTime, reasonId, actionId, comment, gamemaster, statement);
+	return true;
 }
 
 bool IOBan::addNotation(uint32_t account, uint32_t reasonId, std::string comment, uint32_t gamemaster, uint32_t playerId, std::string statement /* = ""*/) const
@@ -187,20 +393,16 @@ bool IOBan::addStatement(std::string name, uint32_t reasonId, std::string commen
 
 bool IOBan::removeIpBanishment(uint32_t ip, uint32_t mask /* = 0xFFFFFFFF*/) const
 {
-	std::ostringstream query;
-
-	query << "UPDATE `bans` SET `active` = 0 WHERE `value` = " << ip << " AND `param` = " << mask
-		  << " AND `type` = " << static_cast<int>(BAN_IP) << " AND `active` = 1 LIMIT 1";
-	return g_database.executeQuery(query.str());
+	std::ostringstream condition;
+	condition << " AND `param` = " << mask;
+	return removeBan(BAN_IP, ip, condition.str());
 }
 
 bool IOBan::removePlayerBanishment(uint32_t guid, PlayerBan_t type) const
 {
-	std::ostringstream query;
-
-	query << "UPDATE `bans` SET `active` = 0 WHERE `value` = " << guid << " AND `param` = " << type
-		  << " AND `type` = " << static_cast<int>(BAN_PLAYER) << " AND `active` = 1 LIMIT 1";
-	return g_database.executeQuery(query.str());
+	std::ostringstream condition;
+	condition << " AND `param` = " << type;
+	return removeBan(BAN_PLAYER, guid, condition.str());
 }
 
 bool IOBan::removePlayerBanishment(std::string name, PlayerBan_t type) const
@@ -212,15 +414,12 @@ bool IOBan::removePlayerBanishment(std::string name, PlayerBan_t type) const
 
 bool IOBan::removeAccountBanishment(uint32_t account, uint32_t playerId /* = 0*/) const
 {
-	std::ostringstream query;
-
-	query << "UPDATE `bans` SET `active` = 0 WHERE `value` = " << account;
+	std::ostringstream condition;
 	if (playerId > 0) {
-		query << " AND `param` = " << playerId;
+		condition << " AND `param` = " << playerId;
 	}
 
-	query << " AND `type` = " << static_cast<int>(BAN_ACCOUNT) << " AND `active` = 1 LIMIT 1";
-	return g_database.executeQuery(query.str());
+	return removeBan(BAN_ACCOUNT, account, condition.str());
 }
 
 bool IOBan::removeNotations(uint32_t account, uint32_t playerId /* = 0*/) const
@@ -304,6 +503,39 @@ uint32_t IOBan::getStatementsCount(std::string name, int16_t channelId /* = -1*/
 }
 
 bool IOBan::getData(Ban& ban) const
+{
+	if (ban.type != BAN_IP && ban.type != BAN_PLAYER && ban.type != BAN_ACCOUNT) {
+		return getDataFromDatabase(ban);
+	}
+
+	const time_t now = time(nullptr);
+	auto matches = [&ban, now](const Ban& cached) {
+		return cached.value == ban.value && (!ban.param || cached.param == ban.param) && !isExpired(cached, now);
+	};
+
+	BanIndexPtr index = getIndex();
+	if (ban.type == BAN_IP) {
+		auto it = std::find_if(index->ipBans.begin(), index->ipBans.end(), matches);
+		if (it == index->ipBans.end()) {
+			return false;
+		}
+
+		ban = *it;
+		return true;
+	}
+
+	auto range = index->bans.equal_range(getKey(ban.type, ban.value));
+	for (auto it = range.first; it != range.second; ++it) {
+		if (matches(it->second)) {
+			ban = it->second;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool IOBan::getDataFromDatabase(Ban& ban) const
 {
 	std::ostringstream query;
 
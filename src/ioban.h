@@ -17,6 +17,11 @@
 
 #pragma once
 
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
 enum Ban_t : uint8_t
 {
 	BAN_NONE = 0,
@@ -56,16 +61,23 @@ typedef std::vector<Ban> BansVec;
 class IOBan final
 {
 private:
-	IOBan() {}
+	IOBan() : m_index(std::make_shared<const BanIndex>()) {}
 
 public:
-	virtual ~IOBan() {}
+	virtual ~IOBan() { shutdown(); }
 	static IOBan* getInstance()
 	{
 		static IOBan instance;
 		return &instance;
 	}
 
+	// loads the ban index and starts refreshing it for edits made outside the server
+	void start();
+	void shutdown();
+	bool reload();
+
+	size_t getCachedCount() const;
+
 	bool isIpBanished(uint32_t ip, uint32_t mask = 0xFFFFFFFF) const;
 	bool isPlayerBanished(uint32_t guid, PlayerBan_t type) const;
 	bool isPlayerBanished(std::string name, PlayerBan_t type) const;
@@ -102,4 +114,40 @@ public:
 	uint32_t getStatementsCount(std::string name, int16_t channelId = -1) const;
 
 	bool clearTemporials() const;
+
+private:
+	// active ip, player and account bans; readers take a snapshot, writers publish a modified copy
+	struct BanIndex
+	{
+		std::vector<Ban> ipBans;
+		std::unordered_multimap<uint64_t, Ban> bans;
+	};
+	using BanIndexPtr = std::shared_ptr<const BanIndex>;
+
+	static uint64_t getKey(Ban_t type, uint32_t value) { return (static_cast<uint64_t>(type) << 32) | value; }
+	static bool isExpired(const Ban& ban, time_t now) { return ban.expires > 0 && ban.expires <= now; }
+
+	BanIndexPtr getIndex() const { return std::atomic_load(&m_index); }
+	static void insertBan(BanIndex& index, Ban ban);
+	void updateIndex(const std::function<void(BanIndex&)>& function) const;
+	void addToIndex(Ban_t type, uint32_t value, uint32_t param, int64_t banTime, uint32_t reasonId, ViolationAction_t actionId,
+		const std::string& comment, uint32_t gamemaster, const std::string& statement) const;
+	void removeFromIndex(Ban_t type, uint32_t value, uint32_t id) const;
+	// deactivates the first active ban matching value and condition, in the table and the index
+	bool removeBan(Ban_t type, uint32_t value, const std::string& condition) const;
+
+	bool getDataFromDatabase(Ban& ban) const;
+	void threadMain();
+
+	mutable BanIndexPtr m_index;
+	mutable std::mutex m_writeLock;
+
+	// changes published while reload() queries the database, replayed onto its result
+	mutable std::vector<std::function<void(BanIndex&)>> m_reloadChanges;
+	mutable bool m_reloading = false;
+
+	std::thread m_thread;
+	std::mutex m_lock;
+	std::condition_variable m_signal;
+	bool m_running = false;
 };
@@ -22,149 +22,427 @@
 #include "chat.h"
 #include "configmanager.h"
 #include "database.h"
+#include "databasetasks.h"
 #include "game.h"
+#include "iologindata.h"
 #include "player.h"
 
-bool IOGuild::getGuildId(uint32_t& id, const std::string& name)
+#include "otx/util.hpp"
+
+namespace
+{
+	GuildRank* findRankByName(Guild* guild, const std::string& name)
+	{
+		// guild_ranks.name compares case-insensitively in the database as well
+		const std::string lowerName = otx::util::as_lower_string(name);
+		for (GuildRank& rank : guild->ranks) {
+			if (otx::util::as_lower_string(rank.name) == lowerName) {
+				return &rank;
+			}
+		}
+		return nullptr;
+	}
+}
+
+void IOGuild::load()
 {
+	g_databaseTasks.flush();
+
+	m_guilds.clear();
+	m_guildNames.clear();
+	m_rankGuilds.clear();
+	m_playerRanks.clear();
+	m_invites.clear();
+	++m_memberChanges;
+
+	m_missingGuilds.clear();
+	m_missingRanks.clear();
+	m_missingGuildNames.clear();
+
+	// a war that reached its limit keeps its entry until the queued finishWar ran, or it could pay out twice
+	for (auto it = m_wars.begin(); it != m_wars.end();) {
+		if (it->second.ending) {
+			++it;
+		} else {
+			it = m_wars.erase(it);
+		}
+	}
+
 	DBResultPtr result;
+	if ((result = g_database.storeQuery("SELECT `id`, `name`, `ownerid`, `motd` FROM `guilds`"))) {
+		const size_t idColumn = result->getColumnIndex("id"), nameColumn = result->getColumnIndex("name"),
+					 ownerColumn = result->getColumnIndex("ownerid"), motdColumn = result->getColumnIndex("motd");
+		do {
+			Guild guild;
+			guild.id = result->getNumber<int32_t>(idColumn);
+			guild.name = result->getString(nameColumn);
+			guild.ownerId = result->getNumber<int32_t>(ownerColumn);
+			guild.motd = result->getString(motdColumn);
+			addGuild(std::move(guild));
+		} while (result->next());
+	}
 
-	std::ostringstream query;
-	query << "SELECT `id` FROM `guilds` WHERE `name` = " << g_database.escapeString(name) << " LIMIT 1";
-	if (!(result = g_database.storeQuery(query.str()))) {
-		return false;
+	if ((result = g_database.storeQuery("SELECT `id`, `guild_id`, `name`, `level` FROM `guild_ranks`"))) {
+		const size_t idColumn = result->getColumnIndex("id"), guildColumn = result->getColumnIndex("guild_id"),
+					 nameColumn = result->getColumnIndex("name"), levelColumn = result->getColumnIndex("level");
+		do {
+			auto it = m_guilds.find(result->getNumber<int32_t>(guildColumn));
+			if (it == m_guilds.end()) {
+				continue;
+			}
+
+			GuildRank rank;
+			rank.id = result->getNumber<int32_t>(idColumn);
+			rank.name = result->getString(nameColumn);
+			rank.level = static_cast<GuildLevel_t>(result->getNumber<uint8_t>(levelColumn));
+
+			m_rankGuilds[rank.id] = it->first;
+			it->second.ranks.push_back(std::move(rank));
+		} while (result->next());
 	}
 
-	id = result->getNumber<int32_t>("id");
-	return true;
+	if ((result = g_database.storeQuery("SELECT `id`, `rank_id` FROM `players` WHERE `rank_id` > 0 AND `deleted` = 0"))) {
+		const size_t idColumn = result->getColumnIndex("id"), rankColumn = result->getColumnIndex("rank_id");
+		do {
+			m_playerRanks[result->getNumber<uint32_t>(idColumn)] = result->getNumber<uint32_t>(rankColumn);
+		} while (result->next());
+	}
+
+	if ((result = g_database.storeQuery("SELECT `player_id`, `guild_id` FROM `guild_invites`"))) {
+		const size_t playerColumn = result->getColumnIndex("player_id"), guildColumn = result->getColumnIndex("guild_id");
+		do {
+			m_invites.emplace(result->getNumber<uint32_t>(playerColumn), result->getNumber<uint32_t>(guildColumn));
+		} while (result->next());
+	}
+
+	if ((result = g_database.storeQuery("SELECT `id`, `guild_id`, `enemy_id`, `guild_kills`, `enemy_kills`, `frags`, `payment` FROM `guild_wars` WHERE `status` IN (1,4)"))) {
+		do {
+			GuildWar war = readWar(result);
+			m_wars.emplace(war.data.war, std::move(war));
+		} while (result->next());
+	}
 }
 
-bool IOGuild::getGuildById(std::string& name, uint32_t id)
+GuildWar IOGuild::readWar(const DBResultPtr& result)
 {
-	DBResultPtr result;
+	GuildWar war;
+	war.data.war = result->getNumber<int32_t>("id");
+	war.data.ids[WAR_GUILD] = result->getNumber<int32_t>("guild_id");
+	war.data.ids[WAR_ENEMY] = result->getNumber<int32_t>("enemy_id");
+	war.data.frags[WAR_GUILD] = result->getNumber<int32_t>("guild_kills");
+	war.data.frags[WAR_ENEMY] = result->getNumber<int32_t>("enemy_kills");
+	war.data.limit = result->getNumber<int32_t>("frags");
+	war.data.payment = result->getNumber<int32_t>("payment");
+	for (int32_t i = WAR_FIRST; i <= WAR_LAST; ++i) {
+		if (Guild* guild = getGuild(war.data.ids[i])) {
+			war.data.names[i] = guild->name;
+		}
+	}
+	return war;
+}
 
-	std::ostringstream query;
-	query << "SELECT `name` FROM `guilds` WHERE `id` = " << id << " LIMIT 1";
-	if (!(result = g_database.storeQuery(query.str()))) {
-		return false;
+void IOGuild::addGuild(Guild&& guild)
+{
+	const uint32_t id = guild.id;
+	const std::string name = otx::util::as_lower_string(guild.name);
+	m_guildNames[name] = id;
+	m_missingGuilds.erase(id);
+	m_missingGuildNames.erase(name);
+	for (const GuildRank& rank : guild.ranks) {
+		m_rankGuilds[rank.id] = id;
+		m_missingRanks.erase(rank.id);
 	}
 
-	name = result->getString("name");
-	return true;
+	m_guilds[id] = std::move(guild);
 }
 
-bool IOGuild::swapGuildIdToOwner(uint32_t& value)
+void IOGuild::removeGuild(uint32_t id)
 {
-	DBResultPtr result;
+	auto it = m_guilds.find(id);
+	if (it == m_guilds.end()) {
+		return;
+	}
 
-	std::ostringstream query;
-	query << "SELECT `ownerid` FROM `guilds` WHERE `id` = " << value << " LIMIT 1";
-	if (!(result = g_database.storeQuery(query.str()))) {
-		return false;
+	m_guildNames.erase(otx::util::as_lower_string(it->second.name));
+	for (const GuildRank& rank : it->second.ranks) {
+		m_rankGuilds.erase(rank.id);
 	}
 
-	value = result->getNumber<int32_t>("ownerid");
-	return true;
+	m_guilds.erase(it);
 }
 
-bool IOGuild::guildExists(uint32_t guild)
+Guild* IOGuild::loadGuild(const std::string& condition)
 {
+	// guilds created outside of the server (website, scripts) are picked up on the first miss,
+	// the callers remember a miss so an unknown guild is not queried again until the next poll
+	g_databaseTasks.flush();
+
 	DBResultPtr result;
 
 	std::ostringstream query;
-	query << "SELECT `id` FROM `guilds` WHERE `id` = " << guild << " LIMIT 1";
+	query << "SELECT `id`, `name`, `ownerid`, `motd` FROM `guilds` WHERE " << condition << " LIMIT 1";
 	if (!(result = g_database.storeQuery(query.str()))) {
-		return false;
+		return nullptr;
 	}
 
-	return true;
+	Guild guild;
+	guild.id = result->getNumber<int32_t>("id");
+	guild.name = result->getString("name");
+	guild.ownerId = result->getNumber<int32_t>("ownerid");
+	guild.motd = result->getString("motd");
+
+	query.str("");
+	query << "SELECT `id`, `name`, `level` FROM `guild_ranks` WHERE `guild_id` = " << guild.id;
+	if ((result = g_database.storeQuery(query.str()))) {
+		do {
+			GuildRank rank;
+			rank.id = result->getNumber<int32_t>("id");
+			rank.name = result->getString("name");
+			rank.level = static_cast<GuildLevel_t>(result->getNumber<uint8_t>("level"));
+			guild.ranks.push_back(std::move(rank));
+		} while (result->next());
+	}
+
+	const uint32_t id = guild.id;
+	removeGuild(id);
+	addGuild(std::move(guild));
+	return &m_guilds[id];
 }
 
-uint32_t IOGuild::getRankIdByName(uint32_t guild, const std::string& name)
+Guild* IOGuild::getGuild(uint32_t id)
 {
-	DBResultPtr result;
+	if (!id) {
+		return nullptr;
+	}
 
-	std::ostringstream query;
-	query << "SELECT `id` FROM `guild_ranks` WHERE `guild_id` = " << guild << " AND `name` = " << g_database.escapeString(name) << " LIMIT 1";
-	if (!(result = g_database.storeQuery(query.str()))) {
-		return 0;
+	auto it = m_guilds.find(id);
+	if (it != m_guilds.end()) {
+		return &it->second;
 	}
 
-	const uint32_t id = result->getNumber<int32_t>("id");
-	return id;
+	if (m_missingGuilds.count(id)) {
+		return nullptr;
+	}
+
+	std::ostringstream condition;
+	condition << "`id` = " << id;
+	Guild* guild = loadGuild(condition.str());
+	if (!guild) {
+		m_missingGuilds.insert(id);
+	}
+	return guild;
 }
 
-uint32_t IOGuild::getRankIdByLevel(uint32_t guild, GuildLevel_t level)
+Guild* IOGuild::getGuildByName(const std::string& name)
 {
-	DBResultPtr result;
+	const std::string lowerName = otx::util::as_lower_string(name);
+	auto it = m_guildNames.find(lowerName);
+	if (it != m_guildNames.end()) {
+		return &m_guilds[it->second];
+	}
 
-	std::ostringstream query;
-	query << "SELECT `id` FROM `guild_ranks` WHERE `guild_id` = " << guild << " AND `level` = " << static_cast<int>(level) << " LIMIT 1";
-	if (!(result = g_database.storeQuery(query.str()))) {
+	if (m_missingGuildNames.count(lowerName)) {
+		return nullptr;
+	}
+
+	Guild* guild = loadGuild("`name` = " + g_database.escapeString(name));
+	if (!guild) {
+		m_missingGuildNames.insert(lowerName);
+	}
+	return guild;
+}
+
+GuildRank* IOGuild::getRank(Guild* guild, GuildLevel_t level)
+{
+	if (!guild) {
+		return nullptr;
+	}
+
+	for (GuildRank& rank : guild->ranks) {
+		if (rank.level == level) {
+			return &rank;
+		}
+	}
+	return nullptr;
+}
+
+GuildRank* IOGuild::getRankById(uint32_t rankId, Guild** guild /* = nullptr*/)
+{
+	if (!rankId) {
+		return nullptr;
+	}
+
+	Guild* rankGuild = nullptr;
+	auto it = m_rankGuilds.find(rankId);
+	if (it != m_rankGuilds.end()) {
+		rankGuild = &m_guilds[it->second];
+	} else if (m_missingRanks.count(rankId)) {
+		return nullptr;
+	} else {
+		// a rank added outside of the server, reload the guild it belongs to
+		g_databaseTasks.flush();
+
+		DBResultPtr result;
+
+		std::ostringstream query;
+		query << "SELECT `guild_id` FROM `guild_ranks` WHERE `id` = " << rankId << " LIMIT 1";
+		if (!(result = g_database.storeQuery(query.str()))) {
+			m_missingRanks.insert(rankId);
+			return nullptr;
+		}
+
+		query.str("");
+		query << "`id` = " << result->getNumber<int32_t>("guild_id");
+		if (!(rankGuild = loadGuild(query.str()))) {
+			m_missingRanks.insert(rankId);
+			return nullptr;
+		}
+	}
+
+	for (GuildRank& rank : rankGuild->ranks) {
+		if (rank.id == rankId) {
+			if (guild) {
+				*guild = rankGuild;
+			}
+			return &rank;
+		}
+	}
+
+	m_missingRanks.insert(rankId);
+	return nullptr;
+}
+
+uint32_t IOGuild::getPlayerRankId(uint32_t guid) const
+{
+	auto it = m_playerRanks.find(guid);
+	if (it == m_playerRanks.end()) {
 		return 0;
 	}
 
-	const uint32_t id = result->getNumber<int32_t>("id");
-	return id;
+	return it->second;
 }
 
-bool IOGuild::getRankEx(uint32_t& id, std::string& name, uint32_t guild, GuildLevel_t level)
+void IOGuild::setPlayerRank(uint32_t guid, uint32_t rankId)
 {
-	DBResultPtr result;
+	++m_memberChanges;
+	if (rankId) {
+		m_playerRanks[guid] = rankId;
+	} else {
+		m_playerRanks.erase(guid);
+	}
+}
 
-	std::ostringstream query;
-	query << "SELECT `id`, `name` FROM `guild_ranks` WHERE `guild_id` = " << guild << " AND `level` = " << static_cast<int>(level);
-	if (id) {
-		query << " AND `id` = " << id;
+void IOGuild::setPlayerInvites(uint32_t guid, const std::list<uint32_t>& invites)
+{
+	++m_memberChanges;
+	m_invites.erase(m_invites.lower_bound({ guid, 0 }), m_invites.upper_bound({ guid, std::numeric_limits<uint32_t>::max() }));
+	for (uint32_t guild : invites) {
+		m_invites.emplace(guid, guild);
 	}
+}
 
-	query << " LIMIT 1";
-	if (!(result = g_database.storeQuery(query.str()))) {
+bool IOGuild::getGuildId(uint32_t& id, const std::string& name)
+{
+	Guild* guild = getGuildByName(name);
+	if (!guild) {
 		return false;
 	}
 
-	name = result->getString("name");
-	if (!id) {
-		id = result->getNumber<int32_t>("id");
+	id = guild->id;
+	return true;
+}
+
+bool IOGuild::getGuildById(std::string& name, uint32_t id)
+{
+	Guild* guild = getGuild(id);
+	if (!guild) {
+		return false;
 	}
 
+	name = guild->name;
 	return true;
 }
 
-std::string IOGuild::getRank(uint32_t guid)
+bool IOGuild::swapGuildIdToOwner(uint32_t& value)
 {
-	DBResultPtr result;
+	Guild* guild = getGuild(value);
+	if (!guild) {
+		return false;
+	}
 
-	std::ostringstream query;
-	query << "SELECT `guild_ranks`.`name` FROM `players`, `guild_ranks` WHERE `players`.`id` = " << guid << " AND `guild_ranks`.`id` = `players`.`rank_id` LIMIT 1";
-	if (!(result = g_database.storeQuery(query.str()))) {
-		return "";
+	value = guild->ownerId;
+	return true;
+}
+
+bool IOGuild::guildExists(uint32_t guild)
+{
+	return getGuild(guild) != nullptr;
+}
+
+uint32_t IOGuild::getRankIdByName(uint32_t guild, const std::string& name)
+{
+	Guild* _guild = getGuild(guild);
+	if (!_guild) {
+		return 0;
 	}
 
-	const std::string name = result->getString("name");
-	return name;
+	GuildRank* rank = findRankByName(_guild, name);
+	return rank ? rank->id : 0;
 }
 
-bool IOGuild::changeRank(uint32_t guild, const std::string& oldName, const std::string& newName)
+uint32_t IOGuild::getRankIdByLevel(uint32_t guild, GuildLevel_t level)
 {
-	DBResultPtr result;
+	GuildRank* rank = getRank(getGuild(guild), level);
+	return rank ? rank->id : 0;
+}
 
-	std::ostringstream query;
-	query << "SELECT `id` FROM `guild_ranks` WHERE `guild_id` = " << guild << " AND `name` = " << g_database.escapeString(oldName) << " LIMIT 1";
-	if (!(result = g_database.storeQuery(query.str()))) {
+bool IOGuild::getRankEx(uint32_t& id, std::string& name, uint32_t guild, GuildLevel_t level)
+{
+	Guild* _guild = getGuild(guild);
+	if (!_guild) {
 		return false;
 	}
 
-	const uint32_t id = result->getNumber<int32_t>("id");
+	for (const GuildRank& rank : _guild->ranks) {
+		if (rank.level == level && (!id || rank.id == id)) {
+			name = rank.name;
+			id = rank.id;
+			return true;
+		}
+	}
+	return false;
+}
 
-	query.str("");
-	query << "UPDATE `guild_ranks` SET `name` = " << g_database.escapeString(newName) << " WHERE `id` = " << id << " LIMIT 1";
-	if (!g_database.executeQuery(query.str())) {
+std::string IOGuild::getRank(uint32_t guid)
+{
+	GuildRank* rank = getRankById(getPlayerRankId(guid));
+	if (!rank) {
+		return "";
+	}
+
+	return rank->name;
+}
+
+bool IOGuild::changeRank(uint32_t guild, const std::string& oldName, const std::string& newName)
+{
+	Guild* _guild = getGuild(guild);
+	if (!_guild) {
+		return false;
+	}
+
+	GuildRank* rank = findRankByName(_guild, oldName);
+	if (!rank) {
 		return false;
 	}
 
+	rank->name = newName;
+
+	std::ostringstream query;
+	query << "UPDATE `guild_ranks` SET `name` = " << g_database.escapeString(newName) << " WHERE `id` = " << rank->id << " LIMIT 1";
+	g_databaseTasks.addTask(query.str());
+
 	for (const auto& it : g_game.getPlayers()) {
-		if (it.second->getRankId() == id) {
+		if (it.second->getRankId() == rank->id) {
 			it.second->setRankName(newName);
 		}
 	}
@@ -173,7 +451,8 @@ bool IOGuild::changeRank(uint32_t guild, const std::string& oldName, const std::
 
 bool IOGuild::createGuild(Player* player)
 {
-	DBResultPtr result;
+	// the insert stays synchronous, the id and the ranks made by the oncreate_guilds trigger are needed right away
+	g_databaseTasks.flush();
 
 	std::ostringstream query;
 	query << "INSERT INTO `guilds` (`id`, `name`, `ownerid`, `creationdata`, `motd`, `checkdata`) VALUES (NULL, " << g_database.escapeString(player->getGuildName()) << ", " << player->getGUID() << ", " << time(nullptr) << ", 'Your guild has been successfully created, to view all available commands type: !commands. If you would like to remove this message use !cleanmotd and to set new motd use !setmotd text.', 0)";
@@ -182,48 +461,40 @@ bool IOGuild::createGuild(Player* player)
 	}
 
 	query.str("");
-	query << "SELECT `id` FROM `guilds` WHERE `ownerid` = " << player->getGUID() << " LIMIT 1";
-	if (!(result = g_database.storeQuery(query.str()))) {
+	query << "`id` = " << g_database.getLastInsertId();
+
+	Guild* guild = loadGuild(query.str());
+	if (!guild) {
 		return false;
 	}
 
-	const uint32_t guildId = result->getNumber<int32_t>("id");
-	return joinGuild(player, guildId, true);
+	return joinGuild(player, guild->id, true);
 }
 
 bool IOGuild::joinGuild(Player* player, uint32_t guildId, bool creation /* = false*/)
 {
-	DBResultPtr result;
-
-	std::ostringstream query;
-	query << "SELECT `id` FROM `guild_ranks` WHERE `guild_id` = " << guildId << " AND `level` = " << (creation ? "3" : "1") << " LIMIT 1";
-	if (!(result = g_database.storeQuery(query.str()))) {
+	Guild* guild = getGuild(guildId);
+	GuildRank* rank = getRank(guild, creation ? GUILDLEVEL_LEADER : GUILDLEVEL_MEMBER);
+	if (!rank) {
 		return false;
 	}
 
-	const uint32_t rankId = result->getNumber<int32_t>("id");
-
-	std::string guildName;
-	if (!creation) {
-		query.str("");
-		query << "SELECT `name` FROM `guilds` WHERE `id` = " << guildId << " LIMIT 1";
-		if (!(result = g_database.storeQuery(query.str()))) {
-			return false;
-		}
+	const uint32_t rankId = rank->id;
 
-		guildName = result->getString("name");
-	}
+	IOLoginData::getInstance()->invalidatePrefetch(player->getName());
 
-	query.str("");
+	std::ostringstream query;
 	query << "UPDATE `players` SET `rank_id` = " << rankId << " WHERE `id` = " << player->getGUID() << " LIMIT 1";
 	if (!g_database.executeQuery(query.str())) {
 		return false;
 	}
 
+	setPlayerRank(player->getGUID(), rankId);
+	setPlayerInvites(player->getGUID(), {});
 	player->setGuildId(guildId);
 	GuildLevel_t level = GUILDLEVEL_MEMBER;
 	if (!creation) {
-		player->setGuildName(guildName);
+		player->setGuildName(guild->name);
 	} else {
 		level = GUILDLEVEL_LEADER;
 	}
@@ -235,6 +506,8 @@ bool IOGuild::joinGuild(Player* player, uint32_t guildId, bool creation /* = fal
 
 bool IOGuild::disbandGuild(uint32_t guildId)
 {
+	IOLoginData::getInstance()->invalidatePrefetches();
+
 	std::ostringstream query;
 	query << "UPDATE `players` SET `rank_id` = '' AND `guildnick` = '' WHERE `rank_id` = " << getRankIdByLevel(guildId, GUILDLEVEL_LEADER) << " OR rank_id = " << getRankIdByLevel(guildId, GUILDLEVEL_VICE) << " OR rank_id = " << getRankIdByLevel(guildId, GUILDLEVEL_MEMBER);
 	if (!g_database.executeQuery(query.str())) {
@@ -250,116 +523,155 @@ bool IOGuild::disbandGuild(uint32_t guildId)
 		}
 	}
 
+	++m_memberChanges;
+	for (auto it = m_playerRanks.begin(); it != m_playerRanks.end();) {
+		auto rit = m_rankGuilds.find(it->second);
+		if (rit != m_rankGuilds.end() && rit->second == guildId) {
+			it = m_playerRanks.erase(it);
+		} else {
+			++it;
+		}
+	}
+
+	for (auto it = m_invites.begin(); it != m_invites.end();) {
+		if (it->second == guildId) {
+			it = m_invites.erase(it);
+		} else {
+			++it;
+		}
+	}
+
+	// the deletes below are written behind, a lookup meanwhile must not load the guild again
+	if (Guild* guild = getGuild(guildId)) {
+		m_missingGuildNames.insert(otx::util::as_lower_string(guild->name));
+		for (const GuildRank& rank : guild->ranks) {
+			m_missingRanks.insert(rank.id);
+		}
+	}
+
+	removeGuild(guildId);
+	m_missingGuilds.insert(guildId);
+
 	query.str("");
 	query << "DELETE FROM `guilds` WHERE `id` = " << guildId << " LIMIT 1";
-	if (!g_database.executeQuery(query.str())) {
-		return false;
-	}
+	g_databaseTasks.addTask(query.str());
 
 	query.str("");
 	query << "DELETE FROM `guild_invites` WHERE `guild_id` = " << guildId;
-	if (!g_database.executeQuery(query.str())) {
-		return false;
-	}
+	queueInviteWrite(query.str());
 
 	query.str("");
 	query << "DELETE FROM `guild_ranks` WHERE `guild_id` = " << guildId;
-	return g_database.executeQuery(query.str());
+	g_databaseTasks.addTask(query.str());
+	return true;
 }
 
 bool IOGuild::hasGuild(uint32_t guid)
 {
-	DBResultPtr result;
-
-	std::ostringstream query;
-	query << "SELECT `rank_id` FROM `players` WHERE `id` = " << guid << " LIMIT 1";
-	if (!(result = g_database.storeQuery(query.str()))) {
-		return false;
-	}
-
-	const bool ret = result->getNumber<int32_t>("rank_id") != 0;
-	return ret;
+	return getPlayerRankId(guid) != 0;
 }
 
 bool IOGuild::isInvited(uint32_t guild, uint32_t guid)
 {
-	DBResultPtr result;
-
-	std::ostringstream query;
-	query << "SELECT `guild_id` FROM `guild_invites` WHERE `player_id` = " << guid << " AND `guild_id`= " << guild << " LIMIT 1";
-	if (!(result = g_database.storeQuery(query.str()))) {
-		return false;
-	}
-
-	return true;
+	return m_invites.count({ guid, guild }) != 0;
 }
 
 bool IOGuild::invitePlayer(uint32_t guild, uint32_t guid)
 {
+	m_invites.emplace(guid, guild);
+	++m_memberChanges;
+
 	std::ostringstream query;
 	query << "INSERT INTO `guild_invites` (`player_id`, `guild_id`) VALUES ('" << guid << "', '" << guild << "')";
-	return g_database.executeQuery(query.str());
+	queueInviteWrite(query.str());
+	return true;
 }
 
 bool IOGuild::revokeInvite(uint32_t guild, uint32_t guid)
 {
+	m_invites.erase({ guid, guild });
+	++m_memberChanges;
+
 	std::ostringstream query;
 	query << "DELETE FROM `guild_invites` WHERE `player_id` = " << guid << " AND `guild_id` = " << guild;
-	return g_database.executeQuery(query.str());
+	queueInviteWrite(query.str());
+	return true;
 }
 
-uint32_t IOGuild::getGuildId(uint32_t guid)
+void IOGuild::queueInviteWrite(std::string query)
 {
-	DBResultPtr result;
+	++m_inviteWrites;
+	g_databaseTasks.addTask(
+		[this, query = std::move(query)](Database& database) {
+			const bool success = database.executeQuery(query);
+			--m_inviteWrites;
+			return success;
+		},
+		nullptr);
+}
 
-	std::ostringstream query;
-	query << "SELECT `guild_ranks`.`guild_id` FROM `players`, `guild_ranks` WHERE `players`.`id` = " << guid << " AND `guild_ranks`.`id` = `players`.`rank_id` LIMIT 1";
-	if (!(result = g_database.storeQuery(query.str()))) {
+void IOGuild::flushInviteWrites()
+{
+	if (m_inviteWrites != 0) {
+		g_databaseTasks.flush();
+	}
+}
+
+uint32_t IOGuild::getGuildId(uint32_t guid)
+{
+	Guild* guild = nullptr;
+	if (!getRankById(getPlayerRankId(guid), &guild)) {
 		return 0;
 	}
 
-	const uint32_t guildId = result->getNumber<int32_t>("guild_id");
-	return guildId;
+	return guild->id;
 }
 
 GuildLevel_t IOGuild::getGuildLevel(uint32_t guid)
 {
-	DBResultPtr result;
-
-	std::ostringstream query;
-	query << "SELECT `guild_ranks`.`level` FROM `players`, `guild_ranks` WHERE `players`.`id` = " << guid << " AND `guild_ranks`.`id` = `players`.`rank_id` LIMIT 1";
-	if (!(result = g_database.storeQuery(query.str()))) {
+	GuildRank* rank = getRankById(getPlayerRankId(guid));
+	if (!rank) {
 		return GUILDLEVEL_NONE;
 	}
 
-	const GuildLevel_t level = static_cast<GuildLevel_t>(result->getNumber<uint8_t>("level"));
-	return level;
+	return rank->level;
 }
 
 bool IOGuild::setGuildLevel(uint32_t guid, GuildLevel_t level)
 {
-	DBResultPtr result;
+	GuildRank* rank = getRank(getGuild(getGuildId(guid)), level);
+	if (!rank) {
+		return false;
+	}
+
+	IOLoginData::getInstance()->invalidatePrefetch(guid);
 
 	std::ostringstream query;
-	query << "SELECT `id` FROM `guild_ranks` WHERE `guild_id` = " << getGuildId(guid) << " AND `level` = " << level << " LIMIT 1";
-	if (!(result = g_database.storeQuery(query.str()))) {
+	query << "UPDATE `players` SET `rank_id` = " << rank->id << " WHERE `id` = " << guid << " LIMIT 1";
+	if (!g_database.executeQuery(query.str())) {
 		return false;
 	}
 
-	query.str("");
-	query << "UPDATE `players` SET `rank_id` = " << result->getNumber<int32_t>("id") << " WHERE `id` = " << guid << " LIMIT 1";
-	return g_database.executeQuery(query.str());
+	setPlayerRank(guid, rank->id);
+	return true;
 }
 
 bool IOGuild::updateOwnerId(uint32_t guild, uint32_t guid)
 {
+	if (Guild* _guild = getGuild(guild)) {
+		_guild->ownerId = guid;
+	}
+
 	std::ostringstream query;
 	query << "UPDATE `guilds` SET `ownerid` = " << guid << " WHERE `id` = " << guild << " LIMIT 1";
-	return g_database.executeQuery(query.str());
+	g_databaseTasks.addTask(query.str());
+	return true;
 }
 
 bool IOGuild::setGuildNick(uint32_t guid, const std::string& nick)
 {
+	IOLoginData::getInstance()->invalidatePrefetch(guid);
+
 	std::ostringstream query;
 	query << "UPDATE `players` SET `guildnick` = " << g_database.escapeString(nick) << " WHERE `id` = " << guid << " LIMIT 1";
 	return g_database.executeQuery(query.str());
@@ -367,48 +679,137 @@ bool IOGuild::setGuildNick(uint32_t guid, const std::string& nick)
 
 bool IOGuild::setMotd(uint32_t guild, const std::string& newMessage)
 {
+	if (Guild* _guild = getGuild(guild)) {
+		_guild->motd = newMessage;
+	}
+
 	std::ostringstream query;
 	query << "UPDATE `guilds` SET `motd` = " << g_database.escapeString(newMessage) << " WHERE `id` = " << guild << " LIMIT 1";
-	return g_database.executeQuery(query.str());
+	g_databaseTasks.addTask(query.str());
+	return true;
 }
 
 std::string IOGuild::getMotd(uint32_t guild)
 {
-	DBResultPtr result;
-
-	std::ostringstream query;
-	query << "SELECT `motd` FROM `guilds` WHERE `id` = " << guild << " LIMIT 1";
-	if (!(result = g_database.storeQuery(query.str()))) {
+	Guild* _guild = getGuild(guild);
+	if (!_guild) {
 		return "";
 	}
 
-	const std::string motd = result->getString("motd");
-	return motd;
+	return _guild->motd;
 }
 
 void IOGuild::checkWars()
 {
+	// war.lua and the website start wars by writing the table, pick up every running war not known yet
+	g_databaseTasks.addTask(
+		"SELECT `id`, `guild_id`, `enemy_id`, `guild_kills`, `enemy_kills`, `frags`, `payment` FROM `guild_wars` WHERE `status` IN (1,4)",
+		[this](DBResultPtr result, bool) {
+			if (!result) {
+				return;
+			}
+
+			do {
+				const uint32_t id = result->getNumber<uint32_t>("id");
+				if (!m_wars.count(id) && !m_loadingWars.count(id)) {
+					m_wars.emplace(id, readWar(result));
+				}
+			} while (result->next());
+		},
+		true);
+
 	if (!otx::config::getBoolean(otx::config::EXTERNAL_GUILD_WARS_MANAGEMENT)) {
 		return;
 	}
 
-	DBResultPtr result;
+	// the webpage drives these states, so they are polled; on the database thread, behind the kills and endings written so far
+	auto poll = std::make_shared<WarPoll>();
+	g_databaseTasks.addTask(
+		[poll](Database& database) {
+			std::ostringstream query;
+
+			// I don't know if there any easier way to make it right.
+			// If exists other solution just let me know.
+			// NOTE:
+			// status states 6,7,8,9 are additional only for external management, do not anything in talkaction, those states make possible to manage wars for example from webpage
+			// status 6 means accepted invite, it's before proper start of war
+			// status 7 means 'mend fences', related to signed an armistice declaration by enemy
+			// status 8 means ended up, when guild ended up war without signed an armistice declaration by enemy
+			// status 9 means signed an armistice declaration by enemy
+			uint32_t tmpInterval = (EVENT_WARSINTERVAL / 1000) + 10; //+10 for sure
+
+			query << "SELECT `g`.`name` as `guild_name`, `e`.`name` as `enemy_name`, `guild_wars`.`frags` as `frags`  FROM `guild_wars` LEFT JOIN `guilds` as `g` ON `guild_wars`.`guild_id` = `g`.`id` LEFT JOIN `guilds` as `e` ON `guild_wars`.`enemy_id` = `e`.`id` WHERE (`begin` > 0 AND (`begin` + " << tmpInterval << ") > UNIX_TIMESTAMP()) AND `status` IN (0, 6)";
+			poll->invited = database.storeQuery(query.str());
+
+			query.str("");
+			query << "UPDATE `guild_wars` SET `begin` = UNIX_TIMESTAMP(), `end` = ((`end` - `begin`) + UNIX_TIMESTAMP()), `status` = 1 WHERE `status` = 6";
+			database.executeQuery(query.str());
+
+			query.str("");
+			query << "SELECT `g`.`name` as `guild_name`, `e`.`name` as `enemy_name`, `g`.`id` as `guild_id`, `e`.`id` as `enemy_id`, `guild_wars`.*  FROM `guild_wars` LEFT JOIN `guilds` as `g` ON `guild_wars`.`guild_id` = `g`.`id` LEFT JOIN `guilds` as `e` ON `guild_wars`.`enemy_id` = `e`.`id` WHERE (`begin` > 0 AND (`begin` + " << tmpInterval << ") > UNIX_TIMESTAMP()) AND `status` = 1";
+			poll->accepted = database.storeQuery(query.str());
+
+			query.str("");
+			query << "SELECT `g`.`name` as `guild_name`, `e`.`name` as `enemy_name`  FROM `guild_wars` LEFT JOIN `guilds` as `g` ON `guild_wars`.`guild_id` = `g`.`id` LEFT JOIN `guilds` as `e` ON `guild_wars`.`enemy_id` = `e`.`id` WHERE (`end` > 0 AND (`end` + " << tmpInterval << ") > UNIX_TIMESTAMP()) AND `status` = 2";
+			poll->rejected = database.storeQuery(query.str());
+
+			query.str("");
+			query << "SELECT `g`.`name` as `guild_name`, `e`.`name` as `enemy_name`  FROM `guild_wars` LEFT JOIN `guilds` as `g` ON `guild_wars`.`guild_id` = `g`.`id` LEFT JOIN `guilds` as `e` ON `guild_wars`.`enemy_id` = `e`.`id` WHERE (`end` > 0 AND (`end` + " << tmpInterval << ") > UNIX_TIMESTAMP()) AND `status` = 3";
+			poll->canceled = database.storeQuery(query.str());
+
+			query.str("");
+			query << "SELECT `g`.`name` as `guild_name`, `e`.`name` as `enemy_name`, `guild_wars`.`status` as `status`, `g`.`id` as `guild_id`, `e`.`id` as `enemy_id`, `guild_wars`.*   FROM `guild_wars` LEFT JOIN `guilds` as `g` ON `guild_wars`.`guild_id` = `g`.`id` LEFT JOIN `guilds` as `e` ON `guild_wars`.`enemy_id` = `e`.`id` WHERE (`end` > 0 AND (`end` + " << tmpInterval << ") > UNIX_TIMESTAMP()) AND `status` IN (7,8)";
+			poll->ended = database.storeQuery(query.str());
+
+			query.str("");
+			query << "UPDATE `guild_wars` SET `end` = UNIX_TIMESTAMP(), `status` = 5 WHERE `status` IN (7,8)";
+			database.executeQuery(query.str());
+			return true;
+		},
+		[this, poll](DBResultPtr, bool) { announceWars(*poll); });
+}
 
-	std::ostringstream query;
+void IOGuild::checkMembers()
+{
+	// the webpage and scripts write ranks and invites as well, so they are polled like the wars
+	auto poll = std::make_shared<MemberPoll>();
+	g_databaseTasks.addReadTask(
+		[poll](Database& database) {
+			DBResultPtr result;
+			if ((result = database.storeQuery("SELECT `id`, `rank_id` FROM `players` WHERE `rank_id` > 0 AND `deleted` = 0"))) {
+				const size_t idColumn = result->getColumnIndex("id"), rankColumn = result->getColumnIndex("rank_id");
+				do {
+					poll->ranks[result->getNumber<uint32_t>(idColumn)] = result->getNumber<uint32_t>(rankColumn);
+				} while (result->next());
+			}
 
-	// I don't know if there any easier way to make it right.
-	// If exists other solution just let me know.
-	// NOTE:
-	// status states 6,7,8,9 are additional only for external management, do not anything in talkaction, those states make possible to manage wars for example from webpage
-	// status 6 means accepted invite, it's before proper start of war
-	// status 7 means 'mend fences', related to signed an armistice declaration by enemy
-	// status 8 means ended up, when guild ended up war without signed an armistice declaration by enemy
-	// status 9 means signed an armistice declaration by enemy
-	std::ostringstream s;
-	uint32_t tmpInterval = (EVENT_WARSINTERVAL / 1000) + 10; //+10 for sure
+			if ((result = database.storeQuery("SELECT `player_id`, `guild_id` FROM `guild_invites`"))) {
+				const size_t playerColumn = result->getColumnIndex("player_id"), guildColumn = result->getColumnIndex("guild_id");
+				do {
+					poll->invites.emplace(result->getNumber<uint32_t>(playerColumn), result->getNumber<uint32_t>(guildColumn));
+				} while (result->next());
+			}
+			return true;
+		},
+		[this, poll, changes = m_memberChanges](DBResultPtr, bool success) {
+			// a change made here meanwhile may not be written yet, the next poll picks everything up
+			if (success && changes == m_memberChanges) {
+				m_playerRanks = std::move(poll->ranks);
+				m_invites = std::move(poll->invites);
+			}
 
-	query << "SELECT `g`.`name` as `guild_name`, `e`.`name` as `enemy_name`, `guild_wars`.`frags` as `frags`  FROM `guild_wars` LEFT JOIN `guilds` as `g` ON `guild_wars`.`guild_id` = `g`.`id` LEFT JOIN `guilds` as `e` ON `guild_wars`.`enemy_id` = `e`.`id` WHERE (`begin` > 0 AND (`begin` + " << tmpInterval << ") > UNIX_TIMESTAMP()) AND `status` IN (0, 6)";
-	if ((result = g_database.storeQuery(query.str()))) {
+			// the website may have created what was missing, look it up again on the next miss
+			m_missingGuilds.clear();
+			m_missingRanks.clear();
+			m_missingGuildNames.clear();
+		});
+}
+
+void IOGuild::announceWars(const WarPoll& poll)
+{
+	DBResultPtr result;
+	std::ostringstream s;
+	if ((result = poll.invited)) {
 		do {
 			s << result->getString("guild_name") << " has invited " << result->getString("enemy_name") << " to war till " << result->getNumber<int32_t>("frags") << " frags.";
 			g_game.broadcastMessage(s.str().c_str(), MSG_EVENT_ADVANCE);
@@ -416,22 +817,15 @@ void IOGuild::checkWars()
 		} while (result->next());
 	}
 
-	query.str("");
-	query << "UPDATE `guild_wars` SET `begin` = UNIX_TIMESTAMP(), `end` = ((`end` - `begin`) + UNIX_TIMESTAMP()), `status` = 1 WHERE `status` = 6";
-	g_database.executeQuery(query.str());
-
-	query.str("");
-	query << "SELECT `g`.`name` as `guild_name`, `e`.`name` as `enemy_name`, `g`.`id` as `guild_id`, `e`.`id` as `enemy_id`, `guild_wars`.*  FROM `guild_wars` LEFT JOIN `guilds` as `g` ON `guild_wars`.`guild_id` = `g`.`id` LEFT JOIN `guilds` as `e` ON `guild_wars`.`enemy_id` = `e`.`id` WHERE (`begin` > 0 AND (`begin` + " << tmpInterval << ") > UNIX_TIMESTAMP()) AND `status` = 1";
-	if ((result = g_database.storeQuery(query.str()))) {
+	if ((result = poll.accepted)) {
 		do {
 			s << result->getString("enemy_name") << " accepted " << result->getString("guild_name") << " invitation to war.";
 			g_game.broadcastMessage(s.str().c_str(), MSG_EVENT_ADVANCE);
 			s.str("");
 
-			War_t tmp;
-			tmp.war = result->getNumber<int32_t>("id");
-			tmp.ids[WAR_GUILD] = result->getNumber<int32_t>("guild_id");
-			tmp.ids[WAR_ENEMY] = result->getNumber<int32_t>("enemy_id");
+			GuildWar war = readWar(result);
+			War_t tmp = war.data;
+			m_wars.emplace(tmp.war, std::move(war));
 			for (const auto& it : g_game.getPlayers()) {
 				bool update = false;
 				if (it.second->getGuildId() == tmp.ids[WAR_GUILD]) {
@@ -451,10 +845,7 @@ void IOGuild::checkWars()
 		} while (result->next());
 	}
 
-	query.str("");
-
-	query << "SELECT `g`.`name` as `guild_name`, `e`.`name` as `enemy_name`  FROM `guild_wars` LEFT JOIN `guilds` as `g` ON `guild_wars`.`guild_id` = `g`.`id` LEFT JOIN `guilds` as `e` ON `guild_wars`.`enemy_id` = `e`.`id` WHERE (`end` > 0 AND (`end` + " << tmpInterval << ") > UNIX_TIMESTAMP()) AND `status` = 2";
-	if ((result = g_database.storeQuery(query.str()))) {
+	if ((result = poll.rejected)) {
 		do {
 			s << result->getString("enemy_name") << " rejected " << result->getString("guild_name") << " invitation to war.";
 			g_game.broadcastMessage(s.str().c_str(), MSG_EVENT_ADVANCE);
@@ -462,9 +853,7 @@ void IOGuild::checkWars()
 		} while (result->next());
 	}
 
-	query.str("");
-	query << "SELECT `g`.`name` as `guild_name`, `e`.`name` as `enemy_name`  FROM `guild_wars` LEFT JOIN `guilds` as `g` ON `guild_wars`.`guild_id` = `g`.`id` LEFT JOIN `guilds` as `e` ON `guild_wars`.`enemy_id` = `e`.`id` WHERE (`end` > 0 AND (`end` + " << tmpInterval << ") > UNIX_TIMESTAMP()) AND `status` = 3";
-	if ((result = g_database.storeQuery(query.str()))) {
+	if ((result = poll.canceled)) {
 		do {
 			s << result->getString("guild_name") << " canceled invitation to a war with " << result->getString("enemy_name") << ".";
 			g_game.broadcastMessage(s.str().c_str(), MSG_EVENT_ADVANCE);
@@ -472,9 +861,7 @@ void IOGuild::checkWars()
 		} while (result->next());
 	}
 
-	query.str("");
-	query << "SELECT `g`.`name` as `guild_name`, `e`.`name` as `enemy_name`, `guild_wars`.`status` as `status`, `g`.`id` as `guild_id`, `e`.`id` as `enemy_id`, `guild_wars`.*   FROM `guild_wars` LEFT JOIN `guilds` as `g` ON `guild_wars`.`guild_id` = `g`.`id` LEFT JOIN `guilds` as `e` ON `guild_wars`.`enemy_id` = `e`.`id` WHERE (`end` > 0 AND (`end` + " << tmpInterval << ") > UNIX_TIMESTAMP()) AND `status` IN (7,8)";
-	if ((result = g_database.storeQuery(query.str()))) {
+	if ((result = poll.ended)) {
 		do {
 			if (result->getNumber<int32_t>("status") == 7) {
 				s << result->getString("guild_name") << " has mend fences with " << result->getString("enemy_name") << ".";
@@ -486,6 +873,7 @@ void IOGuild::checkWars()
 			tmp.war = result->getNumber<int32_t>("id");
 			tmp.ids[WAR_GUILD] = result->getNumber<int32_t>("guild_id");
 			tmp.ids[WAR_ENEMY] = result->getNumber<int32_t>("enemy_id");
+			m_wars.erase(tmp.war);
 			for (const auto& it : g_game.getPlayers()) {
 				bool update = false;
 				if (it.second->getGuildId() == tmp.ids[WAR_GUILD]) {
@@ -505,78 +893,148 @@ void IOGuild::checkWars()
 			s.str("");
 		} while (result->next());
 	}
-
-	query.str("");
-
-	query << "UPDATE `guild_wars` SET `end` = UNIX_TIMESTAMP(), `status` = 5 WHERE `status` IN (7,8)";
-	g_database.executeQuery(query.str());
-
-	query.str("");
 }
 
 void IOGuild::checkEndingWars()
 {
-	DBResultPtr result;
-
+	// run behind the writes queued so far, a war finished meanwhile is not selected twice
 	std::ostringstream query;
-
 	query << "SELECT `id`, `guild_id`, `enemy_id` FROM `guild_wars` WHERE `status` IN (1,4) AND `end` > 0 AND `end` < " << time(nullptr);
-	if (!(result = g_database.storeQuery(query.str()))) {
-		return;
-	}
+	g_databaseTasks.addTask(
+		query.str(),
+		[this](DBResultPtr result, bool) {
+			if (!result) {
+				return;
+			}
 
-	War_t tmp;
-	do {
-		tmp.war = result->getNumber<int32_t>("id");
-		tmp.ids[WAR_GUILD] = result->getNumber<int32_t>("guild_id");
-		tmp.ids[WAR_ENEMY] = result->getNumber<int32_t>("enemy_id");
-		finishWar(tmp, false);
-	}
+			War_t tmp;
+			do {
+				tmp.war = result->getNumber<int32_t>("id");
+				auto it = m_wars.find(tmp.war);
+				if (it != m_wars.end() && it->second.ending) {
+					// reached its limit meanwhile, the finishWar already queued pays it out
+					continue;
+				}
 
-	while (result->next());
+				tmp.ids[WAR_GUILD] = result->getNumber<int32_t>("guild_id");
+				tmp.ids[WAR_ENEMY] = result->getNumber<int32_t>("enemy_id");
+				finishWar(tmp, false);
+			} while (result->next());
+		},
+		true);
 }
 
 bool IOGuild::updateWar(War_t& war)
 {
-	DBResultPtr result;
+	auto it = m_wars.find(war.war);
+	if (it == m_wars.end()) {
+		// not on the kill path: count the frag once the war is read, behind the queued writes
+		auto loading = m_loadingWars.find(war.war);
+		if (loading == m_loadingWars.end()) {
+			loadWar(war.war);
+			loading = m_loadingWars.find(war.war);
+		}
 
-	std::ostringstream query;
-	query << "SELECT `g`.`name` AS `guild_name`, `e`.`name` AS `enemy_name`, `w`.* FROM `guild_wars` w LEFT JOIN `guilds` g ON `w`.`guild_id` = `g`.`id` LEFT JOIN `guilds` e ON `w`.`enemy_id` = `e`.`id` WHERE `w`.`id` = " << war.war;
-	if (!(result = g_database.storeQuery(query.str()))) {
+		if (loading != m_loadingWars.end()) {
+			loading->second[war.type]++;
+		}
 		return false;
 	}
 
-	war.ids[WAR_GUILD] = result->getNumber<int32_t>("guild_id");
-	war.ids[WAR_ENEMY] = result->getNumber<int32_t>("enemy_id");
-	war.names[WAR_GUILD] = result->getString("guild_name");
-	war.names[WAR_ENEMY] = result->getString("enemy_name");
+	GuildWar& cached = it->second;
+	const WarType_t type = war.type;
+	addFrag(cached, type);
 
-	war.frags[WAR_GUILD] = result->getNumber<int32_t>("guild_kills");
-	war.frags[WAR_ENEMY] = result->getNumber<int32_t>("enemy_kills");
-	war.frags[war.type]++;
+	war = cached.data;
+	war.type = type;
+	return true;
+}
 
-	war.limit = result->getNumber<int32_t>("frags");
-	war.payment = result->getNumber<int32_t>("payment");
+GuildWarFrag_t GuildWar::addFrags(WarType_t type, uint16_t count /* = 1*/)
+{
+	GuildWarFrag_t result = WARFRAG_IGNORED;
+	for (; count > 0 && !ending; --count) {
+		data.frags[type]++;
+		result = WARFRAG_COUNTED;
+		if (data.frags[WAR_GUILD] >= data.limit || data.frags[WAR_ENEMY] >= data.limit) {
+			// finishWar is pending from now on and must not pay out twice
+			ending = true;
+			result = WARFRAG_WON;
+		}
+	}
+
+	return result;
+}
+
+void IOGuild::addFrag(GuildWar& war, WarType_t type, uint16_t count /* = 1*/)
+{
+	const War_t& data = war.data;
+	switch (war.addFrags(type, count)) {
+		case WARFRAG_WON: {
+			War_t finished = data;
+			finished.type = type;
+			addSchedulerTask(1000, ([this, finished]() { finishWar(finished, true); }));
+			break;
+		}
 
-	if (war.frags[WAR_GUILD] >= war.limit || war.frags[WAR_ENEMY] >= war.limit) {
-		addSchedulerTask(1000, ([this, war]() { finishWar(war, true); }));
-		return true;
+		case WARFRAG_COUNTED: {
+			std::ostringstream query;
+			query << "UPDATE `guild_wars` SET `guild_kills` = " << data.frags[WAR_GUILD] << ", `enemy_kills` = " << data.frags[WAR_ENEMY] << " WHERE `id` = " << data.war;
+			g_databaseTasks.addTask(query.str());
+			break;
+		}
+
+		default:
+			break;
 	}
+}
 
-	query.str("");
-	query << "UPDATE `guild_wars` SET `guild_kills` = " << war.frags[WAR_GUILD] << ", `enemy_kills` = " << war.frags[WAR_ENEMY] << " WHERE `id` = " << war.war;
-	return g_database.executeQuery(query.str());
+void IOGuild::loadWar(uint32_t id)
+{
+	if (!id || m_wars.count(id) || !m_loadingWars.emplace(id, std::array<uint16_t, WAR_LAST + 1>{}).second) {
+		return;
+	}
+
+	// behind the queued writes, so a war finished meanwhile is not read back as running
+	std::ostringstream query;
+	query << "SELECT `id`, `guild_id`, `enemy_id`, `guild_kills`, `enemy_kills`, `frags`, `payment` FROM `guild_wars` WHERE `id` = " << id << " AND `status` IN (1,4)";
+	g_databaseTasks.addTask(
+		query.str(),
+		[this, id](DBResultPtr result, bool) {
+			auto loading = m_loadingWars.find(id);
+			if (loading == m_loadingWars.end()) {
+				return;
+			}
+
+			const auto frags = loading->second;
+			m_loadingWars.erase(loading);
+
+			auto it = m_wars.find(id);
+			if (it == m_wars.end()) {
+				if (!result) {
+					return;
+				}
+
+				it = m_wars.emplace(id, readWar(result)).first;
+			}
+
+			for (int32_t type = WAR_FIRST; type <= WAR_LAST; ++type) {
+				if (frags[type]) {
+					addFrag(it->second, static_cast<WarType_t>(type), frags[type]);
+				}
+			}
+		},
+		true);
 }
 
 void IOGuild::finishWar(War_t war, bool finished)
 {
+	m_wars.erase(war.war);
+
 	std::ostringstream query;
 	if (finished) {
 		query << "UPDATE `guilds` SET `balance` = `balance` + " << (war.payment << 1) << " WHERE `id` = " << war.ids[war.type];
-		if (!g_database.executeQuery(query.str())) {
-			return;
-		}
-
+		g_databaseTasks.addTask(query.str());
 		query.str("");
 	}
 
@@ -586,9 +1044,7 @@ void IOGuild::finishWar(War_t war, bool finished)
 	}
 
 	query << "`end` = " << time(nullptr) << ", `status` = 5 WHERE `id` = " << war.war;
-	if (!g_database.executeQuery(query.str())) {
-		return;
-	}
+	g_databaseTasks.addTask(query.str());
 
 	for (const auto& it : g_game.getPlayers()) {
 		bool update = false;
@@ -650,7 +1106,7 @@ void IOGuild::frag(Player* player, uint64_t deathId, const DeathList& list, bool
 	ChatChannel* channel = nullptr;
 	if ((channel = g_chat.getChannel(player, CHANNEL_GUILD))) {
 		s << "Guild member " << player->getName() << " was killed by " << killers << ".";
-		if (score) {
+		if (score && war.limit) {
 			s << " The new score is " << war.frags[war.type == WAR_GUILD] << ":"
 			  << war.frags[war.type] << " frags (limit " << war.limit << ").";
 		}
@@ -661,7 +1117,7 @@ void IOGuild::frag(Player* player, uint64_t deathId, const DeathList& list, bool
 	s.str("");
 	if ((channel = g_chat.getChannel(list[0].getKillerCreature()->getPlayer(), CHANNEL_GUILD))) {
 		s << "Opponent " << player->getName() << " was killed by " << killers << ".";
-		if (score) {
+		if (score && war.limit) {
 			s << " The new score is " << war.frags[war.type] << ":"
 			  << war.frags[war.type == WAR_GUILD] << " frags (limit " << war.limit << ").";
 		}
@@ -673,5 +1129,6 @@ void IOGuild::frag(Player* player, uint64_t deathId, const DeathList& list, bool
 
 	query << "INSERT INTO `guild_kills` (`guild_id`, `war_id`, `death_id`) VALUES ("
 		  << war.ids[war.type] << ", " << war.war << ", " << deathId << ");";
+	// part of the death transaction in IOLoginData::playerDeath, so it stays on the same connection
 	g_database.executeQuery(query.str());
 }
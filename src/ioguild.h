@@ -18,10 +18,44 @@
 #pragma once
 
 #include "const.h"
+#include "database.h"
 
 struct DeathEntry;
 typedef std::vector<DeathEntry> DeathList;
 
+struct GuildRank
+{
+	uint32_t id = 0;
+	GuildLevel_t level = GUILDLEVEL_NONE;
+	std::string name;
+};
+
+struct Guild
+{
+	uint32_t id = 0;
+	uint32_t ownerId = 0;
+	std::string name;
+	std::string motd;
+	std::vector<GuildRank> ranks;
+};
+
+enum GuildWarFrag_t : uint8_t
+{
+	WARFRAG_IGNORED,
+	WARFRAG_COUNTED,
+	WARFRAG_WON
+};
+
+// a running war as IOGuild caches it
+struct GuildWar
+{
+	War_t data;
+	bool ending = false;
+
+	// counts frags for one side, WARFRAG_WON for the frag reaching the limit, nothing is counted after that one
+	GuildWarFrag_t addFrags(WarType_t type, uint16_t count = 1);
+};
+
 class Player;
 class IOGuild
 {
@@ -33,6 +67,11 @@ public:
 		return &instance;
 	}
 
+	void load();
+	size_t getCachedGuilds() const { return m_guilds.size(); }
+	size_t getCachedMembers() const { return m_playerRanks.size(); }
+	size_t getCachedWars() const { return m_wars.size(); }
+
 	bool guildExists(uint32_t guild);
 	bool createGuild(Player* player);
 	bool disbandGuild(uint32_t guild);
@@ -53,6 +92,12 @@ public:
 	bool hasGuild(uint32_t guid);
 	bool isInvited(uint32_t guild, uint32_t guid);
 
+	// IOLoginData writes players.rank_id and guild_invites as well, it keeps the cache in step through these
+	void setPlayerRank(uint32_t guid, uint32_t rankId);
+	void setPlayerInvites(uint32_t guid, const std::list<uint32_t>& invites);
+	// waits for the queued guild_invites writes, a synchronous write to the table must not be overtaken by them
+	void flushInviteWrites();
+
 	bool getGuildId(uint32_t& id, const std::string& name);
 	bool getGuildById(std::string& name, uint32_t id);
 
@@ -68,10 +113,59 @@ public:
 
 	void checkWars();
 	void checkEndingWars();
+	void checkMembers();
+	// false when the war is not known yet: it is loaded behind the queued writes and the frag counted then
 	bool updateWar(War_t& enemy);
+	// a war started outside of IOGuild, e.g. accepted by war.lua writing the table itself
+	void loadWar(uint32_t id);
 	void finishWar(War_t enemy, bool finished);
 	void frag(Player* player, uint64_t deathId, const DeathList& list, bool score);
 
 private:
 	IOGuild() {}
+
+	// what checkWars reads on the database thread for the dispatcher to announce
+	struct WarPoll
+	{
+		DBResultPtr invited, accepted, rejected, canceled, ended;
+	};
+	void announceWars(const WarPoll& poll);
+
+	// what checkMembers reads on the database thread
+	struct MemberPoll
+	{
+		std::unordered_map<uint32_t, uint32_t> ranks;
+		std::set<std::pair<uint32_t, uint32_t>> invites;
+	};
+
+	Guild* getGuild(uint32_t id);
+	Guild* getGuildByName(const std::string& name);
+	GuildRank* getRank(Guild* guild, GuildLevel_t level);
+	GuildRank* getRankById(uint32_t rankId, Guild** guild = nullptr);
+	uint32_t getPlayerRankId(uint32_t guid) const;
+	GuildWar readWar(const DBResultPtr& result);
+	void addFrag(GuildWar& war, WarType_t type, uint16_t count = 1);
+
+	Guild* loadGuild(const std::string& condition);
+	void addGuild(Guild&& guild);
+	void removeGuild(uint32_t id);
+	void queueInviteWrite(std::string query);
+
+	// guilds and wars are only touched by the dispatcher, the tables are written behind through g_databaseTasks
+	std::map<uint32_t, Guild> m_guilds;
+	std::map<std::string, uint32_t> m_guildNames;
+	std::map<uint32_t, uint32_t> m_rankGuilds;
+	std::map<uint32_t, GuildWar> m_wars;
+	// wars being loaded by loadWar, with the frags scored meanwhile
+	std::map<uint32_t, std::array<uint16_t, WAR_LAST + 1>> m_loadingWars;
+
+	// lookups that found nothing in the database, dropped on every member poll so new guilds show up
+	std::set<uint32_t> m_missingGuilds, m_missingRanks;
+	std::set<std::string> m_missingGuildNames;
+
+	// players.rank_id of every guild member by guid, and guild_invites as (guid, guild)
+	std::unordered_map<uint32_t, uint32_t> m_playerRanks;
+	std::set<std::pair<uint32_t, uint32_t>> m_invites;
+	uint32_t m_memberChanges = 0; // bumped on every change of the two above, a poll older than a change is dropped
+	std::atomic<uint32_t> m_inviteWrites{ 0 };
 };
@@ -20,6 +20,7 @@
 #include "iologindata.h"
 
 #include "configmanager.h"
+#include "container.h"
 #include "game.h"
 #include "house.h"
 #include "ioguild.h"
@@ -27,13 +28,101 @@
 #include "town.h"
 #include "vocation.h"
 
-Account IOLoginData::loadAccount(uint32_t accountId, bool preLoad /* = false*/)
+#include "otx/util.hpp"
+
+namespace
+{
+	// adds the lifetime of a load or save to the storage statistics
+	class StorageTimer
+	{
+	public:
+		StorageTimer(std::atomic<uint64_t>& count, std::atomic<uint64_t>& time) :
+			m_count(count), m_time(time), m_start(std::chrono::steady_clock::now()) {}
+		~StorageTimer()
+		{
+			++m_count;
+			m_time += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_start).count();
+		}
+
+	private:
+		std::atomic<uint64_t>& m_count;
+		std::atomic<uint64_t>& m_time;
+		std::chrono::steady_clock::time_point m_start;
+	};
+
+	// the columns of the players row a login reads, in the order of its SELECT; snapshot only exists with the column
+	enum PlayerColumn_t : size_t
+	{
+		PLAYERCOLUMN_ID,
+		PLAYERCOLUMN_ACCOUNT_ID,
+		PLAYERCOLUMN_GROUP_ID,
+		PLAYERCOLUMN_SEX,
+		PLAYERCOLUMN_VOCATION,
+		PLAYERCOLUMN_EXPERIENCE,
+		PLAYERCOLUMN_LEVEL,
+		PLAYERCOLUMN_MAGLEVEL,
+		PLAYERCOLUMN_HEALTH,
+		PLAYERCOLUMN_HEALTHMAX,
+		PLAYERCOLUMN_BLESSINGS,
+		PLAYERCOLUMN_PVP_BLESSING,
+		PLAYERCOLUMN_MANA,
+		PLAYERCOLUMN_MANAMAX,
+		PLAYERCOLUMN_MANASPENT,
+		PLAYERCOLUMN_SOUL,
+		PLAYERCOLUMN_LOOKBODY,
+		PLAYERCOLUMN_LOOKFEET,
+		PLAYERCOLUMN_LOOKHEAD,
+		PLAYERCOLUMN_LOOKLEGS,
+		PLAYERCOLUMN_LOOKTYPE,
+		PLAYERCOLUMN_LOOKADDONS,
+		PLAYERCOLUMN_POSX,
+		PLAYERCOLUMN_POSY,
+		PLAYERCOLUMN_POSZ,
+		PLAYERCOLUMN_CAP,
+		PLAYERCOLUMN_LASTLOGIN,
+		PLAYERCOLUMN_LASTLOGOUT,
+		PLAYERCOLUMN_LASTIP,
+		PLAYERCOLUMN_CONDITIONS,
+		PLAYERCOLUMN_SKULL,
+		PLAYERCOLUMN_SKULLTIME,
+		PLAYERCOLUMN_GUILDNICK,
+		PLAYERCOLUMN_RANK_ID,
+		PLAYERCOLUMN_TOWN_ID,
+		PLAYERCOLUMN_BALANCE,
+		PLAYERCOLUMN_STAMINA,
+		PLAYERCOLUMN_DIRECTION,
+		PLAYERCOLUMN_LOSS_EXPERIENCE,
+		PLAYERCOLUMN_LOSS_MANA,
+		PLAYERCOLUMN_LOSS_SKILLS,
+		PLAYERCOLUMN_LOSS_CONTAINERS,
+		PLAYERCOLUMN_LOSS_ITEMS,
+		PLAYERCOLUMN_MARRIAGE,
+		PLAYERCOLUMN_PROMOTION,
+		PLAYERCOLUMN_DESCRIPTION,
+		PLAYERCOLUMN_OFFLINETRAINING_TIME,
+		PLAYERCOLUMN_OFFLINETRAINING_SKILL,
+		PLAYERCOLUMN_SAVE,
+		PLAYERCOLUMN_SNAPSHOT,
+		PLAYERCOLUMN_COUNT
+	};
+
+	constexpr std::array<const char*, PLAYERCOLUMN_COUNT> playerColumns = {
+		"id", "account_id", "group_id", "sex", "vocation", "experience", "level", "maglevel", "health",
+		"healthmax", "blessings", "pvp_blessing", "mana", "manamax", "manaspent", "soul", "lookbody", "lookfeet",
+		"lookhead", "looklegs", "looktype", "lookaddons", "posx", "posy", "posz", "cap", "lastlogin", "lastlogout",
+		"lastip", "conditions", "skull", "skulltime", "guildnick", "rank_id", "town_id", "balance", "stamina",
+		"direction", "loss_experience", "loss_mana", "loss_skills", "loss_containers", "loss_items", "marriage",
+		"promotion", "description", "offlinetraining_time", "offlinetraining_skill", "save", "snapshot"
+	};
+}
+
+Account IOLoginData::loadAccount(uint32_t accountId, bool preLoad /* = false*/, Database& database /* = g_database*/)
 {
 	std::ostringstream query;
-	query << "SELECT `name`, `password`, `salt`, `premdays`, `lastday`, `key`, `warnings` FROM `accounts` WHERE `id` = " << accountId << " LIMIT 1";
+	query << "SELECT `name`, `password`, `salt`, `premdays`, `lastday`, `key`, `warnings`, `group_id` FROM `accounts` WHERE `id` = " << accountId << " LIMIT 1";
 
 	DBResultPtr result;
-	if (!(result = g_database.storeQuery(query.str()))) {
+	if (!(result = database.storeQuery(query.str()))) {
 		return Account();
 	}
 
@@ -46,9 +135,10 @@ Account IOLoginData::loadAccount(uint32_t accountId, bool preLoad /* = false*/)
 	account.lastDay = result->getNumber<uint32_t>("lastday");
 	account.recoveryKey = result->getString("key");
 	account.warnings = result->getNumber<uint16_t>("warnings");
+	account.groupId = result->getNumber<uint16_t>("group_id");
 
 	if (!preLoad) {
-		loadCharacters(account);
+		loadCharacters(account, database);
 	}
 
 	return account;
@@ -73,16 +163,16 @@ bool IOLoginData::loadAccount(Account& account, const std::string& name)
 	account.recoveryKey = result->getString("key");
 	account.warnings = result->getNumber<uint16_t>("warnings");
 
-	loadCharacters(account);
+	loadCharacters(account, g_database);
 	return true;
 }
 
-void IOLoginData::loadCharacters(Account& account)
+void IOLoginData::loadCharacters(Account& account, Database& database)
 {
 	std::ostringstream query;
 	query << "SELECT `name` FROM `players` WHERE `account_id` = " << account.number << " AND `deleted` = 0";
 
-	if (DBResultPtr result = g_database.storeQuery(query.str())) {
+	if (DBResultPtr result = database.storeQuery(query.str())) {
 		do {
 			account.charList.push_back(result->getString("name"));
 		} while (result->next());
@@ -337,40 +427,184 @@ const Group* IOLoginData::getPlayerGroupByAccount(uint32_t accountId)
 }
 
 bool IOLoginData::loadPlayer(Player* player, const std::string& name, bool preLoad /*= false*/)
+{
+	PlayerLoadData data;
+	if (!prefetchPlayer(g_database, name, data, preLoad)) {
+		return false;
+	}
+
+	return loadPlayer(player, data, preLoad);
+}
+
+uint32_t IOLoginData::beginPrefetch(const std::string& name)
+{
+	PrefetchState& state = m_prefetches[otx::util::as_lower_string(name)];
+	++state.pending;
+	return state.version;
+}
+
+bool IOLoginData::finishPrefetch(const std::string& name, uint32_t version)
+{
+	auto it = m_prefetches.find(otx::util::as_lower_string(name));
+	if (it == m_prefetches.end()) {
+		return true;
+	}
+
+	const bool valid = it->second.version == version;
+	if (--it->second.pending == 0) {
+		m_prefetches.erase(it);
+	}
+	return valid;
+}
+
+void IOLoginData::invalidatePrefetch(const std::string& name)
+{
+	if (m_prefetches.empty()) {
+		return;
+	}
+
+	auto it = m_prefetches.find(otx::util::as_lower_string(name));
+	if (it != m_prefetches.end()) {
+		++it->second.version;
+	}
+}
+
+void IOLoginData::invalidatePrefetch(uint32_t guid)
+{
+	if (m_prefetches.empty()) {
+		return;
+	}
+
+	// no query for the name, when it is not cached every prefetch in flight is taken again
+	auto it = nameCacheMap.find(guid);
+	if (it != nameCacheMap.end()) {
+		invalidatePrefetch(it->second);
+	} else {
+		invalidatePrefetches();
+	}
+}
+
+void IOLoginData::invalidatePrefetches()
+{
+	for (auto& it : m_prefetches) {
+		++it.second.version;
+	}
+}
+
+bool IOLoginData::prefetchPlayer(Database& database, const std::string& name, PlayerLoadData& data, bool preLoad /*= false*/)
 {
 	std::ostringstream query;
-	query << "SELECT `id`, `account_id`, `group_id`, `sex`, `vocation`, `experience`, `level`, "
-		  << "`maglevel`, `health`, `healthmax`, `blessings`, `pvp_blessing`, `mana`, `manamax`, `manaspent`, `soul`, "
-		  << "`lookbody`, `lookfeet`, `lookhead`, `looklegs`, `looktype`, `lookaddons`, `posx`, `posy`, "
-		  << "`posz`, `cap`, `lastlogin`, `lastlogout`, `lastip`, `conditions`, `skull`, `skulltime`, `guildnick`, "
-		  << "`rank_id`, `town_id`, `balance`, `stamina`, `direction`, `loss_experience`, `loss_mana`, `loss_skills`, "
-		  << "`loss_containers`, `loss_items`, `marriage`, `promotion`, `description`, `offlinetraining_time`, `offlinetraining_skill`, "
-		  << "`save` FROM `players` WHERE "
-		  << "`name` = " << g_database.escapeString(name) << " AND `deleted` = 0 LIMIT 1";
+	query << "SELECT ";
+	const size_t columns = m_snapshotColumn ? PLAYERCOLUMN_COUNT : PLAYERCOLUMN_SNAPSHOT;
+	for (size_t column = 0; column < columns; ++column) {
+		query << (column ? ", `" : "`") << playerColumns[column] << '`';
+	}
 
-	DBResultPtr result = g_database.storeQuery(query.str());
-	if (!result) {
+	query << " FROM `players` WHERE `name` = " << database.escapeString(name) << " AND `deleted` = 0 LIMIT 1";
+	if (!(data.player = database.storeQuery(query.str()))) {
 		return false;
 	}
 
-	uint32_t accountId = result->getNumber<int32_t>("account_id");
+	data.name = name;
+	data.account = loadAccount(data.player->getNumber<uint32_t>(PLAYERCOLUMN_ACCOUNT_ID), true, database);
+	if (preLoad) {
+		return true;
+	}
+
+	StorageTimer timer(m_loads, m_loadTime);
+	const uint32_t guid = data.player->getNumber<uint32_t>(PLAYERCOLUMN_ID);
+
+	const uint32_t rankId = data.player->getNumber<int32_t>(PLAYERCOLUMN_RANK_ID);
+	if (rankId > 0) {
+		query.str("");
+		query << "SELECT `guild_ranks`.`name` AS `rank`, `guild_ranks`.`guild_id` AS `guildid`, `guild_ranks`.`level` AS `level`, `guilds`.`name` AS `guildname` FROM `guild_ranks`, `guilds` WHERE `guild_ranks`.`id` = " << rankId << " AND `guild_ranks`.`guild_id` = `guilds`.`id` LIMIT 1";
+		if ((data.rank = database.storeQuery(query.str()))) {
+			const uint32_t guildId = data.rank->getNumber<uint32_t>("guildid");
+
+			std::string tmpStatus = "AND `status` IN (1,4)";
+			if (otx::config::getBoolean(otx::config::EXTERNAL_GUILD_WARS_MANAGEMENT)) {
+				tmpStatus = "AND `status` IN (1,4,9)";
+			}
+
+			query.str("");
+			query << "SELECT `id`, `guild_id`, `enemy_id` FROM `guild_wars` WHERE (`guild_id` = "
+				  << guildId << " OR `enemy_id` = " << guildId << ")" << tmpStatus;
+			data.wars = database.storeQuery(query.str());
+		}
+	} else if (otx::config::getBoolean(otx::config::INGAME_GUILD_MANAGEMENT)) {
+		query.str("");
+		query << "SELECT `guild_id` FROM `guild_invites` WHERE `player_id` = " << guid;
+		data.invites = database.storeQuery(query.str());
+	}
+
+	// a snapshot is cleared by every relational save, one still there is newer than the relational rows
+	unsigned long snapshotSize = 0;
+	if (m_snapshotColumn) {
+		data.player->getStream(PLAYERCOLUMN_SNAPSHOT, snapshotSize);
+	}
+
+	if (!snapshotSize) {
+		// never saved as a snapshot yet
+		query.str("");
+		query << "SELECT `skillid`, `value`, `count` FROM `player_skills` WHERE `player_id` = " << guid;
+		data.skills = database.storeQuery(query.str());
+
+		query.str("");
+		query << "SELECT `player_id`, `name` FROM `player_spells` WHERE `player_id` = " << guid;
+		data.spells = database.storeQuery(query.str());
+
+		query.str("");
+		query << "SELECT `pid`, `sid`, `itemtype`, `count`, `attributes`, `serial` FROM `player_items` WHERE `player_id` = " << guid << " ORDER BY `sid` DESC";
+		data.items = database.storeQuery(query.str());
+
+		query.str("");
+		query << "SELECT `pid`, `sid`, `itemtype`, `count`, `attributes`, `serial` FROM `player_depotitems` WHERE `player_id` = " << guid << " ORDER BY `sid` DESC";
+		data.depotItems = database.storeQuery(query.str());
+
+		query.str("");
+		query << "SELECT `key`, `value` FROM `player_storage` WHERE `player_id` = " << guid;
+		data.storage = database.storeQuery(query.str());
+	}
+
+	// the names come along so the vip list needs no lookups later, a snapshot only carries the per player list
+	query.str("");
+	if (!otx::config::getBoolean(otx::config::VIPLIST_PER_PLAYER)) {
+		query << "SELECT `account_viplist`.`player_id` AS `vip`, `players`.`name` FROM `account_viplist`, `players` WHERE `account_viplist`.`account_id` = "
+			  << data.account.number << " AND `players`.`id` = `account_viplist`.`player_id` AND `players`.`deleted` = 0";
+	} else if (!snapshotSize) {
+		query << "SELECT `player_viplist`.`vip_id` AS `vip`, `players`.`name` FROM `player_viplist`, `players` WHERE `player_viplist`.`player_id` = "
+			  << guid << " AND `players`.`id` = `player_viplist`.`vip_id` AND `players`.`deleted` = 0";
+	}
+
+	if (!query.str().empty()) {
+		data.vips = database.storeQuery(query.str());
+	}
+	return true;
+}
+
+bool IOLoginData::loadPlayer(Player* player, PlayerLoadData& data, bool preLoad /*= false*/)
+{
+	DBResultPtr result = data.player;
+	const std::string& name = data.name;
+
+	uint32_t accountId = result->getNumber<int32_t>(PLAYERCOLUMN_ACCOUNT_ID);
 	if (accountId < 1) {
 		return false;
 	}
 
-	const auto groupId = result->getNumber<uint16_t>("group_id");
+	const auto groupId = result->getNumber<uint16_t>(PLAYERCOLUMN_GROUP_ID);
 	Group* group = g_game.groups.getGroup(groupId);
 	if (!group) {
 		std::clog << "[Warning - IOLoginData::loadPlayer] Player with invalid group id " << groupId << " (" << name << ')' << std::endl;
 		return false;
 	}
 
-	Account account = loadAccount(accountId, true);
+	const Account& account = data.account;
 	player->m_account = account.name;
 	player->m_accountId = accountId;
 
 	player->setGroup(group);
-	player->setGUID(result->getNumber<uint32_t>("id"));
+	player->setGUID(result->getNumber<uint32_t>(PLAYERCOLUMN_ID));
 	player->m_premiumDays = account.premiumDays;
 
 	nameCacheMap[player->getGUID()] = name;
@@ -380,14 +614,14 @@ bool IOLoginData::loadPlayer(Player* player, const std::string& name, bool preLo
 		return true;
 	}
 
-	player->m_nameDescription += result->getString("description");
-	player->setSex(result->getNumber<int32_t>("sex"));
+	player->m_nameDescription += result->getString(PLAYERCOLUMN_DESCRIPTION);
+	player->setSex(result->getNumber<int32_t>(PLAYERCOLUMN_SEX));
 	if (otx::config::getBoolean(otx::config::STORE_DIRECTION)) {
-		player->setDirection(static_cast<Direction>(result->getNumber<uint8_t>("direction")));
+		player->setDirection(static_cast<Direction>(result->getNumber<uint8_t>(PLAYERCOLUMN_DIRECTION)));
 	}
 
-	player->m_vocationId = result->getNumber<int32_t>("vocation");
-	player->setPromotionLevel(result->getNumber<int32_t>("promotion"));
+	player->m_vocationId = result->getNumber<int32_t>(PLAYERCOLUMN_VOCATION);
+	player->setPromotionLevel(result->getNumber<int32_t>(PLAYERCOLUMN_PROMOTION));
 
 	const Vocation* vocation = player->getVocation();
 	if (!vocation) {
@@ -395,9 +629,9 @@ bool IOLoginData::loadPlayer(Player* player, const std::string& name, bool preLo
 		return false;
 	}
 
-	player->m_level = std::max<uint32_t>(1, result->getNumber<uint32_t>("level"));
+	player->m_level = std::max<uint32_t>(1, result->getNumber<uint32_t>(PLAYERCOLUMN_LEVEL));
 
-	uint64_t currExpCount = Player::getExpForLevel(player->m_level), nextExpCount = Player::getExpForLevel(player->m_level + 1), experience = result->getNumber<uint64_t>("experience");
+	uint64_t currExpCount = Player::getExpForLevel(player->m_level), nextExpCount = Player::getExpForLevel(player->m_level + 1), experience = result->getNumber<uint64_t>(PLAYERCOLUMN_EXPERIENCE);
 	if (experience < currExpCount || experience > nextExpCount) {
 		experience = currExpCount;
 	}
@@ -408,19 +642,19 @@ bool IOLoginData::loadPlayer(Player* player, const std::string& name, bool preLo
 		player->m_levelPercent = Player::getPercentLevel(player->m_experience - currExpCount, nextExpCount - currExpCount);
 	}
 
-	player->m_soul = result->getNumber<int32_t>("soul");
-	player->m_capacity = result->getNumber<int32_t>("cap");
-	player->setStamina(result->getNumber<uint64_t>("stamina"));
-	player->m_marriage = result->getNumber<int32_t>("marriage");
+	player->m_soul = result->getNumber<int32_t>(PLAYERCOLUMN_SOUL);
+	player->m_capacity = result->getNumber<int32_t>(PLAYERCOLUMN_CAP);
+	player->setStamina(result->getNumber<uint64_t>(PLAYERCOLUMN_STAMINA));
+	player->m_marriage = result->getNumber<int32_t>(PLAYERCOLUMN_MARRIAGE);
 
-	player->m_balance = result->getNumber<uint64_t>("balance");
+	player->m_balance = result->getNumber<uint64_t>(PLAYERCOLUMN_BALANCE);
 	if (otx::config::getBoolean(otx::config::BLESSINGS) && (player->isPremium() || !otx::config::getBoolean(otx::config::BLESSING_ONLY_PREMIUM))) {
-		player->m_blessings = result->getNumber<int32_t>("blessings");
-		player->setPVPBlessing(result->getNumber<int32_t>("pvp_blessing") != 0);
+		player->m_blessings = result->getNumber<int32_t>(PLAYERCOLUMN_BLESSINGS);
+		player->setPVPBlessing(result->getNumber<int32_t>(PLAYERCOLUMN_PVP_BLESSING) != 0);
 	}
 
 	unsigned long conditionsSize = 0;
-	const char* conditions = result->getStream("conditions", conditionsSize);
+	const char* conditions = result->getStream(PLAYERCOLUMN_CONDITIONS, conditionsSize);
 
 	PropStream propStream;
 	propStream.init(conditions, conditionsSize);
@@ -434,13 +668,13 @@ bool IOLoginData::loadPlayer(Player* player, const std::string& name, bool preLo
 		}
 	}
 
-	player->m_health = result->getNumber<int32_t>("health");
-	player->m_healthMax = result->getNumber<int32_t>("healthmax");
-	player->m_mana = result->getNumber<int32_t>("mana");
-	player->m_manaMax = result->getNumber<int32_t>("manamax");
+	player->m_health = result->getNumber<int32_t>(PLAYERCOLUMN_HEALTH);
+	player->m_healthMax = result->getNumber<int32_t>(PLAYERCOLUMN_HEALTHMAX);
+	player->m_mana = result->getNumber<int32_t>(PLAYERCOLUMN_MANA);
+	player->m_manaMax = result->getNumber<int32_t>(PLAYERCOLUMN_MANAMAX);
 
-	player->m_magLevel = result->getNumber<int32_t>("maglevel");
-	uint64_t nextManaCount = vocation->getReqMana(player->m_magLevel + 1), manaSpent = result->getNumber<uint64_t>("manaspent");
+	player->m_magLevel = result->getNumber<int32_t>(PLAYERCOLUMN_MAGLEVEL);
+	uint64_t nextManaCount = vocation->getReqMana(player->m_magLevel + 1), manaSpent = result->getNumber<uint64_t>(PLAYERCOLUMN_MANASPENT);
 	if (manaSpent > nextManaCount) {
 		manaSpent = 0;
 	}
@@ -450,54 +684,59 @@ bool IOLoginData::loadPlayer(Player* player, const std::string& name, bool preLo
 	if (group && group->lookType != 0) {
 		player->m_defaultOutfit.lookType = group->lookType;
 	} else {
-		player->m_defaultOutfit.lookType = result->getNumber<uint16_t>("looktype");
+		player->m_defaultOutfit.lookType = result->getNumber<uint16_t>(PLAYERCOLUMN_LOOKTYPE);
 	}
 
-	player->m_defaultOutfit.lookHead = result->getNumber<int32_t>("lookhead");
-	player->m_defaultOutfit.lookBody = result->getNumber<int32_t>("lookbody");
-	player->m_defaultOutfit.lookLegs = result->getNumber<int32_t>("looklegs");
-	player->m_defaultOutfit.lookFeet = result->getNumber<int32_t>("lookfeet");
-	player->m_defaultOutfit.lookAddons = result->getNumber<int32_t>("lookaddons");
+	player->m_defaultOutfit.lookHead = result->getNumber<int32_t>(PLAYERCOLUMN_LOOKHEAD);
+	player->m_defaultOutfit.lookBody = result->getNumber<int32_t>(PLAYERCOLUMN_LOOKBODY);
+	player->m_defaultOutfit.lookLegs = result->getNumber<int32_t>(PLAYERCOLUMN_LOOKLEGS);
+	player->m_defaultOutfit.lookFeet = result->getNumber<int32_t>(PLAYERCOLUMN_LOOKFEET);
+	player->m_defaultOutfit.lookAddons = result->getNumber<int32_t>(PLAYERCOLUMN_LOOKADDONS);
 
 	player->m_currentOutfit = player->m_defaultOutfit;
 	Skulls_t skull = SKULL_RED;
 	if (otx::config::getBoolean(otx::config::USE_BLACK_SKULL)) {
-		skull = static_cast<Skulls_t>(result->getNumber<uint8_t>("skull"));
+		skull = static_cast<Skulls_t>(result->getNumber<uint8_t>(PLAYERCOLUMN_SKULL));
 	}
 
-	player->setSkullEnd(result->getNumber<int64_t>("skulltime"), true, skull);
-	player->m_saving = result->getNumber<int32_t>("save") != 0;
+	player->setSkullEnd(result->getNumber<int64_t>(PLAYERCOLUMN_SKULLTIME), true, skull);
+	player->m_saving = result->getNumber<int32_t>(PLAYERCOLUMN_SAVE) != 0;
 
-	player->m_town = result->getNumber<int32_t>("town_id");
+	player->m_town = result->getNumber<int32_t>(PLAYERCOLUMN_TOWN_ID);
 	if (Town* town = Towns::getInstance()->getTown(player->m_town)) {
 		player->setMasterPosition(town->getPosition());
 	}
 
-	player->setLossPercent(LOSS_EXPERIENCE, result->getNumber<int32_t>("loss_experience"));
-	player->setLossPercent(LOSS_MANA, result->getNumber<int32_t>("loss_mana"));
-	player->setLossPercent(LOSS_SKILLS, result->getNumber<int32_t>("loss_skills"));
-	player->setLossPercent(LOSS_CONTAINERS, result->getNumber<int32_t>("loss_containers"));
-	player->setLossPercent(LOSS_ITEMS, result->getNumber<int32_t>("loss_items"));
+	player->setLossPercent(LOSS_EXPERIENCE, result->getNumber<int32_t>(PLAYERCOLUMN_LOSS_EXPERIENCE));
+	player->setLossPercent(LOSS_MANA, result->getNumber<int32_t>(PLAYERCOLUMN_LOSS_MANA));
+	player->setLossPercent(LOSS_SKILLS, result->getNumber<int32_t>(PLAYERCOLUMN_LOSS_SKILLS));
+	player->setLossPercent(LOSS_CONTAINERS, result->getNumber<int32_t>(PLAYERCOLUMN_LOSS_CONTAINERS));
+	player->setLossPercent(LOSS_ITEMS, result->getNumber<int32_t>(PLAYERCOLUMN_LOSS_ITEMS));
 
-	player->m_lastLogin = result->getNumber<uint64_t>("lastlogin");
-	player->m_lastLogout = result->getNumber<uint64_t>("lastlogout");
-	player->m_lastIP = result->getNumber<int32_t>("lastip");
+	player->m_lastLogin = result->getNumber<uint64_t>(PLAYERCOLUMN_LASTLOGIN);
+	player->m_lastLogout = result->getNumber<uint64_t>(PLAYERCOLUMN_LASTLOGOUT);
+	player->m_lastIP = result->getNumber<int32_t>(PLAYERCOLUMN_LASTIP);
 
-	player->m_offlineTrainingTime = result->getNumber<int32_t>("offlinetraining_time") * 1000;
-	player->m_offlineTrainingSkill = result->getNumber<int32_t>("offlinetraining_skill");
+	player->m_offlineTrainingTime = result->getNumber<int32_t>(PLAYERCOLUMN_OFFLINETRAINING_TIME) * 1000;
+	player->m_offlineTrainingSkill = result->getNumber<int32_t>(PLAYERCOLUMN_OFFLINETRAINING_SKILL);
 
-	player->m_loginPosition = Position(result->getNumber<int32_t>("posx"), result->getNumber<int32_t>("posy"), result->getNumber<int32_t>("posz"));
+	player->m_loginPosition = Position(result->getNumber<int32_t>(PLAYERCOLUMN_POSX), result->getNumber<int32_t>(PLAYERCOLUMN_POSY), result->getNumber<int32_t>(PLAYERCOLUMN_POSZ));
 	if (!player->m_loginPosition.x || !player->m_loginPosition.y) {
 		player->m_loginPosition = player->getMasterPosition();
 	}
 
-	const uint32_t rankId = result->getNumber<int32_t>("rank_id");
-	const std::string nick = result->getString("guildnick");
+	std::string snapshot;
+	if (m_snapshotColumn) {
+		unsigned long snapshotSize = 0;
+		const char* snapshotData = result->getStream(PLAYERCOLUMN_SNAPSHOT, snapshotSize);
+		snapshot.assign(snapshotData, snapshotSize);
+	}
+
+	const uint32_t rankId = result->getNumber<int32_t>(PLAYERCOLUMN_RANK_ID);
+	const std::string nick = result->getString(PLAYERCOLUMN_GUILDNICK);
 
 	if (rankId > 0) {
-		query.str("");
-		query << "SELECT `guild_ranks`.`name` AS `rank`, `guild_ranks`.`guild_id` AS `guildid`, `guild_ranks`.`level` AS `level`, `guilds`.`name` AS `guildname` FROM `guild_ranks`, `guilds` WHERE `guild_ranks`.`id` = " << rankId << " AND `guild_ranks`.`guild_id` = `guilds`.`id` LIMIT 1";
-		if ((result = g_database.storeQuery(query.str()))) {
+		if ((result = data.rank)) {
 			player->m_guildId = result->getNumber<int32_t>("guildid");
 			player->m_guildName = result->getString("guildname");
 			player->m_guildLevel = static_cast<GuildLevel_t>(result->getNumber<uint8_t>("level"));
@@ -505,64 +744,86 @@ bool IOLoginData::loadPlayer(Player* player, const std::string& name, bool preLo
 			player->m_rankId = rankId;
 			player->m_rankName = result->getString("rank");
 			player->m_guildNick = nick;
+			if ((result = data.wars)) {
+				const size_t idColumn = result->getColumnIndex("id"), guildColumn = result->getColumnIndex("guild_id"),
+							 enemyColumn = result->getColumnIndex("enemy_id");
 
-			std::string tmpStatus = "AND `status` IN (1,4)";
-			if (otx::config::getBoolean(otx::config::EXTERNAL_GUILD_WARS_MANAGEMENT)) {
-				tmpStatus = "AND `status` IN (1,4,9)";
-			}
-
-			query.str("");
-			query << "SELECT `id`, `guild_id`, `enemy_id` FROM `guild_wars` WHERE (`guild_id` = "
-				  << player->m_guildId << " OR `enemy_id` = " << player->m_guildId << ")" << tmpStatus;
-			if ((result = g_database.storeQuery(query.str()))) {
 				War_t war;
 				do {
-					uint32_t guild = result->getNumber<int32_t>("guild_id");
+					uint32_t guild = result->getNumber<int32_t>(guildColumn);
 					if (player->m_guildId == guild) {
 						war.type = WAR_ENEMY;
-						war.war = result->getNumber<int32_t>("id");
-						player->addEnemy(result->getNumber<int32_t>("enemy_id"), war);
+						war.war = result->getNumber<int32_t>(idColumn);
+						player->addEnemy(result->getNumber<int32_t>(enemyColumn), war);
 					} else {
 						war.type = WAR_GUILD;
-						war.war = result->getNumber<int32_t>("id");
+						war.war = result->getNumber<int32_t>(idColumn);
 						player->addEnemy(guild, war);
 					}
 				} while (result->next());
 			}
 		}
-	} else if (otx::config::getBoolean(otx::config::INGAME_GUILD_MANAGEMENT)) {
-		query.str("");
-		query << "SELECT `guild_id` FROM `guild_invites` WHERE `player_id` = " << player->getGUID();
-		if ((result = g_database.storeQuery(query.str()))) {
-			do {
-				player->m_invitationsList.push_back(result->getNumber<uint32_t>("guild_id"));
-			} while (result->next());
-		}
+	} else if ((result = data.invites)) {
+		const size_t guildColumn = result->getColumnIndex("guild_id");
+		do {
+			player->m_invitationsList.push_back(result->getNumber<uint32_t>(guildColumn));
+		} while (result->next());
 	}
 
-	query.str("");
-	query << "SELECT `password` FROM `accounts` WHERE `id` = " << accountId << " LIMIT 1";
-	if (!(result = g_database.storeQuery(query.str()))) {
+	if (!account.number) {
 		return false;
 	}
 
-	player->m_password = result->getString("password");
+	player->m_password = account.password;
+	if (snapshot.empty()) {
+		// never saved as a snapshot yet
+		loadRelational(player, vocation, data);
+	} else {
+		PropStream propStream;
+		propStream.init(snapshot.data(), snapshot.size());
+		if (!unserializePlayer(player, vocation, propStream)) {
+			std::clog << "[Error - IOLoginData::loadPlayer] Cannot unserialize the snapshot of player " << name << std::endl;
+			return false;
+		}
+
+		if (!m_snapshotStorage) {
+			std::clog << "[Notice - IOLoginData::loadPlayer] Player " << name << " was last saved with binary storage, loaded from the snapshot." << std::endl;
+		}
+	}
 
+	// load vip
+	if ((result = data.vips)) {
+		const size_t vipColumn = result->getColumnIndex("vip"), nameColumn = result->getColumnIndex("name");
+		do {
+			uint32_t vid = result->getNumber<int32_t>(vipColumn);
+			nameCacheMap[vid] = result->getString(nameColumn);
+			player->addVIP(vid, "", false, true);
+		} while (result->next());
+	}
+
+	player->updateInventoryWeight();
+	player->updateItemsLight(true);
+	player->updateBaseSpeed();
+	return true;
+}
+
+void IOLoginData::loadRelational(Player* player, const Vocation* vocation, PlayerLoadData& data)
+{
 	// we need to find out our skills
-	// so we query the skill table
-	query.str("");
-	query << "SELECT `skillid`, `value`, `count` FROM `player_skills` WHERE `player_id` = " << player->getGUID();
-	if ((result = g_database.storeQuery(query.str()))) {
+	if (DBResultPtr result = data.skills) {
+		const size_t skillColumn = result->getColumnIndex("skillid"), valueColumn = result->getColumnIndex("value"),
+					 countColumn = result->getColumnIndex("count");
+
 		// now iterate over the skills
 		do {
-			int16_t skillId = result->getNumber<int32_t>("skillid");
+			int16_t skillId = result->getNumber<int32_t>(skillColumn);
 			if (skillId < SKILL_FIRST || skillId > SKILL_LAST) {
 				continue;
 			}
 
-			uint32_t skillLevel = result->getNumber<int32_t>("value");
+			uint32_t skillLevel = result->getNumber<int32_t>(valueColumn);
 			uint64_t nextSkillCount = vocation->getReqSkillTries(skillId, skillLevel + 1),
-					 skillCount = result->getNumber<uint64_t>("count");
+					 skillCount = result->getNumber<uint64_t>(countColumn);
 			if (skillCount > nextSkillCount) {
 				skillCount = 0;
 			}
@@ -573,11 +834,10 @@ bool IOLoginData::loadPlayer(Player* player, const std::string& name, bool preLo
 		} while (result->next());
 	}
 
-	query.str("");
-	query << "SELECT `player_id`, `name` FROM `player_spells` WHERE `player_id` = " << player->getGUID();
-	if ((result = g_database.storeQuery(query.str()))) {
+	if (DBResultPtr result = data.spells) {
+		const size_t nameColumn = result->getColumnIndex("name");
 		do {
-			player->m_learnedInstantSpellList.push_back(result->getString("name"));
+			player->m_learnedInstantSpellList.push_back(result->getString(nameColumn));
 		} while (result->next());
 	}
 
@@ -585,9 +845,7 @@ bool IOLoginData::loadPlayer(Player* player, const std::string& name, bool preLo
 	ItemMap::iterator it;
 
 	// load inventory items
-	query.str("");
-	query << "SELECT `pid`, `sid`, `itemtype`, `count`, `attributes`, `serial` FROM `player_items` WHERE `player_id` = " << player->getGUID() << " ORDER BY `sid` DESC";
-	if ((result = g_database.storeQuery(query.str()))) {
+	if (DBResultPtr result = data.items) {
 		loadItems(itemMap, result);
 		for (ItemMap::reverse_iterator rit = itemMap.rbegin(); rit != itemMap.rend(); ++rit) {
 			Item* item = rit->second.first;
@@ -608,9 +866,7 @@ bool IOLoginData::loadPlayer(Player* player, const std::string& name, bool preLo
 	}
 
 	// load depot items
-	query.str("");
-	query << "SELECT `pid`, `sid`, `itemtype`, `count`, `attributes`, `serial` FROM `player_depotitems` WHERE `player_id` = " << player->getGUID() << " ORDER BY `sid` DESC";
-	if ((result = g_database.storeQuery(query.str()))) {
+	if (DBResultPtr result = data.depotItems) {
 		loadItems(itemMap, result);
 		for (ItemMap::reverse_iterator rit = itemMap.rbegin(); rit != itemMap.rend(); ++rit) {
 			Item* item = rit->second.first;
@@ -620,10 +876,10 @@ bool IOLoginData::loadPlayer(Player* player, const std::string& name, bool preLo
 					if (Depot* depot = c->getDepot()) {
 						player->addDepot(depot, pid);
 					} else {
-						std::clog << "[Error - IOLoginData::loadPlayer] Cannot load depot " << pid << " for player " << name << std::endl;
+						std::clog << "[Error - IOLoginData::loadPlayer] Cannot load depot " << pid << " for player " << data.name << std::endl;
 					}
 				} else {
-					std::clog << "[Error - IOLoginData::loadPlayer] Cannot load depot " << pid << " for player " << name << std::endl;
+					std::clog << "[Error - IOLoginData::loadPlayer] Cannot load depot " << pid << " for player " << data.name << std::endl;
 				}
 			} else if ((it = itemMap.find(pid)) != itemMap.end()) {
 				if (Container* container = it->second.first->getContainer()) {
@@ -636,56 +892,36 @@ bool IOLoginData::loadPlayer(Player* player, const std::string& name, bool preLo
 	}
 
 	// load storage map
-	query.str("");
-	query << "SELECT `key`, `value` FROM `player_storage` WHERE `player_id` = " << player->getGUID();
-	if ((result = g_database.storeQuery(query.str()))) {
+	if (DBResultPtr result = data.storage) {
+		const size_t keyColumn = result->getColumnIndex("key"), valueColumn = result->getColumnIndex("value");
 		do {
-			player->setStorage(result->getString("key"), result->getString("value"), true);
+			player->setStorage(result->getString(keyColumn), result->getString(valueColumn), true);
 		} while (result->next());
 	}
-
-	// load vip
-	query.str("");
-	if (!otx::config::getBoolean(otx::config::VIPLIST_PER_PLAYER)) {
-		query << "SELECT `player_id` AS `vip` FROM `account_viplist` WHERE `account_id` = " << account.number;
-	} else {
-		query << "SELECT `vip_id` AS `vip` FROM `player_viplist` WHERE `player_id` = " << player->getGUID();
-	}
-
-	if ((result = g_database.storeQuery(query.str()))) {
-		do {
-			uint32_t vid = result->getNumber<int32_t>("vip");
-			if (storeNameByGuid(vid)) {
-				player->addVIP(vid, "", false, true);
-			}
-		} while (result->next());
-	}
-
-	player->updateInventoryWeight();
-	player->updateItemsLight(true);
-	player->updateBaseSpeed();
-	return true;
 }
 
 void IOLoginData::loadItems(ItemMap& itemMap, DBResultPtr result)
 {
+	const size_t sidColumn = result->getColumnIndex("sid"), pidColumn = result->getColumnIndex("pid"),
+				 typeColumn = result->getColumnIndex("itemtype"), countColumn = result->getColumnIndex("count"),
+				 attributesColumn = result->getColumnIndex("attributes"), serialColumn = result->getColumnIndex("serial");
 	do {
 		unsigned long attrSize = 0;
-		const char* attr = result->getStream("attributes", attrSize);
+		const char* attr = result->getStream(attributesColumn, attrSize);
 
 		PropStream propStream;
 		propStream.init(attr, attrSize);
-		if (Item* item = Item::CreateItem(result->getNumber<int32_t>("itemtype"), result->getNumber<int32_t>("count"))) {
+		if (Item* item = Item::CreateItem(result->getNumber<int32_t>(typeColumn), result->getNumber<int32_t>(countColumn))) {
 			if (!item->unserializeAttr(propStream)) {
 				std::clog << "[Warning - IOLoginData::loadItems] Unserialize error for item with id " << item->getID() << std::endl;
 			}
 
-			const std::string serial = result->getString("serial");
+			const std::string serial = result->getString(serialColumn);
 			if (!serial.empty()) {
 				item->setStrAttr("serial", serial);
 			}
 
-			itemMap[result->getNumber<int32_t>("sid")] = std::make_pair(item, result->getNumber<int32_t>("pid"));
+			itemMap[result->getNumber<int32_t>(sidColumn)] = std::make_pair(item, result->getNumber<int32_t>(pidColumn));
 		}
 	} while (result->next());
 }
@@ -699,6 +935,8 @@ bool IOLoginData::setName(Player* player, std::string newName)
 		return false;
 	}
 
+	invalidatePrefetch(player->getName());
+
 	query.str("");
 	query << "UPDATE `players` SET `name` = " << g_database.escapeString(newName) << " WHERE `name` = " << g_database.escapeString(player->getName());
 
@@ -718,6 +956,8 @@ bool IOLoginData::deletePlayer(Player* player)
 		return false;
 	}
 
+	invalidatePrefetch(player->getName());
+
 	query.str("");
 	query << "DELETE FROM `players` WHERE `name` = " << g_database.escapeString(player->getName());
 
@@ -744,8 +984,16 @@ bool IOLoginData::savePlayer(Player* player, bool preSave /* = true*/, bool shal
 			player->m_mana = player->m_manaMax;
 		}
 	}
+
+	StorageTimer timer(m_saves, m_saveTime);
+	invalidatePrefetch(player->getName());
 	std::ostringstream query;
 
+	// the invites still queued by IOGuild reference this player, waiting for them once its row is locked would deadlock
+	if (!shallow) {
+		IOGuild::getInstance()->flushInviteWrites();
+	}
+
 	DBTransaction trans;
 	if (!trans.begin()) {
 		return false;
@@ -841,7 +1089,9 @@ bool IOLoginData::savePlayer(Player* player, bool preSave /* = true*/, bool shal
 	query << "`marriage` = " << player->m_marriage << ", ";
 	if (otx::config::getBoolean(otx::config::INGAME_GUILD_MANAGEMENT)) {
 		query << "`guildnick` = " << g_database.escapeString(player->m_guildNick) << ", ";
-		query << "`rank_id` = " << IOGuild::getInstance()->getRankIdByLevel(player->getGuildId(), player->getGuildLevel()) << ", ";
+		const uint32_t rankId = IOGuild::getInstance()->getRankIdByLevel(player->getGuildId(), player->getGuildLevel());
+		query << "`rank_id` = " << rankId << ", ";
+		IOGuild::getInstance()->setPlayerRank(player->getGUID(), rankId);
 	}
 
 	uint32_t vocationId = player->getVocationId();
@@ -858,11 +1108,44 @@ bool IOLoginData::savePlayer(Player* player, bool preSave /* = true*/, bool shal
 		}
 	}
 
+	if (m_snapshotStorage) {
+		PropWriteStream snapshot;
+		serializePlayer(player, snapshot);
+
+		uint32_t snapshotSize = 0;
+		const char* snapshotData = snapshot.getStream(snapshotSize);
+		query << "`snapshot` = " << g_database.escapeBlob(snapshotData, snapshotSize) << ", ";
+	} else if (m_snapshotColumn) {
+		// a snapshot left from binary storage is stale from now on
+		query << "`snapshot` = NULL, ";
+	}
+
 	query << "`vocation` = " << vocationId << " WHERE `id` = " << player->getGUID() << " LIMIT 1";
 	if (!g_database.executeQuery(query.str())) {
-		return false;	
+		return false;
 	}
 
+	if (m_snapshotStorage) {
+		// what is left is shared with the guild or the account, so it stays relational
+		if (!shallow && (!saveGuildInvites(player) || (!otx::config::getBoolean(otx::config::VIPLIST_PER_PLAYER) && !saveVIPList(player)))) {
+			return false;
+		}
+
+		return trans.commit();
+	}
+
+	if (!saveRelational(player, shallow)) {
+		return false;
+	}
+
+	// End the transaction
+	return trans.commit();
+}
+
+bool IOLoginData::saveRelational(Player* player, bool shallow)
+{
+	std::ostringstream query;
+
 	// skills
 	for (uint8_t i = SKILL_FIRST; i <= SKILL_LAST; ++i) {
 		query.str("");
@@ -873,7 +1156,7 @@ bool IOLoginData::savePlayer(Player* player, bool preSave /* = true*/, bool shal
 	}
 
 	if (shallow) {
-		return trans.commit();
+		return true;
 	}
 
 	// learned spells
@@ -962,36 +1245,47 @@ bool IOLoginData::savePlayer(Player* player, bool preSave /* = true*/, bool shal
 		return false;
 	}
 
-	if (otx::config::getBoolean(otx::config::INGAME_GUILD_MANAGEMENT)) {
-		query.str("");
-		// save guild invites
-		query << "DELETE FROM `guild_invites` WHERE player_id = " << player->getGUID();
-		if (!g_database.executeQuery(query.str())) {
-			return false;
-		}
+	return saveGuildInvites(player) && saveVIPList(player);
+}
 
-		query.str("");
-		stmt.setQuery("INSERT INTO `guild_invites` (`player_id`, `guild_id`) VALUES ");
-		for (InvitationsList::iterator it = player->m_invitationsList.begin(); it != player->m_invitationsList.end(); ++it) {
-			if (!IOGuild::getInstance()->guildExists(*it)) {
-				it = player->m_invitationsList.erase(it);
-				continue;
-			}
+bool IOLoginData::saveGuildInvites(Player* player)
+{
+	if (!otx::config::getBoolean(otx::config::INGAME_GUILD_MANAGEMENT)) {
+		return true;
+	}
 
-			query << player->getGUID() << "," << (*it);
-			if (!stmt.addRow(query.str())) {
-				return false;
-			}
-			query.str("");
+	// save guild invites, the caller flushed the invites and revokes still queued by IOGuild before its transaction
+	std::ostringstream query;
+	query << "DELETE FROM `guild_invites` WHERE player_id = " << player->getGUID();
+	if (!g_database.executeQuery(query.str())) {
+		return false;
+	}
+
+	DBInsert stmt;
+	stmt.setQuery("INSERT INTO `guild_invites` (`player_id`, `guild_id`) VALUES ");
+
+	query.str("");
+	for (InvitationsList::iterator it = player->m_invitationsList.begin(); it != player->m_invitationsList.end(); ++it) {
+		if (!IOGuild::getInstance()->guildExists(*it)) {
+			it = player->m_invitationsList.erase(it);
+			continue;
 		}
 
-		if (!stmt.execute()) {
+		query << player->getGUID() << "," << (*it);
+		if (!stmt.addRow(query.str())) {
 			return false;
 		}
+		query.str("");
 	}
 
-	query.str("");
+	IOGuild::getInstance()->setPlayerInvites(player->getGUID(), player->m_invitationsList);
+	return stmt.execute();
+}
+
+bool IOLoginData::saveVIPList(Player* player)
+{
 	// save vip list
+	std::ostringstream query;
 	if (!otx::config::getBoolean(otx::config::VIPLIST_PER_PLAYER)) {
 		query << "DELETE FROM `account_viplist` WHERE `account_id` = " << player->getAccount();
 	} else {
@@ -1002,6 +1296,7 @@ bool IOLoginData::savePlayer(Player* player, bool preSave /* = true*/, bool shal
 		return false;
 	}
 
+	DBInsert stmt;
 	if (!otx::config::getBoolean(otx::config::VIPLIST_PER_PLAYER)) {
 		stmt.setQuery("INSERT INTO `account_viplist` (`account_id`, `player_id`) VALUES ");
 	} else {
@@ -1026,12 +1321,7 @@ bool IOLoginData::savePlayer(Player* player, bool preSave /* = true*/, bool shal
 		query.str("");
 	}
 
-	if (!stmt.execute()) {
-		return false;
-	}
-
-	// End the transaction
-	return trans.commit();
+	return stmt.execute();
 }
 
 bool IOLoginData::savePlayerItems(Player* player)
@@ -1043,6 +1333,12 @@ bool IOLoginData::savePlayerItems(Player* player)
 		return false;
 	}
 
+	if (m_snapshotStorage) {
+		// the items are only read back from the snapshot
+		return savePlayer(player, false, true);
+	}
+
+	invalidatePrefetch(player->getName());
 	DBTransaction trans;
 	if (!trans.begin()) {
 		return false;
@@ -1188,6 +1484,365 @@ bool IOLoginData::saveItems(const Player* player, const ItemBlockList& itemList,
 	return stmt.execute();
 }
 
+bool IOLoginData::loadSnapshotState()
+{
+	std::ostringstream query;
+	query << "SELECT 1 FROM `information_schema`.`columns` WHERE `TABLE_SCHEMA` = " << g_database.escapeString(otx::config::getString(otx::config::SQL_DB))
+		  << " AND `TABLE_NAME` = 'players' AND `COLUMN_NAME` = 'snapshot'";
+	m_snapshotColumn = g_database.storeQuery(query.str()) != nullptr;
+
+	const std::string storage = otx::util::as_lower_string(otx::config::getString(otx::config::PLAYER_STORAGE));
+	m_snapshotStorage = storage == "binary";
+	if (m_snapshotStorage && !m_snapshotColumn) {
+		std::clog << "[Error - IOLoginData::loadSnapshotState] Binary player storage needs the `snapshot` column in `players`, see schemas.sql." << std::endl;
+		return false;
+	}
+
+	if (!m_snapshotStorage && storage != "relational") {
+		std::clog << "[Warning - IOLoginData::loadSnapshotState] Unknown player storage \"" << storage << "\", using relational." << std::endl;
+	}
+
+	if (!m_snapshotStorage && m_snapshotColumn) {
+		if (DBResultPtr result = g_database.storeQuery("SELECT COUNT(*) AS `count` FROM `players` WHERE `snapshot` IS NOT NULL")) {
+			if (const uint32_t count = result->getNumber<uint32_t>("count")) {
+				std::clog << "[Warning - IOLoginData::loadSnapshotState] " << count << " players were last saved with binary storage, their snapshots are newer than the relational tables. "
+						  << "They are loaded from the snapshot and moved to the tables on their next save." << std::endl;
+			}
+		}
+	}
+	return true;
+}
+
+bool IOLoginData::exportPlayer(Player* player)
+{
+	if (!m_snapshotStorage) {
+		return true;
+	}
+
+	IOGuild::getInstance()->flushInviteWrites();
+
+	DBTransaction trans;
+	if (!trans.begin()) {
+		return false;
+	}
+
+	if (!saveRelational(player, false)) {
+		return false;
+	}
+
+	return trans.commit();
+}
+
+PlayerStorageStatistics IOLoginData::getStorageStatistics() const
+{
+	PlayerStorageStatistics stats;
+	stats.loads = m_loads;
+	stats.loadTime = m_loadTime;
+	stats.saves = m_saves;
+	stats.saveTime = m_saveTime;
+	return stats;
+}
+
+void IOLoginData::serializePlayer(Player* player, PropWriteStream& stream)
+{
+	stream.addShort(PLAYER_SNAPSHOT_VERSION);
+
+	stream.addByte(SKILL_LAST - SKILL_FIRST + 1);
+	for (uint8_t i = SKILL_FIRST; i <= SKILL_LAST; ++i) {
+		stream.addShort(player->m_skills[i].level);
+		stream.addType<uint64_t>(player->m_skills[i].tries);
+	}
+
+	stream.addLong(player->m_learnedInstantSpellList.size());
+	for (const std::string& spell : player->m_learnedInstantSpellList) {
+		stream.addString(spell);
+	}
+
+	uint8_t slots = 0;
+	for (int32_t slotId = 1; slotId < 11; ++slotId) {
+		if (player->m_inventory[slotId]) {
+			++slots;
+		}
+	}
+
+	stream.addByte(slots);
+	for (int32_t slotId = 1; slotId < 11; ++slotId) {
+		if (Item* item = player->m_inventory[slotId]) {
+			stream.addByte(slotId);
+			serializeItem(stream, item);
+		}
+	}
+
+	stream.addLong(player->m_depots.size());
+	for (const auto& it : player->m_depots) {
+		stream.addLong(it.first);
+		serializeItem(stream, it.second.first);
+	}
+
+	player->generateReservedStorage();
+	stream.addLong(player->getStorages().size());
+	for (const auto& [key, value] : player->getStorages()) {
+		stream.addLongString(key);
+		stream.addLongString(value);
+	}
+
+	// an account wide list is shared with the other characters, so it stays in its table
+	if (otx::config::getBoolean(otx::config::VIPLIST_PER_PLAYER)) {
+		stream.addLong(player->m_VIPList.size());
+		for (uint32_t guid : player->m_VIPList) {
+			stream.addLong(guid);
+		}
+	} else {
+		stream.addLong(0);
+	}
+}
+
+bool IOLoginData::unserializePlayer(Player* player, const Vocation* vocation, PropStream& stream)
+{
+	uint16_t version = 0;
+	if (!stream.getShort(version) || version != PLAYER_SNAPSHOT_VERSION) {
+		std::clog << "[Error - IOLoginData::unserializePlayer] Unsupported snapshot version " << version << '.' << std::endl;
+		return false;
+	}
+
+	// everything is read before anything is applied, a broken snapshot leaves the player untouched
+	std::vector<std::pair<uint16_t, uint64_t>> skills;
+	std::vector<std::string> spells;
+	std::vector<std::pair<uint8_t, Item*>> inventory;
+	std::vector<std::pair<uint32_t, Depot*>> depots;
+	std::vector<std::pair<std::string, std::string>> storages;
+	std::vector<uint32_t> vips;
+
+	auto discard = [&]() {
+		for (const auto& it : inventory) {
+			delete it.second;
+		}
+
+		for (const auto& it : depots) {
+			delete it.second;
+		}
+		return false;
+	};
+
+	uint8_t skillCount = 0;
+	if (!stream.getByte(skillCount)) {
+		return false;
+	}
+
+	for (uint8_t i = 0; i < skillCount; ++i) {
+		uint16_t skillLevel = 0;
+		uint64_t skillTries = 0;
+		if (!stream.getShort(skillLevel) || !stream.getType(skillTries)) {
+			return false;
+		}
+
+		skills.emplace_back(skillLevel, skillTries);
+	}
+
+	uint32_t count = 0;
+	if (!stream.getLong(count)) {
+		return false;
+	}
+
+	for (; count > 0; --count) {
+		std::string spell;
+		if (!stream.getString(spell)) {
+			return false;
+		}
+
+		spells.push_back(std::move(spell));
+	}
+
+	uint8_t slots = 0;
+	if (!stream.getByte(slots)) {
+		return false;
+	}
+
+	for (; slots > 0; --slots) {
+		uint8_t slotId = 0;
+		Item* item = nullptr;
+		if (!stream.getByte(slotId) || slotId < 1 || slotId > 10 || !unserializeItem(stream, item)) {
+			return discard();
+		}
+
+		if (item) {
+			inventory.emplace_back(slotId, item);
+		}
+	}
+
+	if (!stream.getLong(count)) {
+		return discard();
+	}
+
+	for (; count > 0; --count) {
+		uint32_t depotId = 0;
+		Item* item = nullptr;
+		if (!stream.getLong(depotId) || !unserializeItem(stream, item)) {
+			return discard();
+		}
+
+		if (!item) {
+			continue;
+		}
+
+		Container* container = item->getContainer();
+		Depot* depot = container ? container->getDepot() : nullptr;
+		if (!depot) {
+			std::clog << "[Error - IOLoginData::unserializePlayer] Cannot load depot " << depotId << " for player " << player->getName() << std::endl;
+			delete item;
+			continue;
+		}
+
+		depots.emplace_back(depotId, depot);
+	}
+
+	if (!stream.getLong(count)) {
+		return discard();
+	}
+
+	for (; count > 0; --count) {
+		std::string key, value;
+		if (!stream.getLongString(key) || !stream.getLongString(value)) {
+			return discard();
+		}
+
+		storages.emplace_back(std::move(key), std::move(value));
+	}
+
+	if (!stream.getLong(count)) {
+		return discard();
+	}
+
+	for (; count > 0; --count) {
+		uint32_t guid = 0;
+		if (!stream.getLong(guid)) {
+			return discard();
+		}
+
+		vips.push_back(guid);
+	}
+
+	for (uint8_t i = 0; i < skills.size(); ++i) {
+		const uint8_t skillId = SKILL_FIRST + i;
+		if (skillId > SKILL_LAST) {
+			break;
+		}
+
+		const uint16_t skillLevel = skills[i].first;
+		uint64_t skillTries = skills[i].second;
+		uint64_t nextSkillCount = vocation->getReqSkillTries(skillId, skillLevel + 1);
+		if (skillTries > nextSkillCount) {
+			skillTries = 0;
+		}
+
+		player->m_skills[skillId].level = skillLevel;
+		player->m_skills[skillId].tries = skillTries;
+		player->m_skills[skillId].percent = Player::getPercentLevel(skillTries, nextSkillCount);
+	}
+
+	for (std::string& spell : spells) {
+		player->m_learnedInstantSpellList.push_back(std::move(spell));
+	}
+
+	for (const auto& it : inventory) {
+		player->__internalAddThing(it.first, it.second);
+	}
+
+	for (const auto& it : depots) {
+		player->addDepot(it.second, it.first);
+	}
+
+	for (const auto& it : storages) {
+		player->setStorage(it.first, it.second, true);
+	}
+
+	for (uint32_t guid : vips) {
+		if (storeNameByGuid(guid)) {
+			player->addVIP(guid, "", false, true);
+		}
+	}
+	return true;
+}
+
+void IOLoginData::serializeItem(PropWriteStream& stream, const Item* item)
+{
+	// the same layout as the binary house storage, sized so that an unknown type can be skipped with its contents
+	PropWriteStream itemStream;
+	itemStream.addShort(item->getID());
+	item->serializeAttr(itemStream);
+	if (const Container* container = item->getContainer()) {
+		itemStream.addByte(ATTR_CONTAINER_ITEMS);
+		itemStream.addLong(container->size());
+		for (auto rit = container->getReversedItems(); rit != container->getReversedEnd(); ++rit) {
+			serializeItem(itemStream, (*rit));
+		}
+	}
+
+	itemStream.addByte(ATTR_END);
+
+	uint32_t size = 0;
+	const char* data = itemStream.getStream(size);
+	stream.addLongString(std::string(data, size));
+}
+
+bool IOLoginData::unserializeItem(PropStream& stream, Item*& item)
+{
+	item = nullptr;
+	std::string data;
+	if (!stream.getLongString(data)) {
+		return false;
+	}
+
+	PropStream itemStream;
+	itemStream.init(data.data(), data.size());
+	return unserializeItemData(itemStream, item);
+}
+
+bool IOLoginData::unserializeItemData(PropStream& stream, Item*& item)
+{
+	uint16_t id = 0;
+	if (!stream.getShort(id)) {
+		return false;
+	}
+
+	item = Item::CreateItem(id);
+	if (!item) {
+		// like the relational loader, the item and whatever it holds are dropped
+		std::clog << "[Warning - IOLoginData::unserializeItem] Unknown item type " << id << ", skipped with its contents." << std::endl;
+		return true;
+	}
+
+	if (!item->unserializeAttr(stream)) {
+		delete item;
+		item = nullptr;
+		return false;
+	}
+
+	if (Container* container = item->getContainer()) {
+		for (; container->serializationCount > 0; --container->serializationCount) {
+			Item* child = nullptr;
+			if (!unserializeItem(stream, child)) {
+				delete item;
+				item = nullptr;
+				return false;
+			}
+
+			if (child) {
+				container->__internalAddThing(child);
+			}
+		}
+
+		// the attributes of a container stop at its items, the end marker follows them
+		uint8_t endAttr = ATTR_END;
+		if (!stream.getByte(endAttr) || endAttr != ATTR_END) {
+			delete item;
+			item = nullptr;
+			return false;
+		}
+	}
+	return true;
+}
+
 bool IOLoginData::playerStatement(Player* _player, uint16_t channelId, const std::string& text, uint32_t& statementId)
 {
 	std::ostringstream query;
@@ -1570,6 +2225,8 @@ bool IOLoginData::changeName(uint32_t guid, std::string newName, std::string old
 		return false;
 	}
 
+	invalidatePrefetch(oldName);
+
 	query.str("");
 	query << "UPDATE `players` SET `name` = " << g_database.escapeString(newName) << " WHERE `id` = " << guid << " LIMIT 1";
 	if (!g_database.executeQuery(query.str())) {
@@ -1652,15 +2309,21 @@ DeleteCharacter_t IOLoginData::deleteCharacter(uint32_t accountId, const std::st
 		return DELETE_LEADER;
 	}
 
+	invalidatePrefetch(id);
+
 	query.str("");
 	query << "UPDATE `players` SET `deleted` = " << time(nullptr) << " WHERE `id` = " << id << " LIMIT 1";
 	if (!g_database.executeQuery(query.str())) {
 		return DELETE_INTERNAL;
 	}
 
+	IOGuild::getInstance()->flushInviteWrites();
+
 	query.str("");
 	query << "DELETE FROM `guild_invites` WHERE `player_id` = " << id;
 	g_database.executeQuery(query.str());
+	IOGuild::getInstance()->setPlayerInvites(id, {});
+	IOGuild::getInstance()->setPlayerRank(id, 0);
 
 	query.str("");
 	query << "DELETE FROM `player_viplist` WHERE `vip_id` = " << id;
@@ -1813,9 +2476,16 @@ bool IOLoginData::updateOnlineStatus(uint32_t guid, bool login)
 
 bool IOLoginData::resetGuildInformation(uint32_t guid)
 {
+	invalidatePrefetch(guid);
+
 	std::ostringstream query;
 	query << "UPDATE `players` SET `rank_id` = 0, `guildnick` = '' WHERE `id` = " << guid << " AND `deleted` = 0 LIMIT 1";
-	return g_database.executeQuery(query.str());
+	if (!g_database.executeQuery(query.str())) {
+		return false;
+	}
+
+	IOGuild::getInstance()->setPlayerRank(guid, 0);
+	return true;
 }
 
 void IOLoginData::increaseBankBalance(uint32_t guid, uint64_t bankBalance)
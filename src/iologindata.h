@@ -43,10 +43,28 @@ struct Account
 	uint32_t number = 0;
 	uint32_t lastDay = 0;
 	uint16_t premiumDays = 0;
+	uint16_t groupId = 0;
 	uint16_t warnings = 0;
 	std::vector<std::string> charList;
 };
 
+// Everything loadPlayer reads from the database; it is fetched on any connection and applied on the dispatcher
+struct PlayerLoadData
+{
+	std::string name;
+	Account account;
+
+	DBResultPtr player;
+	DBResultPtr rank, wars, invites;
+	DBResultPtr skills, spells, items, depotItems, storage, vips;
+};
+
+struct PlayerStorageStatistics
+{
+	uint64_t loads = 0, loadTime = 0;
+	uint64_t saves = 0, saveTime = 0;
+};
+
 class IOLoginData final
 {
 public:
@@ -57,7 +75,7 @@ public:
 		return &instance;
 	}
 
-	Account loadAccount(uint32_t accountId, bool preLoad = false);
+	Account loadAccount(uint32_t accountId, bool preLoad = false, Database& database = g_database);
 	bool loadAccount(Account& account, const std::string& name);
 	bool saveAccount(Account account);
 
@@ -86,9 +104,35 @@ public:
 	bool setName(Player* player, std::string newName);
 
 	bool loadPlayer(Player* player, const std::string& name, bool preLoad = false);
+
+	// Login splits loading in two, the queries can run on another thread with their own connection
+	bool prefetchPlayer(Database& database, const std::string& name, PlayerLoadData& data, bool preLoad = false);
+	// dispatcher thread; a prefetch is stale once the player was saved between its start and its finish
+	uint32_t beginPrefetch(const std::string& name);
+	bool finishPrefetch(const std::string& name, uint32_t version);
+	// every direct write to a player's rows has to call one of these, or a prefetch may load what it replaced
+	void invalidatePrefetch(const std::string& name);
+	void invalidatePrefetch(uint32_t guid);
+	void invalidatePrefetches();
+	bool loadPlayer(Player* player, PlayerLoadData& data, bool preLoad = false);
 	bool savePlayer(Player* player, bool preSave = true, bool shallow = false);
 	bool savePlayerItems(Player* player);
 
+	// Checks the players.snapshot column against playerDataStorage, needs a connected database
+	bool loadSnapshotState();
+	bool isSnapshotStorage() const { return m_snapshotStorage; }
+
+	// an item with its contents in the snapshot layout, each one is prefixed with its size
+	static void serializeItem(PropWriteStream& stream, const Item* item);
+	// false on a broken stream; true with a null item when an unknown type was skipped
+	static bool unserializeItem(PropStream& stream, Item*& item);
+
+	// Writes the relational tables of a player kept in a snapshot, does nothing with relational storage
+	bool exportPlayer(Player* player);
+
+	// times are in microseconds
+	PlayerStorageStatistics getStorageStatistics() const;
+
 	bool playerStatement(Player* _player, uint16_t channelId, const std::string& text, uint32_t& statementId);
 	bool playerDeath(Player* _player, const DeathList& dl);
 	bool playerMail(Creature* actor, std::string name, uint32_t townId, Item* item);
@@ -139,6 +183,31 @@ private:
 	bool saveItems(const Player* player, const ItemBlockList& itemList, DBInsert& query_insert);
 	void loadItems(ItemMap& itemMap, DBResultPtr result);
 
-	void loadCharacters(Account& account);
+	void loadRelational(Player* player, const Vocation* vocation, PlayerLoadData& data);
+	bool saveRelational(Player* player, bool shallow);
+	bool saveGuildInvites(Player* player);
+	bool saveVIPList(Player* player);
+
+	// bump on any layout change, older snapshots must stay readable
+	static constexpr uint16_t PLAYER_SNAPSHOT_VERSION = 2;
+
+	void serializePlayer(Player* player, PropWriteStream& stream);
+	bool unserializePlayer(Player* player, const Vocation* vocation, PropStream& stream);
+	static bool unserializeItemData(PropStream& stream, Item*& item);
+
+	bool m_snapshotColumn = false;
+	bool m_snapshotStorage = false;
+
+	std::atomic<uint64_t> m_loads{ 0 }, m_loadTime{ 0 };
+	std::atomic<uint64_t> m_saves{ 0 }, m_saveTime{ 0 };
+
+	struct PrefetchState
+	{
+		uint32_t pending = 0, version = 0;
+	};
+	// players with a prefetch in flight by lower case name, the version counts their saves
+	std::unordered_map<std::string, PrefetchState> m_prefetches;
+
+	void loadCharacters(Account& account, Database& database);
 	bool storeNameByGuid(uint32_t guid);
 };
@@ -26,6 +26,8 @@
 
 #include "otx/util.hpp"
 
+#include <future>
+
 bool IOMapSerialize::loadMap(Map* map)
 {
 	std::string config = otx::util::as_lower_string(otx::config::getString(otx::config::HOUSE_STORAGE));
@@ -422,57 +424,7 @@ bool IOMapSerialize::saveMapRelational(Map*)
 
 bool IOMapSerialize::loadMapBinary(Map* map)
 {
-	DBResultPtr result = g_database.storeQuery("SELECT `house_id`, `data` FROM `house_data`");
-	if (!result) {
-		return false;
-	}
-
-	House* house = nullptr;
-	do {
-		int32_t houseId = result->getNumber<int32_t>("house_id");
-		house = Houses::getInstance()->getHouse(houseId);
-
-		unsigned long attrSize = 0;
-		const char* attr = result->getStream("data", attrSize);
-
-		PropStream propStream;
-		propStream.init(attr, attrSize);
-		while (propStream.size()) {
-			uint16_t x = 0, y = 0;
-			uint8_t z = 0;
-
-			propStream.getShort(x);
-			propStream.getShort(y);
-			propStream.getByte(z);
-
-			uint32_t itemCount = 0;
-			propStream.getLong(itemCount);
-
-			Position pos(x, y, z);
-			if (house && house->hasPendingTransfer()) {
-				if (Player* player = g_game.getPlayerByGuidEx(house->getOwner())) {
-					Depot* depot = player->getDepot(player->getTown(), true);
-					while (itemCount--) {
-						loadItem(propStream, depot, true);
-					}
-
-					if (player->isVirtual()) {
-						IOLoginData::getInstance()->savePlayer(player);
-						delete player;
-					}
-				}
-			} else if (Tile* tile = map->getTile(pos)) {
-				while (itemCount--) {
-					loadItem(propStream, tile, false);
-				}
-			} else {
-				std::clog << "[Error - IOMapSerialize::loadMapBinary] Unserialization of invalid tile"
-						  << " at position " << pos << std::endl;
-				break;
-			}
-		}
-	} while (result->next());
-	return true;
+	return loadHouseData(map, "house_data");
 }
 
 bool IOMapSerialize::saveMapBinary(Map*)
@@ -503,59 +455,347 @@ bool IOMapSerialize::saveMapBinary(Map*)
 
 bool IOMapSerialize::loadMapBinaryTileBased(Map* map)
 {
-	DBResultPtr result = g_database.storeQuery("SELECT `house_id`, `data` FROM `tile_store`");
+	return loadHouseData(map, "tile_store");
+}
+
+bool IOMapSerialize::loadHouseData(Map* map, const std::string& table)
+{
+	const int64_t start = otx::util::mstime();
+
+	// the rows are streamed, so they need a connection nothing else talks on meanwhile
+	Database database;
+	const bool streaming = database.connect();
+
+	std::ostringstream query;
+	query << "SELECT `house_id`, `data` FROM `" << table << "`";
+
+	// a read error must stop the startup, the next save would delete whatever was not loaded
+	bool failed = false;
+	DBResultPtr result = streaming ? database.useQuery(query.str(), failed) : g_database.storeQuery(query.str(), failed);
 	if (!result) {
-		return false;
+		if (failed) {
+			std::clog << "[Error - IOMapSerialize::loadHouseData] Cannot read `" << table << "`." << std::endl;
+		}
+		return !failed;
 	}
 
-	House* house = nullptr;
+	size_t threads = otx::config::getInteger(otx::config::LOAD_THREADS);
+	if (threads == 0) {
+		threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+	}
+
+	const bool verify = otx::config::getBoolean(otx::config::HOUSE_DATA_VERIFY);
+	const size_t houseColumn = result->getColumnIndex("house_id"), dataColumn = result->getColumnIndex("data");
+
+	HouseDataStatistics stats;
+	stats.threads = threads;
+
+	// rows are decoded on the pool while the next ones are fetched, and attached in the order they were read
+	std::unique_ptr<boost::asio::thread_pool> pool;
+	if (threads > 1) {
+		pool = std::make_unique<boost::asio::thread_pool>(threads);
+	}
+
+	std::deque<std::pair<std::unique_ptr<HouseDataRow>, std::future<void>>> pending;
+	auto attachFront = [&]() {
+		auto& front = pending.front();
+		const int64_t waitStart = otx::util::mstime();
+		front.second.wait();
+		stats.waited += otx::util::mstime() - waitStart;
+
+		attachHouseData(map, *front.first, verify, stats);
+		pending.pop_front();
+	};
+
 	do {
-		int32_t houseId = result->getNumber<int32_t>("house_id");
-		house = Houses::getInstance()->getHouse(houseId);
+		auto row = std::make_unique<HouseDataRow>();
+		row->houseId = result->getNumber<int32_t>(houseColumn);
+
+		unsigned long size = 0;
+		const char* data = result->getStream(dataColumn, size);
+		row->data.assign(data, size);
+		stats.bytes += size;
+
+		HouseDataRow* rowPtr = row.get();
+		auto task = std::make_shared<std::packaged_task<void()>>([rowPtr]() { decodeHouseData(*rowPtr); });
+		std::future<void> future = task->get_future();
+		if (pool) {
+			boost::asio::post(*pool, [task]() { (*task)(); });
+		} else {
+			(*task)();
+		}
 
-		unsigned long attrSize = 0;
-		const char* attr = result->getStream("data", attrSize);
+		pending.emplace_back(std::move(row), std::move(future));
+		if (pending.size() > threads * 4) {
+			attachFront();
+		}
+	} while (result->next());
 
-		PropStream propStream;
-		propStream.init(attr, attrSize);
-		while (propStream.size()) {
-			uint16_t x = 0, y = 0;
-			uint8_t z = 0;
-
-			propStream.getShort(x);
-			propStream.getShort(y);
-			propStream.getByte(z);
-
-			uint32_t itemCount = 0;
-			propStream.getLong(itemCount);
-
-			Position pos(x, y, z);
-			if (house && house->hasPendingTransfer()) {
-				if (Player* player = g_game.getPlayerByGuidEx(house->getOwner())) {
-					Depot* depot = player->getDepot(player->getTown(), true);
-					while (itemCount--) {
-						loadItem(propStream, depot, true);
-					}
+	// release the streamed result before the connection goes away
+	failed = result->hasFailed();
+	result.reset();
+	while (!pending.empty()) {
+		attachFront();
+	}
 
-					if (player->isVirtual()) {
-						IOLoginData::getInstance()->savePlayer(player);
-						delete player;
-					}
-				}
-			} else if (Tile* tile = map->getTile(pos)) {
+	if (pool) {
+		pool->join();
+	}
+
+	if (failed) {
+		std::clog << "[Error - IOMapSerialize::loadHouseData] Reading `" << table << "` stopped after " << stats.rows << " rows." << std::endl;
+		return false;
+	}
+
+	std::clog << ">>> House data: " << stats.rows << " rows (" << stats.decoded << " decoded on " << stats.threads << " threads, "
+			  << (stats.rows - stats.decoded) << " loaded serially), " << stats.tiles << " tiles, " << stats.items << " items, "
+			  << (stats.bytes / 1024) << " KB, " << (otx::util::mstime() - start) << " ms (" << stats.waited << " ms waiting for decoders)";
+	if (!streaming) {
+		std::clog << ", buffered";
+	}
+
+	std::clog << "." << std::endl;
+	if (verify) {
+		std::clog << ">>> House data verification: " << stats.mismatches << " of " << stats.verified << " tiles differ after loading." << std::endl;
+	}
+	return true;
+}
+
+void IOMapSerialize::attachHouseData(Map* map, HouseDataRow& row, bool verify, HouseDataStatistics& stats)
+{
+	++stats.rows;
+
+	House* house = Houses::getInstance()->getHouse(row.houseId);
+	if (!row.decoded || (house && house->hasPendingTransfer())) {
+		row.release();
+		loadHouseRow(map, house, row.data.data(), row.data.size());
+		return;
+	}
+
+	++stats.decoded;
+	for (size_t i = 0; i < row.tiles.size(); ++i) {
+		HouseDataTile& tileData = row.tiles[i];
+		Tile* tile = map->getTile(tileData.pos);
+		if (!tile) {
+			std::clog << "[Error - IOMapSerialize::loadMapBinary] Unserialization of invalid tile"
+					  << " at position " << tileData.pos << std::endl;
+			break;
+		}
+
+		++stats.tiles;
+		for (HouseDataItem& entry : tileData.items) {
+			++stats.items;
+			if (Item* item = entry.item) {
+				entry.item = nullptr;
+				registerUniqueIds(item);
+				tile->__internalAddThing(item);
+				item->__startDecaying();
+			} else {
+				// stationary items are matched against the map, that has to happen here
+				PropStream propStream;
+				propStream.init(row.data.data() + entry.offset, entry.size);
+				loadItem(propStream, tile, false);
+			}
+		}
+
+		if (verify) {
+			++stats.verified;
+
+			PropWriteStream stream;
+			saveTile(stream, tile);
+
+			uint32_t size = 0;
+			const char* data = stream.getStream(size);
+			if (size != tileData.size || std::memcmp(data, row.data.data() + tileData.offset, size) != 0) {
+				++stats.mismatches;
+				std::clog << "[Warning - IOMapSerialize::loadMapBinary] House " << row.houseId << " tile at position " << tileData.pos
+						  << " does not match its saved data after loading." << std::endl;
+			}
+		}
+	}
+
+	row.release();
+}
+
+bool IOMapSerialize::loadHouseRow(Map* map, House* house, const char* data, uint32_t size)
+{
+	PropStream propStream;
+	propStream.init(data, size);
+	while (propStream.size()) {
+		uint16_t x = 0, y = 0;
+		uint8_t z = 0;
+
+		propStream.getShort(x);
+		propStream.getShort(y);
+		propStream.getByte(z);
+
+		uint32_t itemCount = 0;
+		propStream.getLong(itemCount);
+
+		Position pos(x, y, z);
+		if (house && house->hasPendingTransfer()) {
+			if (Player* player = g_game.getPlayerByGuidEx(house->getOwner())) {
+				Depot* depot = player->getDepot(player->getTown(), true);
 				while (itemCount--) {
-					loadItem(propStream, tile, false);
+					loadItem(propStream, depot, true);
 				}
-			} else {
-				std::clog << "[Error - IOMapSerialize::loadMapBinary] Unserialization of invalid tile"
-						  << " at position " << pos << std::endl;
+
+				if (player->isVirtual()) {
+					IOLoginData::getInstance()->savePlayer(player);
+					delete player;
+				}
+			}
+		} else if (Tile* tile = map->getTile(pos)) {
+			while (itemCount--) {
+				loadItem(propStream, tile, false);
+			}
+		} else {
+			std::clog << "[Error - IOMapSerialize::loadMapBinary] Unserialization of invalid tile"
+					  << " at position " << pos << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+void IOMapSerialize::HouseDataRow::release()
+{
+	for (HouseDataTile& tile : tiles) {
+		for (HouseDataItem& entry : tile.items) {
+			delete entry.item;
+		}
+	}
+	tiles.clear();
+}
+
+void IOMapSerialize::decodeHouseData(HouseDataRow& row)
+{
+	const uint32_t total = row.data.size();
+
+	PropStream propStream;
+	propStream.init(row.data.data(), total);
+
+	Item::loadingDetached = true;
+
+	bool success = true;
+	while (success && propStream.size()) {
+		HouseDataTile tile;
+		tile.offset = total - propStream.size();
+
+		uint16_t x = 0, y = 0;
+		uint8_t z = 0;
+
+		propStream.getShort(x);
+		propStream.getShort(y);
+		propStream.getByte(z);
+		tile.pos = Position(x, y, z);
+
+		uint32_t itemCount = 0;
+		propStream.getLong(itemCount);
+		while (itemCount--) {
+			HouseDataItem entry;
+			if (!decodeItem(propStream, entry, total)) {
+				success = false;
 				break;
 			}
+
+			if (entry.item || entry.size) {
+				tile.items.push_back(entry);
+			}
 		}
-	} while (result->next());
+
+		tile.size = (total - propStream.size()) - tile.offset;
+		row.tiles.push_back(std::move(tile));
+	}
+
+	Item::loadingDetached = false;
+
+	// anything unusual is left to the serial loader, which reports it the way it always has
+	row.decoded = success;
+	if (!success) {
+		row.release();
+	}
+}
+
+bool IOMapSerialize::decodeItem(PropStream& propStream, HouseDataItem& entry, uint32_t total)
+{
+	const uint32_t offset = total - propStream.size();
+
+	uint16_t id = 0;
+	propStream.getShort(id);
+
+	const ItemType& iType = Item::items[id];
+	Item* item = Item::CreateItem(id);
+	if (!item) {
+		// loadItem only consumes the id of an unknown movable item, a stationary one may still match the tile
+		return iType.movable || iType.forceSerialize;
+	}
+
+	bool success = item->unserializeAttr(propStream);
+	if (success) {
+		if (Container* container = item->getContainer()) {
+			success = decodeContainer(propStream, container);
+		}
+	}
+
+	if (success && (iType.movable || iType.forceSerialize)) {
+		entry.item = item;
+		return true;
+	}
+
+	// stationary items were only read to find where their data ends
+	delete item;
+	if (!success) {
+		return false;
+	}
+
+	entry.offset = offset;
+	entry.size = (total - propStream.size()) - offset;
 	return true;
 }
 
+bool IOMapSerialize::decodeContainer(PropStream& propStream, Container* container)
+{
+	while (container->serializationCount > 0) {
+		uint16_t id = 0;
+		propStream.getShort(id);
+		if (Item* item = Item::CreateItem(id)) {
+			bool success = item->unserializeAttr(propStream);
+			if (success) {
+				if (Container* subContainer = item->getContainer()) {
+					success = decodeContainer(propStream, subContainer);
+				}
+			}
+
+			if (!success) {
+				delete item;
+				return false;
+			}
+
+			container->__internalAddThing(item);
+		}
+
+		container->serializationCount--;
+	}
+
+	uint8_t endAttr = ATTR_END;
+	propStream.getByte(endAttr);
+	return endAttr == ATTR_END;
+}
+
+void IOMapSerialize::registerUniqueIds(Item* item)
+{
+	if (int32_t uid = item->getUniqueId()) {
+		g_game.addUniqueItem(uid, item);
+	}
+
+	if (Container* container = item->getContainer()) {
+		for (Item* containerItem : container->getItemList()) {
+			registerUniqueIds(containerItem);
+		}
+	}
+}
+
 bool IOMapSerialize::saveMapBinaryTileBased(Map*)
 {
 	// Start the transaction
@@ -641,17 +881,21 @@ bool IOMapSerialize::loadItems(DBResultPtr result, Cylinder* parent, bool depotT
 		tile = parent->getTile();
 	}
 
+	const size_t sidColumn = result->getColumnIndex("sid"), pidColumn = result->getColumnIndex("pid"),
+				 typeColumn = result->getColumnIndex("itemtype"), countColumn = result->getColumnIndex("count"),
+				 attributesColumn = result->getColumnIndex("attributes");
+
 	Item* item = nullptr;
 	int32_t sid, pid, id, count;
 	do {
-		sid = result->getNumber<int32_t>("sid");
-		pid = result->getNumber<int32_t>("pid");
-		id = result->getNumber<int32_t>("itemtype");
-		count = result->getNumber<int32_t>("count");
+		sid = result->getNumber<int32_t>(sidColumn);
+		pid = result->getNumber<int32_t>(pidColumn);
+		id = result->getNumber<int32_t>(typeColumn);
+		count = result->getNumber<int32_t>(countColumn);
 
 		item = nullptr;
 		unsigned long attrSize = 0;
-		const char* attr = result->getStream("attributes", attrSize);
+		const char* attr = result->getStream(attributesColumn, attrSize);
 
 		PropStream propStream;
 		propStream.init(attr, attrSize);
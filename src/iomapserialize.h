@@ -50,6 +50,42 @@ public:
 private:
 	IOMapSerialize() {}
 
+	// an item of a decoded tile, either a detached tree or the span of a stationary item to replay
+	struct HouseDataItem
+	{
+		Item* item = nullptr;
+		uint32_t offset = 0;
+		uint32_t size = 0;
+	};
+
+	struct HouseDataTile
+	{
+		Position pos;
+		uint32_t offset = 0;
+		uint32_t size = 0;
+		std::vector<HouseDataItem> items;
+	};
+
+	struct HouseDataRow
+	{
+		~HouseDataRow() { release(); }
+		void release();
+
+		int32_t houseId = 0;
+		std::string data;
+		std::vector<HouseDataTile> tiles;
+		bool decoded = false;
+	};
+
+	struct HouseDataStatistics
+	{
+		size_t threads = 0;
+		uint32_t rows = 0, decoded = 0, tiles = 0, items = 0;
+		uint32_t verified = 0, mismatches = 0;
+		uint64_t bytes = 0;
+		int64_t waited = 0;
+	};
+
 	// Relational storage uses a row for each item/tile
 	bool loadMapRelational(Map* map);
 	bool saveMapRelational(Map* map);
@@ -65,6 +101,16 @@ private:
 	bool saveMapBinaryTileBased(Map* map);
 	bool saveHouseBinaryTileBased(DBInsert& stmt, House* house);
 
+	// Both binary layouts are streamed, decoded on loader threads and attached here in row order
+	bool loadHouseData(Map* map, const std::string& table);
+	void attachHouseData(Map* map, HouseDataRow& row, bool verify, HouseDataStatistics& stats);
+	bool loadHouseRow(Map* map, House* house, const char* data, uint32_t size);
+	void registerUniqueIds(Item* item);
+
+	static void decodeHouseData(HouseDataRow& row);
+	static bool decodeItem(PropStream& propStream, HouseDataItem& entry, uint32_t total);
+	static bool decodeContainer(PropStream& propStream, Container* container);
+
 	bool loadItems(DBResultPtr result, Cylinder* parent, bool depotTransfer);
 	bool saveItems(uint32_t& tileId, uint32_t houseId, const Tile* tile);
 
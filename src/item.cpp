@@ -36,6 +36,7 @@
 #include "otx/util.hpp"
 
 Items Item::items;
+thread_local bool Item::loadingDetached = false;
 
 Item* Item::CreateItem(const uint16_t type, uint16_t amount /* = 0*/)
 {
@@ -526,7 +527,7 @@ Attr_ReadValue Item::readAttr(AttrTypes_t attr, PropStream& propStream)
 			}
 
 			ItemAttributes* itemAttr = getAttribute("uid");
-			if (!unique && itemAttr && itemAttr->isInt()) {
+			if (!unique && itemAttr && itemAttr->isInt() && !loadingDetached) {
 				// unfortunately we have to do this
 				g_game.addUniqueItem(itemAttr->getInt(), this);
 			}
@@ -569,7 +570,7 @@ Attr_ReadValue Item::readAttr(AttrTypes_t attr, PropStream& propStream)
 			}
 
 			ItemAttributes* itemAttr = getAttribute("uid");
-			if (!unique && itemAttr && itemAttr->isInt()) {
+			if (!unique && itemAttr && itemAttr->isInt() && !loadingDetached) {
 				// unfortunately we have to do this
 				g_game.addUniqueItem(itemAttr->getInt(), this);
 			}
@@ -1592,6 +1593,11 @@ void Item::setUniqueId(int32_t uid)
 		return;
 	}
 
+	if (loadingDetached) {
+		setIntAttr("uid", uid);
+		return;
+	}
+
 	if (g_game.addUniqueItem(uid, this)) {
 		setIntAttr("uid", uid);
 	}
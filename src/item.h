@@ -18,6 +18,7 @@
 #pragma once
 
 #include "fileloader.h"
+#include "lockfree.h"
 #include "items.h"
 #include "raids.h"
 #include "thing.h"
@@ -299,7 +300,14 @@ public:
 	Item(const Item& i) : Thing(), m_id(i.m_id), m_count(i.m_count) {}
 	virtual ~Item() {}
 
+	using Pool = ObjectPool<Item, 32768>;
+	static void* operator new(size_t size) { return Pool::allocate(size); }
+	static void operator delete(void* p, size_t size) { Pool::deallocate(p, size); }
+
 	static Items items;
+	// set on loader threads building item trees that are attached to the map later,
+	// unique ids and bed sleepers are not registered with the game while it is
+	static thread_local bool loadingDetached;
 
 	// Factory member to create item of right type based on type
 	static Item* CreateItem(const uint16_t type, uint16_t amount = 0);
@@ -0,0 +1,790 @@
+////////////////////////////////////////////////////////////////////////
+// OpenTibia - an opensource roleplaying game
+////////////////////////////////////////////////////////////////////////
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+////////////////////////////////////////////////////////////////////////
+
+#include "../otpch.h"
+
+#include "botclient.h"
+
+namespace
+{
+	// 2 bytes message length, 4 bytes checksum, the payload starts after them
+	constexpr size_t FRAME_HEADER_LENGTH = NetworkMessage::HEADER_LENGTH + NetworkMessage::CHECKSUM_LENGTH;
+	constexpr size_t RSA_BUFFER_LENGTH = 128;
+
+	constexpr auto PING_INTERVAL = std::chrono::seconds(5);
+	constexpr auto PROBE_INTERVAL = std::chrono::seconds(2);
+	constexpr auto PROBE_TIMEOUT = std::chrono::seconds(5);
+	// a logout the server did not answer by closing, in combat for instance, is asked for again after this
+	constexpr auto LOGOUT_TIMEOUT = std::chrono::seconds(10);
+	// how long after an item was added next to the bot losing its target still makes that item the corpse
+	constexpr auto CORPSE_TIMEOUT = std::chrono::seconds(1);
+
+	constexpr size_t MAX_MONSTERS = 8;
+	// the container id corpses are opened with, the backpack the use action opens gets 0
+	constexpr uint8_t LOOT_CONTAINER = 1;
+
+	// monster ids count up from Monster::monsterAutoID, the npc ids of Npc::npcAutoID start past them
+	constexpr uint32_t MONSTER_ID_FIRST = 0x40000000, MONSTER_ID_LAST = 0x7FFFFFFF;
+
+	// adlerChecksum is in tools.cpp, which needs the whole server
+	uint32_t checksum(const uint8_t* data, size_t length)
+	{
+		uint32_t a = 1, b = 0;
+		while (length > 0) {
+			size_t tmp = std::min<size_t>(length, 5552);
+			length -= tmp;
+			do {
+				a += *data++;
+				b += a;
+			} while (--tmp);
+			a %= 65521;
+			b %= 65521;
+		}
+		return (b << 16) | a;
+	}
+
+	void addString(NetworkMessage& msg, const std::string& value)
+	{
+		msg.add<uint16_t>(value.size());
+		for (char c : value) {
+			msg.addByte(c);
+		}
+	}
+
+	// NetworkMessage::getString is in networkmessage.cpp, next to the item code
+	std::string getString(NetworkMessage& msg)
+	{
+		const uint16_t length = msg.get<uint16_t>();
+		if (length > msg.getRemainingBufferLength()) {
+			return std::string();
+		}
+
+		std::string result(reinterpret_cast<const char*>(msg.getRemainingBuffer()), length);
+		msg.skipBytes(length);
+		return result;
+	}
+
+	void addPosition(NetworkMessage& msg, uint16_t x, uint16_t y, uint8_t z)
+	{
+		msg.add<uint16_t>(x);
+		msg.add<uint16_t>(y);
+		msg.addByte(z);
+	}
+
+	void readPosition(const uint8_t* data, uint16_t& x, uint16_t& y, uint8_t& z)
+	{
+		std::memcpy(&x, data, sizeof(x));
+		std::memcpy(&y, data + 2, sizeof(y));
+		z = data[4];
+	}
+
+} // namespace
+
+BotClient::BotClient(boost::asio::io_context& io, LoadContext& context, uint32_t number) :
+	m_socket(io),
+	m_timer(io),
+	m_context(context),
+	m_generator(std::random_device{}()),
+	m_number(number)
+{
+	//
+}
+
+void BotClient::start(uint32_t delay)
+{
+	m_timer.expires_after(std::chrono::milliseconds(delay));
+	m_timer.async_wait([thisPtr = shared_from_this()](const boost::system::error_code& error) {
+		if (!error && thisPtr->m_context.running) {
+			thisPtr->connect();
+		}
+	});
+}
+
+void BotClient::connect()
+{
+	m_state = BOTSTATE_CONNECTING;
+	m_stopping = m_loggingOut = false;
+	m_socket.async_connect(m_context.endpoint, [thisPtr = shared_from_this(), session = m_session](const boost::system::error_code& error) {
+		if (thisPtr->m_session != session) {
+			return;
+		} else if (error) {
+			++thisPtr->m_context.stats.loginFailures;
+			thisPtr->close(true);
+			return;
+		}
+
+		boost::system::error_code ignored;
+		thisPtr->m_socket.set_option(boost::asio::ip::tcp::no_delay(true), ignored);
+		thisPtr->readHeader();
+	});
+}
+
+void BotClient::stop()
+{
+	m_stopping = true;
+	if (m_state == BOTSTATE_ONLINE) {
+		NetworkMessage msg;
+		msg.addByte(0x14);
+		send(msg);
+		return;
+	}
+
+	close(false);
+}
+
+void BotClient::readHeader()
+{
+	m_msg.reset();
+	boost::asio::async_read(m_socket, boost::asio::buffer(m_msg.getBuffer(), NetworkMessage::HEADER_LENGTH),
+		[thisPtr = shared_from_this(), session = m_session](const boost::system::error_code& error, size_t) {
+		if (thisPtr->m_session != session) {
+			return;
+		} else if (error) {
+			thisPtr->close(!thisPtr->m_stopping);
+			return;
+		}
+
+		const uint16_t size = thisPtr->m_msg.getLengthHeader();
+		if (size < NetworkMessage::CHECKSUM_LENGTH + NetworkMessage::HEADER_LENGTH || size >= NETWORKMESSAGE_MAXSIZE - 16) {
+			thisPtr->close(true);
+			return;
+		}
+
+		thisPtr->readBody(size);
+	});
+}
+
+void BotClient::readBody(uint16_t size)
+{
+	boost::asio::async_read(m_socket, boost::asio::buffer(m_msg.getBuffer() + NetworkMessage::HEADER_LENGTH, size),
+		[thisPtr = shared_from_this(), session = m_session, size](const boost::system::error_code& error, size_t) {
+		if (thisPtr->m_session != session) {
+			return;
+		} else if (error) {
+			thisPtr->close(!thisPtr->m_stopping);
+			return;
+		}
+
+		LoadStats& stats = thisPtr->m_context.stats;
+		stats.bytesReceived += size + NetworkMessage::HEADER_LENGTH;
+		++stats.packetsReceived;
+
+		// everything but the challenge is encrypted, the inner length sits where
+		// the server writes it, right before the payload
+		uint8_t* buffer = thisPtr->m_msg.getBuffer();
+		const size_t encrypted = size - NetworkMessage::CHECKSUM_LENGTH;
+		if (thisPtr->m_state != BOTSTATE_CONNECTING) {
+			if ((encrypted % NetworkMessage::XTEA_MULTIPLE) != 0) {
+				thisPtr->close(true);
+				return;
+			}
+
+			otx::xtea::decrypt(buffer + FRAME_HEADER_LENGTH, encrypted, thisPtr->m_key);
+		}
+
+		uint16_t length;
+		std::memcpy(&length, buffer + FRAME_HEADER_LENGTH, sizeof(length));
+		if (static_cast<size_t>(length) + NetworkMessage::HEADER_LENGTH > encrypted) {
+			thisPtr->close(true);
+			return;
+		}
+
+		thisPtr->m_msg.setLength(length);
+		thisPtr->onMessage(thisPtr->m_msg);
+		if (thisPtr->m_session == session) {
+			thisPtr->readHeader();
+		}
+	});
+}
+
+void BotClient::onMessage(NetworkMessage& msg)
+{
+	switch (m_state) {
+		case BOTSTATE_CONNECTING: {
+			if (msg.getByte() != 0x1F) {
+				close(true);
+				return;
+			}
+
+			const uint32_t timestamp = msg.get<uint32_t>();
+			sendLogin(timestamp, msg.getByte());
+			break;
+		}
+
+		case BOTSTATE_LOGGING_IN:
+			onLogin(msg);
+			break;
+
+		case BOTSTATE_ONLINE:
+			checkProbe(msg);
+			trackPosition(msg);
+			trackLoot(msg);
+			break;
+
+		default:
+			break;
+	}
+}
+
+void BotClient::sendLogin(uint32_t timestamp, uint8_t random)
+{
+	const Scenario& scenario = m_context.scenario;
+
+	otx::xtea::key key;
+	for (uint32_t& value : key) {
+		value = m_generator();
+	}
+
+	// same block the server reads in ProtocolGame::onRecvFirstMessage
+	NetworkMessage block;
+	block.addByte(0x00);
+	for (uint32_t value : key) {
+		block.add<uint32_t>(value);
+	}
+
+	block.addByte(0x00); // gamemaster
+	addString(block, scenario.getAccount(m_number));
+	addString(block, scenario.getCharacter(m_number));
+	addString(block, scenario.password);
+	block.add<uint32_t>(timestamp);
+	block.addByte(random);
+	while (block.getLength() < RSA_BUFFER_LENGTH) {
+		block.addByte(m_generator());
+	}
+
+	char* rsaBuffer = reinterpret_cast<char*>(block.getBuffer()) + NetworkMessage::INITIAL_BUFFER_POSITION;
+	m_context.rsa.encrypt(rsaBuffer);
+
+	// the first message has no inner length, the payload starts right after the checksum
+	std::array<uint8_t, FRAME_HEADER_LENGTH + 5 + RSA_BUFFER_LENGTH> buffer;
+	uint8_t* payload = buffer.data() + FRAME_HEADER_LENGTH;
+	payload[0] = 0x0A; // game protocol
+	const uint16_t operatingSystem = CLIENTOS_WINDOWS;
+	std::memcpy(payload + 1, &operatingSystem, sizeof(operatingSystem));
+	std::memcpy(payload + 3, &m_context.version, sizeof(m_context.version));
+	std::memcpy(payload + 5, rsaBuffer, RSA_BUFFER_LENGTH);
+
+	const uint32_t value = checksum(payload, buffer.size() - FRAME_HEADER_LENGTH);
+	const uint16_t size = buffer.size() - NetworkMessage::HEADER_LENGTH;
+	std::memcpy(buffer.data(), &size, sizeof(size));
+	std::memcpy(buffer.data() + NetworkMessage::HEADER_LENGTH, &value, sizeof(value));
+
+	m_key = otx::xtea::expand_key(std::move(key));
+	m_state = BOTSTATE_LOGGING_IN;
+	write(buffer.data(), buffer.size());
+}
+
+void BotClient::onLogin(NetworkMessage& msg)
+{
+	switch (msg.getByte()) {
+		case 0x0A: {
+			m_creatureId = msg.get<uint32_t>();
+			msg.skipBytes(3); // beat, can report bugs
+			if (msg.getByte() == 0x0B) {
+				msg.skipBytes(20); // violation flags
+			} else {
+				msg.skipBytes(-1);
+			}
+
+			if (msg.getByte() == 0x64) {
+				m_x = msg.get<uint16_t>();
+				m_y = msg.get<uint16_t>();
+				m_z = msg.getByte();
+			}
+
+			m_state = BOTSTATE_ONLINE;
+			m_loginTime = m_lastPing = m_probeSent = std::chrono::steady_clock::now();
+			m_context.creatures[m_number] = m_creatureId;
+
+			++m_context.stats.logins;
+			++m_context.stats.online;
+			if (m_stopping) {
+				stop();
+			} else {
+				scheduleThink();
+			}
+			break;
+		}
+
+		case 0x14: {
+			const std::string error = getString(msg);
+			if (m_context.stats.loginFailures++ < 10) {
+				std::clog << "[Warning - BotClient::onLogin] " << m_context.scenario.getCharacter(m_number) << ": " << error << std::endl;
+			}
+
+			close(true);
+			break;
+		}
+
+		case 0x16: {
+			getString(msg);
+			const uint32_t retry = msg.getByte();
+			close(true, std::max<uint32_t>(retry, 1) * 1000);
+			break;
+		}
+
+		default:
+			// anything the server sends before placing the player
+			break;
+	}
+}
+
+void BotClient::checkProbe(NetworkMessage& msg)
+{
+	if (!m_probing) {
+		return;
+	}
+
+	// the turn of this bot, as sent by ProtocolGame::sendCreatureTurn
+	uint8_t pattern[7] = { 0x63, 0x00 };
+	std::memcpy(pattern + 2, &m_creatureId, sizeof(m_creatureId));
+	pattern[6] = m_probeDirection;
+
+	const uint8_t* begin = msg.getBuffer() + NetworkMessage::INITIAL_BUFFER_POSITION;
+	const uint8_t* end = begin + msg.getLength();
+	if (std::search(begin, end, std::begin(pattern), std::end(pattern)) == end) {
+		return;
+	}
+
+	m_probing = false;
+	m_context.stats.addProbe(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_probeSent).count());
+}
+
+void BotClient::trackPosition(NetworkMessage& msg)
+{
+	// the moves of this bot, as sent by ProtocolGame::sendMoveCreature; the bytes are matched
+	// against the tile the bot stands on, nothing else of the message is parsed
+	const uint8_t* begin = msg.getBuffer() + NetworkMessage::INITIAL_BUFFER_POSITION;
+	const uint8_t* end = begin + msg.getLength();
+	if (msg.getLength() >= 6 && begin[0] == 0x64) {
+		readPosition(begin + 1, m_x, m_y, m_z);
+	}
+
+	uint16_t x, y;
+	uint8_t z;
+	for (const uint8_t* p = begin; end - p >= 13; ++p) {
+		if (p[0] != 0x6C && p[0] != 0x6D) {
+			continue;
+		}
+
+		readPosition(p + 1, x, y, z);
+		if (x != m_x || y != m_y || z != m_z) {
+			continue;
+		}
+
+		if (p[0] == 0x6C) {
+			// a teleport removes the bot from its tile and describes the map around the new one
+			if (p[7] == 0x64) {
+				readPosition(p + 8, m_x, m_y, m_z);
+			}
+			continue;
+		}
+
+		// a step: the map slice or floor change after it tells the bot apart from others on its tile
+		readPosition(p + 7, x, y, z);
+		if (std::abs(x - m_x) + std::abs(y - m_y) == 1 && std::abs(z - m_z) <= 1 && ((p[12] >= 0x65 && p[12] <= 0x68) || p[12] == 0xBE || p[12] == 0xBF)) {
+			m_x = x;
+			m_y = y;
+			m_z = z;
+		}
+	}
+}
+
+void BotClient::trackLoot(NetworkMessage& msg)
+{
+	// the kills of this bot and what it finds on them, matched like its moves: monsters by the creature
+	// ids ProtocolGame::AddCreature sends, the corpse as the last item added next to the bot before the
+	// attacked monster was lost, its contents by the container ProtocolGame::sendContainer opens
+	const uint8_t* begin = msg.getBuffer() + NetworkMessage::INITIAL_BUFFER_POSITION;
+	const uint8_t* end = begin + msg.getLength();
+	const auto now = std::chrono::steady_clock::now();
+
+	uint32_t id;
+	for (const uint8_t* p = begin; p < end; ++p) {
+		switch (p[0]) {
+			case 0x61:
+			case 0x62: {
+				// an unknown creature has the id it replaces before its own
+				const ptrdiff_t offset = p[0] == 0x61 ? 6 : 2;
+				if (end - p < offset + 4 || p[1] != 0x00) {
+					break;
+				}
+
+				std::memcpy(&id, p + offset, sizeof(id));
+				if (id < MONSTER_ID_FIRST || id > MONSTER_ID_LAST || std::find(m_monsters.begin(), m_monsters.end(), id) != m_monsters.end()) {
+					break;
+				}
+
+				if (m_monsters.size() >= MAX_MONSTERS) {
+					m_monsters.erase(m_monsters.begin());
+				}
+
+				m_monsters.push_back(id);
+				break;
+			}
+
+			case 0x6A: {
+				// position, stack position and the client id of the item
+				if (end - p < 9 || p[6] >= 10) {
+					break;
+				}
+
+				TileItem item;
+				readPosition(p + 1, item.x, item.y, item.z);
+				std::memcpy(&item.clientId, p + 7, sizeof(item.clientId));
+				if (item.z == m_z && std::abs(item.x - m_x) <= 8 && std::abs(item.y - m_y) <= 6 && item.clientId != 0) {
+					item.time = now;
+					m_lastTileItem = item;
+				}
+				break;
+			}
+
+			case 0xA3: {
+				// the attacked monster is gone, its corpse was added to its tile right before
+				if (!m_target || end - p < 5 || std::any_of(p + 1, p + 5, [](uint8_t byte) { return byte != 0; })) {
+					break;
+				}
+
+				if (m_lastTileItem.clientId != 0 && now - m_lastTileItem.time <= CORPSE_TIMEOUT) {
+					m_corpse = m_lastTileItem;
+					m_lootItem = 0;
+				}
+
+				m_monsters.erase(std::remove(m_monsters.begin(), m_monsters.end(), m_target), m_monsters.end());
+				m_target = 0;
+				break;
+			}
+
+			case 0x6E: {
+				// container id, client id and name, then capacity, whether it has a parent and the item count
+				if (end - p < 6 || p[1] != LOOT_CONTAINER) {
+					break;
+				}
+
+				uint16_t length;
+				std::memcpy(&length, p + 4, sizeof(length));
+
+				const uint8_t* next = p + 6 + length;
+				if (length > 64 || end - next < 3 || next[1] > 1 || next[2] > next[0]) {
+					break;
+				}
+
+				if (next[2] == 0) {
+					// nothing left to take
+					m_corpse.clientId = m_lootItem = 0;
+				} else if (end - next >= 5) {
+					std::memcpy(&m_lootItem, next + 3, sizeof(m_lootItem));
+				}
+				break;
+			}
+
+			default:
+				break;
+		}
+	}
+}
+
+void BotClient::send(NetworkMessage& msg)
+{
+	// same layout Protocol::onRecvMessage expects: length, checksum,
+	// then inner length, payload and padding encrypted together
+	uint8_t* buffer = msg.getBuffer();
+	const uint16_t length = msg.getLength();
+	std::memcpy(buffer + FRAME_HEADER_LENGTH, &length, sizeof(length));
+
+	size_t encrypted = length + NetworkMessage::HEADER_LENGTH;
+	if (const size_t padding = encrypted % NetworkMessage::XTEA_MULTIPLE) {
+		std::memset(buffer + FRAME_HEADER_LENGTH + encrypted, 0x33, NetworkMessage::XTEA_MULTIPLE - padding);
+		encrypted += NetworkMessage::XTEA_MULTIPLE - padding;
+	}
+
+	otx::xtea::encrypt(buffer + FRAME_HEADER_LENGTH, encrypted, m_key);
+
+	const uint32_t value = checksum(buffer + FRAME_HEADER_LENGTH, encrypted);
+	const uint16_t size = encrypted + NetworkMessage::CHECKSUM_LENGTH;
+	std::memcpy(buffer, &size, sizeof(size));
+	std::memcpy(buffer + NetworkMessage::HEADER_LENGTH, &value, sizeof(value));
+	write(buffer, encrypted + FRAME_HEADER_LENGTH);
+}
+
+void BotClient::write(const uint8_t* data, size_t size)
+{
+	m_context.stats.bytesSent += size;
+	++m_context.stats.packetsSent;
+
+	m_writes.emplace_back(data, data + size);
+	if (m_writes.size() == 1) {
+		writeNext();
+	}
+}
+
+void BotClient::writeNext()
+{
+	boost::asio::async_write(m_socket, boost::asio::buffer(m_writes.front()),
+		[thisPtr = shared_from_this(), session = m_session](const boost::system::error_code& error, size_t) {
+		if (thisPtr->m_session != session) {
+			return;
+		} else if (error) {
+			thisPtr->close(!thisPtr->m_stopping);
+			return;
+		}
+
+		thisPtr->m_writes.pop_front();
+		if (!thisPtr->m_writes.empty()) {
+			thisPtr->writeNext();
+		} else if (thisPtr->m_stopping && thisPtr->m_state == BOTSTATE_ONLINE) {
+			thisPtr->close(false);
+		}
+	});
+}
+
+void BotClient::scheduleThink()
+{
+	const Scenario& scenario = m_context.scenario;
+	const uint32_t delay = std::uniform_int_distribution<uint32_t>(scenario.thinkMin, scenario.thinkMax)(m_generator);
+
+	m_timer.expires_after(std::chrono::milliseconds(delay));
+	m_timer.async_wait([thisPtr = shared_from_this()](const boost::system::error_code& error) {
+		if (!error) {
+			thisPtr->think();
+		}
+	});
+}
+
+void BotClient::think()
+{
+	if (m_state != BOTSTATE_ONLINE || m_stopping) {
+		return;
+	}
+
+	const Scenario& scenario = m_context.scenario;
+	const auto now = std::chrono::steady_clock::now();
+	if (m_loggingOut && now - m_logoutSent >= LOGOUT_TIMEOUT) {
+		m_loggingOut = false;
+	}
+
+	if (!m_loggingOut && scenario.relogin != 0 && now - m_loginTime >= std::chrono::milliseconds(scenario.relogin)) {
+		NetworkMessage msg;
+		msg.addByte(0x14);
+		send(msg);
+
+		// the server closes the connection, which brings the bot back; it keeps playing until then
+		m_loggingOut = true;
+		m_logoutSent = now;
+	}
+
+	if (now - m_lastPing >= PING_INTERVAL) {
+		// answers the server pings as well, so idle bots are not kicked
+		NetworkMessage msg;
+		msg.addByte(0x1E);
+		send(msg);
+		m_lastPing = now;
+	}
+
+	if (m_probing && now - m_probeSent >= PROBE_TIMEOUT) {
+		++m_context.stats.probesLost;
+		m_probing = false;
+	}
+
+	if (!m_probing && now - m_probeSent >= PROBE_INTERVAL) {
+		probe();
+	} else if (m_number == 0 && m_setupSent < scenario.setup.size()) {
+		NetworkMessage msg;
+		msg.addByte(0x96);
+		msg.addByte(1); // MSG_SPEAK_SAY
+		addString(msg, scenario.setup[m_setupSent++]);
+		send(msg);
+	} else if (const BotAction* action = scenario.randomAction(m_generator)) {
+		act(*action);
+	}
+
+	scheduleThink();
+}
+
+void BotClient::act(const BotAction& action)
+{
+	NetworkMessage msg;
+	switch (action.type) {
+		case BOTACTION_WALK:
+			m_direction = std::uniform_int_distribution<uint16_t>(NORTH, WEST)(m_generator);
+			msg.addByte(0x65 + m_direction);
+			break;
+
+		case BOTACTION_SAY:
+			msg.addByte(0x96);
+			msg.addByte(action.speak);
+			addString(msg, action.text);
+			break;
+
+		case BOTACTION_ATTACK:
+		case BOTACTION_FOLLOW: {
+			const bool monster = action.type == BOTACTION_ATTACK && action.monsters;
+			const uint32_t target = monster ? randomMonster() : randomPeer();
+			if (target == 0) {
+				return;
+			}
+
+			m_target = monster ? target : 0;
+			msg.addByte(action.type == BOTACTION_ATTACK ? 0xA1 : 0xA2);
+			msg.add<uint32_t>(target);
+			break;
+		}
+
+		case BOTACTION_LOOK:
+			msg.addByte(0x8C);
+			addPosition(msg, m_x, m_y, m_z);
+			msg.add<uint16_t>(0);
+			msg.addByte(0);
+			break;
+
+		case BOTACTION_USE:
+			msg.addByte(0x82);
+			addPosition(msg, 0xFFFF, action.slot, 0);
+			msg.add<uint16_t>(0);
+			msg.addByte(0);
+			msg.addByte(0);
+			break;
+
+		case BOTACTION_CHANNELS:
+			msg.addByte(0x97);
+			break;
+
+		case BOTACTION_LOOT: {
+			if (m_lootItem == 0) {
+				if (m_corpse.clientId == 0) {
+					return;
+				}
+
+				// the server walks the bot to the corpse first when it is not next to it
+				msg.addByte(0x82);
+				addPosition(msg, m_corpse.x, m_corpse.y, m_corpse.z);
+				msg.add<uint16_t>(m_corpse.clientId);
+				msg.addByte(0);
+				msg.addByte(LOOT_CONTAINER);
+				break;
+			}
+
+			// the first item into the backpack
+			msg.addByte(0x78);
+			addPosition(msg, 0xFFFF, 0x40 | LOOT_CONTAINER, 0);
+			msg.add<uint16_t>(m_lootItem);
+			msg.addByte(0);
+			addPosition(msg, 0xFFFF, SLOT_BACKPACK, 0);
+			msg.addByte(1);
+			send(msg);
+
+			// closed again, using an open corpse would close it; the next loot opens it with what is left
+			NetworkMessage closeMsg;
+			closeMsg.addByte(0x87);
+			closeMsg.addByte(LOOT_CONTAINER);
+			send(closeMsg);
+
+			m_lootItem = 0;
+			return;
+		}
+
+		default:
+			return;
+	}
+
+	send(msg);
+}
+
+void BotClient::probe()
+{
+	// a turn the server has to execute and send back, so never the way the bot faces already
+	do {
+		m_probeDirection = std::uniform_int_distribution<uint16_t>(NORTH, WEST)(m_generator);
+	} while (m_probeDirection == m_direction);
+
+	NetworkMessage msg;
+	msg.addByte(0x6F + m_probeDirection);
+	send(msg);
+
+	m_direction = m_probeDirection;
+	m_probeSent = std::chrono::steady_clock::now();
+	m_probing = true;
+}
+
+void BotClient::close(bool reconnect, uint32_t delay /* = 5000*/)
+{
+	if (m_state == BOTSTATE_DISCONNECTED) {
+		return;
+	}
+
+	if (m_state == BOTSTATE_ONLINE) {
+		--m_context.stats.online;
+		m_context.creatures[m_number] = 0;
+		if (m_loggingOut) {
+			// a planned logout, back in as fast as the scenario logs bots in
+			reconnect = true;
+			delay = m_context.scenario.loginInterval;
+		} else if (!m_stopping) {
+			++m_context.stats.disconnects;
+		}
+	}
+
+	boost::system::error_code ignored;
+	m_socket.shutdown(boost::asio::ip::tcp::socket::shutdown_both, ignored);
+	m_socket.close(ignored);
+	m_timer.cancel();
+
+	// handlers of this connection that are already queued see it is gone
+	++m_session;
+	m_state = BOTSTATE_DISCONNECTED;
+	m_writes.clear();
+	m_probing = false;
+
+	// creature ids and the containers opened do not outlive the session
+	m_monsters.clear();
+	m_target = m_lootItem = 0;
+	m_lastTileItem = m_corpse = TileItem();
+
+	if (!reconnect || !m_context.running) {
+		return;
+	}
+
+	start(delay);
+}
+
+uint32_t BotClient::randomPeer()
+{
+	const uint32_t bots = m_context.scenario.bots;
+	if (bots < 2) {
+		return 0;
+	}
+
+	// a few tries, early in the run most bots are not online yet
+	for (int32_t i = 0; i < 4; ++i) {
+		const uint32_t peer = std::uniform_int_distribution<uint32_t>(0, bots - 1)(m_generator);
+		if (peer != m_number) {
+			if (const uint32_t creatureId = m_context.creatures[peer]) {
+				return creatureId;
+			}
+		}
+	}
+	return 0;
+}
+
+uint32_t BotClient::randomMonster()
+{
+	if (m_monsters.empty()) {
+		return 0;
+	}
+
+	return m_monsters[std::uniform_int_distribution<size_t>(0, m_monsters.size() - 1)(m_generator)];
+}
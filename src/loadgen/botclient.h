@@ -0,0 +1,153 @@
+////////////////////////////////////////////////////////////////////////
+// OpenTibia - an opensource roleplaying game
+////////////////////////////////////////////////////////////////////////
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "../networkmessage.h"
+#include "../rsa.h"
+#include "../xtea.h"
+
+#include "scenario.h"
+
+// Counters of the whole run, updated by every bot
+struct LoadStats
+{
+	std::atomic<uint64_t> bytesSent{ 0 }, bytesReceived{ 0 };
+	std::atomic<uint64_t> packetsSent{ 0 }, packetsReceived{ 0 };
+	std::atomic<uint32_t> online{ 0 }, logins{ 0 }, loginFailures{ 0 }, disconnects{ 0 };
+	std::atomic<uint32_t> probesLost{ 0 };
+
+	void addProbe(uint32_t microseconds) {
+		std::lock_guard<std::mutex> lockClass(probeLock);
+		probes.push_back(microseconds);
+	}
+
+	// the probes since the last call
+	std::vector<uint32_t> takeProbes() {
+		std::lock_guard<std::mutex> lockClass(probeLock);
+		std::vector<uint32_t> result;
+		result.swap(probes);
+		return result;
+	}
+
+private:
+	std::mutex probeLock;
+	std::vector<uint32_t> probes;
+};
+
+// Everything the bots of a run share
+struct LoadContext
+{
+	explicit LoadContext(const Scenario& scenario) :
+		scenario(scenario),
+		creatures(std::make_unique<std::atomic<uint32_t>[]>(scenario.bots)) {}
+
+	const Scenario& scenario;
+	boost::asio::ip::tcp::endpoint endpoint;
+	uint16_t version = CLIENT_VERSION_MAX;
+
+	RSA rsa;
+	LoadStats stats;
+
+	// creature id of every bot that is online, zero otherwise; what attack and follow pick from
+	std::unique_ptr<std::atomic<uint32_t>[]> creatures;
+	std::atomic<bool> running{ true };
+};
+
+// A scripted client speaking the game protocol, every bot lives on a single
+// io_context thread so none of its members are locked
+class BotClient final : public std::enable_shared_from_this<BotClient>
+{
+public:
+	BotClient(boost::asio::io_context& io, LoadContext& context, uint32_t number);
+
+	// non-copyable
+	BotClient(const BotClient&) = delete;
+	BotClient& operator=(const BotClient&) = delete;
+
+	// connects after delay milliseconds
+	void start(uint32_t delay);
+	void connect();
+	// logs out, the socket is closed once everything queued was written
+	void stop();
+
+private:
+	enum BotState_t : uint8_t
+	{
+		BOTSTATE_DISCONNECTED,
+		BOTSTATE_CONNECTING, // waiting for the challenge
+		BOTSTATE_LOGGING_IN, // waiting for the player to be placed
+		BOTSTATE_ONLINE,
+	};
+
+	void readHeader();
+	void readBody(uint16_t size);
+	void onMessage(NetworkMessage& msg);
+
+	void sendLogin(uint32_t timestamp, uint8_t random);
+	void onLogin(NetworkMessage& msg);
+	void checkProbe(NetworkMessage& msg);
+	void trackPosition(NetworkMessage& msg);
+	void trackLoot(NetworkMessage& msg);
+
+	void send(NetworkMessage& msg);
+	void write(const uint8_t* data, size_t size);
+	void writeNext();
+
+	void scheduleThink();
+	void think();
+	void act(const BotAction& action);
+	void probe();
+
+	// reconnect tells whether to log in again after the delay, while the run lasts
+	void close(bool reconnect, uint32_t delay = 5000);
+
+	uint32_t randomPeer();
+	uint32_t randomMonster();
+
+	boost::asio::ip::tcp::socket m_socket;
+	boost::asio::steady_timer m_timer;
+	LoadContext& m_context;
+
+	NetworkMessage m_msg;
+	std::deque<std::vector<uint8_t>> m_writes;
+	otx::xtea::round_keys m_key;
+	std::mt19937 m_generator;
+
+	std::chrono::steady_clock::time_point m_loginTime, m_lastPing, m_probeSent, m_logoutSent;
+	uint32_t m_number, m_creatureId = 0, m_session = 0;
+	uint32_t m_setupSent = 0; // of the scenario setup, kept over relogins
+	uint16_t m_x = 0, m_y = 0; // where the bot stands, what look targets
+	uint8_t m_z = 0;
+
+	// an item the bot saw added to a tile near it
+	struct TileItem
+	{
+		uint16_t x = 0, y = 0, clientId = 0; // no item while the client id is zero
+		uint8_t z = 0;
+		std::chrono::steady_clock::time_point time;
+	};
+
+	std::vector<uint32_t> m_monsters; // last seen around the bot, what attack target="monster" picks from
+	uint32_t m_target = 0; // the monster attacked
+	TileItem m_lastTileItem, m_corpse; // the corpse of the last kill, until it is empty
+	uint16_t m_lootItem = 0; // client id of the first item in the opened corpse
+
+	BotState_t m_state = BOTSTATE_DISCONNECTED;
+	uint8_t m_direction = 0, m_probeDirection = 0;
+	bool m_probing = false, m_stopping = false, m_loggingOut = false;
+};
@@ -0,0 +1,253 @@
+////////////////////////////////////////////////////////////////////////
+// OpenTibia - an opensource roleplaying game
+////////////////////////////////////////////////////////////////////////
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+////////////////////////////////////////////////////////////////////////
+
+#include "../otpch.h"
+
+#include "botclient.h"
+
+#include <fstream>
+#include <iomanip>
+#include <numeric>
+#include <thread>
+
+namespace
+{
+	struct Options
+	{
+		std::string scenario, host = "127.0.0.1", report, rsaKey;
+		uint16_t port = 7172, version = CLIENT_VERSION_MAX;
+		uint32_t bots = 0, duration = 0, threads = 1, interval = 5;
+	};
+
+	bool parseArguments(int argc, char* argv[], Options& options)
+	{
+		for (int i = 1; i < argc; ++i) {
+			const std::string argument = argv[i];
+			if (argument == "--help") {
+				return false;
+			}
+
+			const std::string::size_type separator = argument.find('=');
+			if (separator == std::string::npos) {
+				std::clog << "Unknown argument " << argument << "." << std::endl;
+				return false;
+			}
+
+			const std::string key = argument.substr(0, separator), value = argument.substr(separator + 1);
+			if (key == "--scenario") {
+				options.scenario = value;
+			} else if (key == "--host") {
+				options.host = value;
+			} else if (key == "--port") {
+				options.port = static_cast<uint16_t>(std::stoul(value));
+			} else if (key == "--version") {
+				options.version = static_cast<uint16_t>(std::stoul(value));
+			} else if (key == "--bots") {
+				options.bots = std::stoul(value);
+			} else if (key == "--duration") {
+				options.duration = std::stoul(value);
+			} else if (key == "--threads") {
+				options.threads = std::max<uint32_t>(1, std::stoul(value));
+			} else if (key == "--interval") {
+				options.interval = std::max<uint32_t>(1, std::stoul(value));
+			} else if (key == "--report") {
+				options.report = value;
+			} else if (key == "--rsa-key") {
+				options.rsaKey = value;
+			} else {
+				std::clog << "Unknown argument " << key << "." << std::endl;
+				return false;
+			}
+		}
+		return !options.scenario.empty();
+	}
+
+	struct ProbeSummary
+	{
+		uint32_t count = 0, average = 0, median = 0, high = 0, highest = 0;
+	};
+
+	// microseconds in, milliseconds are what the report shows
+	ProbeSummary summarize(std::vector<uint32_t>& probes)
+	{
+		ProbeSummary summary;
+		if (probes.empty()) {
+			return summary;
+		}
+
+		std::sort(probes.begin(), probes.end());
+		summary.count = probes.size();
+		summary.average = std::accumulate(probes.begin(), probes.end(), uint64_t(0)) / probes.size();
+		summary.median = probes[probes.size() / 2];
+		summary.high = probes[probes.size() * 95 / 100];
+		summary.highest = probes.back();
+		return summary;
+	}
+
+	std::string asMilliseconds(uint32_t microseconds)
+	{
+		std::ostringstream ss;
+		ss << std::fixed << std::setprecision(1) << microseconds / 1000.;
+		return ss.str();
+	}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+	Options options;
+	if (!parseArguments(argc, argv, options)) {
+		std::clog << "Usage: otx_loadgen --scenario=$1 [options]\n"
+					 "\n"
+					 "\t--scenario=$1\t\tScenario file to run.\n"
+					 "\t--host=$1\t\tServer to connect to, 127.0.0.1 by default.\n"
+					 "\t--port=$1\t\tGame port, 7172 by default.\n"
+					 "\t--version=$1\t\tClient version the bots announce.\n"
+					 "\t--bots=$1\t\tOverrides the number of bots of the scenario.\n"
+					 "\t--duration=$1\t\tOverrides the duration of the scenario, in seconds.\n"
+					 "\t--threads=$1\t\tNetwork threads the bots are spread over.\n"
+					 "\t--interval=$1\t\tSeconds between two lines of the report.\n"
+					 "\t--report=$1\t\tAlso writes every report line to this CSV file.\n"
+					 "\t--rsa-key=$1\t\tKey file of the server, when it is not the OpenTibia key.\n";
+		return EXIT_FAILURE;
+	}
+
+	Scenario scenario;
+	if (!scenario.load(options.scenario)) {
+		return EXIT_FAILURE;
+	}
+
+	if (options.bots != 0) {
+		scenario.bots = options.bots;
+	}
+
+	if (options.duration != 0) {
+		scenario.duration = options.duration;
+	}
+
+	LoadContext context(scenario);
+	context.version = options.version;
+	if (options.rsaKey.empty()) {
+		context.rsa.initialize(RSA_OTSERV_P, RSA_OTSERV_Q, RSA_OTSERV_D);
+	} else if (!context.rsa.initialize(options.rsaKey)) {
+		std::clog << "Cannot load the RSA key " << options.rsaKey << "." << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	boost::system::error_code error;
+	const auto address = boost::asio::ip::make_address(options.host, error);
+	if (error) {
+		std::clog << "Invalid host " << options.host << ": " << error.message() << std::endl;
+		return EXIT_FAILURE;
+	}
+	context.endpoint = boost::asio::ip::tcp::endpoint(address, options.port);
+
+	std::ofstream report;
+	if (!options.report.empty()) {
+		report.open(options.report, std::ios::trunc);
+		report << std::fixed << std::setprecision(2);
+		report << "seconds,online,kb_in,kb_out,packets_in,packets_out,probes,probe_avg_ms,probe_median_ms,probe_95_ms,probe_max_ms,probes_lost\n";
+	}
+
+	// one io_context per thread, a bot never leaves the thread it was created on
+	std::vector<std::unique_ptr<boost::asio::io_context>> contexts;
+	std::vector<boost::asio::executor_work_guard<boost::asio::io_context::executor_type>> guards;
+	std::vector<std::thread> threads;
+	for (uint32_t i = 0; i < options.threads; ++i) {
+		contexts.push_back(std::make_unique<boost::asio::io_context>());
+		guards.push_back(boost::asio::make_work_guard(*contexts.back()));
+	}
+
+	for (auto& io : contexts) {
+		threads.emplace_back([&io]() { io->run(); });
+	}
+
+	std::clog << ">> Running " << scenario.name << ": " << scenario.bots << " bots for " << scenario.duration << " seconds against "
+			  << context.endpoint << "." << std::endl;
+
+	// logins are spread like the scenario says, the first one starts the clock
+	std::vector<std::shared_ptr<BotClient>> bots;
+	bots.reserve(scenario.bots);
+	for (uint32_t i = 0; i < scenario.bots; ++i) {
+		boost::asio::io_context& io = *contexts[i % contexts.size()];
+		bots.push_back(std::make_shared<BotClient>(io, context, i));
+		boost::asio::post(io, [bot = bots.back(), delay = i * scenario.loginInterval]() { bot->start(delay); });
+	}
+
+	const LoadStats& stats = context.stats;
+	std::vector<uint32_t> allProbes;
+
+	uint64_t lastIn = 0, lastOut = 0, lastPacketsIn = 0, lastPacketsOut = 0;
+	const auto start = std::chrono::steady_clock::now(), end = start + std::chrono::seconds(scenario.duration);
+	for (auto next = start + std::chrono::seconds(options.interval); next <= end; next += std::chrono::seconds(options.interval)) {
+		std::this_thread::sleep_until(next);
+
+		const uint64_t in = stats.bytesReceived, out = stats.bytesSent, packetsIn = stats.packetsReceived, packetsOut = stats.packetsSent;
+		std::vector<uint32_t> probes = context.stats.takeProbes();
+		allProbes.insert(allProbes.end(), probes.begin(), probes.end());
+
+		const ProbeSummary summary = summarize(probes);
+		const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(next - start).count();
+		const double kbIn = (in - lastIn) / 1024. / options.interval, kbOut = (out - lastOut) / 1024. / options.interval;
+
+		std::clog << std::fixed << std::setprecision(1) << "[" << seconds << "s] online " << stats.online << ", in " << kbIn << " kB/s, out "
+				  << kbOut << " kB/s, response " << asMilliseconds(summary.median) << " ms median, " << asMilliseconds(summary.high)
+				  << " ms 95th, " << asMilliseconds(summary.highest) << " ms max" << std::endl;
+		if (report.is_open()) {
+			report << seconds << "," << stats.online << "," << kbIn << "," << kbOut << "," << (packetsIn - lastPacketsIn) / options.interval
+				   << "," << (packetsOut - lastPacketsOut) / options.interval << "," << summary.count << "," << asMilliseconds(summary.average)
+				   << "," << asMilliseconds(summary.median) << "," << asMilliseconds(summary.high) << "," << asMilliseconds(summary.highest)
+				   << "," << stats.probesLost << "\n";
+		}
+
+		lastIn = in;
+		lastOut = out;
+		lastPacketsIn = packetsIn;
+		lastPacketsOut = packetsOut;
+	}
+
+	// logs every bot out, whatever was not written after a moment is dropped
+	context.running = false;
+	for (uint32_t i = 0; i < bots.size(); ++i) {
+		boost::asio::post(*contexts[i % contexts.size()], [bot = bots[i]]() { bot->stop(); });
+	}
+
+	std::this_thread::sleep_for(std::chrono::seconds(2));
+	for (auto& io : contexts) {
+		io->stop();
+	}
+
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+
+	std::vector<uint32_t> lastProbes = context.stats.takeProbes();
+	allProbes.insert(allProbes.end(), lastProbes.begin(), lastProbes.end());
+
+	const ProbeSummary summary = summarize(allProbes);
+	const double seconds = std::max<uint32_t>(scenario.duration, 1), perBot = scenario.bots;
+	std::clog << std::fixed << std::setprecision(1) << "\n>> " << scenario.name << " finished\n"
+			  << "Logins: " << stats.logins << ", failed " << stats.loginFailures << ", dropped by the server " << stats.disconnects << "\n"
+			  << "Received: " << stats.bytesReceived / 1024. / seconds << " kB/s, " << stats.bytesReceived / perBot / seconds << " B/s and "
+			  << stats.packetsReceived / perBot / seconds << " packets/s per bot\n"
+			  << "Sent: " << stats.bytesSent / 1024. / seconds << " kB/s, " << stats.bytesSent / perBot / seconds << " B/s and "
+			  << stats.packetsSent / perBot / seconds << " packets/s per bot\n"
+			  << "Response time (" << summary.count << " probes, " << stats.probesLost << " lost): " << asMilliseconds(summary.average)
+			  << " ms average, " << asMilliseconds(summary.median) << " ms median, " << asMilliseconds(summary.high) << " ms 95th, "
+			  << asMilliseconds(summary.highest) << " ms max" << std::endl;
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,183 @@
+////////////////////////////////////////////////////////////////////////
+// OpenTibia - an opensource roleplaying game
+////////////////////////////////////////////////////////////////////////
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+////////////////////////////////////////////////////////////////////////
+
+#include "../otpch.h"
+
+#include "scenario.h"
+
+namespace
+{
+	// readXMLString and friends live in tools.cpp, which needs the whole server
+	bool readString(xmlNodePtr node, const char* tag, std::string& value)
+	{
+		auto nodeValue = reinterpret_cast<char*>(xmlGetProp(node, reinterpret_cast<const xmlChar*>(tag)));
+		if (!nodeValue) {
+			return false;
+		}
+
+		value = nodeValue;
+		xmlFree(nodeValue);
+		return true;
+	}
+
+	bool readInteger(xmlNodePtr node, const char* tag, uint32_t& value)
+	{
+		std::string strValue;
+		if (!readString(node, tag, strValue)) {
+			return false;
+		}
+
+		value = static_cast<uint32_t>(std::strtoul(strValue.c_str(), nullptr, 10));
+		return true;
+	}
+
+	const std::map<std::string, BotAction_t> actionNames = {
+		{ "walk", BOTACTION_WALK },
+		{ "say", BOTACTION_SAY },
+		{ "attack", BOTACTION_ATTACK },
+		{ "follow", BOTACTION_FOLLOW },
+		{ "look", BOTACTION_LOOK },
+		{ "use", BOTACTION_USE },
+		{ "channels", BOTACTION_CHANNELS },
+		{ "loot", BOTACTION_LOOT },
+	};
+
+} // namespace
+
+bool Scenario::load(const std::string& file)
+{
+	xmlDocPtr doc = xmlParseFile(file.c_str());
+	if (!doc) {
+		std::clog << "[Error - Scenario::load] Cannot load " << file << "." << std::endl;
+		return false;
+	}
+
+	xmlNodePtr root = xmlDocGetRootElement(doc);
+	if (xmlStrcmp(root->name, reinterpret_cast<const xmlChar*>("scenario"))) {
+		std::clog << "[Error - Scenario::load] Malformed scenario file " << file << "." << std::endl;
+		xmlFreeDoc(doc);
+		return false;
+	}
+
+	if (!readString(root, "name", name)) {
+		name = std::filesystem::path(file).stem().string();
+	}
+
+	readInteger(root, "bots", bots);
+	readInteger(root, "duration", duration);
+	readInteger(root, "loginInterval", loginInterval);
+	readInteger(root, "relogin", relogin);
+
+	std::string strValue;
+	for (xmlNodePtr p = root->children; p; p = p->next) {
+		if (!xmlStrcmp(p->name, reinterpret_cast<const xmlChar*>("accounts"))) {
+			readString(p, "name", account);
+			readString(p, "password", password);
+			readString(p, "character", character);
+			readInteger(p, "first", first);
+		} else if (!xmlStrcmp(p->name, reinterpret_cast<const xmlChar*>("think"))) {
+			readInteger(p, "min", thinkMin);
+			readInteger(p, "max", thinkMax);
+		} else if (!xmlStrcmp(p->name, reinterpret_cast<const xmlChar*>("setup"))) {
+			if (!readString(p, "text", strValue)) {
+				std::clog << "[Warning - Scenario::load] Missing setup text in " << file << "." << std::endl;
+				continue;
+			}
+
+			uint32_t repeat = 1, forEachBot = 0;
+			readInteger(p, "repeat", repeat);
+			readInteger(p, "forEachBot", forEachBot);
+			for (uint32_t i = 0; i < repeat; ++i) {
+				if (!forEachBot) {
+					setup.push_back(strValue);
+					continue;
+				}
+
+				// once for every other bot, %d is its number; the first bot is the one saying it
+				for (uint32_t bot = 1; bot < bots; ++bot) {
+					setup.push_back(formatName(strValue, bot));
+				}
+			}
+		} else if (!xmlStrcmp(p->name, reinterpret_cast<const xmlChar*>("action"))) {
+			if (!readString(p, "type", strValue)) {
+				std::clog << "[Warning - Scenario::load] Missing action type in " << file << "." << std::endl;
+				continue;
+			}
+
+			auto it = actionNames.find(strValue);
+			if (it == actionNames.end()) {
+				std::clog << "[Warning - Scenario::load] Unknown action type " << strValue << " in " << file << "." << std::endl;
+				continue;
+			}
+
+			BotAction action;
+			action.type = it->second;
+			readInteger(p, "weight", action.weight);
+			readString(p, "text", action.text);
+
+			uint32_t intValue;
+			if (readInteger(p, "speak", intValue)) {
+				action.speak = static_cast<uint8_t>(intValue);
+			}
+
+			if (readInteger(p, "slot", intValue)) {
+				action.slot = static_cast<uint8_t>(intValue);
+			}
+
+			if (readString(p, "target", strValue)) {
+				action.monsters = strValue == "monster";
+			}
+
+			if (action.weight > 0) {
+				totalWeight += action.weight;
+				actions.push_back(std::move(action));
+			}
+		}
+	}
+
+	xmlFreeDoc(doc);
+	bots = std::max<uint32_t>(bots, 1);
+	thinkMin = std::max<uint32_t>(thinkMin, 50);
+	thinkMax = std::max(thinkMax, thinkMin);
+	return true;
+}
+
+const BotAction* Scenario::randomAction(std::mt19937& generator) const
+{
+	if (totalWeight == 0) {
+		return nullptr;
+	}
+
+	uint32_t roll = std::uniform_int_distribution<uint32_t>(0, totalWeight - 1)(generator);
+	for (const BotAction& action : actions) {
+		if (roll < action.weight) {
+			return &action;
+		}
+		roll -= action.weight;
+	}
+	return nullptr;
+}
+
+std::string Scenario::formatName(const std::string& pattern, uint32_t bot) const
+{
+	std::string result = pattern;
+	std::string::size_type pos = result.find("%d");
+	if (pos != std::string::npos) {
+		result.replace(pos, 2, std::to_string(first + bot));
+	}
+	return result;
+}
@@ -0,0 +1,81 @@
+////////////////////////////////////////////////////////////////////////
+// OpenTibia - an opensource roleplaying game
+////////////////////////////////////////////////////////////////////////
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "../const.h"
+
+enum BotAction_t : uint8_t
+{
+	BOTACTION_WALK, // a random step
+	BOTACTION_SAY, // text
+	BOTACTION_ATTACK, // another bot of the run, or a monster seen around the bot
+	BOTACTION_FOLLOW, // another bot of the run
+	BOTACTION_LOOK, // the tile the bot logged in at
+	BOTACTION_USE, // the item in an inventory slot
+	BOTACTION_CHANNELS, // requests the channel list
+	BOTACTION_LOOT, // opens the corpse of a monster the bot killed and takes an item
+};
+
+struct BotAction
+{
+	BotAction_t type = BOTACTION_WALK;
+	uint32_t weight = 1;
+
+	std::string text;
+	uint8_t speak = 1; // MSG_SPEAK_SAY
+	uint8_t slot = 3; // SLOT_BACKPACK
+	bool monsters = false; // attack target="monster"
+};
+
+// A load test described by an XML file: who the bots are, how fast they come
+// in and what they keep doing while they are online
+struct Scenario
+{
+	std::string name;
+
+	uint32_t bots = 1;
+	uint32_t duration = 60; // seconds, from the first login
+	uint32_t loginInterval = 50; // milliseconds between two bots connecting
+	uint32_t relogin = 0; // milliseconds online before logging out and back in, 0 stays
+
+	// %d is replaced by the bot number, counting from first
+	std::string account = "bot%d", password = "bot", character = "Bot %d";
+	uint32_t first = 1;
+
+	// milliseconds between two actions of a bot
+	uint32_t thinkMin = 500, thinkMax = 1000;
+
+	std::vector<BotAction> actions;
+	uint32_t totalWeight = 0;
+
+	// said once by the first bot after it logged in, one per think, before it starts acting;
+	// how a run fills its area with monsters, that bot needs the access for the commands;
+	// forEachBot repeats a text for every other bot, after the accounts are known
+	std::vector<std::string> setup;
+
+	bool load(const std::string& file);
+
+	// a random action by weight, null when the bots only stand around
+	const BotAction* randomAction(std::mt19937& generator) const;
+
+	std::string getAccount(uint32_t bot) const { return formatName(account, bot); }
+	std::string getCharacter(uint32_t bot) const { return formatName(character, bot); }
+
+private:
+	std::string formatName(const std::string& pattern, uint32_t bot) const;
+};
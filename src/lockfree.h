@@ -22,6 +22,9 @@
 #endif
 
 #include <boost/lockfree/stack.hpp>
+
+#include <atomic>
+
 /*
   * we use this to avoid instantiating multiple free lists for objects of the
   * same size and it can be replaced by a variable template in C++14
@@ -74,3 +77,68 @@ public:
 		}
 	}
 };
+
+struct ObjectPoolStatistics
+{
+	std::atomic<uint64_t> allocations{0}, reused{0}, releases{0}, pooled{0};
+};
+
+/*
+  * per-type slab used through class-level operator new/delete; released
+  * objects are kept on a bounded free list of their own so churn on one type
+  * (loot, decaying items, respawns) recycles the same memory instead of
+  * fragmenting the heap. Derived types without their own pool have a
+  * different size and go straight to the global allocator.
+*/
+template <typename T, size_t Capacity>
+class ObjectPool
+{
+public:
+	static void* allocate(size_t size) {
+		if (size != sizeof(T)) {
+			return ::operator new(size);
+		}
+
+		ObjectPoolStatistics& stats = getStatistics();
+		++stats.allocations;
+
+		void* p;
+		if (getFreeList().pop(p)) {
+			++stats.reused;
+			--stats.pooled;
+			return p;
+		}
+		return ::operator new(size);
+	}
+
+	static void deallocate(void* p, size_t size) {
+		if (!p) {
+			return;
+		}
+
+		if (size != sizeof(T)) {
+			::operator delete(p);
+			return;
+		}
+
+		ObjectPoolStatistics& stats = getStatistics();
+		++stats.releases;
+		if (getFreeList().bounded_push(p)) {
+			++stats.pooled;
+		} else {
+			::operator delete(p);
+		}
+	}
+
+	static ObjectPoolStatistics& getStatistics() {
+		static ObjectPoolStatistics stats;
+		return stats;
+	}
+
+private:
+	using FreeList = boost::lockfree::stack<void*, boost::lockfree::capacity<Capacity>>;
+	static FreeList& getFreeList() {
+		static FreeList freeList;
+		return freeList;
+	}
+};
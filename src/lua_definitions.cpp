@@ -100,6 +100,84 @@ namespace
 		otx::lua::pushString(L, getStackTrace(L, otx::lua::popString(L)));
 		return 1;
 	}
+
+	// lightweight representation of a thing pushed to scripts,
+	// fields are resolved by the shared metatable on access
+	struct LuaThing
+	{
+		uint32_t uid;
+		uint32_t actionId;
+		uint16_t itemId;
+		uint16_t type;
+		bool overridden;
+	};
+
+	int thingMetatableRef = LUA_NOREF;
+
+	int luaThingIndex(lua_State* L)
+	{
+		auto luaThing = static_cast<LuaThing*>(lua_touserdata(L, 1));
+		if (luaThing->overridden) {
+			// fields assigned by scripts take precedence
+			lua_getfenv(L, 1);
+			lua_pushvalue(L, 2);
+			lua_rawget(L, -2);
+			if (!otx::lua::isNil(L, -1)) {
+				return 1;
+			}
+			lua_pop(L, 2);
+		}
+
+		if (!otx::lua::isString(L, 2)) {
+			lua_pushnil(L);
+			return 1;
+		}
+
+		size_t length;
+		const char* data = lua_tolstring(L, 2, &length);
+
+		const std::string_view key(data, length);
+		if (key == "uid" || key == "uniqueid") {
+			lua_pushnumber(L, luaThing->uid);
+		} else if (key == "itemid" || key == "id") {
+			lua_pushnumber(L, luaThing->itemId);
+		} else if (key == "type") {
+			lua_pushnumber(L, luaThing->type);
+		} else if (key == "actionid" || key == "aid") {
+			lua_pushnumber(L, luaThing->actionId);
+		} else {
+			lua_pushnil(L);
+		}
+		return 1;
+	}
+
+	int luaThingNewIndex(lua_State* L)
+	{
+		auto luaThing = static_cast<LuaThing*>(lua_touserdata(L, 1));
+		if (!luaThing->overridden) {
+			lua_createtable(L, 0, 1);
+			lua_setfenv(L, 1);
+			luaThing->overridden = true;
+		}
+
+		lua_getfenv(L, 1);
+		lua_pushvalue(L, 2);
+		lua_pushvalue(L, 3);
+		lua_rawset(L, -3);
+		return 0;
+	}
+
+	void registerThingMetatable(lua_State* L)
+	{
+		lua_createtable(L, 0, 3);
+		lua_pushcfunction(L, luaThingIndex);
+		lua_setfield(L, -2, "__index");
+		lua_pushcfunction(L, luaThingNewIndex);
+		lua_setfield(L, -2, "__newindex");
+		lua_pushliteral(L, "Thing");
+		lua_setfield(L, -2, "__metatable");
+		thingMetatableRef = luaL_ref(L, LUA_REGISTRYINDEX);
+	}
 } // namespace (end)
 
 void otx::lua::reportError(const char* function, std::string_view desc, lua_State* L /*= nullptr*/, bool stack_trace /*= false*/)
@@ -362,41 +440,23 @@ void otx::lua::pushThing(lua_State* L, Thing* thing,
 	uint32_t id/* = 0*/, Recursive_t recursive/* = RECURSE_NONE*/,
 	int narr/* = 0*/, int nrec/* = 0*/)
 {
-	lua_createtable(L, narr, 7 + nrec);
+	const Container* container = nullptr;
+	uint32_t actionId = 0;
+	uint16_t itemId = 0, type = 0;
 	if (thing && thing->getItem()) {
 		const Item* item = thing->getItem();
 		if (id == 0) {
 			id = getScriptEnv().addThing(thing);
 		}
 
-		setTableValue(L, "uniqueid", id);
-		setTableValue(L, "uid", id);
-		setTableValue(L, "itemid", item->getID());
-		setTableValue(L, "id", item->getID());
+		itemId = item->getID();
 		if (item->hasSubType()) {
-			setTableValue(L, "type", item->getSubType());
-		} else {
-			setTableValue(L, "type", 0);
+			type = item->getSubType();
 		}
 
-		setTableValue(L, "actionid", item->getActionId());
-		setTableValue(L, "aid", item->getActionId());
+		actionId = item->getActionId();
 		if (recursive != RECURSE_NONE) {
-			if (const Container* container = item->getContainer()) {
-				if (recursive == RECURSE_FIRST) {
-					recursive = RECURSE_NONE;
-				}
-
-				const auto& containerItems = container->getItemList();
-
-				int index = 0;
-				lua_createtable(L, containerItems.size(), 0);
-				for (Item* containerItem : containerItems) {
-					pushThing(L, containerItem, 0, recursive);
-					lua_rawseti(L, -2, ++index);
-				}
-				lua_setfield(L, -2, "items");
-			}
+			container = item->getContainer();
 		}
 	} else if (thing && thing->getCreature()) {
 		const Creature* creature = thing->getCreature();
@@ -404,33 +464,54 @@ void otx::lua::pushThing(lua_State* L, Thing* thing,
 			id = creature->getID();
 		}
 
-		setTableValue(L, "uniqueid", id);
-		setTableValue(L, "uid", id);
-		setTableValue(L, "itemid", 1);
-		setTableValue(L, "id", 1);
-		if (creature->getPlayer()) {
-			setTableValue(L, "type", 1);
+		itemId = 1;
+		if (const Player* player = creature->getPlayer()) {
+			type = 1;
+			actionId = player->getGUID();
 		} else if (creature->getMonster()) {
-			setTableValue(L, "type", 2);
+			type = 2;
 		} else {
-			setTableValue(L, "type", 3);
+			type = 3;
 		}
+	} else {
+		id = 0;
+	}
 
-		if (const Player* player = creature->getPlayer()) {
-			setTableValue(L, "actionid", player->getGUID());
-			setTableValue(L, "aid", player->getGUID());
-		} else {
-			setTableValue(L, "actionid", 0);
-			setTableValue(L, "aid", 0);
+	if (narr == 0 && nrec == 0 && !container && otx::config::getBoolean(otx::config::LUA_THING_USERDATA)) {
+		auto luaThing = static_cast<LuaThing*>(lua_newuserdata(L, sizeof(LuaThing)));
+		luaThing->uid = id;
+		luaThing->actionId = actionId;
+		luaThing->itemId = itemId;
+		luaThing->type = type;
+		luaThing->overridden = false;
+
+		lua_rawgeti(L, LUA_REGISTRYINDEX, thingMetatableRef);
+		lua_setmetatable(L, -2);
+		return;
+	}
+
+	lua_createtable(L, narr, 7 + nrec);
+	setTableValue(L, "uniqueid", id);
+	setTableValue(L, "uid", id);
+	setTableValue(L, "itemid", itemId);
+	setTableValue(L, "id", itemId);
+	setTableValue(L, "type", type);
+	setTableValue(L, "actionid", actionId);
+	setTableValue(L, "aid", actionId);
+	if (container) {
+		if (recursive == RECURSE_FIRST) {
+			recursive = RECURSE_NONE;
 		}
-	} else {
-		setTableValue(L, "uid", 0);
-		setTableValue(L, "uniqueid", 0);
-		setTableValue(L, "itemid", 0);
-		setTableValue(L, "id", 0);
-		setTableValue(L, "type", 0);
-		setTableValue(L, "actionid", 0);
-		setTableValue(L, "aid", 0);
+
+		const auto& containerItems = container->getItemList();
+
+		int index = 0;
+		lua_createtable(L, containerItems.size(), 0);
+		for (Item* containerItem : containerItems) {
+			pushThing(L, containerItem, 0, recursive);
+			lua_rawseti(L, -2, ++index);
+		}
+		lua_setfield(L, -2, "items");
 	}
 }
 
@@ -963,6 +1044,7 @@ void LuaEnvironment::init()
 
 	m_L = luaL_newstate();
 	luaL_openlibs(m_L);
+	registerThingMetatable(m_L);
 
 	m_mainInterface = std::make_unique<LuaInterface>("Main Interface");
 	m_mainInterface->initState();
@@ -1005,6 +1087,7 @@ void LuaEnvironment::terminate()
 
 	lua_close(m_L);
 	m_L = nullptr;
+	thingMetatableRef = LUA_NOREF;
 }
 
 void LuaEnvironment::addScriptInterface(LuaInterface* luaInterface)
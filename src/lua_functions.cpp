@@ -3798,9 +3798,9 @@ static int luaGetMonsterTargetList(lua_State* L)
 	lua_createtable(L, targetList.size(), 0);
 
 	int index = 0;
-	for (Creature* target : targetList) {
-		if (monster->isTarget(target)) {
-			lua_pushnumber(L, env.addThing(target));
+	for (const MonsterTarget& target : targetList) {
+		if (monster->isTarget(target.creature)) {
+			lua_pushnumber(L, env.addThing(target.creature));
 			lua_rawseti(L, -2, ++index);
 		}
 	}
@@ -7152,6 +7152,9 @@ static int luaDoGuildAddEnemy(lua_State* L)
 	war.war = warId;
 	war.type = warType;
 
+	// war.lua writes the table right after this call, read the war once the script is done
+	addDispatcherTask([warId]() { IOGuild::getInstance()->loadWar(warId); });
+
 	uint32_t count = 0;
 	for (const auto& it : g_game.getPlayers()) {
 		if (it.second->getGuildId() != guildId) {
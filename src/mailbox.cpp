@@ -49,7 +49,7 @@ ReturnValue Mailbox::canSend(const Item* item, Creature* actor) const
 				return RET_YOUAREEXHAUSTED;
 			}
 
-			player->setLastMail(otx::util::mstime());
+			player->setLastMail(otx::util::ticks());
 			player->addMailAttempt();
 		}
 	}
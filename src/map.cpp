@@ -64,7 +64,10 @@ bool Map::loadMap(const std::string& identifier)
 
 	start = otx::util::mstime();
 	IOMapSerialize::getInstance()->loadHouses();
-	IOMapSerialize::getInstance()->loadMap(this);
+	if (!IOMapSerialize::getInstance()->loadMap(this)) {
+		std::clog << "> FATAL: Could not load the house items." << std::endl;
+		return false;
+	}
 
 	std::clog << ">>> Unserialization time: " << (otx::util::mstime() - start) / (1000.) << " seconds." << std::endl;
 	return true;
@@ -264,6 +267,22 @@ bool Map::placeCreature(const Position& centerPos, Creature* creature, bool exte
 	return true;
 }
 
+bool Map::hasPlayersNear(const Position& pos, int32_t rangex, int32_t rangey) const
+{
+	const int32_t x1 = std::max<int32_t>(0, pos.x - rangex), y1 = std::max<int32_t>(0, pos.y - rangey);
+	const int32_t x2 = std::min<int32_t>(0xFFFF, pos.x + rangex), y2 = std::min<int32_t>(0xFFFF, pos.y + rangey);
+	for (int32_t ny = y1 - (y1 % FLOOR_SIZE); ny <= y2; ny += FLOOR_SIZE) {
+		for (int32_t nx = x1 - (x1 % FLOOR_SIZE); nx <= x2; nx += FLOOR_SIZE) {
+			const QTreeLeafNode* leaf = QTreeNode::getLeafStatic<const QTreeLeafNode*, const QTreeNode*>(&root, nx, ny);
+			if (leaf && !leaf->playerList.empty()) {
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
 bool Map::removeCreature(Creature* creature)
 {
 	Tile* tile = creature->getTile();
@@ -399,7 +418,9 @@ void Map::getSpectators(SpectatorVec& list, const Position& centerPos, bool mult
 		}
 	}
 
-	if (!foundCache) {
+	if (foundCache) {
+		++spectatorCacheHits;
+	} else {
 		int32_t minRangeZ;
 		int32_t maxRangeZ;
 
@@ -425,6 +446,7 @@ void Map::getSpectators(SpectatorVec& list, const Position& centerPos, bool mult
 			maxRangeZ = centerPos.z;
 		}
 
+		++spectatorScans;
 		getSpectatorsInternal(list, centerPos, minRangeX, maxRangeX, minRangeY, maxRangeY, minRangeZ, maxRangeZ, onlyPlayers);
 
 		if (cacheResult) {
@@ -437,6 +459,32 @@ void Map::getSpectators(SpectatorVec& list, const Position& centerPos, bool mult
 	}
 }
 
+void Map::invalidateSpectatorCache(const Position& pos)
+{
+	// only multifloor lists around the default viewport are cached, and those reach at most
+	// maxViewport tiles plus the floor offset away, so entries further out remain valid
+	const int32_t rangeX = maxViewportX + MAP_MAX_LAYERS, rangeY = maxViewportY + MAP_MAX_LAYERS;
+	const uint16_t minX = std::max<int32_t>(0, pos.x - rangeX), maxX = std::min<int32_t>(0xFFFF, pos.x + rangeX);
+	const uint16_t minY = std::max<int32_t>(0, pos.y - rangeY), maxY = std::min<int32_t>(0xFFFF, pos.y + rangeY);
+	for (SpectatorCache* cache : {&spectatorCache, &playersSpectatorCache}) {
+		if (cache->empty()) {
+			continue;
+		}
+
+		for (uint16_t z = 0; z < MAP_MAX_LAYERS; ++z) {
+			auto it = cache->lower_bound(Position(minX, minY, z));
+			const auto end = cache->upper_bound(Position(maxX, maxY, z));
+			while (it != end) {
+				if (it->first.x >= minX && it->first.x <= maxX) {
+					it = cache->erase(it);
+				} else {
+					++it;
+				}
+			}
+		}
+	}
+}
+
 bool Map::canThrowObjectTo(const Position& fromPos, const Position& toPos, bool checkLineOfSight /*= true*/,
 	int32_t rangex /*= Map::maxClientViewportX*/, int32_t rangey /*= Map::maxClientViewportY*/)
 {
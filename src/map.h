@@ -223,6 +223,19 @@ public:
 	bool canThrowObjectTo(const Position& fromPos, const Position& toPos, bool checkLineOfSight = true,
 		int32_t rangex = Map::maxClientViewportX, int32_t rangey = Map::maxClientViewportY);
 
+	/**
+	 * Checks if any player stands in the quadtree leaves around a position
+	 * Notice: Leaves span every floor, so this may report players that a spectator query would skip.
+	 *	\param pos Center point
+	 *	\param rangex maximum range horizontially
+	 *	\param rangey maximum range vertically
+	 *	\returns True if a leaf in range holds a player
+	 */
+	bool hasPlayersNear(const Position& pos, int32_t rangex = Map::maxViewportX, int32_t rangey = Map::maxViewportY) const;
+
+	uint64_t getSpectatorScans() const { return spectatorScans; }
+	uint64_t getSpectatorCacheHits() const { return spectatorCacheHits; }
+
 	/**
 	 * Checks if path is clear from fromPos to toPos
 	 * Notice: This only checks a straight line if the path is clear, for path finding use getPathTo.
@@ -265,6 +278,9 @@ private:
 		spectatorCache.clear();
 		playersSpectatorCache.clear();
 	}
+	void invalidateSpectatorCache(const Position& pos);
+
+	uint64_t spectatorScans = 0, spectatorCacheHits = 0;
 
 	// Actually scans the map for spectators
 	void getSpectatorsInternal(SpectatorVec& list, const Position& centerPos,
@@ -34,6 +34,24 @@ uint32_t Monster::monsterAutoID = 0x40000000;
 
 #if ENABLE_SERVER_DIAGNOSTIC > 0
 uint32_t Monster::monsterCount = 0;
+uint64_t Monster::thinksFull = 0;
+uint64_t Monster::thinksReduced = 0;
+uint64_t Monster::thinksSkipped = 0;
+Monster::ThinkTick Monster::lastThinkTick;
+uint64_t Monster::thinkTicks = 0;
+
+void Monster::endThinkTick()
+{
+	static ThinkTick tickStart;
+	lastThinkTick.full = thinksFull - tickStart.full;
+	lastThinkTick.reduced = thinksReduced - tickStart.reduced;
+	lastThinkTick.skipped = thinksSkipped - tickStart.skipped;
+
+	tickStart.full = thinksFull;
+	tickStart.reduced = thinksReduced;
+	tickStart.skipped = thinksSkipped;
+	++thinkTicks;
+}
 #endif
 
 Monster* Monster::createMonster(MonsterType* mType)
@@ -214,6 +232,12 @@ void Monster::onCreatureMove(const Creature* creature, const Tile* newTile, cons
 			isMasterInRange = true;
 		}
 
+		updateTargetDistance(creature);
+
+		if (canSeeNewPos && isInLodRange(newPos) && isOpponent(creature)) {
+			lodWake = true;
+		}
+
 		updateIdleStatus();
 		if (!m_followCreature && !isSummon() && isOpponent(creature)) { // we have no target lets try pick this one
 			selectTarget(const_cast<Creature*>(creature));
@@ -223,23 +247,34 @@ void Monster::onCreatureMove(const Creature* creature, const Tile* newTile, cons
 
 void Monster::updateTargetList()
 {
-	// for(it = friendList.begin(); it != friendList.end();)
-	for (const auto& element : friendList) {
-		if ((element.second)->getHealth() <= 0 || !canSee((element.second)->getPosition())) {
-			element.second->unRef();
-			friendList.erase(element.first);
+	for (auto it = friendList.begin(); it != friendList.end();) {
+		if (it->second->getHealth() <= 0 || !canSee(it->second->getPosition())) {
+			it->second->unRef();
+			it = friendList.erase(it);
+		} else {
+			++it;
 		}
 	}
 
-	for (auto it = targetList.begin(); it != targetList.end();) {
-		if ((*it)->getHealth() <= 0 || !canSee((*it)->getPosition())) {
-			(*it)->unRef();
-			it = targetList.erase(it);
-		} else {
-			++it;
+	auto lost = [this](const MonsterTarget& target) {
+		if (target.creature->getHealth() > 0 && canSee(target.creature->getPosition())) {
+			return false;
 		}
+
+		target.creature->unRef();
+		return true;
+	};
+	targetList.erase(std::remove_if(targetList.begin(), targetList.end(), lost), targetList.end());
+
+	// we moved, so every distance changed; the list was sorted for the old position and mostly still is
+	for (MonsterTarget& target : targetList) {
+		target.distance = getTargetDistance(target.creature);
 	}
 
+	std::stable_sort(targetList.begin(), targetList.end(), [](const MonsterTarget& lhs, const MonsterTarget& rhs) {
+		return lhs.distance < rhs.distance;
+	});
+
 	for (Creature* spectator : g_game.getSpectators(getPosition())) {
 		if (spectator != this && canSee(spectator->getPosition())) {
 			onCreatureFound(spectator);
@@ -249,13 +284,65 @@ void Monster::updateTargetList()
 
 void Monster::clearTargetList()
 {
-	for (CreatureList::iterator it = targetList.begin(); it != targetList.end(); ++it) {
-		(*it)->unRef();
+	for (const MonsterTarget& target : targetList) {
+		target.creature->unRef();
 	}
 
 	targetList.clear();
 }
 
+int32_t Monster::getTargetDistance(const Creature* creature) const
+{
+	const Position& myPos = getPosition();
+	const Position& pos = creature->getPosition();
+	return std::max(std::abs(myPos.x - pos.x), std::abs(myPos.y - pos.y));
+}
+
+TargetList::iterator Monster::findTarget(const Creature* creature)
+{
+	return std::find_if(targetList.begin(), targetList.end(), [creature](const MonsterTarget& target) {
+		return target.creature == creature;
+	});
+}
+
+void Monster::insertTarget(Creature* creature, bool hasPath, bool preferred)
+{
+	auto byDistance = [](const MonsterTarget& lhs, const MonsterTarget& rhs) { return lhs.distance < rhs.distance; };
+
+	// a preferred target goes before the others at the same distance
+	const MonsterTarget target{ creature, getTargetDistance(creature), hasPath };
+	if (preferred) {
+		targetList.insert(std::lower_bound(targetList.begin(), targetList.end(), target, byDistance), target);
+	} else {
+		targetList.insert(std::upper_bound(targetList.begin(), targetList.end(), target, byDistance), target);
+	}
+}
+
+void Monster::updateTargetDistance(const Creature* creature)
+{
+	auto it = findTarget(creature);
+	if (it == targetList.end()) {
+		return;
+	}
+
+	const int32_t distance = getTargetDistance(creature);
+	if (distance == it->distance) {
+		return;
+	}
+
+	// a step changes the distance by one, so the target only moves past its neighbours
+	it->distance = distance;
+	while (it != targetList.begin() && std::prev(it)->distance > distance) {
+		std::iter_swap(it, std::prev(it));
+		--it;
+	}
+
+	while (std::next(it) != targetList.end() && std::next(it)->distance < distance) {
+		std::iter_swap(it, std::next(it));
+		++it;
+	}
+}
+
 void Monster::clearFriendList()
 {
 	for (const auto& element : friendList) {
@@ -269,22 +356,17 @@ void Monster::onCreatureFound(Creature* creature, bool pushFront /*= false*/)
 {
 	if (isFriend(creature)) {
 		assert(creature != this);
-		auto search = friendList.find(creature->getID());
-		if (search != friendList.end()) {
+		if (friendList.emplace(creature->getID(), creature).second) {
 			creature->addRef();
-			friendList.insert(std::make_pair(creature->getID(), creature));
 		}
 	}
 
 	if (isOpponent(creature)) {
 		assert(creature != this);
-		if (std::find(targetList.begin(), targetList.end(), creature) == targetList.end()) {
+		if (findTarget(creature) == targetList.end()) {
+			lodWake = true;
 			creature->addRef();
-			if (pushFront) {
-				targetList.push_front(creature);
-			} else {
-				targetList.push_back(creature);
-			}
+			insertTarget(creature, true, pushFront);
 		}
 	}
 
@@ -359,9 +441,9 @@ void Monster::onCreatureLeave(Creature* creature)
 
 	// update targetList
 	if (isOpponent(creature)) {
-		CreatureList::iterator it = std::find(targetList.begin(), targetList.end(), creature);
+		auto it = findTarget(creature);
 		if (it != targetList.end()) {
-			(*it)->unRef();
+			it->creature->unRef();
 			targetList.erase(it);
 			if (targetList.empty()) {
 				updateIdleStatus();
@@ -372,40 +454,37 @@ void Monster::onCreatureLeave(Creature* creature)
 
 bool Monster::searchTarget(TargetSearchType_t searchType /*= TARGETSEARCH_DEFAULT*/)
 {
-	std::list<Creature*> resultList;
 	const Position& myPos = getPosition();
-	for (CreatureList::iterator it = targetList.begin(); it != targetList.end(); ++it) {
-		if (m_followCreature != (*it) && isTarget(*it) && (searchType == TARGETSEARCH_RANDOM || canUseAttack(myPos, *it))) {
-			resultList.push_back(*it);
-		}
-	}
+	auto isCandidate = [&](Creature* creature) {
+		return m_followCreature != creature && isTarget(creature) && (searchType == TARGETSEARCH_RANDOM || canUseAttack(myPos, creature));
+	};
 
 	switch (searchType) {
 		case TARGETSEARCH_NEAREST: {
-			Creature* target = nullptr;
-			int32_t range = -1;
-			for (CreatureList::iterator it = resultList.begin(); it != resultList.end(); ++it) {
-				int32_t tmp = std::max(std::abs(myPos.x - (*it)->getPosition().x),
-					std::abs(myPos.y - (*it)->getPosition().y));
-				if (range >= 0 && tmp >= range) {
-					continue;
+			// the list is sorted by distance, the first candidate is the nearest one
+			for (const MonsterTarget& target : targetList) {
+				if (isCandidate(target.creature)) {
+					if (selectTarget(target.creature)) {
+						return true;
+					}
+					break;
 				}
-
-				target = *it;
-				range = tmp;
-			}
-
-			if (target && selectTarget(target)) {
-				return true;
 			}
 
 			break;
 		}
 		default: {
-			if (!resultList.empty()) {
-				CreatureList::iterator it = resultList.begin();
-				std::advance(it, random_range(0, resultList.size() - 1));
-				return selectTarget(*it);
+			// reservoir pick, every candidate is equally likely without collecting them first
+			Creature* target = nullptr;
+			int32_t count = 0;
+			for (const MonsterTarget& it : targetList) {
+				if (isCandidate(it.creature) && random_range(0, count++) == 0) {
+					target = it.creature;
+				}
+			}
+
+			if (target) {
+				return selectTarget(target);
 			}
 
 			if (searchType == TARGETSEARCH_ATTACKRANGE) {
@@ -416,12 +495,14 @@ bool Monster::searchTarget(TargetSearchType_t searchType /*= TARGETSEARCH_DEFAUL
 		}
 	}
 
-	// lets just pick the first target in the list
-	for (CreatureList::iterator it = targetList.begin(); it != targetList.end(); ++it) {
-		if (m_followCreature == (*it) || !selectTarget(*it)) {
-			continue;
+	// lets just pick the nearest target, those we found a path to first
+	for (bool hasPath : { true, false }) {
+		for (const MonsterTarget& target : targetList) {
+			if (target.hasPath != hasPath || m_followCreature == target.creature || !selectTarget(target.creature)) {
+				continue;
+			}
+			return true;
 		}
-		return true;
 	}
 	return false;
 }
@@ -432,17 +513,13 @@ void Monster::onFollowCreatureComplete(const Creature* creature)
 		return;
 	}
 
-	CreatureList::iterator it = std::find(targetList.begin(), targetList.end(), creature);
+	auto it = findTarget(creature);
 	if (it != targetList.end()) {
-		Creature* target = (*it);
-		targetList.erase(it);
-
-		if (m_hasFollowPath) { // push target we have found a path to the front
-			targetList.push_front(target);
-		} else if (!isSummon()) { // push target we have not found a path to the back
-			targetList.push_back(target);
-		} else { // Since we removed the creature from the targetList (and not put it back) we have to release it too
-			target->unRef();
+		if (m_hasFollowPath || !isSummon()) { // targets we have not found a path to are picked last
+			it->hasPath = m_hasFollowPath;
+		} else { // a summon drops a target it cannot reach
+			it->creature->unRef();
+			targetList.erase(it);
 		}
 	}
 }
@@ -483,7 +560,7 @@ bool Monster::isTarget(Creature* creature)
 
 bool Monster::selectTarget(Creature* creature)
 {
-	if (!isTarget(creature) || std::find(targetList.begin(), targetList.end(), creature) == targetList.end()) {
+	if (!isTarget(creature) || findTarget(creature) == targetList.end()) {
 		// Target not found in our target list.
 		return false;
 	}
@@ -561,6 +638,35 @@ void Monster::onThink(uint32_t interval)
 		return;
 	}
 
+	int32_t lodInterval = mType->lodThinkInterval;
+	if (lodInterval < 0) {
+		lodInterval = otx::config::getInteger(otx::config::MONSTER_LOD_THINK_INTERVAL);
+	}
+
+	if (static_cast<uint32_t>(lodInterval) > interval && !isEngaged()) {
+		lodTicks += interval;
+		if (lodTicks < static_cast<uint32_t>(lodInterval) && !lodWake) {
+#if ENABLE_SERVER_DIAGNOSTIC > 0
+			++Monster::thinksSkipped;
+#endif
+			return;
+		}
+
+		// the target and yell timers below catch up on the skipped thinks
+		interval = lodTicks;
+		lodTicks = 0;
+		lodWake = false;
+#if ENABLE_SERVER_DIAGNOSTIC > 0
+		++Monster::thinksReduced;
+#endif
+	} else {
+		lodTicks = 0;
+		lodWake = false;
+#if ENABLE_SERVER_DIAGNOSTIC > 0
+		++Monster::thinksFull;
+#endif
+	}
+
 	if (teleportToMaster && doTeleportToMaster()) {
 		teleportToMaster = false;
 	}
@@ -590,6 +696,22 @@ void Monster::onThink(uint32_t interval)
 	onThinkYell(interval);
 }
 
+bool Monster::isEngaged() const
+{
+	if (isSummon() || isFleeing()) {
+		return true;
+	}
+
+	return m_attackedCreature && isInLodRange(m_attackedCreature->getPosition());
+}
+
+bool Monster::isInLodRange(const Position& pos) const
+{
+	const int32_t range = std::max<int32_t>(otx::config::getInteger(otx::config::MONSTER_LOD_RANGE), mType->targetDistance + 1);
+	const Position& myPos = getPosition();
+	return Position::getDistanceX(myPos, pos) <= range && Position::getDistanceY(myPos, pos) <= range;
+}
+
 void Monster::onAttacking(uint32_t interval)
 {
 	Creature::onAttacking(interval);
@@ -1376,7 +1498,7 @@ bool Monster::isWalkable() const
 
 bool Monster::hasRecentBattle() const
 {
-	return lastDamage && otx::util::mstime() < (lastDamage + 30000);
+	return lastDamage && otx::util::ticks() < (lastDamage + 30000);
 }
 
 bool Monster::isFleeing() const
@@ -1420,7 +1542,7 @@ void Monster::changeHealth(int32_t healthChange)
 	// In case a player with ignore flag set attacks the monster
 	setIdle(false);
 	if (!hasRecentBattle()) {
-		lastDamage = otx::util::mstime();
+		lastDamage = otx::util::ticks();
 		updateMapCache();
 	}
 
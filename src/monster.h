@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include "lockfree.h"
 #include "monsters.h"
 #include "raids.h"
 #include "tile.h"
@@ -34,6 +35,14 @@ enum TargetSearchType_t
 };
 
 typedef std::list<Creature*> CreatureList;
+struct MonsterTarget
+{
+	Creature* creature;
+	int32_t distance; // to the monster, updated whenever either of them moves
+	bool hasPath; // false once following it found no path
+};
+// ordered by distance, nearest first
+typedef std::vector<MonsterTarget> TargetList;
 class Monster final : public Creature
 {
 private:
@@ -42,9 +51,24 @@ private:
 public:
 #if ENABLE_SERVER_DIAGNOSTIC > 0
 	static uint32_t monsterCount;
+	static uint64_t thinksFull, thinksReduced, thinksSkipped;
+
+	// the thinks of a single creature check, by level of detail
+	struct ThinkTick
+	{
+		uint64_t full = 0, reduced = 0, skipped = 0;
+	};
+	static ThinkTick lastThinkTick;
+	static uint64_t thinkTicks;
+	// Game::checkCreatures, once its bucket was thought
+	static void endThinkTick();
 #endif
 	virtual ~Monster();
 
+	using Pool = ObjectPool<Monster, 4096>;
+	static void* operator new(size_t size) { return Pool::allocate(size); }
+	static void operator delete(void* p, size_t size) { Pool::deallocate(p, size); }
+
 	static Monster* createMonster(MonsterType* mType);
 	static Monster* createMonster(const std::string& name);
 
@@ -136,7 +160,7 @@ public:
 		bool checkDefense = false, bool checkArmor = false, bool reflect = true, bool field = false, bool element = false);
 
 private:
-	CreatureList targetList;
+	TargetList targetList;
 	std::unordered_map<uint32_t, Creature*> friendList;
 
 	MonsterType* mType;
@@ -149,6 +173,8 @@ private:
 	uint32_t targetChangeTicks;
 	uint32_t defenseTicks;
 	uint32_t yellTicks;
+	uint32_t lodTicks = 0;
+	bool lodWake = false; // an opponent came close, the next think is not skipped
 	int32_t targetChangeCooldown;
 	int64_t lastDamage;
 	bool resetTicks;
@@ -164,6 +190,9 @@ private:
 	bool randomStepping;
 	bool ignoreFieldDamage;
 
+	bool isEngaged() const;
+	bool isInLodRange(const Position& pos) const;
+
 	virtual void onCreatureEnter(Creature* creature);
 	virtual void onCreatureLeave(Creature* creature);
 	void onCreatureFound(Creature* creature, bool pushFront = false);
@@ -173,6 +202,11 @@ private:
 
 	void updateTargetList();
 	void clearTargetList();
+
+	int32_t getTargetDistance(const Creature* creature) const;
+	TargetList::iterator findTarget(const Creature* creature);
+	void insertTarget(Creature* creature, bool hasPath, bool preferred);
+	void updateTargetDistance(const Creature* creature);
 	void clearFriendList();
 
 	virtual bool onDeath();
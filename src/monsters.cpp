@@ -43,7 +43,7 @@ void MonsterType::reset()
 	runAwayHealth = healthMin = manaCost = lightLevel = lightColor = yellSpeedTicks = yellChance = changeTargetSpeed = changeTargetChance = 0;
 	experience = defense = armor = lookCorpse = corpseUnique = corpseAction = conditionImmunities = damageImmunities = 0;
 
-	maxSummons = -1;
+	maxSummons = lodThinkInterval = -1;
 	targetDistance = 1;
 	staticAttackChance = 95;
 	health = healthMax = 100;
@@ -80,26 +80,76 @@ void MonsterType::reset()
 
 	voiceVector.clear();
 	lootItems.clear();
+	compiledLoot.clear();
+	compiledLootRate = 0.;
 	elementMap.clear();
 }
 
-ItemList MonsterType::createLoot(const LootBlock& lootBlock)
+namespace {
+
+uint32_t getLootThreshold(uint32_t chance, double rate)
 {
-	uint16_t item = lootBlock.ids[0], random = Monsters::getLootRandom(), count = 0;
-	if (lootBlock.ids.size() > 1) {
-		item = lootBlock.ids[random_range(0, lootBlock.ids.size() - 1)];
+	// a block drops when ceil(roll / rate) < chance for a raw roll in [0, MAX_LOOTCHANCE],
+	// so the first failing raw roll can be worked out once per rate
+	if (!chance || rate <= 0.) {
+		return 0;
 	}
 
-	ItemList items;
-	if (random < lootBlock.chance) {
-		count = random % lootBlock.count + 1;
+	auto scaled = [rate](uint32_t roll) { return std::ceil(roll / rate); };
+	uint32_t threshold = static_cast<uint32_t>(std::min<double>(MAX_LOOTCHANCE + 1, std::floor((chance - 1) * rate) + 1));
+	while (threshold > 0 && scaled(threshold - 1) >= chance) {
+		--threshold;
+	}
+
+	while (threshold <= MAX_LOOTCHANCE && scaled(threshold) < chance) {
+		++threshold;
+	}
+
+	return threshold;
+}
+
+void flattenLoot(std::vector<CompiledLoot>& compiled, const LootItems& items, double rate)
+{
+	for (const LootBlock& block : items) {
+		const size_t index = compiled.size();
+		compiled.push_back({&block, getLootThreshold(block.chance, rate), 0});
+
+		flattenLoot(compiled, block.childLoot, rate);
+		compiled[index].next = compiled.size();
+	}
+}
+
+} // namespace
+
+void MonsterType::compileLoot(double rate)
+{
+	compiledLoot.clear();
+	flattenLoot(compiledLoot, lootItems, rate);
+	compiledLootRate = rate;
+}
+
+ItemList MonsterType::createLoot(const CompiledLoot& loot)
+{
+	FastRandomGenerator& generator = getFastRandomGenerator();
+	const uint32_t roll = generator.next(MAX_LOOTCHANCE + 1);
+	if (roll >= loot.threshold) {
+		return {};
+	}
+
+	const LootBlock& lootBlock = *loot.block;
+	uint16_t item = lootBlock.ids[0];
+	if (lootBlock.ids.size() > 1) {
+		item = lootBlock.ids[generator.next(lootBlock.ids.size())];
 	}
 
+	uint32_t count = static_cast<uint32_t>(std::ceil(roll / compiledLootRate)) % lootBlock.count + 1;
+
+	ItemList items;
 	Item* tmpItem = nullptr;
 	while (count > 0) {
 		uint16_t n = 0;
 		if (Item::items[item].stackable) {
-			n = std::min<uint16_t>(count, 100);
+			n = std::min<uint32_t>(count, 100);
 		}
 
 		if (!(tmpItem = Item::CreateItem(item, n))) {
@@ -129,24 +179,14 @@ ItemList MonsterType::createLoot(const LootBlock& lootBlock)
 	return items;
 }
 
-bool MonsterType::createChildLoot(Container* parent, const LootBlock& lootBlock)
+bool MonsterType::createChildLoot(Container* parent, uint32_t index)
 {
-	LootItems::const_iterator it = lootBlock.childLoot.begin();
-	if (it == lootBlock.childLoot.end()) {
-		return true;
-	}
-
-	ItemList items;
-	for (; it != lootBlock.childLoot.end() && !parent->full(); ++it) {
-		items = createLoot(*it);
-		if (items.empty()) {
-			continue;
-		}
-
-		for (ItemList::iterator iit = items.begin(); iit != items.end(); ++iit) {
-			Item* tmpItem = *iit;
+	const uint32_t end = compiledLoot[index].next;
+	for (uint32_t i = index + 1; i < end && !parent->full(); i = compiledLoot[i].next) {
+		ItemList items = createLoot(compiledLoot[i]);
+		for (Item* tmpItem : items) {
 			if (Container* container = tmpItem->getContainer()) {
-				if (createChildLoot(container, *it)) {
+				if (createChildLoot(container, i)) {
 					parent->__internalAddThing(tmpItem);
 				} else {
 					delete container;
@@ -160,24 +200,19 @@ bool MonsterType::createChildLoot(Container* parent, const LootBlock& lootBlock)
 	return !parent->empty();
 }
 
-uint16_t Monsters::getLootRandom()
-{
-	return std::ceil(random_range(0, MAX_LOOTCHANCE) / otx::config::getDouble(otx::config::RATE_LOOT));
-}
-
 void MonsterType::dropLoot(Container* corpse)
 {
-	ItemList items;
-	for (LootItems::const_iterator it = lootItems.begin(); it != lootItems.end() && !corpse->full(); ++it) {
-		items = createLoot(*it);
-		if (items.empty()) {
-			continue;
-		}
+	const double rate = otx::config::getDouble(otx::config::RATE_LOOT);
+	if (rate != compiledLootRate) {
+		compileLoot(rate);
+	}
 
-		for (ItemList::iterator iit = items.begin(); iit != items.end(); ++iit) {
-			Item* tmpItem = *iit;
+	const uint32_t end = compiledLoot.size();
+	for (uint32_t i = 0; i < end && !corpse->full(); i = compiledLoot[i].next) {
+		ItemList items = createLoot(compiledLoot[i]);
+		for (Item* tmpItem : items) {
 			if (Container* container = tmpItem->getContainer()) {
-				if (createChildLoot(container, *it)) {
+				if (createChildLoot(container, i)) {
 					corpse->__internalAddThing(tmpItem);
 				} else {
 					delete container;
@@ -235,6 +270,8 @@ bool Monsters::loadFromXml(bool reloading /*= false*/)
 		return false;
 	}
 
+	std::vector<XMLFile> files;
+	std::vector<std::string> names;
 	for (xmlNodePtr p = root->children; p; p = p->next) {
 		if (p->type != XML_ELEMENT_NODE) {
 			continue;
@@ -250,11 +287,24 @@ bool Monsters::loadFromXml(bool reloading /*= false*/)
 			continue;
 		}
 
-		file = getFilePath(FILE_TYPE_OTHER, "monster/" + file);
-		loadMonster(file, name, reloading);
+		files.emplace_back().path = getFilePath(FILE_TYPE_OTHER, "monster/" + file);
+		names.push_back(std::move(name));
 	}
 
 	xmlFreeDoc(doc);
+
+	// the files are parsed in parallel, but registered in the order of monsters.xml
+	parseXMLFiles(files);
+	for (size_t i = 0; i < files.size(); ++i) {
+		if (!files[i].doc) {
+			std::clog << "[Warning - Monsters::loadMonster] Cannot load monster (" << names[i] << ") file (" << files[i].path << ")." << std::endl;
+			std::clog << files[i].error << std::endl;
+			continue;
+		}
+
+		loadMonster(files[i].doc, files[i].path, names[i], reloading);
+	}
+
 	loaded = true;
 	return loaded;
 }
@@ -857,9 +907,21 @@ bool Monsters::deserializeSpell(xmlNodePtr node, spellBlock_t& sb, const std::st
 #define SHOW_XML_ERROR(desc) std::clog << "[Error - Monsters::loadMonster] " << desc << " (" << file << ")." << std::endl;
 
 bool Monsters::loadMonster(const std::string& file, const std::string& monsterName, bool reloading /* = false*/)
+{
+	xmlDocPtr doc = xmlParseFile(file.c_str());
+	if (!doc) {
+		std::clog << "[Warning - Monsters::loadMonster] Cannot load monster (" << monsterName << ") file (" << file << ")." << std::endl;
+		std::clog << getLastXMLError() << std::endl;
+		return false;
+	}
+	return loadMonster(doc, file, monsterName, reloading);
+}
+
+bool Monsters::loadMonster(xmlDocPtr doc, const std::string& file, const std::string& monsterName, bool reloading)
 {
 	if (getIdByName(monsterName) && !reloading) {
 		std::clog << "[Warning - Monsters::loadMonster] Duplicate registered monster with name: " << monsterName << std::endl;
+		xmlFreeDoc(doc);
 		return true;
 	}
 
@@ -880,13 +942,6 @@ bool Monsters::loadMonster(const std::string& file, const std::string& monsterNa
 		mType = new MonsterType();
 	}
 
-	xmlDocPtr doc = xmlParseFile(file.c_str());
-	if (!doc) {
-		std::clog << "[Warning - Monsters::loadMonster] Cannot load monster (" << monsterName << ") file (" << file << ")." << std::endl;
-		std::clog << getLastXMLError() << std::endl;
-		return false;
-	}
-
 	monsterLoad = true;
 	xmlNodePtr root = xmlDocGetRootElement(doc);
 	if (xmlStrcmp(root->name, reinterpret_cast<const xmlChar*>("monster"))) {
@@ -1083,6 +1138,10 @@ bool Monsters::loadMonster(const std::string& file, const std::string& monsterNa
 						mType->eliminable = booleanString(strValue);
 					}
 
+					if (readXMLInteger(tmpNode, "lodthinkinterval", intValue)) {
+						mType->lodThinkInterval = intValue;
+					}
+
 					if (readXMLString(tmpNode, "ignorespawnboost", strValue)) {
 						mType->ignoreSpawnBoost = booleanString(strValue); // true = don't change spawn time with spawndivider boost system
 					}
@@ -1321,7 +1380,7 @@ bool Monsters::loadMonster(const std::string& file, const std::string& monsterNa
 
 				LootBlock rootBlock;
 				if (loadLoot(tmpNode, rootBlock)) {
-					mType->lootItems.push_back(rootBlock);
+					mType->lootItems.push_back(std::move(rootBlock));
 				} else {
 					SHOW_XML_WARNING("Cant load loot");
 				}
@@ -1413,6 +1472,8 @@ bool Monsters::loadMonster(const std::string& file, const std::string& monsterNa
 		return false;
 	}
 
+	mType->compileLoot(otx::config::getDouble(otx::config::RATE_LOOT));
+
 	static uint32_t id = 0;
 	if (new_mType) {
 		monsterNames[otx::util::as_lower_string(monsterName)] = ++id;
@@ -51,6 +51,14 @@ struct LootBlock
 	}
 };
 
+// loot blocks flattened in pre-order, with the drop chance folded into a raw roll threshold
+struct CompiledLoot
+{
+	const LootBlock* block;
+	uint32_t threshold; // drops while the raw roll is below this
+	uint32_t next; // index past this block's nested loot
+};
+
 struct summonBlock_t
 {
 	std::string name;
@@ -86,9 +94,10 @@ public:
 
 	void reset();
 
+	void compileLoot(double rate);
 	void dropLoot(Container* corpse);
-	ItemList createLoot(const LootBlock& lootBlock);
-	bool createChildLoot(Container* parent, const LootBlock& lootBlock);
+	ItemList createLoot(const CompiledLoot& loot);
+	bool createChildLoot(Container* parent, uint32_t index);
 
 	bool isSummonable, isIllusionable, isConvinceable, isAttackable, isHostile, isPassive, isLureable,
 		isWalkable, canPushItems, canPushCreatures, pushable, hideName, hideHealth, eliminable, ignoreSpawnBoost, canWalkOnEnergy, canWalkOnFire, canWalkOnPoison;
@@ -100,6 +109,7 @@ public:
 	GuildEmblems_t guildEmblem;
 	LootMessage_t lootMessage;
 
+	int32_t lodThinkInterval; // -1 uses monsterLodThinkInterval
 	int32_t defense, armor, health, healthMin, healthMax, baseSpeed, lookCorpse, corpseUnique, corpseAction,
 		maxSummons, targetDistance, runAwayHealth, conditionImmunities, damageImmunities,
 		lightLevel, lightColor, changeTargetSpeed, changeTargetChance;
@@ -110,6 +120,8 @@ public:
 
 	SummonList summonList;
 	LootItems lootItems;
+	std::vector<CompiledLoot> compiledLoot;
+	double compiledLootRate;
 	ElementMap elementMap;
 	SpellList spellAttackList;
 	SpellList spellDefenseList;
@@ -134,11 +146,12 @@ public:
 
 	uint32_t getIdByName(const std::string& name);
 	bool isLoaded() const { return loaded; }
-	static uint16_t getLootRandom();
 
 private:
 	bool loaded;
 
+	bool loadMonster(xmlDocPtr doc, const std::string& file, const std::string& monsterName, bool reloading);
+
 	bool loadLoot(xmlNodePtr, LootBlock&);
 	bool loadChildLoot(xmlNodePtr, LootBlock&);
 
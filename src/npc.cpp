@@ -33,6 +33,7 @@ uint32_t Npc::npcAutoID = 0x80000000;
 
 #if ENABLE_SERVER_DIAGNOSTIC > 0
 uint32_t Npc::npcCount = 0;
+uint64_t Npc::npcDormantThinks = 0;
 #endif
 
 NpcScript* Npc::m_interface = nullptr;
@@ -116,6 +117,10 @@ bool Npcs::parseNpcNode(xmlNodePtr node, FileType_t path, bool reloading /* = fa
 		nType->script = strValue;
 	}
 
+	if (readXMLString(node, "alwaysthink", strValue) || readXMLString(node, "alwaysThink", strValue)) {
+		nType->alwaysThink = booleanString(strValue);
+	}
+
 	for (xmlNodePtr q = node->children; q; q = q->next) {
 		if (!xmlStrcmp(q->name, reinterpret_cast<const xmlChar*>("look"))) {
 			int32_t intValue;
@@ -260,10 +265,11 @@ void Npc::reset()
 	walkable = false;
 	focusCreature = 0;
 	isIdle = true;
+	isDormant = false;
 	talkRadius = 2;
 	idleTime = 0;
 	idleInterval = 5 * 60;
-	lastVoice = otx::util::mstime();
+	lastVoice = otx::util::ticks();
 	baseDirection = SOUTH;
 	if (m_npcEventHandler) {
 		delete m_npcEventHandler;
@@ -342,6 +348,10 @@ bool Npc::loadFromXml()
 		nType->name = strValue;
 	}
 
+	if (readXMLString(root, "alwaysthink", strValue) || readXMLString(root, "alwaysThink", strValue)) {
+		nType->alwaysThink = booleanString(strValue);
+	}
+
 	if (readXMLString(root, "script", strValue)) {
 		nType->script = strValue;
 	}
@@ -537,6 +547,10 @@ void Npc::onCreatureAppear(const Creature* creature)
 		return;
 	}
 
+	if (creature->getPlayer()) {
+		wake();
+	}
+
 	if (m_npcEventHandler) {
 		m_npcEventHandler->onCreatureAppear(creature);
 	}
@@ -559,6 +573,10 @@ void Npc::onCreatureMove(const Creature* creature, const Tile* newTile, const Po
 	const Tile* oldTile, const Position& oldPos, bool teleport)
 {
 	Creature::onCreatureMove(creature, newTile, newPos, oldTile, oldPos, teleport);
+	if (creature == this || creature->getPlayer()) {
+		wake();
+	}
+
 	if (m_npcEventHandler) {
 		m_npcEventHandler->onCreatureMove(creature, oldPos, newPos);
 	}
@@ -566,6 +584,10 @@ void Npc::onCreatureMove(const Creature* creature, const Tile* newTile, const Po
 
 void Npc::onCreatureSay(const Creature* creature, MessageType_t type, const std::string& text, Position* pos /* = nullptr*/)
 {
+	if (creature->getPlayer()) {
+		wake();
+	}
+
 	if (m_npcEventHandler) {
 		m_npcEventHandler->onCreatureSay(creature, type, text, pos);
 	}
@@ -585,11 +607,26 @@ void Npc::onPlayerLeave(Player* player)
 	}
 }
 
+void Npc::wake()
+{
+	if (!isDormant) {
+		return;
+	}
+
+	isDormant = false;
+	if (walkTicks) {
+		addEventWalk();
+	}
+}
+
 void Npc::onThink(uint32_t interval)
 {
 	Creature::onThink(interval);
-	if (m_npcEventHandler) {
-		m_npcEventHandler->onThink();
+	if (isDormant) {
+#if ENABLE_SERVER_DIAGNOSTIC > 0
+		++Npc::npcDormantThinks;
+#endif
+		return;
 	}
 
 	std::vector<Player*> list;
@@ -607,9 +644,20 @@ void Npc::onThink(uint32_t interval)
 		}
 	}
 
+	if (m_npcEventHandler) {
+		m_npcEventHandler->onThink();
+	}
+
+	// nobody to talk to, sleep until a player shows up (see wake), the last
+	// onThink above has already let the script release focus and say farewell
+	if (list.empty() && !nType->alwaysThink && !focusCreature && shopPlayerList.empty()) {
+		isDormant = true;
+		return;
+	}
+
 	if (list.size()) // loop only if there's at least one player
 	{
-		int64_t now = otx::util::mstime();
+		int64_t now = otx::util::ticks();
 		for (VoiceList::iterator it = voiceList.begin(); it != voiceList.end(); ++it) {
 			if (now < (lastVoice + it->margin)) {
 				continue;
@@ -683,7 +731,7 @@ bool Npc::getNextStep(Direction& dir, uint32_t& flags)
 		return true;
 	}
 
-	if (!walkTicks || !isIdle || focusCreature || getTimeSinceLastMove() < walkTicks) {
+	if (!walkTicks || !isIdle || isDormant || focusCreature || getTimeSinceLastMove() < walkTicks) {
 		return false;
 	}
 	return getRandomStep(dir);
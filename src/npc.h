@@ -26,6 +26,7 @@ struct NpcType
 {
 	std::string name, file, nameDescription, script;
 	Outfit_t outfit;
+	bool alwaysThink = false; // keeps onThink running without players around
 };
 
 class Npcs
@@ -115,6 +116,7 @@ class Npc final : public Creature
 public:
 #if ENABLE_SERVER_DIAGNOSTIC > 0
 	static uint32_t npcCount;
+	static uint64_t npcDormantThinks;
 #endif
 	virtual ~Npc();
 
@@ -188,12 +190,13 @@ private:
 	bool canWalkTo(const Position& fromPos, Direction dir);
 
 	void onPlayerLeave(Player* player);
+	void wake();
 
 	void addShopPlayer(Player* player);
 	void removeShopPlayer(const Player* player);
 	void closeAllShopWindows();
 
-	bool floorChange, attackable, walkable, isIdle;
+	bool floorChange, attackable, walkable, isIdle, isDormant;
 	Direction baseDirection;
 
 	int32_t talkRadius, idleTime, idleInterval, focusCreature;
@@ -25,6 +25,7 @@
 
 // STD
 #include <algorithm>
+#include <array>
 #include <bitset>
 #include <chrono>
 #include <filesystem>
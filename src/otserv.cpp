@@ -19,11 +19,14 @@
 
 #include "chat.h"
 #include "configmanager.h"
+#include "databasetasks.h"
 #include "game.h"
+#include "ioban.h"
 #include "iologindata.h"
 #include "monsters.h"
 #include "npc.h"
 #include "outfit.h"
+#include "packetcapture.h"
 #include "protocolgame.h"
 #include "protocollogin.h"
 #include "protocolold.h"
@@ -44,6 +47,50 @@
 
 RSA g_RSA;
 
+namespace
+{
+	// measures the startup phases, the report is printed once the world is loaded
+	class StartupTimer
+	{
+	public:
+		void next(const char* phase)
+		{
+			const int64_t now = otx::util::mstime();
+			finish(now);
+			m_phase = phase;
+			m_start = now;
+		}
+
+		void report()
+		{
+			finish(otx::util::mstime());
+
+			int64_t total = 0;
+			std::clog << ">> Startup timings:" << std::endl;
+			for (const auto& it : m_phases) {
+				std::clog << "\t" << it.first << ": " << it.second << " ms" << std::endl;
+				total += it.second;
+			}
+
+			std::clog << "\tTotal: " << total << " ms" << std::endl;
+		}
+
+	private:
+		void finish(int64_t now)
+		{
+			if (m_phase) {
+				m_phases.emplace_back(m_phase, now - m_start);
+				m_phase = nullptr;
+			}
+		}
+
+		std::vector<std::pair<const char*, int64_t>> m_phases;
+		const char* m_phase = nullptr;
+		int64_t m_start = 0;
+	};
+
+} // namespace
+
 std::mutex g_loaderLock;
 std::condition_variable g_loaderSignal;
 std::unique_lock<std::mutex> g_loaderUniqueLock(g_loaderLock);
@@ -78,7 +125,10 @@ bool argumentsHandler(StringVec args)
 			std::clog << "\t--log=$1\t\tWhole standard output will be logged to\n"
 						 "\t\t\t\tthis file.\n"
 						 "\t--closed\t\t\tStarts the server as closed.\n"
-						 "\t--no-script\t\t\tStarts the server without script system.\n";
+						 "\t--no-script\t\t\tStarts the server without script system.\n"
+						 "\t--replay=$1\t\tReplays the packet captures in this file\n"
+						 "\t\t\t\tor directory once the server is online.\n"
+						 "\t--replay-speed=$1\tScales the recorded delays, 0 does not wait.\n";
 			return false;
 		}
 
@@ -113,6 +163,10 @@ bool argumentsHandler(StringVec args)
 #endif
 		else if (tmp[0] == "--closed") {
 			otx::config::setBoolean(otx::config::START_CLOSED, true);
+		} else if (tmp[0] == "--replay") {
+			g_packetReplay.setPath(tmp[1]);
+		} else if (tmp[0] == "--replay-speed") {
+			g_packetReplay.setSpeed(atof(tmp[1].c_str()));
 		}
 	}
 
@@ -243,12 +297,22 @@ int main(int argc, char* argv[])
 		g_dispatcher.shutdown();
 	}
 
+	g_RSA.shutdown();
+	g_packetReplay.stop();
+	g_packetReplay.join();
+
 	otx::scriptmanager::terminate();
 	g_game.terminate();
 	g_lua.terminate();
 
 	g_scheduler.join();
 	g_dispatcher.join();
+
+	g_databaseTasks.shutdown();
+	g_databaseTasks.join();
+
+	IOBan::getInstance()->shutdown();
+	Logger::getInstance()->close();
 	return 0;
 }
 
@@ -259,6 +323,7 @@ void otserv(ServiceManager* services)
 #endif
 
 	g_game.setGameState(GAMESTATE_STARTUP);
+	StartupTimer startupTimer;
 
 	std::clog << SOFTWARE_NAME << " Version: (" << SOFTWARE_VERSION << "." << MINOR_VERSION << ")\n"
 		"Compiled with " << BOOST_COMPILER << " for arch "
@@ -299,6 +364,12 @@ void otserv(ServiceManager* services)
 		startupErrorMessage("Unable to load " + otx::config::getString(otx::config::CONFIG_FILE) + "!");
 	}
 
+	// the loader runs on the dispatcher, so this seeds the generator the loot rolls use
+	if (const int64_t seed = otx::config::getInteger(otx::config::RANDOM_SEED)) {
+		seedFastRandomGenerator(seed);
+		std::clog << ">> Loot rolls use the fixed seed " << seed << "." << std::endl;
+	}
+
 #ifndef _WIN32
 	if (otx::config::getBoolean(otx::config::DAEMONIZE)) {
 		std::clog << "> Daemonization... ";
@@ -369,26 +440,49 @@ void otserv(ServiceManager* services)
 	if (!nice(otx::config::getInteger(otx::config::NICE_LEVEL))) {}
 #endif
 
+	startupTimer.next("RSA key");
 	std::clog << ">> Loading RSA key" << std::endl;
-	const char* p("14299623962416399520070177382898895550795403345466153217470516082934737582776038882967213386204600674145392845853859217990626450972452084065728686565928113");
-	const char* q("7630979195970404721891201847792002125535401292779123937207447574596692788513647179235335529307251350570728407373705564708871762033017096809910315212884101");
-	const char* d("46730330223584118622160180015036832148732986808519344675210555262940258739805766860224610646919605860206328024326703361630109888417839241959507572247284807035235569619173792292786907845791904955103601652822519121908367187885509270025388641700821735345222087940578381210879116823013776808975766851829020659073");
-
-	g_RSA.initialize(p, q, d);
+	g_RSA.initialize(RSA_OTSERV_P, RSA_OTSERV_Q, RSA_OTSERV_D);
+	g_RSA.start(std::max<int64_t>(0, otx::config::getInteger(otx::config::RSA_THREADS)));
 
+	startupTimer.next("SQL connection");
 	std::clog << ">> Starting SQL connection" << std::endl;
 	if (g_database.connect()) {
 		std::clog << ">> Running Database Manager" << std::endl;
 		if (otx::config::getBoolean(otx::config::OPTIMIZE_DATABASE) && !g_database.optimizeTables()) {
 			std::clog << "[Done] No tables to optimize." << std::endl;
 		}
+
+		if (!g_databaseTasks.connect()) {
+			startupErrorMessage("Couldn't estabilish the write-behind connection to SQL database!");
+		}
+
+		g_databaseTasks.start();
+
+		std::clog << ">> Loading bans" << std::endl;
+		IOBan::getInstance()->start();
+
+		if (!IOLoginData::getInstance()->loadSnapshotState()) {
+			startupErrorMessage("Unable to use the configured player storage!");
+		}
 	} else {
 		startupErrorMessage("Couldn't estabilish connection to SQL database!");
 	}
 
+	startupTimer.next("Duplicated items");
 	std::clog << ">> Checking for duplicated items" << std::endl;
+	// with binary storage the snapshot is what gets loaded, the relational rows are only an export
+	const bool playerItems = !IOLoginData::getInstance()->isSnapshotStorage();
+	if (!playerItems) {
+		std::clog << ">> Player items are kept in snapshots and are not checked, only house tiles are." << std::endl;
+	}
+
 	std::ostringstream query;
-	query << "SELECT unitedItems.serial, COUNT(1) AS duplicatesCount FROM (SELECT serial FROM `player_items` UNION ALL SELECT serial FROM `player_depotitems` UNION ALL SELECT serial FROM `tile_items`) unitedItems GROUP BY unitedItems.serial HAVING COUNT(1) > 1;";
+	if (playerItems) {
+		query << "SELECT unitedItems.serial, COUNT(1) AS duplicatesCount FROM (SELECT serial FROM `player_items` UNION ALL SELECT serial FROM `player_depotitems` UNION ALL SELECT serial FROM `tile_items`) unitedItems GROUP BY unitedItems.serial HAVING COUNT(1) > 1;";
+	} else {
+		query << "SELECT serial, COUNT(1) AS duplicatesCount FROM `tile_items` GROUP BY serial HAVING COUNT(1) > 1;";
+	}
 
 	DBResultPtr result;
 	bool duplicated = false;
@@ -398,36 +492,39 @@ void otserv(ServiceManager* services)
 			std::string serial = result->getString("serial");
 			if (serial != "" && serial.length() > 1) {
 				DBResultPtr result_;
-				std::ostringstream query_playeritems;
-				query_playeritems << "SELECT `player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`, `serial` FROM `player_items` WHERE `serial` = " << g_database.escapeString(serial);
-				if ((result_ = g_database.storeQuery(query_playeritems.str()))) {
-					duplicated = true;
-					do {
-						std::string name;
-						IOLoginData::getInstance()->getNameByGuid(result_->getNumber<uint32_t>("player_id"), name);
-						std::clog << ">> Deleted item from 'player_items' with SERIAL: [" << serial.c_str() << "] PLAYER: [" << result_->getNumber<int32_t>("player_id") << "] PLAYER NAME: [" << name.c_str() << "] ITEM: [" << result_->getNumber<int32_t>("itemtype") << "] COUNT: [" << result_->getNumber<int32_t>("count") << "]" << std::endl;
-						std::ostringstream logText;
-						logText << "Deleted item from 'player_items' with SERIAL: [" << serial << "] PLAYER: [" << result_->getNumber<int32_t>("player_id") << "] PLAYER NAME: [" << name << "] ITEM: [" << result_->getNumber<int32_t>("itemtype") << "] COUNT: [" << result_->getNumber<int32_t>("count") << "]";
-						Logger::getInstance()->eFile("anti_dupe.log", logText.str(), true);
-					} while (result_->next());
+				if (playerItems) {
+					std::ostringstream query_playeritems;
+					query_playeritems << "SELECT `player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`, `serial` FROM `player_items` WHERE `serial` = " << g_database.escapeString(serial);
+					if ((result_ = g_database.storeQuery(query_playeritems.str()))) {
+						duplicated = true;
+						do {
+							std::string name;
+							IOLoginData::getInstance()->getNameByGuid(result_->getNumber<uint32_t>("player_id"), name);
+							std::clog << ">> Deleted item from 'player_items' with SERIAL: [" << serial.c_str() << "] PLAYER: [" << result_->getNumber<int32_t>("player_id") << "] PLAYER NAME: [" << name.c_str() << "] ITEM: [" << result_->getNumber<int32_t>("itemtype") << "] COUNT: [" << result_->getNumber<int32_t>("count") << "]" << std::endl;
+							std::ostringstream logText;
+							logText << "Deleted item from 'player_items' with SERIAL: [" << serial << "] PLAYER: [" << result_->getNumber<int32_t>("player_id") << "] PLAYER NAME: [" << name << "] ITEM: [" << result_->getNumber<int32_t>("itemtype") << "] COUNT: [" << result_->getNumber<int32_t>("count") << "]";
+							Logger::getInstance()->eFile("anti_dupe.log", logText.str(), true);
+						} while (result_->next());
+					}
+
+					query_playeritems.clear();
+					std::ostringstream query_playerdepotitems;
+					query_playerdepotitems << "SELECT `player_id`, `sid`, `pid`, `itemtype`, `count`, `attributes`, `serial` FROM `player_depotitems` WHERE `serial` = " << g_database.escapeString(serial);
+					if ((result_ = g_database.storeQuery(query_playerdepotitems.str()))) {
+						duplicated = true;
+						do {
+							std::string name;
+							IOLoginData::getInstance()->getNameByGuid(result_->getNumber<uint32_t>("player_id"), name);
+							std::clog << ">> Deleted item from 'player_depotitems' with SERIAL: [" << serial.c_str() << "] PLAYER: [" << result_->getNumber<int32_t>("player_id") << "] PLAYER NAME: [" << name.c_str() << "] ITEM: [" << result_->getNumber<int32_t>("itemtype") << "] COUNT: [" << result_->getNumber<int32_t>("count") << "]" << std::endl;
+							std::ostringstream logText;
+							logText << "Deleted item from 'player_depotitems' with SERIAL: [" << serial << "] PLAYER: [" << result_->getNumber<int32_t>("player_id") << "] PLAYER NAME: [" << name << "] ITEM: [" << result_->getNumber<int32_t>("itemtype") << "] COUNT: [" << result_->getNumber<int32_t>("count") << "]";
+							Logger::getInstance()->eFile("anti_dupe.log", logText.str(), true);
+						} while (result_->next());
+					}
+
+					query_playerdepotitems.clear();
 				}
 
-				query_playeritems.clear();
-				std::ostringstream query_playerdepotitems;
-				query_playerdepotitems << "SELECT `player_id`, `sid`, `pid`, `itemtype`, `count`, `attributes`, `serial` FROM `player_depotitems` WHERE `serial` = " << g_database.escapeString(serial);
-				if ((result_ = g_database.storeQuery(query_playerdepotitems.str()))) {
-					duplicated = true;
-					do {
-						std::string name;
-						IOLoginData::getInstance()->getNameByGuid(result_->getNumber<uint32_t>("player_id"), name);
-						std::clog << ">> Deleted item from 'player_depotitems' with SERIAL: [" << serial.c_str() << "] PLAYER: [" << result_->getNumber<int32_t>("player_id") << "] PLAYER NAME: [" << name.c_str() << "] ITEM: [" << result_->getNumber<int32_t>("itemtype") << "] COUNT: [" << result_->getNumber<int32_t>("count") << "]" << std::endl;
-						std::ostringstream logText;
-						logText << "Deleted item from 'player_depotitems' with SERIAL: [" << serial << "] PLAYER: [" << result_->getNumber<int32_t>("player_id") << "] PLAYER NAME: [" << name << "] ITEM: [" << result_->getNumber<int32_t>("itemtype") << "] COUNT: [" << result_->getNumber<int32_t>("count") << "]";
-						Logger::getInstance()->eFile("anti_dupe.log", logText.str(), true);
-					} while (result_->next());
-				}
-
-				query_playerdepotitems.clear();
 				std::ostringstream query_tileitems;
 				query_tileitems << "SELECT `tile_id`, `sid`, `pid`, `itemtype`, `count`, `attributes`, `serial` FROM `tile_items` WHERE `serial` = " << g_database.escapeString(serial);
 				if ((result_ = g_database.storeQuery(query_tileitems.str()))) {
@@ -441,20 +538,23 @@ void otserv(ServiceManager* services)
 				}
 
 				query_tileitems.clear();
-				std::ostringstream query_deletepi;
-				query_deletepi << "DELETE FROM `player_items` WHERE `serial` = " << g_database.escapeString(serial);
-				if (!g_database.executeQuery(query_deletepi.str())) {
-					std::clog << ">> Cannot delete duplicated items from 'player_items'!" << std::endl;
-				}
-
-				query_deletepi.clear();
-				std::ostringstream query_deletedi;
-				query_deletedi << "DELETE FROM `player_depotitems` WHERE `serial` = " << g_database.escapeString(serial);
-				if (!g_database.executeQuery(query_deletedi.str())) {
-					std::clog << ">> Cannot delete duplicated items from 'player_depotitems'!" << std::endl;
+				if (playerItems) {
+					std::ostringstream query_deletepi;
+					query_deletepi << "DELETE FROM `player_items` WHERE `serial` = " << g_database.escapeString(serial);
+					if (!g_database.executeQuery(query_deletepi.str())) {
+						std::clog << ">> Cannot delete duplicated items from 'player_items'!" << std::endl;
+					}
+
+					query_deletepi.clear();
+					std::ostringstream query_deletedi;
+					query_deletedi << "DELETE FROM `player_depotitems` WHERE `serial` = " << g_database.escapeString(serial);
+					if (!g_database.executeQuery(query_deletedi.str())) {
+						std::clog << ">> Cannot delete duplicated items from 'player_depotitems'!" << std::endl;
+					}
+
+					query_deletedi.clear();
 				}
 
-				query_deletedi.clear();
 				std::ostringstream query_deleteti;
 				query_deleteti << "DELETE FROM `tile_items` WHERE `serial` = " << g_database.escapeString(serial);
 				if (!g_database.executeQuery(query_deleteti.str())) {
@@ -472,11 +572,13 @@ void otserv(ServiceManager* services)
 		std::clog << ">> There wasn't duplicated items in the server." << std::endl;
 	}
 
+	startupTimer.next("Items (OTB)");
 	std::clog << ">> Loading items (OTB)" << std::endl;
 	if (!Item::items.loadFromOtb(getFilePath(FILE_TYPE_OTHER, "items/items.otb"))) {
 		startupErrorMessage("Unable to load items (OTB)!");
 	}
 
+	startupTimer.next("Items (XML)");
 	std::clog << ">> Loading items (XML)" << std::endl;
 	if (!Item::items.loadFromXml()) {
 		std::clog << "Unable to load items (XML)! Continue? (y/N)" << std::endl;
@@ -486,46 +588,55 @@ void otserv(ServiceManager* services)
 		}
 	}
 
+	startupTimer.next("Groups");
 	std::clog << ">> Loading groups" << std::endl;
 	if (!g_game.groups.loadFromXml()) {
 		startupErrorMessage("Unable to load groups!");
 	}
 
+	startupTimer.next("Outfits");
 	std::clog << ">> Loading outfits" << std::endl;
 	if (!g_game.outfits.loadFromXml()) {
 		startupErrorMessage("Unable to load outfits!");
 	}
 
+	startupTimer.next("Quests");
 	std::clog << ">> Loading quests" << std::endl;
 	if (!g_game.quests.loadFromXml()) {
 		startupErrorMessage("Unable to load quests!");
 	}
 
+	startupTimer.next("Raids");
 	std::clog << ">> Loading raids" << std::endl;
 	if (!Raids::getInstance()->loadFromXml()) {
 		startupErrorMessage("Unable to load raids!");
 	}
 
+	startupTimer.next("Vocations");
 	std::clog << ">> Loading vocations" << std::endl;
 	if (!g_vocations.loadFromXml()) {
 		startupErrorMessage("Unable to load vocations!");
 	}
 
+	startupTimer.next("Chat channels");
 	std::clog << ">> Loading chat channels" << std::endl;
 	if (!g_chat.loadFromXml()) {
 		startupErrorMessage("Unable to load chat channels!");
 	}
 
+	startupTimer.next("Experience stages");
 	std::clog << ">> Loading experience stages" << std::endl;
 	if (!g_game.loadExperienceStages()) {
 		startupErrorMessage("Unable to load experience stages!");
 	}
 
+	startupTimer.next("Script systems");
 	std::clog << ">> Loading script systems:" << std::endl;
 	if (!otx::scriptmanager::load()) {
 		startupErrorMessage();
 	}
 
+	startupTimer.next("Monsters");
 	std::clog << ">> Loading monsters" << std::endl;
 	if (!g_monsters.loadFromXml()) {
 		std::clog << "Unable to load monsters! Continue? (y/N)" << std::endl;
@@ -536,6 +647,7 @@ void otserv(ServiceManager* services)
 	}
 
 	if (fileExists(getFilePath(FILE_TYPE_OTHER, "npc/npcs.xml"))) {
+		startupTimer.next("Npcs");
 		std::clog << ">> Loading npcs" << std::endl;
 		if (!g_npcs.loadFromXml()) {
 			std::clog << "Unable to load npcs! Continue? (y/N)" << std::endl;
@@ -546,9 +658,11 @@ void otserv(ServiceManager* services)
 		}
 	}
 
+	startupTimer.next("Raids (second pass)");
 	std::clog << ">> Loading raids" << std::endl;
 	Raids::getInstance()->loadFromXml();
 
+	startupTimer.next("Map and spawns");
 	std::clog << ">> Loading map and spawns..." << std::endl;
 	if (!g_game.loadMap(otx::config::getString(otx::config::MAP_NAME))) {
 		startupErrorMessage();
@@ -570,6 +684,7 @@ void otserv(ServiceManager* services)
 		startupErrorMessage("Unknown world type: " + otx::config::getString(otx::config::WORLD_TYPE));
 	}
 
+	startupTimer.report();
 	std::clog << ">> Starting to dominate the world... done." << std::endl;
 
 	std::clog << ">> Initializing game state and binding services:" << std::endl;
@@ -587,4 +702,8 @@ void otserv(ServiceManager* services)
 	g_game.start(services);
 	g_game.setGameState(otx::config::getBoolean(otx::config::START_CLOSED) ? GAMESTATE_CLOSED : GAMESTATE_NORMAL);
 	g_loaderSignal.notify_all();
+
+	if (g_packetReplay.isEnabled() && g_packetReplay.load()) {
+		g_packetReplay.start();
+	}
 }
@@ -7,6 +7,25 @@ int64_t otx::util::mstime()
 	return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
 }
 
+namespace
+{
+	const auto steadyStart = std::chrono::steady_clock::now();
+	const int64_t wallStart = otx::util::mstime();
+	std::atomic<int64_t> cachedTicks{ wallStart };
+
+} // namespace
+
+int64_t otx::util::ticks()
+{
+	return cachedTicks.load(std::memory_order_relaxed);
+}
+
+void otx::util::update_ticks()
+{
+	const auto elapsed = std::chrono::steady_clock::now() - steadyStart;
+	cachedTicks.store(wallStart + std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count(), std::memory_order_relaxed);
+}
+
 void otx::util::trim_left_string(std::string& str, char c/* = ' '*/)
 {
 	str.erase(0, str.find_first_not_of(c));
@@ -4,8 +4,14 @@
 
 namespace otx::util
 {
+	// wall clock in milliseconds, use it for anything that is stored or shown
 	int64_t mstime();
 
+	// game clock in milliseconds, it starts at the wall clock but is monotonic and
+	// only advances when the dispatcher samples it before running a task
+	int64_t ticks();
+	void update_ticks();
+
 	void trim_left_string(std::string& str, char c = ' ');
 	void trim_right_string(std::string& str, char c = ' ');
 	void trim_string(std::string& str, char c = ' ');
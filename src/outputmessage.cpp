@@ -29,28 +29,6 @@ namespace
 	const uint16_t OUTPUTMESSAGE_FREE_LIST_CAPACITY = 2048;
 	const std::chrono::milliseconds OUTPUTMESSAGE_AUTOSEND_DELAY{ 10 };
 
-	void sendAll(const std::vector<Protocol_ptr>& bufferedProtocols);
-
-	void scheduleSendAll(const std::vector<Protocol_ptr>& bufferedProtocols)
-	{
-		g_scheduler.addEvent(createSchedulerTask(OUTPUTMESSAGE_AUTOSEND_DELAY.count(), [&]() { sendAll(bufferedProtocols); }));
-	}
-
-	void sendAll(const std::vector<Protocol_ptr>& bufferedProtocols)
-	{
-		// dispatcher thread
-		for (auto& protocol : bufferedProtocols) {
-			auto& msg = protocol->getCurrentBuffer();
-			if (msg) {
-				protocol->send(std::move(msg));
-			}
-		}
-
-		if (!bufferedProtocols.empty()) {
-			scheduleSendAll(bufferedProtocols);
-		}
-	}
-
 } //namespace
 
 void OutputMessage::addCryptoHeader(bool addChecksum)
@@ -61,22 +39,104 @@ void OutputMessage::addCryptoHeader(bool addChecksum)
 	writeMessageLength();
 }
 
-void OutputMessagePool::addProtocolToAutosend(Protocol_ptr protocol)
+void OutputMessagePool::addProtocolToAutosend(const Protocol_ptr& protocol)
 {
 	// dispatcher thread
-	if (bufferedProtocols.empty()) {
-		scheduleSendAll(bufferedProtocols);
+	if (!protocol->m_autosend) {
+#if ENABLE_SERVER_DIAGNOSTIC > 0
+		addClientTime();
+#endif
+		protocol->m_autosend = true;
+		++autosendCount;
+	}
+
+	if (protocol->m_outputBuffer) {
+		addPendingProtocol(protocol);
 	}
-	bufferedProtocols.emplace_back(protocol);
 }
 
 void OutputMessagePool::removeProtocolFromAutosend(const Protocol_ptr& protocol)
+{
+	// dispatcher thread, it might still be pending, it is skipped then
+	if (protocol->m_autosend) {
+#if ENABLE_SERVER_DIAGNOSTIC > 0
+		addClientTime();
+#endif
+		protocol->m_autosend = false;
+		--autosendCount;
+	}
+}
+
+#if ENABLE_SERVER_DIAGNOSTIC > 0
+void OutputMessagePool::addClientTime()
+{
+	const auto now = std::chrono::steady_clock::now();
+	clientTime += autosendCount * std::chrono::duration<double>(now - clientsChanged).count();
+	clientsChanged = now;
+}
+#endif
+
+void OutputMessagePool::addPendingProtocol(Protocol_ptr protocol)
+{
+	// dispatcher thread
+	if (protocol->m_pendingFlush) {
+		return;
+	}
+
+	if (pendingProtocols.empty()) {
+		g_scheduler.addEvent(createSchedulerTask(OUTPUTMESSAGE_AUTOSEND_DELAY.count(), [this]() { sendPending(); }));
+	}
+
+	protocol->m_pendingFlush = true;
+	pendingProtocols.push_back(std::move(protocol));
+}
+
+void OutputMessagePool::flushAtBatchEnd(Protocol_ptr protocol)
 {
 	// dispatcher thread
-	auto it = std::find(bufferedProtocols.begin(), bufferedProtocols.end(), protocol);
-	if (it != bufferedProtocols.end()) {
-		std::swap(*it, bufferedProtocols.back());
-		bufferedProtocols.pop_back();
+	if (!protocol->m_batchFlush) {
+		protocol->m_batchFlush = true;
+		batchProtocols.push_back(std::move(protocol));
+	}
+}
+
+void OutputMessagePool::onBatchEnd()
+{
+	// dispatcher thread, they stay pending, the delayed flush finds an empty buffer then
+	for (const Protocol_ptr& protocol : batchProtocols) {
+		protocol->m_batchFlush = false;
+		if (protocol->m_autosend) {
+			send(*protocol, OUTPUTFLUSH_BATCH);
+		}
+	}
+	batchProtocols.clear();
+}
+
+void OutputMessagePool::send(Protocol& protocol, OutputFlush_t reason)
+{
+	// dispatcher thread
+	OutputMessage_ptr& msg = protocol.m_outputBuffer;
+	if (!msg) {
+		return;
+	}
+
+#if ENABLE_SERVER_DIAGNOSTIC > 0
+	++messages[reason];
+	bytes += msg->getLength();
+#endif
+	protocol.send(std::move(msg));
+}
+
+void OutputMessagePool::sendPending()
+{
+	// dispatcher thread
+	std::vector<Protocol_ptr> protocols;
+	protocols.swap(pendingProtocols);
+	for (const Protocol_ptr& protocol : protocols) {
+		protocol->m_pendingFlush = false;
+		if (protocol->m_autosend) {
+			send(*protocol, OUTPUTFLUSH_DELAY);
+		}
 	}
 }
 
@@ -63,6 +63,15 @@ private:
 	MsgSize_t outputBufferStart = NetworkMessage::INITIAL_BUFFER_POSITION;
 };
 
+enum OutputFlush_t : uint8_t
+{
+	OUTPUTFLUSH_BATCH, // answers to the client's own commands, once the dispatcher batch ends
+	OUTPUTFLUSH_DELAY, // everything else, once the autosend delay has passed
+	OUTPUTFLUSH_FULL, // the next packet would not fit anymore
+
+	OUTPUTFLUSH_LAST
+};
+
 class OutputMessagePool final
 {
 public:
@@ -77,12 +86,47 @@ public:
 
 	static OutputMessage_ptr getOutputMessage();
 
-	void addProtocolToAutosend(Protocol_ptr protocol);
+	// dispatcher thread, all of the below
+	void addProtocolToAutosend(const Protocol_ptr& protocol);
 	void removeProtocolFromAutosend(const Protocol_ptr& protocol);
 
+	// the protocol started a new buffer, it is sent within the autosend delay
+	// unless it fills up or the protocol asks for it earlier
+	void addPendingProtocol(Protocol_ptr protocol);
+	// the buffer of the protocol is sent as soon as the current dispatcher batch ends
+	void flushAtBatchEnd(Protocol_ptr protocol);
+
+	void onBatchEnd();
+
+	void send(Protocol& protocol, OutputFlush_t reason);
+
+#if ENABLE_SERVER_DIAGNOSTIC > 0
+	uint32_t getAutosendCount() const { return autosendCount; }
+	uint64_t getMessages(OutputFlush_t reason) const { return messages[reason]; }
+	uint64_t getBytes() const { return bytes; }
+	// seconds every client was connected for, summed up; what a rate per client is measured against
+	double getClientSeconds() const {
+		return clientTime + autosendCount * std::chrono::duration<double>(std::chrono::steady_clock::now() - clientsChanged).count();
+	}
+#endif
+
 private:
 	OutputMessagePool() = default;
-	// NOTE: A vector is used here because this container is mostly read
-	// and relatively rarely modified (only when a client connects/disconnects)
-	std::vector<Protocol_ptr> bufferedProtocols;
-};
\ No newline at end of file
+
+	void sendPending();
+#if ENABLE_SERVER_DIAGNOSTIC > 0
+	// before autosendCount changes
+	void addClientTime();
+#endif
+
+	// only the protocols that wrote something since the last flush are visited
+	std::vector<Protocol_ptr> pendingProtocols, batchProtocols;
+	uint32_t autosendCount = 0;
+
+#if ENABLE_SERVER_DIAGNOSTIC > 0
+	std::array<uint64_t, OUTPUTFLUSH_LAST> messages = {};
+	uint64_t bytes = 0;
+	std::chrono::steady_clock::time_point clientsChanged = std::chrono::steady_clock::now();
+	double clientTime = 0;
+#endif
+};
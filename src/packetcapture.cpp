@@ -0,0 +1,332 @@
+////////////////////////////////////////////////////////////////////////
+// OpenTibia - an opensource roleplaying game
+////////////////////////////////////////////////////////////////////////
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+////////////////////////////////////////////////////////////////////////
+
+#include "otpch.h"
+
+#include "packetcapture.h"
+
+#include "dispatcher.h"
+#include "protocolgame.h"
+#include "tools.h"
+
+#include "otx/util.hpp"
+
+#include <fstream>
+#include <future>
+#include <iterator>
+
+PacketReplay g_packetReplay;
+
+namespace
+{
+	// keeps a few packets in memory so the network thread only writes once in a while
+	constexpr size_t PACKET_CAPTURE_BUFFER = 16384;
+
+	class CaptureReader
+	{
+	public:
+		CaptureReader(const std::vector<uint8_t>& data, size_t position) :
+			data(data),
+			position(position) {}
+
+		template<typename T>
+		bool read(T& value) {
+			if (position + sizeof(T) > data.size()) {
+				return false;
+			}
+
+			std::memcpy(&value, data.data() + position, sizeof(T));
+			position += sizeof(T);
+			return true;
+		}
+
+		bool skip(size_t size) {
+			if (position + size > data.size()) {
+				return false;
+			}
+
+			position += size;
+			return true;
+		}
+
+		size_t getPosition() const { return position; }
+
+	private:
+		const std::vector<uint8_t>& data;
+		size_t position;
+	};
+} // namespace
+
+PacketCapture::~PacketCapture()
+{
+	flush();
+	fclose(m_file);
+}
+
+std::unique_ptr<PacketCapture> PacketCapture::open(const PacketCaptureHeader& header)
+{
+	const std::string& directory = otx::config::getString(otx::config::PACKET_CAPTURE);
+	if (directory.empty()) {
+		return nullptr;
+	}
+
+	static std::atomic<uint32_t> sequence{ 0 };
+
+	std::ostringstream path;
+	path << directory;
+	if (directory.back() != '/' && directory.back() != '\\') {
+		path << '/';
+	}
+
+	path << header.name << "-" << formatDateEx(0, "%Y%m%d-%H%M%S") << "-" << ++sequence << ".otxcap";
+
+	FILE* file = fopen(path.str().c_str(), "wb");
+	if (!file) {
+		std::clog << "[Warning - PacketCapture::open] Cannot create " << path.str() << std::endl;
+		return nullptr;
+	}
+
+	auto capture = std::unique_ptr<PacketCapture>(new PacketCapture(file, std::chrono::steady_clock::now()));
+	capture->write(PACKET_CAPTURE_MAGIC);
+	capture->write(PACKET_CAPTURE_VERSION);
+	capture->write<int64_t>(otx::util::mstime());
+	capture->write(header.accountId);
+	capture->write(header.version);
+	capture->write<uint16_t>(header.operatingSystem);
+	capture->write<uint8_t>(header.gamemaster);
+	capture->write<uint16_t>(header.name.size());
+	capture->m_buffer.insert(capture->m_buffer.end(), header.name.begin(), header.name.end());
+	return capture;
+}
+
+void PacketCapture::addPacket(const uint8_t* data, uint16_t size)
+{
+	// network thread
+	write<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - m_start).count());
+	write(size);
+	m_buffer.insert(m_buffer.end(), data, data + size);
+	if (m_buffer.size() >= PACKET_CAPTURE_BUFFER) {
+		flush();
+	}
+}
+
+void PacketCapture::flush()
+{
+	if (!m_buffer.empty()) {
+		fwrite(m_buffer.data(), 1, m_buffer.size(), m_file);
+		m_buffer.clear();
+	}
+}
+
+bool PacketReplay::load()
+{
+	std::error_code error;
+	if (std::filesystem::is_directory(path, error)) {
+		// sorted, so the same directory always gives the same timeline
+		std::vector<std::string> files;
+		for (const auto& entry : std::filesystem::directory_iterator(path, error)) {
+			if (entry.path().extension() == ".otxcap") {
+				files.push_back(entry.path().string());
+			}
+		}
+
+		std::sort(files.begin(), files.end());
+		for (const std::string& file : files) {
+			loadFile(file);
+		}
+	} else {
+		loadFile(path);
+	}
+
+	if (sessions.empty()) {
+		std::clog << "[Error - PacketReplay::load] No capture could be loaded from " << path << std::endl;
+		return false;
+	}
+
+	int64_t base = sessions.front().header.start;
+	for (const Session& session : sessions) {
+		base = std::min(base, session.header.start);
+	}
+
+	for (Packet& packet : packets) {
+		packet.time += sessions[packet.session].header.start - base;
+	}
+
+	std::stable_sort(packets.begin(), packets.end(), [](const Packet& lhs, const Packet& rhs) { return lhs.time < rhs.time; });
+	for (uint32_t i = 0; i < packets.size(); ++i) {
+		sessions[packets[i].session].lastPacket = i;
+	}
+
+	std::clog << ">> Loaded " << packets.size() << " packets from " << sessions.size() << " captures to replay." << std::endl;
+	return true;
+}
+
+bool PacketReplay::loadFile(const std::string& path)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (!file) {
+		std::clog << "[Warning - PacketReplay::loadFile] Cannot open " << path << std::endl;
+		return false;
+	}
+
+	Session session;
+	session.data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+	CaptureReader reader(session.data, 0);
+	uint32_t magic;
+	uint16_t version, operatingSystem, nameSize;
+	uint8_t gamemaster;
+	if (!reader.read(magic) || magic != PACKET_CAPTURE_MAGIC || !reader.read(version) || version != PACKET_CAPTURE_VERSION) {
+		std::clog << "[Warning - PacketReplay::loadFile] " << path << " is not a capture of this version." << std::endl;
+		return false;
+	}
+
+	PacketCaptureHeader& header = session.header;
+	if (!reader.read(header.start) || !reader.read(header.accountId) || !reader.read(header.version) || !reader.read(operatingSystem)
+		|| !reader.read(gamemaster) || !reader.read(nameSize) || !reader.skip(nameSize)) {
+		std::clog << "[Warning - PacketReplay::loadFile] " << path << " has a truncated header." << std::endl;
+		return false;
+	}
+
+	header.operatingSystem = static_cast<OperatingSystem_t>(operatingSystem);
+	header.gamemaster = gamemaster != 0;
+	header.name.assign(reinterpret_cast<const char*>(session.data.data()) + reader.getPosition() - nameSize, nameSize);
+
+	const auto sessionId = static_cast<uint32_t>(sessions.size());
+	uint32_t time;
+	uint16_t size;
+	// a capture cut short by a crash simply ends at its last complete packet
+	while (reader.read(time) && reader.read(size)) {
+		const auto offset = static_cast<uint32_t>(reader.getPosition());
+		if (!reader.skip(size)) {
+			break;
+		}
+
+		if (size > 0 && size <= NetworkMessage::MAX_BODY_LENGTH) {
+			packets.push_back({ time, sessionId, offset, size });
+		}
+	}
+
+	sessions.push_back(std::move(session));
+	return true;
+}
+
+bool PacketReplay::waitUntil(std::chrono::steady_clock::time_point time)
+{
+	// short naps, so a shutdown does not wait for the next packet
+	while (getState() == THREAD_STATE_RUNNING) {
+		const auto now = std::chrono::steady_clock::now();
+		if (now >= time) {
+			return true;
+		}
+
+		std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(time - now, std::chrono::milliseconds(100)));
+	}
+	return false;
+}
+
+void PacketReplay::finish(Session& session)
+{
+	// same as the client closing its connection
+	addDispatcherTask([protocol = std::move(session.protocol)]() { protocol->release(); });
+}
+
+void PacketReplay::threadMain()
+{
+	// every session is logged in before the first packet, recorded packets only make sense for a placed player
+	auto protocols = std::make_shared<std::vector<ProtocolGame_ptr>>();
+	for (Session& session : sessions) {
+		session.protocol = std::make_shared<ProtocolGame>(nullptr);
+		session.protocol->m_replay = true;
+		protocols->push_back(session.protocol);
+		addDispatcherTask(([protocol = session.protocol, header = session.header]() {
+			protocol->login(header.name, header.accountId, header.operatingSystem, header.version, header.gamemaster);
+		}));
+	}
+
+	// a login may finish in a later dispatcher task, and acceptPackets belongs to the dispatcher, so it is counted there
+	auto loggedIn = std::make_shared<std::atomic<uint32_t>>(0);
+	const auto loginDeadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+	while (waitUntil(std::min(loginDeadline, std::chrono::steady_clock::now() + std::chrono::milliseconds(10)))) {
+		if (*loggedIn == sessions.size() || std::chrono::steady_clock::now() >= loginDeadline) {
+			break;
+		}
+
+		addDispatcherTask(([protocols, loggedIn]() {
+			*loggedIn = std::count_if(protocols->begin(), protocols->end(), [](const ProtocolGame_ptr& protocol) { return protocol->acceptPackets; });
+		}));
+	}
+
+	std::clog << ">> Replaying " << packets.size() << " packets, " << *loggedIn << " of " << sessions.size() << " characters logged in." << std::endl;
+
+	// every few packets a probe measures how long the dispatcher takes to get to a new task
+	auto latency = std::make_shared<std::atomic<int64_t>>(0);
+	auto probes = std::make_shared<std::atomic<uint32_t>>(0);
+
+	NetworkMessage msg;
+	uint32_t replayed = 0;
+
+	const auto start = std::chrono::steady_clock::now();
+	for (uint32_t i = 0; i < packets.size(); ++i) {
+		const Packet& packet = packets[i];
+		if (speed > 0 && !waitUntil(start + std::chrono::microseconds(static_cast<int64_t>(packet.time * 1000 / speed)))) {
+			break;
+		}
+
+		Session& session = sessions[packet.session];
+		msg.reset();
+		std::memcpy(msg.getBuffer() + NetworkMessage::INITIAL_BUFFER_POSITION, session.data.data() + packet.offset, packet.size);
+		msg.setLength(packet.size);
+
+		// as the network thread would, the protocol takes it from here
+		static_cast<Protocol&>(*session.protocol).parsePacket(msg);
+		++replayed;
+
+		if (session.lastPacket == i) {
+			finish(session);
+		}
+
+		if (replayed % 64 == 0) {
+			addDispatcherTask(([latency, probes, posted = std::chrono::steady_clock::now()]() {
+				*latency += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - posted).count();
+				++*probes;
+			}));
+		}
+	}
+
+	const auto sent = std::chrono::steady_clock::now();
+	for (Session& session : sessions) {
+		if (session.protocol) {
+			finish(session);
+		}
+	}
+
+	if (getState() != THREAD_STATE_RUNNING) {
+		return;
+	}
+
+	// the run is over once the dispatcher went through everything the packets queued
+	auto drained = std::make_shared<std::promise<void>>();
+	addDispatcherTask([drained]() { drained->set_value(); });
+	drained->get_future().wait_for(std::chrono::seconds(30));
+
+	const auto end = std::chrono::steady_clock::now();
+	std::clog << ">> Replay finished: " << replayed << " packets in "
+			  << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() << " ms, dispatcher done "
+			  << std::chrono::duration_cast<std::chrono::milliseconds>(end - sent).count() << " ms after the last packet, avg latency "
+			  << (*probes ? *latency / *probes : 0) << " us." << std::endl;
+}
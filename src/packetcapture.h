@@ -0,0 +1,129 @@
+////////////////////////////////////////////////////////////////////////
+// OpenTibia - an opensource roleplaying game
+////////////////////////////////////////////////////////////////////////
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "const.h"
+#include "thread_holder_base.h"
+
+class ProtocolGame;
+using ProtocolGame_ptr = std::shared_ptr<ProtocolGame>;
+
+/*
+ * Capture file layout, little endian:
+ *   "OTXC", u16 format version, u64 start (unix ms), u32 account id, u16 client version,
+ *   u16 operating system, u8 gamemaster, u16 + character name
+ * followed by one record per packet the client sent, after decryption:
+ *   u32 milliseconds since the start, u16 size, payload
+ * The login packet with the account password and session key is not part of it, and
+ * account or namelock manager sessions, which take passwords as chat, are not captured.
+ */
+static constexpr uint32_t PACKET_CAPTURE_MAGIC = 0x4358544F; // "OTXC"
+static constexpr uint16_t PACKET_CAPTURE_VERSION = 1;
+
+struct PacketCaptureHeader
+{
+	std::string name;
+	int64_t start = 0;
+	uint32_t accountId = 0;
+	uint16_t version = 0;
+	OperatingSystem_t operatingSystem = CLIENTOS_WINDOWS;
+	bool gamemaster = false;
+};
+
+// Records the packets of a single game connection, written by the network thread
+class PacketCapture
+{
+public:
+	~PacketCapture();
+
+	// non-copyable
+	PacketCapture(const PacketCapture&) = delete;
+	PacketCapture& operator=(const PacketCapture&) = delete;
+
+	// a new file in the packetCaptureDirectory, null when capturing is off or the file cannot be created
+	static std::unique_ptr<PacketCapture> open(const PacketCaptureHeader& header);
+
+	void addPacket(const uint8_t* data, uint16_t size);
+
+private:
+	PacketCapture(FILE* file, std::chrono::steady_clock::time_point start) :
+		m_file(file),
+		m_start(start) {}
+
+	template<typename T>
+	void write(T value) {
+		const auto bytes = reinterpret_cast<const uint8_t*>(&value);
+		m_buffer.insert(m_buffer.end(), bytes, bytes + sizeof(T));
+	}
+
+	void flush();
+
+	FILE* m_file;
+	std::chrono::steady_clock::time_point m_start;
+	std::vector<uint8_t> m_buffer;
+};
+
+// Plays capture files back against the running server: every session gets a
+// ProtocolGame without a connection, whatever the server sends is discarded
+class PacketReplay final : public ThreadHolder<PacketReplay>
+{
+public:
+	PacketReplay() = default;
+
+	// non-copyable
+	PacketReplay(const PacketReplay&) = delete;
+	PacketReplay& operator=(const PacketReplay&) = delete;
+
+	// a capture file or a directory of them, set from the command line
+	void setPath(const std::string& path) { this->path = path; }
+	// scales the recorded delays, 0 sends every packet without waiting
+	void setSpeed(double speed) { this->speed = std::max(0., speed); }
+	bool isEnabled() const { return !path.empty(); }
+
+	bool load();
+
+	void threadMain();
+
+private:
+	struct Packet
+	{
+		int64_t time; // milliseconds since the earliest session started
+		uint32_t session;
+		uint32_t offset; // into the session data
+		uint16_t size;
+	};
+
+	struct Session
+	{
+		PacketCaptureHeader header;
+		std::vector<uint8_t> data;
+		ProtocolGame_ptr protocol;
+		uint32_t lastPacket = 0;
+	};
+
+	bool loadFile(const std::string& path);
+	bool waitUntil(std::chrono::steady_clock::time_point time);
+	void finish(Session& session);
+
+	std::vector<Session> sessions;
+	std::vector<Packet> packets;
+	std::string path;
+	double speed = 1.;
+};
+
+extern PacketReplay g_packetReplay;
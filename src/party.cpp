@@ -26,7 +26,7 @@
 #include "otx/util.hpp"
 
 Party::CountBlock_t::CountBlock_t(int32_t heal, int32_t damage) :
-	ticks(otx::util::mstime()),
+	ticks(otx::util::ticks()),
 	totalHeal(heal),
 	totalDamage(damage)
 {
@@ -441,7 +441,7 @@ bool Party::canUseSharedExperience(const Player* player, uint32_t highestLevel /
 	}
 
 	CountMap::const_iterator it = pointMap.find(player->getID());
-	return it != pointMap.end() && (otx::util::mstime() - it->second.ticks) <= otx::config::getInteger(otx::config::EXPERIENCE_SHARE_ACTIVITY);
+	return it != pointMap.end() && (otx::util::ticks() - it->second.ticks) <= otx::config::getInteger(otx::config::EXPERIENCE_SHARE_ACTIVITY);
 }
 
 bool Party::canEnableSharedExperience()
@@ -471,7 +471,7 @@ void Party::addPlayerHealedMember(Player* player, uint32_t points)
 	CountMap::iterator it = pointMap.find(player->getID());
 	if (it != pointMap.end()) {
 		it->second.totalHeal += points;
-		it->second.ticks = otx::util::mstime();
+		it->second.ticks = otx::util::ticks();
 	} else {
 		pointMap[player->getID()] = CountBlock_t(points, 0);
 	}
@@ -484,7 +484,7 @@ void Party::addPlayerDamageMonster(Player* player, uint32_t points)
 	CountMap::iterator it = pointMap.find(player->getID());
 	if (it != pointMap.end()) {
 		it->second.totalDamage += points;
-		it->second.ticks = otx::util::mstime();
+		it->second.ticks = otx::util::ticks();
 	} else {
 		pointMap[player->getID()] = CountBlock_t(0, points);
 	}
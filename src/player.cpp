@@ -60,7 +60,7 @@ Player::Player(const std::string& name, ProtocolGame_ptr p) :
 	m_name(name),
 	m_nameDescription(name),
 	m_client(new Spectators(p)),
-	m_lastLoad(otx::util::mstime()),
+	m_lastLoad(otx::util::ticks()),
 	m_lastPong(m_lastLoad),
 	m_lastPing(m_lastLoad),
 	m_lastAttack(m_lastLoad),
@@ -428,7 +428,7 @@ float Player::getDefenseFactor() const
 			return 1.2f;
 
 		case FIGHTMODE_DEFENSE: {
-			if ((otx::util::mstime() - m_lastAttack) < getAttackSpeed()) { // attacking will cause us to get into normal defense
+			if ((otx::util::ticks() - m_lastAttack) < getAttackSpeed()) { // attacking will cause us to get into normal defense
 				return 1.0f;
 			}
 
@@ -1576,6 +1576,8 @@ void Player::onCreatureDisappear(const Creature* creature, bool isLogout)
 
 	if (!saved) {
 		std::clog << "Error while saving player: " << getName() << "." << std::endl;
+	} else if (otx::config::getBoolean(otx::config::PLAYER_SNAPSHOT_EXPORT) && !IOLoginData::getInstance()->exportPlayer(this)) {
+		std::clog << "Error while exporting player: " << getName() << "." << std::endl;
 	}
 }
 
@@ -1639,7 +1641,7 @@ void Player::onWalk(Direction& dir)
 {
 	Creature::onWalk(dir);
 	setNextActionTask(nullptr);
-	setNextAction(otx::util::mstime() + getStepDuration(dir));
+	setNextAction(otx::util::ticks() + getStepDuration(dir));
 }
 
 void Player::onCreatureMove(const Creature* creature, const Tile* newTile, const Position& newPos,
@@ -1826,31 +1828,31 @@ void Player::setNextActionTask(SchedulerTaskPtr task)
 
 bool Player::canDoAction() const
 {
-	return m_nextAction <= otx::util::mstime();
+	return m_nextAction <= otx::util::ticks();
 }
 
 uint32_t Player::getNextActionTime(bool scheduler /* = true*/) const
 {
 	if (!scheduler) {
-		return std::max<int64_t>(0, m_nextAction - otx::util::mstime());
+		return std::max<int64_t>(0, m_nextAction - otx::util::ticks());
 	}
-	return std::max<int64_t>(SCHEDULER_MINTICKS, m_nextAction - otx::util::mstime());
+	return std::max<int64_t>(SCHEDULER_MINTICKS, m_nextAction - otx::util::ticks());
 }
 
 bool Player::canDoExAction() const
 {
-	return m_nextExAction <= otx::util::mstime();
+	return m_nextExAction <= otx::util::ticks();
 }
 
 void Player::receivePing()
 {
-	m_lastPong = otx::util::mstime();
+	m_lastPong = otx::util::ticks();
 }
 
 void Player::onThink(uint32_t interval)
 {
 	Creature::onThink(interval);
-	int64_t timeNow = otx::util::mstime();
+	int64_t timeNow = otx::util::ticks();
 	if (timeNow - m_lastPing >= 5000) {
 		m_lastPing = timeNow;
 		if (hasClient()) {
@@ -1879,7 +1881,7 @@ void Player::onThink(uint32_t interval)
 		addMessageBuffer();
 	}
 
-	if (m_lastMail != 0 && m_lastMail < (otx::util::mstime() + otx::config::getInteger(otx::config::MAIL_ATTEMPTS_FADE))) {
+	if (m_lastMail != 0 && m_lastMail < (otx::util::ticks() + otx::config::getInteger(otx::config::MAIL_ATTEMPTS_FADE))) {
 		m_mailAttempts = m_lastMail = 0;
 	}
 
@@ -1897,15 +1899,19 @@ bool Player::isMuted(uint16_t channelId, MessageType_t type, int32_t& time)
 	}
 
 	int32_t muteTicks = 0;
-	for (ConditionList::iterator it = m_conditions.begin(); it != m_conditions.end(); ++it) {
-		if ((*it)->getType() == CONDITION_MUTED && (*it)->getSubId() == 0) {
-			if ((*it)->getTicks() == -1) {
+	if (hasConditionType(CONDITION_MUTED)) {
+		for (const Condition* condition : m_conditions) {
+			if (condition->getType() != CONDITION_MUTED || condition->getSubId() != 0) {
+				continue;
+			}
+
+			if (condition->getTicks() == -1) {
 				time = -1;
 				break;
 			}
 
-			if ((*it)->getTicks() > muteTicks) {
-				muteTicks = (*it)->getTicks();
+			if (condition->getTicks() > muteTicks) {
+				muteTicks = condition->getTicks();
 			}
 		}
 	}
@@ -2356,7 +2362,7 @@ bool Player::onDeath()
 
 	uint32_t totalDamage = 0, pvpDamage = 0, opponents = 0;
 	for (CountMap::iterator it = m_damageMap.begin(); it != m_damageMap.end(); ++it) {
-		if (((otx::util::mstime() - it->second.ticks) / 1000) > otx::config::getInteger(otx::config::FAIRFIGHT_TIMERANGE)) {
+		if (((otx::util::ticks() - it->second.ticks) / 1000) > otx::config::getInteger(otx::config::FAIRFIGHT_TIMERANGE)) {
 			continue;
 		}
 
@@ -2928,7 +2934,7 @@ ReturnValue Player::__queryAdd(int32_t index, const Thing* thing, uint32_t count
 
 	if (index == SLOT_LEFT || index == SLOT_RIGHT) {
 		if (ret == RET_NOERROR && item->getWeaponType() != WEAPON_NONE) {
-			self->setLastAttack(otx::util::mstime());
+			self->setLastAttack(otx::util::ticks());
 		}
 
 		Item* tmpItem = m_inventory[index];
@@ -3186,6 +3192,7 @@ void Player::__addThing(Creature*, int32_t index, Thing* thing)
 
 	item->setParent(this);
 	m_inventory[index] = item;
+	m_inventoryIndex.addItem(item);
 
 	// send to client
 	sendAddInventoryItem(index, item);
@@ -3203,8 +3210,10 @@ void Player::__updateThing(Thing* thing, uint16_t itemId, uint32_t count)
 		return /*RET_NOTPOSSIBLE*/;
 	}
 
+	m_inventoryIndex.removeItem(item, false);
 	item->setID(itemId);
 	item->setSubType(count);
+	m_inventoryIndex.addItem(item, false);
 
 	// send to client
 	sendUpdateInventoryItem(index, item);
@@ -3238,6 +3247,8 @@ void Player::__replaceThing(uint32_t index, Thing* thing)
 	item->setParent(this);
 
 	m_inventory[index] = item;
+	m_inventoryIndex.removeItem(oldItem);
+	m_inventoryIndex.addItem(item);
 }
 
 void Player::__removeThing(Thing* thing, uint32_t count)
@@ -3260,10 +3271,13 @@ void Player::__removeThing(Thing* thing, uint32_t count)
 			// event methods
 			onRemoveInventoryItem(item);
 
+			m_inventoryIndex.removeItem(item);
 			item->setParent(nullptr);
 			m_inventory[index] = nullptr;
 		} else {
+			m_inventoryIndex.removeItem(item, false);
 			item->setItemCount(std::max<int32_t>(0, item->getItemCount() - count));
+			m_inventoryIndex.addItem(item, false);
 
 			// send change to client
 			sendUpdateInventoryItem(index, item);
@@ -3278,6 +3292,7 @@ void Player::__removeThing(Thing* thing, uint32_t count)
 		// event methods
 		onRemoveInventoryItem(item);
 
+		m_inventoryIndex.removeItem(item);
 		item->setParent(nullptr);
 		m_inventory[index] = nullptr;
 	}
@@ -3313,8 +3328,55 @@ int32_t Player::__getLastIndex() const
 	return SLOT_LAST + 1;
 }
 
+uint32_t InventoryIndex::getItemTypeCount(uint16_t itemId) const
+{
+	auto it = m_counts.find(itemId);
+	if (it == m_counts.end()) {
+		return 0;
+	}
+	return it->second;
+}
+
+void InventoryIndex::update(const Item* item, int32_t sign, bool recursive)
+{
+	const Container* container = item->getContainer();
+	update(item->getID(), item->getItemCount(), container ? 0 : item->getWorth(), sign);
+	if (!recursive || !container) {
+		return;
+	}
+
+	for (ContainerIterator it = container->iterator(); it.hasNext(); it.advance()) {
+		const Item* containerItem = *it;
+		update(containerItem->getID(), containerItem->getItemCount(), containerItem->getContainer() ? 0 : containerItem->getWorth(), sign);
+	}
+}
+
+void InventoryIndex::update(uint16_t itemId, uint32_t count, int64_t worth, int32_t sign)
+{
+	m_money += sign * worth;
+	if (sign > 0) {
+		m_counts[itemId] += count;
+		return;
+	}
+
+	auto it = m_counts.find(itemId);
+	if (it == m_counts.end()) {
+		return;
+	}
+
+	if (it->second <= count) {
+		m_counts.erase(it);
+	} else {
+		it->second -= count;
+	}
+}
+
 uint32_t Player::__getItemTypeCount(uint16_t itemId, int32_t subType /*= -1*/) const
 {
+	if (subType == -1) {
+		return m_inventoryIndex.getItemTypeCount(itemId);
+	}
+
 	Item* item = nullptr;
 	Container* container = nullptr;
 
@@ -3344,24 +3406,23 @@ uint32_t Player::__getItemTypeCount(uint16_t itemId, int32_t subType /*= -1*/) c
 
 std::map<uint32_t, uint32_t>& Player::__getAllItemTypeCount(std::map<uint32_t, uint32_t>& countMap) const
 {
-	Item* item = nullptr;
-	Container* container = nullptr;
-	for (int32_t i = SLOT_FIRST; i <= SLOT_LAST; ++i) {
-		if (!(item = m_inventory[i])) {
-			continue;
-		}
+	for (const auto& it : m_inventoryIndex.getItemTypeCounts()) {
+		countMap[it.first] += it.second;
+	}
 
-		countMap[item->getID()] += Item::countByType(item, -1);
-		if (!(container = item->getContainer())) {
-			continue;
-		}
+	return countMap;
+}
 
-		for (ContainerIterator it = container->iterator(); it.hasNext(); it.advance()) {
-			countMap[(*it)->getID()] += Item::countByType(*it, -1);
+bool Player::checkInventoryIndex() const
+{
+	InventoryIndex index;
+	for (int32_t i = SLOT_FIRST; i <= SLOT_LAST; ++i) {
+		if (m_inventory[i]) {
+			index.addItem(m_inventory[i]);
 		}
 	}
 
-	return countMap;
+	return index == m_inventoryIndex;
 }
 
 void Player::postAddNotification(Creature*, Thing* thing, const Cylinder* oldParent,
@@ -3489,6 +3550,7 @@ void Player::__internalAddThing(uint32_t index, Thing* thing)
 
 	m_inventory[index] = item;
 	item->setParent(this);
+	m_inventoryIndex.addItem(item);
 }
 
 bool Player::setFollowCreature(Creature* creature, bool fullPathSearch /*= false*/)
@@ -3554,7 +3616,7 @@ void Player::getPathSearchParams(const Creature* creature, FindPathParams& fpp)
 
 void Player::doAttacking(uint32_t)
 {
-	const int64_t timeNow = otx::util::mstime();
+	const int64_t timeNow = otx::util::ticks();
 	const uint32_t attackSpeed = getAttackSpeed();
 	if (attackSpeed == 0 || (hasCondition(CONDITION_PACIFIED) && !hasCustomFlag(PlayerCustomFlag_IgnorePacification))) {
 		m_lastAttack = timeNow;
@@ -3588,7 +3650,7 @@ void Player::doAttacking(uint32_t)
 
 bool Player::hasExtraSwing()
 {
-	return m_lastAttack > 0 && ((otx::util::mstime() - m_lastAttack) >= getAttackSpeed());
+	return m_lastAttack > 0 && ((otx::util::ticks() - m_lastAttack) >= getAttackSpeed());
 }
 
 double Player::getGainedExperience(Creature* attacker) const
@@ -3899,7 +3961,7 @@ void Player::onAttacked()
 
 bool Player::checkLoginDelay() const
 {
-	return (!hasCustomFlag(PlayerCustomFlag_IgnoreLoginDelay) && otx::util::mstime() <= (m_lastLoad + otx::config::getInteger(otx::config::LOGIN_PROTECTION)));
+	return (!hasCustomFlag(PlayerCustomFlag_IgnoreLoginDelay) && otx::util::ticks() <= (m_lastLoad + otx::config::getInteger(otx::config::LOGIN_PROTECTION)));
 }
 
 void Player::onIdleStatus()
@@ -4050,8 +4112,10 @@ bool Player::onKilledCreature(Creature* target, DeathEntry& entry)
 
 	War_t enemy;
 	if (targetPlayer->getEnemy(this, enemy)) {
-		if (entry.isLast()) {
-			IOGuild::getInstance()->updateWar(enemy);
+		if (entry.isLast() && !IOGuild::getInstance()->updateWar(enemy)) {
+			// the war is still being loaded, the kill is recorded with the two guilds and scored later
+			enemy.ids[enemy.type] = m_guildId;
+			enemy.ids[enemy.type == WAR_GUILD ? WAR_ENEMY : WAR_GUILD] = targetPlayer->getGuildId();
 		}
 
 		entry.setWar(enemy);
@@ -78,6 +78,28 @@ struct OutfitEntry
 	uint8_t addons = 0;
 };
 
+// item id -> count and the money of everything a player carries, kept up to
+// date by the cylinder methods of the player and the containers it holds
+class InventoryIndex
+{
+public:
+	void addItem(const Item* item, bool recursive = true) { update(item, 1, recursive); }
+	void removeItem(const Item* item, bool recursive = true) { update(item, -1, recursive); }
+
+	uint32_t getItemTypeCount(uint16_t itemId) const;
+	uint64_t getMoney() const { return m_money; }
+	const std::unordered_map<uint16_t, uint32_t>& getItemTypeCounts() const { return m_counts; }
+
+	bool operator==(const InventoryIndex& other) const { return m_money == other.m_money && m_counts == other.m_counts; }
+
+private:
+	void update(const Item* item, int32_t sign, bool recursive);
+	void update(uint16_t itemId, uint32_t count, int64_t worth, int32_t sign);
+
+	std::unordered_map<uint16_t, uint32_t> m_counts;
+	int64_t m_money = 0;
+};
+
 typedef std::set<uint32_t> VIPSet;
 typedef std::list<std::pair<uint16_t, std::string>> ChannelsList;
 typedef std::vector<std::pair<uint32_t, Container*>> ContainerVector;
@@ -995,6 +1017,11 @@ public:
 	uint32_t __getItemTypeCount(uint16_t itemId, int32_t subType = -1) const override;
 	std::map<uint32_t, uint32_t>& __getAllItemTypeCount(std::map<uint32_t, uint32_t>& countMap) const override;
 
+	InventoryIndex& getInventoryIndex() { return m_inventoryIndex; }
+	uint64_t getMoney() const { return m_inventoryIndex.getMoney(); }
+	// rebuilds the index from scratch and compares, for debugging
+	bool checkInventoryIndex() const;
+
 	VIPSet m_VIPList;
 	ContainerVector m_containerVec;
 	InvitationsList m_invitationsList;
@@ -1114,6 +1141,7 @@ private:
 	House* m_editHouse = nullptr;
 	Npc* m_shopOwner = nullptr;
 	Item* m_inventory[SLOT_LAST + 1] = {};
+	InventoryIndex m_inventoryIndex;
 
 	double m_inventoryWeight = 0.0;
 	double m_capacity = 400.0;
@@ -0,0 +1,160 @@
+////////////////////////////////////////////////////////////////////////
+// OpenTibia - an opensource roleplaying game
+////////////////////////////////////////////////////////////////////////
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "const.h"
+#include "position.h"
+
+enum PlayerCommand_t : uint8_t
+{
+	PLAYERCOMMAND_NONE = 0,
+	PLAYERCOMMAND_LOGOUT,
+	PLAYERCOMMAND_PING,
+	PLAYERCOMMAND_MOVE, // count: direction
+	PLAYERCOMMAND_STOP_AUTOWALK,
+	PLAYERCOMMAND_TURN, // count: direction
+	PLAYERCOMMAND_THROW, // fromPos, spriteId, stackpos, toPos, count
+	PLAYERCOMMAND_LOOK_IN_SHOP, // spriteId, count
+	PLAYERCOMMAND_PURCHASE, // spriteId, count, amount, flag: ignore cap, secondFlag: in backpacks
+	PLAYERCOMMAND_SALE, // spriteId, count, amount, flag: ignore equipped
+	PLAYERCOMMAND_CLOSE_SHOP,
+	PLAYERCOMMAND_REQUEST_TRADE, // fromPos, spriteId, stackpos, id: partner
+	PLAYERCOMMAND_LOOK_IN_TRADE, // flag: counter offer, stackpos: index
+	PLAYERCOMMAND_ACCEPT_TRADE,
+	PLAYERCOMMAND_CLOSE_TRADE,
+	PLAYERCOMMAND_USE_ITEM, // fromPos, spriteId, stackpos, count: index, flag: hotkey
+	PLAYERCOMMAND_USE_ITEM_EX, // fromPos, spriteId, stackpos, toPos, toSpriteId, toStackpos, flag: hotkey
+	PLAYERCOMMAND_BATTLE_WINDOW, // fromPos, spriteId, stackpos, id: creature, flag: hotkey
+	PLAYERCOMMAND_ROTATE_ITEM, // fromPos, spriteId, stackpos
+	PLAYERCOMMAND_CLOSE_CONTAINER, // count: container id
+	PLAYERCOMMAND_UP_ARROW_CONTAINER, // count: container id
+	PLAYERCOMMAND_UPDATE_CONTAINER, // count: container id
+	PLAYERCOMMAND_UPDATE_TILE, // fromPos
+	PLAYERCOMMAND_LOOK_AT, // fromPos, spriteId, stackpos
+	PLAYERCOMMAND_LOOK_IN_BATTLE_LIST, // id: creature
+	PLAYERCOMMAND_GET_CHANNELS,
+	PLAYERCOMMAND_CLOSE_CHANNEL, // spriteId: channel id
+	PLAYERCOMMAND_CLOSE_NPC_CHANNEL,
+	PLAYERCOMMAND_CREATE_PRIVATE_CHANNEL,
+	PLAYERCOMMAND_CANCEL_RULE_VIOLATION,
+	PLAYERCOMMAND_FIGHT_MODES, // count: fight mode, flag: chase, secondFlag: secure
+	PLAYERCOMMAND_ATTACK, // id: creature
+	PLAYERCOMMAND_FOLLOW, // id: creature
+	PLAYERCOMMAND_CANCEL_ATTACK_AND_FOLLOW,
+	PLAYERCOMMAND_INVITE_TO_PARTY, // id: target
+	PLAYERCOMMAND_JOIN_PARTY, // id: target
+	PLAYERCOMMAND_REVOKE_PARTY_INVITE, // id: target
+	PLAYERCOMMAND_PASS_PARTY_LEADERSHIP, // id: target
+	PLAYERCOMMAND_LEAVE_PARTY,
+	PLAYERCOMMAND_SHARE_PARTY_EXPERIENCE, // flag: activate
+	PLAYERCOMMAND_REQUEST_OUTFIT,
+	PLAYERCOMMAND_SET_OUTFIT, // outfit
+	PLAYERCOMMAND_REMOVE_VIP, // id: guid
+	PLAYERCOMMAND_QUESTS,
+	PLAYERCOMMAND_QUEST_INFO, // spriteId: quest id
+};
+
+// A client packet already decoded by the network thread, the meaning of each
+// field depends on the type (see above); it is copied around by value only
+struct PlayerCommand
+{
+	PlayerCommand_t type = PLAYERCOMMAND_NONE;
+	bool batchStart = false, flag = false, secondFlag = false;
+
+	uint8_t count = 0, amount = 0;
+	uint16_t spriteId = 0, toSpriteId = 0;
+	int16_t stackpos = 0, toStackpos = 0;
+	uint32_t id = 0;
+
+	Position fromPos, toPos;
+	Outfit_t outfit;
+
+	// zero when the command does not expire, like an untimed dispatcher task
+	std::chrono::steady_clock::time_point expiration;
+};
+
+static_assert(std::is_trivially_copyable<PlayerCommand>::value, "PlayerCommand must stay a plain value");
+
+// Bounded ring of the commands received from a single client; the network
+// thread pushes and the dispatcher pops them in batches, a batch being
+// everything received between two out of band dispatcher tasks
+class PlayerCommandQueue
+{
+public:
+	explicit PlayerCommandQueue(size_t capacity) : m_commands(std::max<size_t>(capacity, 1)) {}
+
+	// non-copyable
+	PlayerCommandQueue(const PlayerCommandQueue&) = delete;
+	PlayerCommandQueue& operator=(const PlayerCommandQueue&) = delete;
+
+	enum PushResult_t : uint8_t
+	{
+		PUSH_QUEUED,
+		PUSH_SCHEDULE, // queued as the first command of a new batch, the caller has to schedule it
+		PUSH_FULL,
+	};
+
+	PushResult_t push(PlayerCommand& command) {
+		std::lock_guard<std::mutex> lockClass(m_lock);
+		if (m_size == m_commands.size()) {
+			return PUSH_FULL;
+		}
+
+		command.batchStart = !m_batchPending;
+		m_commands[(m_head + m_size++) % m_commands.size()] = command;
+		if (!command.batchStart) {
+			return PUSH_QUEUED;
+		}
+
+		m_batchPending = true;
+		return PUSH_SCHEDULE;
+	}
+
+	// closes the current batch, so commands arriving after a task that is
+	// scheduled out of band are executed after it
+	void seal() {
+		std::lock_guard<std::mutex> lockClass(m_lock);
+		m_batchPending = false;
+	}
+
+	// pops the next command of the batch being drained, first tells whether
+	// it is the first call for that batch
+	bool pop(PlayerCommand& command, bool first) {
+		std::lock_guard<std::mutex> lockClass(m_lock);
+		if (m_size == 0) {
+			m_batchPending = false;
+			return false;
+		}
+
+		const PlayerCommand& next = m_commands[m_head];
+		if (next.batchStart && !first) {
+			return false;
+		}
+
+		command = next;
+		m_head = (m_head + 1) % m_commands.size();
+		--m_size;
+		return true;
+	}
+
+private:
+	std::mutex m_lock;
+	std::vector<PlayerCommand> m_commands;
+	size_t m_head = 0, m_size = 0;
+	bool m_batchPending = false;
+};
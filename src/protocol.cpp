@@ -83,8 +83,10 @@ void Protocol::onRecvMessage(NetworkMessage& msg)
 
 OutputMessage_ptr Protocol::getOutputBuffer()
 {
+	// dispatcher thread
 	if (!m_outputBuffer) {
 		m_outputBuffer = OutputMessagePool::getOutputMessage();
+		OutputMessagePool::getInstance().addPendingProtocol(shared_from_this());
 	}
 	return m_outputBuffer;
 }
@@ -92,13 +94,10 @@ OutputMessage_ptr Protocol::getOutputBuffer()
 OutputMessage_ptr Protocol::getOutputBuffer(int32_t size)
 {
 	// dispatcher thread
-	if (!m_outputBuffer) {
-		m_outputBuffer = OutputMessagePool::getOutputMessage();
-	} else if ((m_outputBuffer->getLength() + size) > NetworkMessage::MAX_PROTOCOL_BODY_LENGTH) {
-		send(m_outputBuffer);
-		m_outputBuffer = OutputMessagePool::getOutputMessage();
+	if (m_outputBuffer && (m_outputBuffer->getLength() + size) > NetworkMessage::MAX_PROTOCOL_BODY_LENGTH) {
+		OutputMessagePool::getInstance().send(*this, OUTPUTFLUSH_FULL);
 	}
-	return m_outputBuffer;
+	return getOutputBuffer();
 }
 
 bool Protocol::RSA_decrypt(NetworkMessage& msg)
@@ -107,7 +106,10 @@ bool Protocol::RSA_decrypt(NetworkMessage& msg)
 		return false;
 	}
 
-	g_RSA.decrypt(reinterpret_cast<char*>(msg.getBuffer()) + msg.getBufferPosition()); //does not break strict aliasing
+	// the block might have been decrypted already by the RSA workers
+	if (!m_rsaDecrypted) {
+		g_RSA.decrypt(reinterpret_cast<char*>(msg.getBuffer()) + msg.getBufferPosition()); //does not break strict aliasing
+	}
 	return msg.getByte() == 0;
 }
 
@@ -37,6 +37,9 @@ public:
 	virtual void onRecvFirstMessage(NetworkMessage& msg) = 0;
 	virtual void onConnect() {}
 
+	// offset of the RSA block in the first message, -1 if it has none
+	virtual int32_t getRSABlockOffset() const { return -1; }
+
 	bool isConnectionExpired() const { return m_connection.expired(); }
 
 	Connection_ptr getConnection() const { return m_connection.lock(); }
@@ -47,8 +50,6 @@ public:
 	OutputMessage_ptr getOutputBuffer();
 	OutputMessage_ptr getOutputBuffer(int32_t size);
 
-	OutputMessage_ptr& getCurrentBuffer() { return m_outputBuffer; }
-
 	void send(OutputMessage_ptr msg) const {
 		if (auto connection = getConnection()) {
 			connection->send(msg);
@@ -66,7 +67,7 @@ protected:
 	void setXTEAKey(otx::xtea::key&& key) { m_key = otx::xtea::expand_key(std::move(key)); }
 	void disableChecksum() { m_checksumEnabled = false; }
 
-	static bool RSA_decrypt(NetworkMessage& msg);
+	bool RSA_decrypt(NetworkMessage& msg);
 
 	void setRawMessages(bool value) { m_rawMessages = value; }
 
@@ -81,6 +82,13 @@ private:
 	bool m_encryptionEnabled{ false };
 	bool m_checksumEnabled{ true };
 	bool m_rawMessages{ false };
+	bool m_rsaDecrypted{ false };
+
+	// dispatcher thread, owned by OutputMessagePool
+	bool m_autosend{ false };
+	bool m_pendingFlush{ false };
+	bool m_batchFlush{ false };
 
 	friend class Connection;
+	friend class OutputMessagePool;
 };
@@ -23,6 +23,7 @@
 #include "configmanager.h"
 #include "connection.h"
 #include "creatureevent.h"
+#include "databasetasks.h"
 #include "game.h"
 #include "house.h"
 #include "ioban.h"
@@ -39,6 +40,11 @@
 
 #if ENABLE_SERVER_DIAGNOSTIC > 0
 uint32_t ProtocolGame::protocolGameCount = 0;
+uint64_t ProtocolGame::loginCount = 0;
+uint64_t ProtocolGame::loginTime = 0;
+uint64_t ProtocolGame::commandCount = 0;
+uint64_t ProtocolGame::commandBatches = 0;
+uint64_t ProtocolGame::commandsDropped = 0;
 #endif
 
 namespace WaitList
@@ -332,190 +338,238 @@ void ProtocolGame::login(const std::string& name, uint32_t id,
 	// dispatcher thread
 	Player* foundPlayer = g_game.getPlayerByName(name);
 	if (!foundPlayer || (otx::config::getBoolean(otx::config::ACCOUNT_MANAGER) && name == "Account Manager")) {
-		player = new Player(name, getThis());
-		player->addRef();
+		// the queries run on the database thread, building and placing the player is all that is left for the dispatcher
+		auto data = std::make_shared<PlayerLoadData>();
+		const uint32_t prefetch = IOLoginData::getInstance()->beginPrefetch(name);
+		g_databaseTasks.addReadTask(
+			[data, name](Database& database) { return IOLoginData::getInstance()->prefetchPlayer(database, name, *data); },
+			[=, self = getThis()](DBResultPtr, bool success) {
+				if (!IOLoginData::getInstance()->finishPrefetch(name, prefetch)) {
+					// saved offline while we were reading, e.g. a mail; read it again rather than apply the old copy
+					self->login(name, id, operatingSystem, version, gamemaster);
+					return;
+				}
 
-		player->setID();
+				if (!success) {
+					self->disconnectClient(0x14, "Your character could not be loaded.");
+					return;
+				}
 
-		if (!IOLoginData::getInstance()->loadPlayer(player, name, true)) {
-			disconnectClient(0x14, "Your character could not be loaded.");
-			return;
-		}
+				self->login(name, id, operatingSystem, version, gamemaster, *data);
+			});
+		return;
+	}
 
-		// check exist after load, need this to get groupId
-		if (g_game.existMonsterByName(name) && player->getGroupId() == 1) {
-			bool deleteMonsterName = otx::config::getBoolean(otx::config::DELETE_PLAYER_MONSTER_NAME);
-			if (deleteMonsterName && IOLoginData::getInstance()->deletePlayer(player)) {
-				disconnectClient(0x14, "This character was deleted because it contains invalid characters in its name.");
-			} else {
-				if (IOLoginData::getInstance()->setName(player, generateRandomName(random_range(7, 12)))) {
-					disconnectClient(0x14, "you were disconnected because your name contains invalid characters, your name will be changed randomly.");
-				}
-			}
-			return;
-		}
+	if (eventConnect != 0 || !otx::config::getBoolean(otx::config::REPLACE_KICK_ON_LOGIN)) {
+		// task has already been scheduled just bail out (should not be overriden)
+		disconnectClient(0x14, "You are already logged in.");
+		return;
+	}
 
-		// max connections by swatt' edited by Feetads
-		bool useMaxCon = otx::config::getBoolean(otx::config::MAXIP_USECONECT);
-		if (useMaxCon) {
-			uint32_t ip = player->getIP();
-			PlayerVector player_count = g_game.getPlayersByIP(ip);
-			uint32_t maxConnections = otx::config::getInteger(otx::config::MAX_IP_CONNECTIONS);
-			if ((player_count.size() + 1) > maxConnections) {
-				std::stringstream maxConnectMsg;
-				maxConnectMsg << "Disconnected, the connection limit by IP " << (maxConnections == 1 ? "is " : "are ") << maxConnections << ".";
-				disconnectClient(0x14, maxConnectMsg.str().c_str());
-				return;
-			}
-		}
+	if (foundPlayer->m_client) {
+		foundPlayer->m_client->disconnect();
+		foundPlayer->m_isConnecting = true;
+		foundPlayer->setClientVersion(version);
+		eventConnect = addSchedulerTask(1000, ([self = getThis(), playerID = foundPlayer->getID(), operatingSystem, version]() {
+			self->connect(playerID, operatingSystem, version, true);
+		}));
+	} else {
+		connect(foundPlayer->getID(), operatingSystem, version, true);
+	}
+	OutputMessagePool::getInstance().addProtocolToAutosend(shared_from_this());
+}
 
-		Ban ban;
-		ban.value = player->getGUID();
-		ban.param = PLAYERBAN_BANISHMENT;
+void ProtocolGame::login(const std::string& name, uint32_t id,
+	OperatingSystem_t operatingSystem, uint16_t version, bool gamemaster, PlayerLoadData& data)
+{
+	// dispatcher thread
+	if (!m_replay && isConnectionExpired()) {
+		// the client left while its data was loading
+		return;
+	}
 
-		ban.type = BAN_PLAYER;
-		if (IOBan::getInstance()->getData(ban) && !player->hasFlag(PlayerFlag_CannotBeBanned)) {
-			bool deletion = ban.expires < 0;
-			std::string name_ = "Automatic ";
-			if (!ban.adminId) {
-				name_ += (deletion ? "deletion" : "banishment");
-			} else {
-				IOLoginData::getInstance()->getNameByGuid(ban.adminId, name_);
-			}
+	if (g_game.getPlayerByName(name) && !(otx::config::getBoolean(otx::config::ACCOUNT_MANAGER) && name == "Account Manager")) {
+		// logged in through another connection meanwhile, take the usual path for an online player
+		login(name, id, operatingSystem, version, gamemaster);
+		return;
+	}
 
-			std::stringstream stream;
-			stream << "Your account has been " << (deletion ? "deleted" : "banished") << " at:\n"
-				   << formatDateEx(ban.added, "%d %b %Y").c_str() << " by: " << name_.c_str()
-				   << "\nReason:\n"
-				   << getReason(ban.reason).c_str() << ".\nComment:\n"
-				   << ban.comment.c_str() << ".\nYour " << (deletion ? "account won't be undeleted" : "banishment will be lifted at:\n")
-				   << (deletion ? "" : formatDateEx(ban.expires).c_str());
-			disconnectClient(0x14, stream.str().c_str());
-			return;
-		}
+#if ENABLE_SERVER_DIAGNOSTIC > 0
+	const auto start = std::chrono::steady_clock::now();
+#endif
 
-		if (IOBan::getInstance()->isPlayerBanished(player->getGUID(), PLAYERBAN_LOCK) && id != 1) {
-			if (otx::config::getBoolean(otx::config::NAMELOCK_MANAGER)) {
-				player->m_name = "Account Manager";
-				player->m_accountManager = MANAGER_NAMELOCK;
+	player = new Player(name, getThis());
+	player->addRef();
 
-				player->m_managerNumber = id;
-				player->m_managerString2 = name;
-			} else {
-				disconnectClient(0x14, "Your character has been namelocked.");
-				return;
-			}
-		} else if (player->getName() == "Account Manager") {
-			if (!otx::config::getBoolean(otx::config::ACCOUNT_MANAGER)) {
-				disconnectClient(0x14, "Account Manager is disabled.");
-				return;
-			}
+	player->setID();
 
-			if (id != 1) {
-				player->m_accountManager = MANAGER_ACCOUNT;
-				player->m_managerNumber = id;
-			} else {
-				player->m_accountManager = MANAGER_NEW;
+	if (!IOLoginData::getInstance()->loadPlayer(player, data, true)) {
+		disconnectClient(0x14, "Your character could not be loaded.");
+		return;
+	}
+
+	// check exist after load, need this to get groupId
+	if (g_game.existMonsterByName(name) && player->getGroupId() == 1) {
+		bool deleteMonsterName = otx::config::getBoolean(otx::config::DELETE_PLAYER_MONSTER_NAME);
+		if (deleteMonsterName && IOLoginData::getInstance()->deletePlayer(player)) {
+			disconnectClient(0x14, "This character was deleted because it contains invalid characters in its name.");
+		} else {
+			if (IOLoginData::getInstance()->setName(player, generateRandomName(random_range(7, 12)))) {
+				disconnectClient(0x14, "you were disconnected because your name contains invalid characters, your name will be changed randomly.");
 			}
 		}
+		return;
+	}
 
-		if (gamemaster && !player->hasCustomFlag(PlayerCustomFlag_GamemasterPrivileges)) {
-			disconnectClient(0x14, "You are not allowed to play on spectator mode.");
+	// max connections by swatt' edited by Feetads
+	bool useMaxCon = otx::config::getBoolean(otx::config::MAXIP_USECONECT);
+	if (useMaxCon) {
+		uint32_t ip = player->getIP();
+		PlayerVector player_count = g_game.getPlayersByIP(ip);
+		uint32_t maxConnections = otx::config::getInteger(otx::config::MAX_IP_CONNECTIONS);
+		if ((player_count.size() + 1) > maxConnections) {
+			std::stringstream maxConnectMsg;
+			maxConnectMsg << "Disconnected, the connection limit by IP " << (maxConnections == 1 ? "is " : "are ") << maxConnections << ".";
+			disconnectClient(0x14, maxConnectMsg.str().c_str());
 			return;
 		}
+	}
 
-		if (!player->hasFlag(PlayerFlag_CanAlwaysLogin)) {
-			if (g_game.getGameState() == GAMESTATE_CLOSING) {
-				disconnectClient(0x14, "Gameworld is just going down, please come back later.");
-				return;
-			}
+	Ban ban;
+	ban.value = player->getGUID();
+	ban.param = PLAYERBAN_BANISHMENT;
 
-			if (g_game.getGameState() == GAMESTATE_CLOSED) {
-				disconnectClient(0x14, "Gameworld is currently closed, please come back later.");
-				return;
-			}
+	ban.type = BAN_PLAYER;
+	if (IOBan::getInstance()->getData(ban) && !player->hasFlag(PlayerFlag_CannotBeBanned)) {
+		bool deletion = ban.expires < 0;
+		std::string name_ = "Automatic ";
+		if (!ban.adminId) {
+			name_ += (deletion ? "deletion" : "banishment");
+		} else {
+			IOLoginData::getInstance()->getNameByGuid(ban.adminId, name_);
 		}
 
-		player->setClientVersion(version);
-		player->setOperatingSystem(operatingSystem);
+		std::stringstream stream;
+		stream << "Your account has been " << (deletion ? "deleted" : "banished") << " at:\n"
+			   << formatDateEx(ban.added, "%d %b %Y").c_str() << " by: " << name_.c_str()
+			   << "\nReason:\n"
+			   << getReason(ban.reason).c_str() << ".\nComment:\n"
+			   << ban.comment.c_str() << ".\nYour " << (deletion ? "account won't be undeleted" : "banishment will be lifted at:\n")
+			   << (deletion ? "" : formatDateEx(ban.expires).c_str());
+		disconnectClient(0x14, stream.str().c_str());
+		return;
+	}
 
-		if (otx::config::getBoolean(otx::config::ONE_PLAYER_ON_ACCOUNT) && !player->isAccountManager() && !IOLoginData::getInstance()->hasCustomFlag(id, PlayerCustomFlag_CanLoginMultipleCharacters)) {
-			bool found = false;
-			PlayerVector tmp = g_game.getPlayersByAccount(id);
-			for (PlayerVector::iterator it = tmp.begin(); it != tmp.end(); ++it) {
-				if ((*it)->getName() != name) {
-					continue;
-				}
+	if (IOBan::getInstance()->isPlayerBanished(player->getGUID(), PLAYERBAN_LOCK) && id != 1) {
+		if (otx::config::getBoolean(otx::config::NAMELOCK_MANAGER)) {
+			player->m_name = "Account Manager";
+			player->m_accountManager = MANAGER_NAMELOCK;
 
-				found = true;
-				break;
-			}
+			player->m_managerNumber = id;
+			player->m_managerString2 = name;
+		} else {
+			disconnectClient(0x14, "Your character has been namelocked.");
+			return;
+		}
+	} else if (player->getName() == "Account Manager") {
+		if (!otx::config::getBoolean(otx::config::ACCOUNT_MANAGER)) {
+			disconnectClient(0x14, "Account Manager is disabled.");
+			return;
+		}
 
-			if (tmp.size() > 0 && !found) {
-				disconnectClient(0x14, "You may only login with one character\nof your account at the same time.");
-				return;
-			}
+		if (id != 1) {
+			player->m_accountManager = MANAGER_ACCOUNT;
+			player->m_managerNumber = id;
+		} else {
+			player->m_accountManager = MANAGER_NEW;
 		}
+	}
 
-		const size_t currentSlot = WaitList::clientLogin(*player);
-		if (currentSlot != 0) {
-			std::ostringstream ss;
-			ss << "Too many players online.\nYou are at " << currentSlot << " place on the waiting list.";
+	if (gamemaster && !player->hasCustomFlag(PlayerCustomFlag_GamemasterPrivileges)) {
+		disconnectClient(0x14, "You are not allowed to play on spectator mode.");
+		return;
+	}
 
-			auto output = OutputMessagePool::getOutputMessage();
-			output->addByte(0x16);
-			output->addString(ss.str());
-			output->addByte(WaitList::getWaitTime(currentSlot));
-			send(output);
-			disconnect();
+	if (!player->hasFlag(PlayerFlag_CanAlwaysLogin)) {
+		if (g_game.getGameState() == GAMESTATE_CLOSING) {
+			disconnectClient(0x14, "Gameworld is just going down, please come back later.");
 			return;
 		}
 
-		if (!IOLoginData::getInstance()->loadPlayer(player, name)) {
-			disconnectClient(0x14, "Your character could not be loaded.");
+		if (g_game.getGameState() == GAMESTATE_CLOSED) {
+			disconnectClient(0x14, "Gameworld is currently closed, please come back later.");
 			return;
 		}
+	}
 
-		if (!g_game.placeCreature(player, player->getLoginPosition())) {
-			Position pos = g_game.getClosestFreeTile(player, player->getMasterPosition(), true, false);
-			if (!pos.x) {
-				pos = player->getMasterPosition();
-			}
+	player->setClientVersion(version);
+	player->setOperatingSystem(operatingSystem);
 
-			if (!g_game.placeCreature(player, pos, false, true)) {
-				disconnectClient(0x14, "Temple position is wrong. Contact with the administration.");
-				return;
+	const Group* accountGroup = g_game.groups.getGroup(data.account.groupId);
+	if (otx::config::getBoolean(otx::config::ONE_PLAYER_ON_ACCOUNT) && !player->isAccountManager() && !(accountGroup && accountGroup->hasCustomFlag(PlayerCustomFlag_CanLoginMultipleCharacters))) {
+		bool found = false;
+		PlayerVector tmp = g_game.getPlayersByAccount(id);
+		for (PlayerVector::iterator it = tmp.begin(); it != tmp.end(); ++it) {
+			if ((*it)->getName() != name) {
+				continue;
 			}
+
+			found = true;
+			break;
 		}
 
-		if (player->isUsingOtclient()) {
-			player->registerCreatureEvent("ExtendedOpcode");
+		if (tmp.size() > 0 && !found) {
+			disconnectClient(0x14, "You may only login with one character\nof your account at the same time.");
+			return;
 		}
+	}
 
-		player->m_lastIP = player->getIP();
-		player->m_lastLoad = otx::util::mstime();
-		player->m_lastLogin = std::max(time(nullptr), player->m_lastLogin + 1);
+	const size_t currentSlot = WaitList::clientLogin(*player);
+	if (currentSlot != 0) {
+		std::ostringstream ss;
+		ss << "Too many players online.\nYou are at " << currentSlot << " place on the waiting list.";
 
-		acceptPackets = true;
-	} else {
-		if (eventConnect != 0 || !otx::config::getBoolean(otx::config::REPLACE_KICK_ON_LOGIN)) {
-			// task has already been scheduled just bail out (should not be overriden)
-			disconnectClient(0x14, "You are already logged in.");
-			return;
+		auto output = OutputMessagePool::getOutputMessage();
+		output->addByte(0x16);
+		output->addString(ss.str());
+		output->addByte(WaitList::getWaitTime(currentSlot));
+		send(output);
+		disconnect();
+		return;
+	}
+
+	if (!IOLoginData::getInstance()->loadPlayer(player, data)) {
+		disconnectClient(0x14, "Your character could not be loaded.");
+		return;
+	}
+
+	if (!g_game.placeCreature(player, player->getLoginPosition())) {
+		Position pos = g_game.getClosestFreeTile(player, player->getMasterPosition(), true, false);
+		if (!pos.x) {
+			pos = player->getMasterPosition();
 		}
 
-		if (foundPlayer->m_client) {
-			foundPlayer->m_client->disconnect();
-			foundPlayer->m_isConnecting = true;
-			foundPlayer->setClientVersion(version);
-			eventConnect = addSchedulerTask(1000, ([self = getThis(), playerID = foundPlayer->getID(), operatingSystem, version]() {
-				self->connect(playerID, operatingSystem, version, true);
-			}));
-		} else {
-			connect(foundPlayer->getID(), operatingSystem, version, true);
+		if (!g_game.placeCreature(player, pos, false, true)) {
+			disconnectClient(0x14, "Temple position is wrong. Contact with the administration.");
+			return;
 		}
 	}
+
+	if (player->isUsingOtclient()) {
+		player->registerCreatureEvent("ExtendedOpcode");
+	}
+
+	player->m_lastIP = player->getIP();
+	player->m_lastLoad = otx::util::ticks();
+	player->m_lastLogin = std::max(time(nullptr), player->m_lastLogin + 1);
+
+	acceptPackets = true;
 	OutputMessagePool::getInstance().addProtocolToAutosend(shared_from_this());
+
+#if ENABLE_SERVER_DIAGNOSTIC > 0
+	++loginCount;
+	loginTime += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+#endif
 }
 
 bool ProtocolGame::logout(bool displayEffect, bool forceLogout)
@@ -623,7 +677,7 @@ bool ProtocolGame::connect(uint32_t playerId, OperatingSystem_t operatingSystem,
 		return false;
 	}
 
-	if (isConnectionExpired()) {
+	if (!m_replay && isConnectionExpired()) {
 		// ProtocolGame::release() has been called at this point and the Connection object
 		// no longer exists, so we return to prevent leakage of the Player.
 		return false;
@@ -645,7 +699,7 @@ bool ProtocolGame::connect(uint32_t playerId, OperatingSystem_t operatingSystem,
 
 	player->m_lastIP = player->getIP();
 	if (!replace) {
-		player->m_lastLoad = otx::util::mstime();
+		player->m_lastLoad = otx::util::ticks();
 	}
 	g_chat.reOpenChannels(player);
 	acceptPackets = true;
@@ -790,6 +844,19 @@ void ProtocolGame::onRecvFirstMessage(NetworkMessage& msg)
 	}
 
 	if (name != "10") {
+		// the account and namelock managers take passwords and names as chat, never record those
+		if (!otx::config::getString(otx::config::PACKET_CAPTURE).empty()
+			&& !caseInsensitiveEqual(character, "Account Manager")
+			&& (id == 1 || !IOBan::getInstance()->isPlayerBanished(character, PLAYERBAN_LOCK))) {
+			PacketCaptureHeader header;
+			header.name = character;
+			header.accountId = id;
+			header.version = version;
+			header.operatingSystem = operatingSystem;
+			header.gamemaster = gamemaster;
+			m_capture = PacketCapture::open(header);
+		}
+
 		addDispatcherTask(([=, self = getThis(), character = std::move(character)]() {
 			self->login(character, id, operatingSystem, version, gamemaster);
 		}));
@@ -802,6 +869,10 @@ void ProtocolGame::onRecvFirstMessage(NetworkMessage& msg)
 
 void ProtocolGame::parsePacket(NetworkMessage& msg)
 {
+	if (m_capture && msg.getLength() > 0) {
+		m_capture->addPacket(msg.getRemainingBuffer(), msg.getLength());
+	}
+
 	if (!player || !acceptPackets || g_game.getGameState() == GAMESTATE_SHUTDOWN || msg.getLength() <= 0) {
 		return;
 	}
@@ -811,28 +882,30 @@ void ProtocolGame::parsePacket(NetworkMessage& msg)
 		return;
 	}
 
+	// fixed size packets are decoded into a command, anything else schedules its own task
+	PlayerCommand command;
 	if (m_spectator) {
 		switch (recvbyte) {
 			case 0x14:
-				addDispatcherTask([self = getThis()]() { self->logout(true, false); });
+				command.type = PLAYERCOMMAND_LOGOUT;
 				break;
 			case 0x96:
 				parseSay(msg);
 				break;
 			case 0x1E:
-				addDispatcherTask([playerID = player->getID()]() { g_game.playerReceivePing(playerID); });
+				command.type = PLAYERCOMMAND_PING;
 				break;
 			case 0x97:
-				parseGetChannels(msg);
+				parseGetChannels(msg, command);
 				break;
 			case 0x98:
 				parseOpenChannel(msg);
 				break;
 			case 0xC9:
-				parseUpdateTile(msg);
+				parseUpdateTile(msg, command);
 				break;
 			case 0xCA:
-				parseUpdateContainer(msg);
+				parseUpdateContainer(msg, command);
 				break;
 			case 0xE8:
 				parseDebugAssert(msg);
@@ -849,7 +922,7 @@ void ProtocolGame::parsePacket(NetworkMessage& msg)
 				}));
 				break;
 			case 0x8C:
-				parseLookAt(msg);
+				parseLookAt(msg, command);
 				break;
 
 			default:
@@ -859,16 +932,16 @@ void ProtocolGame::parsePacket(NetworkMessage& msg)
 	} else if (player->isAccountManager()) {
 		switch (recvbyte) {
 			case 0x14:
-				addDispatcherTask([self = getThis()]() { self->logout(true, false); });
+				command.type = PLAYERCOMMAND_LOGOUT;
 				break;
 			case 0x96:
 				parseSay(msg);
 				break;
 			case 0x1E:
-				addDispatcherTask([playerID = player->getID()]() { g_game.playerReceivePing(playerID); });
+				command.type = PLAYERCOMMAND_PING;
 				break;
 			case 0xC9:
-				parseUpdateTile(msg);
+				parseUpdateTile(msg, command);
 				break;
 			case 0xE8:
 				parseDebugAssert(msg);
@@ -884,10 +957,10 @@ void ProtocolGame::parsePacket(NetworkMessage& msg)
 	} else {
 		switch (recvbyte) {
 			case 0x14:
-				addDispatcherTask([self = getThis()]() { self->logout(true, false); });
+				command.type = PLAYERCOMMAND_LOGOUT;
 				break;
 			case 0x1E:
-				addDispatcherTask([playerID = player->getID()]() { g_game.playerReceivePing(playerID); });
+				command.type = PLAYERCOMMAND_PING;
 				break;
 			case 0x32:
 				parseExtendedOpcode(msg);
@@ -896,88 +969,91 @@ void ProtocolGame::parsePacket(NetworkMessage& msg)
 				parseAutoWalk(msg);
 				break;
 			case 0x65:
-				addDispatcherTask([playerID = player->getID()]() { g_game.playerMove(playerID, NORTH); });
+				command.type = PLAYERCOMMAND_MOVE;
+				command.count = NORTH;
 				break;
 			case 0x66:
-				addDispatcherTask([playerID = player->getID()]() { g_game.playerMove(playerID, EAST); });
+				command.type = PLAYERCOMMAND_MOVE;
+				command.count = EAST;
 				break;
 			case 0x67:
-				addDispatcherTask([playerID = player->getID()]() { g_game.playerMove(playerID, SOUTH); });
+				command.type = PLAYERCOMMAND_MOVE;
+				command.count = SOUTH;
 				break;
 			case 0x68:
-				addDispatcherTask([playerID = player->getID()]() { g_game.playerMove(playerID, WEST); });
+				command.type = PLAYERCOMMAND_MOVE;
+				command.count = WEST;
 				break;
 			case 0x69:
-				addDispatcherTask([playerID = player->getID()]() { g_game.playerStopAutoWalk(playerID); });
+				command.type = PLAYERCOMMAND_STOP_AUTOWALK;
 				break;
 			case 0x6A:
-				addDispatcherTask([playerID = player->getID()]() { g_game.playerMove(playerID, NORTHEAST); });
+				command.type = PLAYERCOMMAND_MOVE;
+				command.count = NORTHEAST;
 				break;
 			case 0x6B:
-				addDispatcherTask([playerID = player->getID()]() { g_game.playerMove(playerID, SOUTHEAST); });
+				command.type = PLAYERCOMMAND_MOVE;
+				command.count = SOUTHEAST;
 				break;
 			case 0x6C:
-				addDispatcherTask([playerID = player->getID()]() { g_game.playerMove(playerID, SOUTHWEST); });
+				command.type = PLAYERCOMMAND_MOVE;
+				command.count = SOUTHWEST;
 				break;
 			case 0x6D:
-				addDispatcherTask([playerID = player->getID()]() { g_game.playerMove(playerID, NORTHWEST); });
+				command.type = PLAYERCOMMAND_MOVE;
+				command.count = NORTHWEST;
 				break;
 			case 0x6F:
-				addTimedDispatcherTask(DISPATCHER_TASK_EXPIRATION, [playerID = player->getID()]() { g_game.playerTurn(playerID, NORTH); });
-				break;
 			case 0x70:
-				addTimedDispatcherTask(DISPATCHER_TASK_EXPIRATION, [playerID = player->getID()]() { g_game.playerTurn(playerID, EAST); });
-				break;
 			case 0x71:
-				addTimedDispatcherTask(DISPATCHER_TASK_EXPIRATION, [playerID = player->getID()]() { g_game.playerTurn(playerID, SOUTH); });
-				break;
 			case 0x72:
-				addTimedDispatcherTask(DISPATCHER_TASK_EXPIRATION, [playerID = player->getID()]() { g_game.playerTurn(playerID, WEST); });
+				command.type = PLAYERCOMMAND_TURN;
+				command.count = recvbyte - 0x6F; // NORTH, EAST, SOUTH, WEST
 				break;
 			case 0x78:
-				parseThrow(msg);
+				parseThrow(msg, command);
 				break;
 			case 0x79:
-				parseLookInShop(msg);
+				parseLookInShop(msg, command);
 				break;
 			case 0x7A:
-				parsePlayerPurchase(msg);
+				parsePlayerPurchase(msg, command);
 				break;
 			case 0x7B:
-				parsePlayerSale(msg);
+				parsePlayerSale(msg, command);
 				break;
 			case 0x7C:
-				addDispatcherTask([playerID = player->getID()]() { g_game.playerCloseShop(playerID); });
+				command.type = PLAYERCOMMAND_CLOSE_SHOP;
 				break;
 			case 0x7D:
-				parseRequestTrade(msg);
+				parseRequestTrade(msg, command);
 				break;
 			case 0x7E:
-				parseLookInTrade(msg);
+				parseLookInTrade(msg, command);
 				break;
 			case 0x7F:
-				addDispatcherTask([playerID = player->getID()]() { g_game.playerAcceptTrade(playerID); });
+				command.type = PLAYERCOMMAND_ACCEPT_TRADE;
 				break;
 			case 0x80:
-				parseCloseTrade();
+				command.type = PLAYERCOMMAND_CLOSE_TRADE;
 				break;
 			case 0x82:
-				parseUseItem(msg);
+				parseUseItem(msg, command);
 				break;
 			case 0x83:
-				parseUseItemEx(msg);
+				parseUseItemEx(msg, command);
 				break;
 			case 0x84:
-				parseBattleWindow(msg);
+				parseBattleWindow(msg, command);
 				break;
 			case 0x85:
-				parseRotateItem(msg);
+				parseRotateItem(msg, command);
 				break;
 			case 0x87:
-				parseCloseContainer(msg);
+				parseCloseContainer(msg, command);
 				break;
 			case 0x88:
-				parseUpArrowContainer(msg);
+				parseUpArrowContainer(msg, command);
 				break;
 			case 0x89:
 				parseTextWindow(msg);
@@ -986,28 +1062,28 @@ void ProtocolGame::parsePacket(NetworkMessage& msg)
 				parseHouseWindow(msg);
 				break;
 			case 0x8C:
-				parseLookAt(msg);
+				parseLookAt(msg, command);
 				break;
 			case 0x8D:
-				parseLookInBattleList(msg);
+				parseLookInBattleList(msg, command);
 				break;
 			case 0x96:
 				parseSay(msg);
 				break;
 			case 0x97:
-				parseGetChannels(msg);
+				parseGetChannels(msg, command);
 				break;
 			case 0x98:
 				parseOpenChannel(msg);
 				break;
 			case 0x99:
-				parseCloseChannel(msg);
+				parseCloseChannel(msg, command);
 				break;
 			case 0x9A:
 				parseOpenPrivate(msg);
 				break;
 			case 0x9E:
-				addDispatcherTask([playerID = player->getID()]() { g_game.playerCloseNpcChannel(playerID); });
+				command.type = PLAYERCOMMAND_CLOSE_NPC_CHANNEL;
 				break;
 			case 0x9B:
 				parseProcessRuleViolation(msg);
@@ -1016,37 +1092,37 @@ void ProtocolGame::parsePacket(NetworkMessage& msg)
 				parseCloseRuleViolation(msg);
 				break;
 			case 0x9D:
-				addDispatcherTask([playerID = player->getID()]() { g_game.playerCancelRuleViolation(playerID); });
+				command.type = PLAYERCOMMAND_CANCEL_RULE_VIOLATION;
 				break;
 			case 0xA0:
-				parseFightModes(msg);
+				parseFightModes(msg, command);
 				break;
 			case 0xA1:
-				parseAttack(msg);
+				parseAttack(msg, command);
 				break;
 			case 0xA2:
-				parseFollow(msg);
+				parseFollow(msg, command);
 				break;
 			case 0xA3:
-				parseInviteToParty(msg);
+				parseInviteToParty(msg, command);
 				break;
 			case 0xA4:
-				parseJoinParty(msg);
+				parseJoinParty(msg, command);
 				break;
 			case 0xA5:
-				parseRevokePartyInvite(msg);
+				parseRevokePartyInvite(msg, command);
 				break;
 			case 0xA6:
-				parsePassPartyLeadership(msg);
+				parsePassPartyLeadership(msg, command);
 				break;
 			case 0xA7:
-				addDispatcherTask([playerID = player->getID()]() { g_game.playerLeaveParty(playerID, false); });
+				command.type = PLAYERCOMMAND_LEAVE_PARTY;
 				break;
 			case 0xA8:
-				parseSharePartyExperience(msg);
+				parseSharePartyExperience(msg, command);
 				break;
 			case 0xAA:
-				addDispatcherTask([playerID = player->getID()]() { g_game.playerCreatePrivateChannel(playerID); });
+				command.type = PLAYERCOMMAND_CREATE_PRIVATE_CHANNEL;
 				break;
 			case 0xAB:
 				parseChannelInvite(msg);
@@ -1055,30 +1131,30 @@ void ProtocolGame::parsePacket(NetworkMessage& msg)
 				parseChannelExclude(msg);
 				break;
 			case 0xBE:
-				addDispatcherTask([playerID = player->getID()]() { g_game.playerCancelAttackAndFollow(playerID); });
+				command.type = PLAYERCOMMAND_CANCEL_ATTACK_AND_FOLLOW;
 				break;
 			case 0xC9:
-				parseUpdateTile(msg);
+				parseUpdateTile(msg, command);
 				break;
 			case 0xCA:
-				parseUpdateContainer(msg);
+				parseUpdateContainer(msg, command);
 				break;
 			case 0xD2:
 				if ((!player->hasCustomFlag(PlayerCustomFlag_GamemasterPrivileges) || !otx::config::getBoolean(otx::config::DISABLE_OUTFITS_PRIVILEGED)) && (otx::config::getBoolean(otx::config::ALLOW_CHANGEOUTFIT) || otx::config::getBoolean(otx::config::ALLOW_CHANGECOLORS) || otx::config::getBoolean(otx::config::ALLOW_CHANGEADDONS))) {
-					addDispatcherTask([playerID = player->getID()]() { g_game.playerRequestOutfit(playerID); });
+					command.type = PLAYERCOMMAND_REQUEST_OUTFIT;
 				}
 				break;
 			case 0xD3:
 				if ((!player->hasCustomFlag(PlayerCustomFlag_GamemasterPrivileges) || !otx::config::getBoolean(otx::config::DISABLE_OUTFITS_PRIVILEGED))
 					&& (otx::config::getBoolean(otx::config::ALLOW_CHANGECOLORS) || otx::config::getBoolean(otx::config::ALLOW_CHANGEOUTFIT))) {
-					parseSetOutfit(msg);
+					parseSetOutfit(msg, command);
 				}
 				break;
 			case 0xDC:
 				parseAddVip(msg);
 				break;
 			case 0xDD:
-				parseRemoveVip(msg);
+				parseRemoveVip(msg, command);
 				break;
 			case 0xE6:
 				parseBugReport(msg);
@@ -1090,10 +1166,10 @@ void ProtocolGame::parsePacket(NetworkMessage& msg)
 				parseDebugAssert(msg);
 				break;
 			case 0xF0:
-				addDispatcherTask([playerID = player->getID()]() { g_game.playerQuests(playerID); });
+				command.type = PLAYERCOMMAND_QUESTS;
 				break;
 			case 0xF1:
-				parseQuestInfo(msg);
+				parseQuestInfo(msg, command);
 				break;
 			case 0xF2:
 				parseViolationReport(msg);
@@ -1107,6 +1183,222 @@ void ProtocolGame::parsePacket(NetworkMessage& msg)
 			}
 		}
 	}
+
+	if (command.type != PLAYERCOMMAND_NONE) {
+		queueCommand(command);
+	} else {
+		m_commands.seal();
+	}
+}
+
+void ProtocolGame::queueCommand(PlayerCommand& command)
+{
+	switch (command.type) {
+		case PLAYERCOMMAND_TURN:
+		case PLAYERCOMMAND_THROW:
+		case PLAYERCOMMAND_LOOK_IN_SHOP:
+		case PLAYERCOMMAND_PURCHASE:
+		case PLAYERCOMMAND_SALE:
+		case PLAYERCOMMAND_LOOK_IN_TRADE:
+		case PLAYERCOMMAND_USE_ITEM:
+		case PLAYERCOMMAND_USE_ITEM_EX:
+		case PLAYERCOMMAND_BATTLE_WINDOW:
+		case PLAYERCOMMAND_ROTATE_ITEM:
+		case PLAYERCOMMAND_LOOK_AT:
+		case PLAYERCOMMAND_LOOK_IN_BATTLE_LIST:
+		case PLAYERCOMMAND_FIGHT_MODES:
+			command.expiration = std::chrono::steady_clock::now() + std::chrono::milliseconds(DISPATCHER_TASK_EXPIRATION);
+			break;
+
+		default:
+			break;
+	}
+
+	switch (m_commands.push(command)) {
+		case PlayerCommandQueue::PUSH_SCHEDULE:
+			addDispatcherTask(([self = getThis(), playerID = player->getID()]() {
+				self->executeCommands(playerID);
+			}));
+			break;
+
+		case PlayerCommandQueue::PUSH_FULL:
+#if ENABLE_SERVER_DIAGNOSTIC > 0
+			++commandsDropped;
+#endif
+			if (!m_commandFlood) {
+				m_commandFlood = true;
+				Logger::getInstance()->eFile("bots/" + player->getName() + ".log", "Command queue full, dropping packets.", true);
+			}
+			return;
+
+		default:
+			break;
+	}
+
+	m_commandFlood = false;
+}
+
+void ProtocolGame::executeCommands(uint32_t playerId)
+{
+#if ENABLE_SERVER_DIAGNOSTIC > 0
+	++commandBatches;
+#endif
+	PlayerCommand command;
+	for (bool first = true; m_commands.pop(command, first); first = false) {
+		if (command.expiration != TASK_TIME_ZERO && command.expiration < std::chrono::steady_clock::now()) {
+			continue;
+		}
+
+#if ENABLE_SERVER_DIAGNOSTIC > 0
+		++commandCount;
+#endif
+		otx::util::update_ticks();
+		executeCommand(playerId, command);
+	}
+
+	// the client waits for the outcome of its own commands, the rest can wait for the autosend
+	OutputMessagePool::getInstance().flushAtBatchEnd(shared_from_this());
+}
+
+void ProtocolGame::executeCommand(uint32_t playerId, const PlayerCommand& command)
+{
+	switch (command.type) {
+		case PLAYERCOMMAND_LOGOUT:
+			logout(true, false);
+			break;
+		case PLAYERCOMMAND_PING:
+			g_game.playerReceivePing(playerId);
+			break;
+		case PLAYERCOMMAND_MOVE:
+			g_game.playerMove(playerId, static_cast<Direction>(command.count));
+			break;
+		case PLAYERCOMMAND_STOP_AUTOWALK:
+			g_game.playerStopAutoWalk(playerId);
+			break;
+		case PLAYERCOMMAND_TURN:
+			g_game.playerTurn(playerId, static_cast<Direction>(command.count));
+			break;
+		case PLAYERCOMMAND_THROW:
+			g_game.playerMoveThing(playerId, command.fromPos, command.spriteId, command.stackpos, command.toPos, command.count);
+			break;
+		case PLAYERCOMMAND_LOOK_IN_SHOP:
+			g_game.playerLookInShop(playerId, command.spriteId, command.count);
+			break;
+		case PLAYERCOMMAND_PURCHASE:
+			g_game.playerPurchaseItem(playerId, command.spriteId, command.count, command.amount, command.flag, command.secondFlag);
+			break;
+		case PLAYERCOMMAND_SALE:
+			g_game.playerSellItem(playerId, command.spriteId, command.count, command.amount, command.flag);
+			break;
+		case PLAYERCOMMAND_CLOSE_SHOP:
+			g_game.playerCloseShop(playerId);
+			break;
+		case PLAYERCOMMAND_REQUEST_TRADE:
+			g_game.playerRequestTrade(playerId, command.fromPos, command.stackpos, command.id, command.spriteId);
+			break;
+		case PLAYERCOMMAND_LOOK_IN_TRADE:
+			g_game.playerLookInTrade(playerId, command.flag, command.stackpos);
+			break;
+		case PLAYERCOMMAND_ACCEPT_TRADE:
+			g_game.playerAcceptTrade(playerId);
+			break;
+		case PLAYERCOMMAND_CLOSE_TRADE:
+			g_game.playerCloseTrade(playerId);
+			break;
+		case PLAYERCOMMAND_USE_ITEM:
+			g_game.playerUseItem(playerId, command.fromPos, command.stackpos, command.count, command.spriteId, command.flag);
+			break;
+		case PLAYERCOMMAND_USE_ITEM_EX:
+			g_game.playerUseItemEx(playerId, command.fromPos, command.stackpos, command.spriteId, command.toPos, command.toStackpos, command.toSpriteId, command.flag);
+			break;
+		case PLAYERCOMMAND_BATTLE_WINDOW:
+			g_game.playerUseBattleWindow(playerId, command.fromPos, command.stackpos, command.id, command.spriteId, command.flag);
+			break;
+		case PLAYERCOMMAND_ROTATE_ITEM:
+			g_game.playerRotateItem(playerId, command.fromPos, command.stackpos, command.spriteId);
+			break;
+		case PLAYERCOMMAND_CLOSE_CONTAINER:
+			g_game.playerCloseContainer(playerId, command.count);
+			break;
+		case PLAYERCOMMAND_UP_ARROW_CONTAINER:
+			g_game.playerMoveUpContainer(playerId, command.count);
+			break;
+		case PLAYERCOMMAND_UPDATE_CONTAINER:
+			g_game.playerUpdateContainer(playerId, command.count);
+			break;
+		case PLAYERCOMMAND_UPDATE_TILE:
+			g_game.playerUpdateTile(playerId, command.fromPos);
+			break;
+		case PLAYERCOMMAND_LOOK_AT:
+			g_game.playerLookAt(playerId, command.fromPos, command.spriteId, command.stackpos);
+			break;
+		case PLAYERCOMMAND_LOOK_IN_BATTLE_LIST:
+			g_game.playerLookInBattleList(playerId, command.id);
+			break;
+		case PLAYERCOMMAND_GET_CHANNELS:
+			g_game.playerRequestChannels(playerId);
+			break;
+		case PLAYERCOMMAND_CLOSE_CHANNEL:
+			g_game.playerCloseChannel(playerId, command.spriteId);
+			break;
+		case PLAYERCOMMAND_CLOSE_NPC_CHANNEL:
+			g_game.playerCloseNpcChannel(playerId);
+			break;
+		case PLAYERCOMMAND_CREATE_PRIVATE_CHANNEL:
+			g_game.playerCreatePrivateChannel(playerId);
+			break;
+		case PLAYERCOMMAND_CANCEL_RULE_VIOLATION:
+			g_game.playerCancelRuleViolation(playerId);
+			break;
+		case PLAYERCOMMAND_FIGHT_MODES:
+			g_game.playerSetFightModes(playerId, static_cast<FightMode_t>(command.count), command.flag, command.secondFlag);
+			break;
+		case PLAYERCOMMAND_ATTACK:
+			g_game.playerSetAttackedCreature(playerId, command.id);
+			break;
+		case PLAYERCOMMAND_FOLLOW:
+			g_game.playerFollowCreature(playerId, command.id);
+			break;
+		case PLAYERCOMMAND_CANCEL_ATTACK_AND_FOLLOW:
+			g_game.playerCancelAttackAndFollow(playerId);
+			break;
+		case PLAYERCOMMAND_INVITE_TO_PARTY:
+			g_game.playerInviteToParty(playerId, command.id);
+			break;
+		case PLAYERCOMMAND_JOIN_PARTY:
+			g_game.playerJoinParty(playerId, command.id);
+			break;
+		case PLAYERCOMMAND_REVOKE_PARTY_INVITE:
+			g_game.playerRevokePartyInvitation(playerId, command.id);
+			break;
+		case PLAYERCOMMAND_PASS_PARTY_LEADERSHIP:
+			g_game.playerPassPartyLeadership(playerId, command.id);
+			break;
+		case PLAYERCOMMAND_LEAVE_PARTY:
+			g_game.playerLeaveParty(playerId, false);
+			break;
+		case PLAYERCOMMAND_SHARE_PARTY_EXPERIENCE:
+			g_game.playerSharePartyExperience(playerId, command.flag);
+			break;
+		case PLAYERCOMMAND_REQUEST_OUTFIT:
+			g_game.playerRequestOutfit(playerId);
+			break;
+		case PLAYERCOMMAND_SET_OUTFIT:
+			g_game.playerChangeOutfit(playerId, command.outfit);
+			break;
+		case PLAYERCOMMAND_REMOVE_VIP:
+			g_game.playerRequestRemoveVip(playerId, command.id);
+			break;
+		case PLAYERCOMMAND_QUESTS:
+			g_game.playerQuests(playerId);
+			break;
+		case PLAYERCOMMAND_QUEST_INFO:
+			g_game.playerQuestInfo(playerId, command.spriteId);
+			break;
+
+		default:
+			break;
+	}
 }
 
 void ProtocolGame::GetTileDescription(const Tile* tile, OutputMessage_ptr msg)
@@ -1290,12 +1582,12 @@ void ProtocolGame::parseChannelExclude(NetworkMessage& msg)
 	}));
 }
 
-void ProtocolGame::parseGetChannels(NetworkMessage&)
+void ProtocolGame::parseGetChannels(NetworkMessage&, PlayerCommand& command)
 {
 	if (m_spectator) {
 		addDispatcherTask([self = getThis()]() { self->chat(0); });
 	} else {
-		addDispatcherTask([playerID = player->getID()]() { g_game.playerRequestChannels(playerID); });
+		command.type = PLAYERCOMMAND_GET_CHANNELS;
 	}
 }
 
@@ -1319,10 +1611,10 @@ void ProtocolGame::parseOpenChannel(NetworkMessage& msg)
 	}
 }
 
-void ProtocolGame::parseCloseChannel(NetworkMessage& msg)
+void ProtocolGame::parseCloseChannel(NetworkMessage& msg, PlayerCommand& command)
 {
-	uint16_t channelId = msg.get<uint16_t>();
-	addDispatcherTask(([playerID = player->getID(), channelId]() { g_game.playerCloseChannel(playerID, channelId); }));
+	command.type = PLAYERCOMMAND_CLOSE_CHANNEL;
+	command.spriteId = msg.get<uint16_t>();
 }
 
 void ProtocolGame::parseOpenPrivate(NetworkMessage& msg)
@@ -1415,9 +1707,10 @@ void ProtocolGame::parseAutoWalk(NetworkMessage& msg)
 	}));
 }
 
-void ProtocolGame::parseSetOutfit(NetworkMessage& msg)
+void ProtocolGame::parseSetOutfit(NetworkMessage& msg, PlayerCommand& command)
 {
-	Outfit_t newOutfit = player->m_defaultOutfit;
+	Outfit_t& newOutfit = command.outfit;
+	newOutfit = player->m_defaultOutfit;
 	if (otx::config::getBoolean(otx::config::ALLOW_CHANGEOUTFIT)) {
 		newOutfit.lookType = msg.get<uint16_t>();
 	} else {
@@ -1439,96 +1732,78 @@ void ProtocolGame::parseSetOutfit(NetworkMessage& msg)
 		msg.skipBytes(1);
 	}
 
-	addDispatcherTask(([playerID = player->getID(), outfit = std::move(newOutfit)]() {
-		g_game.playerChangeOutfit(playerID, outfit);
-	}));
+	command.type = PLAYERCOMMAND_SET_OUTFIT;
 }
 
-void ProtocolGame::parseUseItem(NetworkMessage& msg)
+void ProtocolGame::parseUseItem(NetworkMessage& msg, PlayerCommand& command)
 {
-	Position pos = msg.getPosition();
-	uint16_t spriteId = msg.get<uint16_t>();
-	int16_t stackpos = msg.get<char>();
-	uint8_t index = msg.get<char>();
-	bool isHotkey = (pos.x == 0xFFFF && !pos.y && !pos.z);
-	addTimedDispatcherTask(DISPATCHER_TASK_EXPIRATION, ([=, playerID = player->getID()]() {
-		g_game.playerUseItem(playerID, pos, stackpos, index, spriteId, isHotkey);
-	}));
+	command.type = PLAYERCOMMAND_USE_ITEM;
+	command.fromPos = msg.getPosition();
+	command.spriteId = msg.get<uint16_t>();
+	command.stackpos = msg.get<char>();
+	command.count = msg.get<char>();
+	command.flag = (command.fromPos.x == 0xFFFF && !command.fromPos.y && !command.fromPos.z);
 }
 
-void ProtocolGame::parseUseItemEx(NetworkMessage& msg)
+void ProtocolGame::parseUseItemEx(NetworkMessage& msg, PlayerCommand& command)
 {
-	Position fromPos = msg.getPosition();
-	uint16_t fromSpriteId = msg.get<uint16_t>();
-	int16_t fromStackpos = msg.get<char>();
-	Position toPos = msg.getPosition();
-	uint16_t toSpriteId = msg.get<uint16_t>();
-	int16_t toStackpos = msg.get<char>();
-	bool isHotkey = (fromPos.x == 0xFFFF && !fromPos.y && !fromPos.z);
-	addTimedDispatcherTask(DISPATCHER_TASK_EXPIRATION, ([=, playerID = player->getID()]() {
-		g_game.playerUseItemEx(playerID, fromPos, fromStackpos, fromSpriteId, toPos, toStackpos, toSpriteId, isHotkey);
-	}));
+	command.type = PLAYERCOMMAND_USE_ITEM_EX;
+	command.fromPos = msg.getPosition();
+	command.spriteId = msg.get<uint16_t>();
+	command.stackpos = msg.get<char>();
+	command.toPos = msg.getPosition();
+	command.toSpriteId = msg.get<uint16_t>();
+	command.toStackpos = msg.get<char>();
+	command.flag = (command.fromPos.x == 0xFFFF && !command.fromPos.y && !command.fromPos.z);
 }
 
-void ProtocolGame::parseBattleWindow(NetworkMessage& msg)
+void ProtocolGame::parseBattleWindow(NetworkMessage& msg, PlayerCommand& command)
 {
-	Position fromPos = msg.getPosition();
-	uint16_t spriteId = msg.get<uint16_t>();
-	int16_t fromStackpos = msg.get<char>();
-	uint32_t creatureId = msg.get<uint32_t>();
-	bool isHotkey = (fromPos.x == 0xFFFF && !fromPos.y && !fromPos.z);
-	addTimedDispatcherTask(DISPATCHER_TASK_EXPIRATION, ([=, playerID = player->getID()]() {
-		g_game.playerUseBattleWindow(playerID, fromPos, fromStackpos, creatureId, spriteId, isHotkey);
-	}));
+	command.type = PLAYERCOMMAND_BATTLE_WINDOW;
+	command.fromPos = msg.getPosition();
+	command.spriteId = msg.get<uint16_t>();
+	command.stackpos = msg.get<char>();
+	command.id = msg.get<uint32_t>();
+	command.flag = (command.fromPos.x == 0xFFFF && !command.fromPos.y && !command.fromPos.z);
 }
 
-void ProtocolGame::parseCloseContainer(NetworkMessage& msg)
+void ProtocolGame::parseCloseContainer(NetworkMessage& msg, PlayerCommand& command)
 {
-	uint8_t cid = msg.get<char>();
-	addDispatcherTask(([playerID = player->getID(), cid]() {
-		g_game.playerCloseContainer(playerID, cid);
-	}));
+	command.type = PLAYERCOMMAND_CLOSE_CONTAINER;
+	command.count = msg.get<char>();
 }
 
-void ProtocolGame::parseUpArrowContainer(NetworkMessage& msg)
+void ProtocolGame::parseUpArrowContainer(NetworkMessage& msg, PlayerCommand& command)
 {
-	uint8_t cid = msg.get<char>();
-	addDispatcherTask(([playerID = player->getID(), cid]() {
-		g_game.playerMoveUpContainer(playerID, cid);
-	}));
+	command.type = PLAYERCOMMAND_UP_ARROW_CONTAINER;
+	command.count = msg.get<char>();
 }
 
-void ProtocolGame::parseUpdateTile(NetworkMessage& msg)
+void ProtocolGame::parseUpdateTile(NetworkMessage& msg, PlayerCommand& command)
 {
-	Position pos = msg.getPosition();
-	addDispatcherTask(([playerID = player->getID(), pos]() {
-		g_game.playerUpdateTile(playerID, pos);
-	}));
+	command.type = PLAYERCOMMAND_UPDATE_TILE;
+	command.fromPos = msg.getPosition();
 }
 
-void ProtocolGame::parseUpdateContainer(NetworkMessage& msg)
+void ProtocolGame::parseUpdateContainer(NetworkMessage& msg, PlayerCommand& command)
 {
-	uint8_t cid = msg.get<char>();
-	addDispatcherTask(([playerID = player->getID(), cid]() {
-		g_game.playerUpdateContainer(playerID, cid);
-	}));
+	command.type = PLAYERCOMMAND_UPDATE_CONTAINER;
+	command.count = msg.get<char>();
 }
 
-void ProtocolGame::parseThrow(NetworkMessage& msg)
+void ProtocolGame::parseThrow(NetworkMessage& msg, PlayerCommand& command)
 {
-	Position fromPos = msg.getPosition();
-	uint16_t spriteId = msg.get<uint16_t>();
-	int16_t fromStackpos = msg.get<char>();
-	Position toPos = msg.getPosition();
-	uint8_t count = msg.get<char>();
-	if (toPos != fromPos) {
-		addTimedDispatcherTask(DISPATCHER_TASK_EXPIRATION, ([=, playerID = player->getID()]() {
-			g_game.playerMoveThing(playerID, fromPos, spriteId, fromStackpos, toPos, count);
-		}));
+	command.fromPos = msg.getPosition();
+	command.spriteId = msg.get<uint16_t>();
+	command.stackpos = msg.get<char>();
+	command.toPos = msg.getPosition();
+	command.count = msg.get<char>();
+	if (command.toPos != command.fromPos) {
+		command.type = PLAYERCOMMAND_THROW;
 	}
 }
 
-void ProtocolGame::parseLookAt(NetworkMessage& msg)
+void ProtocolGame::parseLookAt(NetworkMessage& msg, PlayerCommand& command)
 {
 	Position pos = msg.getPosition();
 	uint16_t spriteId = msg.get<uint16_t>();
@@ -1542,17 +1817,16 @@ void ProtocolGame::parseLookAt(NetworkMessage& msg)
 		return;
 	}
 
-	addTimedDispatcherTask(DISPATCHER_TASK_EXPIRATION, ([=, playerID = player->getID()]() {
-		g_game.playerLookAt(playerID, pos, spriteId, stackpos);
-	}));
+	command.type = PLAYERCOMMAND_LOOK_AT;
+	command.fromPos = pos;
+	command.spriteId = spriteId;
+	command.stackpos = stackpos;
 }
 
-void ProtocolGame::parseLookInBattleList(NetworkMessage& msg)
+void ProtocolGame::parseLookInBattleList(NetworkMessage& msg, PlayerCommand& command)
 {
-	uint32_t creatureId = msg.get<uint32_t>();
-	addTimedDispatcherTask(DISPATCHER_TASK_EXPIRATION, ([playerID = player->getID(), creatureId]() {
-		g_game.playerLookInBattleList(playerID, creatureId);
-	}));
+	command.type = PLAYERCOMMAND_LOOK_IN_BATTLE_LIST;
+	command.id = msg.get<uint32_t>();
 }
 
 void ProtocolGame::parseSay(NetworkMessage& msg)
@@ -1604,7 +1878,7 @@ void ProtocolGame::parseSay(NetworkMessage& msg)
 	}));
 }
 
-void ProtocolGame::parseFightModes(NetworkMessage& msg)
+void ProtocolGame::parseFightModes(NetworkMessage& msg, PlayerCommand& command)
 {
 	const uint8_t rawFightMode = msg.getByte(); // 1 - offensive, 2 - balanced, 3 - defensive
 	const uint8_t rawChaseMode = msg.getByte(); // 0 - stand while fightning, 1 - chase opponent
@@ -1619,30 +1893,24 @@ void ProtocolGame::parseFightModes(NetworkMessage& msg)
 		fightMode = FIGHTMODE_ATTACK;
 	}
 
-	bool chaseMode = (rawChaseMode != 0);
-	bool secureMode = (rawSecureMode != 0);
-
-	addTimedDispatcherTask(DISPATCHER_TASK_EXPIRATION, ([=, playerID = player->getID()]() {
-		g_game.playerSetFightModes(playerID, fightMode, chaseMode, secureMode);
-	}));
+	command.type = PLAYERCOMMAND_FIGHT_MODES;
+	command.count = fightMode;
+	command.flag = (rawChaseMode != 0);
+	command.secondFlag = (rawSecureMode != 0);
 }
 
-void ProtocolGame::parseAttack(NetworkMessage& msg)
+void ProtocolGame::parseAttack(NetworkMessage& msg, PlayerCommand& command)
 {
-	uint32_t creatureId = msg.get<uint32_t>();
+	command.type = PLAYERCOMMAND_ATTACK;
+	command.id = msg.get<uint32_t>();
 	// msg.get<uint32_t>(); creatureId (same as above)
-	addDispatcherTask(([playerID = player->getID(), creatureId]() {
-		g_game.playerSetAttackedCreature(playerID, creatureId);
-	}));
 }
 
-void ProtocolGame::parseFollow(NetworkMessage& msg)
+void ProtocolGame::parseFollow(NetworkMessage& msg, PlayerCommand& command)
 {
-	uint32_t creatureId = msg.get<uint32_t>();
+	command.type = PLAYERCOMMAND_FOLLOW;
+	command.id = msg.get<uint32_t>();
 	// msg.get<uint32_t>(); creatureId (same as above)
-	addDispatcherTask(([playerID = player->getID(), creatureId]() {
-		g_game.playerFollowCreature(playerID, creatureId);
-	}));
 }
 
 void ProtocolGame::parseTextWindow(NetworkMessage& msg)
@@ -1664,61 +1932,46 @@ void ProtocolGame::parseHouseWindow(NetworkMessage& msg)
 	}));
 }
 
-void ProtocolGame::parseLookInShop(NetworkMessage& msg)
+void ProtocolGame::parseLookInShop(NetworkMessage& msg, PlayerCommand& command)
 {
-	uint16_t id = msg.get<uint16_t>();
-	uint8_t count = msg.get<char>();
-	addTimedDispatcherTask(DISPATCHER_TASK_EXPIRATION, ([=, playerID = player->getID()]() {
-		g_game.playerLookInShop(playerID, id, count);
-	}));
+	command.type = PLAYERCOMMAND_LOOK_IN_SHOP;
+	command.spriteId = msg.get<uint16_t>();
+	command.count = msg.get<char>();
 }
 
-void ProtocolGame::parsePlayerPurchase(NetworkMessage& msg)
+void ProtocolGame::parsePlayerPurchase(NetworkMessage& msg, PlayerCommand& command)
 {
-	uint16_t id = msg.get<uint16_t>();
-	uint8_t count = msg.get<char>();
-	uint8_t amount = msg.get<char>();
-	bool ignoreCap = (msg.get<char>() != 0);
-	bool inBackpacks = (msg.get<char>() != 0);
-	addTimedDispatcherTask(DISPATCHER_TASK_EXPIRATION, ([=, playerID = player->getID()]() {
-		g_game.playerPurchaseItem(playerID, id, count, amount, ignoreCap, inBackpacks);
-	}));
+	command.type = PLAYERCOMMAND_PURCHASE;
+	command.spriteId = msg.get<uint16_t>();
+	command.count = msg.get<char>();
+	command.amount = msg.get<char>();
+	command.flag = (msg.get<char>() != 0);
+	command.secondFlag = (msg.get<char>() != 0);
 }
 
-void ProtocolGame::parsePlayerSale(NetworkMessage& msg)
+void ProtocolGame::parsePlayerSale(NetworkMessage& msg, PlayerCommand& command)
 {
-	uint16_t id = msg.get<uint16_t>();
-	uint8_t count = msg.get<char>();
-	uint8_t amount = msg.get<char>();
-	bool ignoreEquipped = (msg.get<char>() != 0);
-	addTimedDispatcherTask(DISPATCHER_TASK_EXPIRATION, ([=, playerID = player->getID()]() {
-		g_game.playerSellItem(playerID, id, count, amount, ignoreEquipped);
-	}));
+	command.type = PLAYERCOMMAND_SALE;
+	command.spriteId = msg.get<uint16_t>();
+	command.count = msg.get<char>();
+	command.amount = msg.get<char>();
+	command.flag = (msg.get<char>() != 0);
 }
 
-void ProtocolGame::parseRequestTrade(NetworkMessage& msg)
+void ProtocolGame::parseRequestTrade(NetworkMessage& msg, PlayerCommand& command)
 {
-	Position pos = msg.getPosition();
-	uint16_t spriteId = msg.get<uint16_t>();
-	int16_t stackpos = msg.get<char>();
-	uint32_t playerId = msg.get<uint32_t>();
-	addDispatcherTask(([=, playerID = player->getID()]() {
-		g_game.playerRequestTrade(playerID, pos, stackpos, playerId, spriteId);
-	}));
+	command.type = PLAYERCOMMAND_REQUEST_TRADE;
+	command.fromPos = msg.getPosition();
+	command.spriteId = msg.get<uint16_t>();
+	command.stackpos = msg.get<char>();
+	command.id = msg.get<uint32_t>();
 }
 
-void ProtocolGame::parseLookInTrade(NetworkMessage& msg)
+void ProtocolGame::parseLookInTrade(NetworkMessage& msg, PlayerCommand& command)
 {
-	bool counter = (msg.get<char>() != 0);
-	int32_t index = msg.get<char>();
-	addTimedDispatcherTask(DISPATCHER_TASK_EXPIRATION, ([=, playerID = player->getID()]() {
-		g_game.playerLookInTrade(playerID, counter, index);
-	}));
-}
-
-void ProtocolGame::parseCloseTrade()
-{
-	addDispatcherTask([playerID = player->getID()]() { g_game.playerCloseTrade(playerID); });
+	command.type = PLAYERCOMMAND_LOOK_IN_TRADE;
+	command.flag = (msg.get<char>() != 0);
+	command.stackpos = msg.get<char>();
 }
 
 void ProtocolGame::parseAddVip(NetworkMessage& msg)
@@ -1733,22 +1986,18 @@ void ProtocolGame::parseAddVip(NetworkMessage& msg)
 	}));
 }
 
-void ProtocolGame::parseRemoveVip(NetworkMessage& msg)
+void ProtocolGame::parseRemoveVip(NetworkMessage& msg, PlayerCommand& command)
 {
-	uint32_t guid = msg.get<uint32_t>();
-	addDispatcherTask(([playerID = player->getID(), guid]() {
-		g_game.playerRequestRemoveVip(playerID, guid);
-	}));
+	command.type = PLAYERCOMMAND_REMOVE_VIP;
+	command.id = msg.get<uint32_t>();
 }
 
-void ProtocolGame::parseRotateItem(NetworkMessage& msg)
+void ProtocolGame::parseRotateItem(NetworkMessage& msg, PlayerCommand& command)
 {
-	Position pos = msg.getPosition();
-	uint16_t spriteId = msg.get<uint16_t>();
-	int16_t stackpos = msg.get<char>();
-	addTimedDispatcherTask(DISPATCHER_TASK_EXPIRATION, ([=, playerID = player->getID()]() {
-		g_game.playerRotateItem(playerID, pos, stackpos, spriteId);
-	}));
+	command.type = PLAYERCOMMAND_ROTATE_ITEM;
+	command.fromPos = msg.getPosition();
+	command.spriteId = msg.get<uint16_t>();
+	command.stackpos = msg.get<char>();
 }
 
 void ProtocolGame::parseDebugAssert(NetworkMessage& msg)
@@ -1778,52 +2027,40 @@ void ProtocolGame::parseBugReport(NetworkMessage& msg)
 	}));
 }
 
-void ProtocolGame::parseInviteToParty(NetworkMessage& msg)
+void ProtocolGame::parseInviteToParty(NetworkMessage& msg, PlayerCommand& command)
 {
-	uint32_t targetId = msg.get<uint32_t>();
-	addDispatcherTask(([playerID = player->getID(), targetId]() {
-		g_game.playerInviteToParty(playerID, targetId);
-	}));
+	command.type = PLAYERCOMMAND_INVITE_TO_PARTY;
+	command.id = msg.get<uint32_t>();
 }
 
-void ProtocolGame::parseJoinParty(NetworkMessage& msg)
+void ProtocolGame::parseJoinParty(NetworkMessage& msg, PlayerCommand& command)
 {
-	uint32_t targetId = msg.get<uint32_t>();
-	addDispatcherTask(([playerID = player->getID(), targetId]() {
-		g_game.playerJoinParty(playerID, targetId);
-	}));
+	command.type = PLAYERCOMMAND_JOIN_PARTY;
+	command.id = msg.get<uint32_t>();
 }
 
-void ProtocolGame::parseRevokePartyInvite(NetworkMessage& msg)
+void ProtocolGame::parseRevokePartyInvite(NetworkMessage& msg, PlayerCommand& command)
 {
-	uint32_t targetId = msg.get<uint32_t>();
-	addDispatcherTask(([playerID = player->getID(), targetId]() {
-		g_game.playerRevokePartyInvitation(playerID, targetId);
-	}));
+	command.type = PLAYERCOMMAND_REVOKE_PARTY_INVITE;
+	command.id = msg.get<uint32_t>();
 }
 
-void ProtocolGame::parsePassPartyLeadership(NetworkMessage& msg)
+void ProtocolGame::parsePassPartyLeadership(NetworkMessage& msg, PlayerCommand& command)
 {
-	uint32_t targetId = msg.get<uint32_t>();
-	addDispatcherTask(([playerID = player->getID(), targetId]() {
-		g_game.playerPassPartyLeadership(playerID, targetId);
-	}));
+	command.type = PLAYERCOMMAND_PASS_PARTY_LEADERSHIP;
+	command.id = msg.get<uint32_t>();
 }
 
-void ProtocolGame::parseSharePartyExperience(NetworkMessage& msg)
+void ProtocolGame::parseSharePartyExperience(NetworkMessage& msg, PlayerCommand& command)
 {
-	bool activate = (msg.get<char>() != 0);
-	addDispatcherTask(([playerID = player->getID(), activate]() {
-		g_game.playerSharePartyExperience(playerID, activate);
-	}));
+	command.type = PLAYERCOMMAND_SHARE_PARTY_EXPERIENCE;
+	command.flag = (msg.get<char>() != 0);
 }
 
-void ProtocolGame::parseQuestInfo(NetworkMessage& msg)
+void ProtocolGame::parseQuestInfo(NetworkMessage& msg, PlayerCommand& command)
 {
-	uint16_t questId = msg.get<uint16_t>();
-	addDispatcherTask(([playerID = player->getID(), questId]() {
-		g_game.playerQuestInfo(playerID, questId);
-	}));
+	command.type = PLAYERCOMMAND_QUEST_INFO;
+	command.spriteId = msg.get<uint16_t>();
 }
 
 void ProtocolGame::parseViolationReport(NetworkMessage& msg)
@@ -18,6 +18,8 @@
 #pragma once
 
 #include "creature.h"
+#include "packetcapture.h"
+#include "playercommand.h"
 #include "protocol.h"
 
 class NetworkMessage;
@@ -28,6 +30,7 @@ class Container;
 class Tile;
 class Connection;
 class Quest;
+struct PlayerLoadData;
 class Depot;
 class Spectators;
 
@@ -49,9 +52,15 @@ public:
 
 #if ENABLE_SERVER_DIAGNOSTIC > 0
 	static uint32_t protocolGameCount;
+	// logins placed and the dispatcher time they took, in microseconds
+	static uint64_t loginCount, loginTime;
+	// commands executed, dispatcher batches they took and commands dropped by full queues
+	static uint64_t commandCount, commandBatches, commandsDropped;
 #endif
 
-	explicit ProtocolGame(Connection_ptr connection) : Protocol(connection) {
+	explicit ProtocolGame(Connection_ptr connection) :
+		Protocol(connection),
+		m_commands(otx::config::getInteger(otx::config::PLAYER_COMMAND_QUEUE)) {
 		lastCastMsg = 0;
 #if ENABLE_SERVER_DIAGNOSTIC > 0
 		++ProtocolGame::protocolGameCount;
@@ -95,6 +104,7 @@ private:
 	void checkCreatureAsKnown(uint32_t id, bool& known, uint32_t& removedKnown);
 
 	bool connect(uint32_t playerId, OperatingSystem_t operatingSystem, uint16_t version, bool replace = false);
+	void login(const std::string& name, uint32_t id, OperatingSystem_t operatingSystem, uint16_t version, bool gamemaster, PlayerLoadData& data);
 
 	void release() final;
 
@@ -104,67 +114,71 @@ private:
 
 	void onConnect() override;
 	void onRecvFirstMessage(NetworkMessage& msg) override;
+	int32_t getRSABlockOffset() const override { return 4; }
 
 	void parsePacket(NetworkMessage& msg) override;
 
+	void queueCommand(PlayerCommand& command);
+	void executeCommands(uint32_t playerId);
+	void executeCommand(uint32_t playerId, const PlayerCommand& command);
+
 	// Parse methods
 	void parseTelescopeBack(bool lostConnection);
 
 	void parseAutoWalk(NetworkMessage& msg);
 
-	void parseSetOutfit(NetworkMessage& msg);
+	void parseSetOutfit(NetworkMessage& msg, PlayerCommand& command);
 	void parseSay(NetworkMessage& msg);
-	void parseLookAt(NetworkMessage& msg);
-	void parseLookInBattleList(NetworkMessage& msg);
-	void parseFightModes(NetworkMessage& msg);
-	void parseAttack(NetworkMessage& msg);
-	void parseFollow(NetworkMessage& msg);
+	void parseLookAt(NetworkMessage& msg, PlayerCommand& command);
+	void parseLookInBattleList(NetworkMessage& msg, PlayerCommand& command);
+	void parseFightModes(NetworkMessage& msg, PlayerCommand& command);
+	void parseAttack(NetworkMessage& msg, PlayerCommand& command);
+	void parseFollow(NetworkMessage& msg, PlayerCommand& command);
 
 	void parseBugReport(NetworkMessage& msg);
 	void parseDebugAssert(NetworkMessage& msg);
 
-	void parseThrow(NetworkMessage& msg);
-	void parseUseItemEx(NetworkMessage& msg);
-	void parseBattleWindow(NetworkMessage& msg);
-	void parseUseItem(NetworkMessage& msg);
-	void parseCloseContainer(NetworkMessage& msg);
-	void parseUpArrowContainer(NetworkMessage& msg);
-	void parseUpdateTile(NetworkMessage& msg);
-	void parseUpdateContainer(NetworkMessage& msg);
+	void parseThrow(NetworkMessage& msg, PlayerCommand& command);
+	void parseUseItemEx(NetworkMessage& msg, PlayerCommand& command);
+	void parseBattleWindow(NetworkMessage& msg, PlayerCommand& command);
+	void parseUseItem(NetworkMessage& msg, PlayerCommand& command);
+	void parseCloseContainer(NetworkMessage& msg, PlayerCommand& command);
+	void parseUpArrowContainer(NetworkMessage& msg, PlayerCommand& command);
+	void parseUpdateTile(NetworkMessage& msg, PlayerCommand& command);
+	void parseUpdateContainer(NetworkMessage& msg, PlayerCommand& command);
 	void parseTextWindow(NetworkMessage& msg);
 	void parseHouseWindow(NetworkMessage& msg);
 
-	void parseLookInShop(NetworkMessage& msg);
-	void parsePlayerPurchase(NetworkMessage& msg);
-	void parsePlayerSale(NetworkMessage& msg);
+	void parseLookInShop(NetworkMessage& msg, PlayerCommand& command);
+	void parsePlayerPurchase(NetworkMessage& msg, PlayerCommand& command);
+	void parsePlayerSale(NetworkMessage& msg, PlayerCommand& command);
 
 	void parseQuests(NetworkMessage& msg);
-	void parseQuestInfo(NetworkMessage& msg);
+	void parseQuestInfo(NetworkMessage& msg, PlayerCommand& command);
 
-	void parseInviteToParty(NetworkMessage& msg);
-	void parseJoinParty(NetworkMessage& msg);
-	void parseRevokePartyInvite(NetworkMessage& msg);
-	void parsePassPartyLeadership(NetworkMessage& msg);
-	void parseSharePartyExperience(NetworkMessage& msg);
+	void parseInviteToParty(NetworkMessage& msg, PlayerCommand& command);
+	void parseJoinParty(NetworkMessage& msg, PlayerCommand& command);
+	void parseRevokePartyInvite(NetworkMessage& msg, PlayerCommand& command);
+	void parsePassPartyLeadership(NetworkMessage& msg, PlayerCommand& command);
+	void parseSharePartyExperience(NetworkMessage& msg, PlayerCommand& command);
 
 	// trade methods
-	void parseRequestTrade(NetworkMessage& msg);
-	void parseLookInTrade(NetworkMessage& msg);
-	void parseCloseTrade();
+	void parseRequestTrade(NetworkMessage& msg, PlayerCommand& command);
+	void parseLookInTrade(NetworkMessage& msg, PlayerCommand& command);
 
 	// VIP methods
 	void parseAddVip(NetworkMessage& msg);
-	void parseRemoveVip(NetworkMessage& msg);
+	void parseRemoveVip(NetworkMessage& msg, PlayerCommand& command);
 
-	void parseRotateItem(NetworkMessage& msg);
+	void parseRotateItem(NetworkMessage& msg, PlayerCommand& command);
 
 	// Channel tabs
 	void parseChannelInvite(NetworkMessage& msg);
 	void parseChannelExclude(NetworkMessage& msg);
-	void parseGetChannels(NetworkMessage& msg);
+	void parseGetChannels(NetworkMessage& msg, PlayerCommand& command);
 	void parseOpenChannel(NetworkMessage& msg);
 	void parseOpenPrivate(NetworkMessage& msg);
-	void parseCloseChannel(NetworkMessage& msg);
+	void parseCloseChannel(NetworkMessage& msg, PlayerCommand& command);
 
 	// rule violation
 	void parseViolationReport(NetworkMessage& msg);
@@ -328,6 +342,13 @@ private:
 	bool castlistopen = false;
 	bool spy = false;
 
+	PlayerCommandQueue m_commands;
+	bool m_commandFlood = false;
+
+	std::unique_ptr<PacketCapture> m_capture;
+	bool m_replay = false; // driven by PacketReplay, there is no connection behind it
+
 	friend class Player;
 	friend class Spectators;
+	friend class PacketReplay;
 };
@@ -46,6 +46,7 @@ public:
 #endif
 
 	void onRecvFirstMessage(NetworkMessage& msg) override;
+	int32_t getRSABlockOffset() const override { return 16; }
 
 private:
 	void disconnectClient(uint8_t error, const char* message);
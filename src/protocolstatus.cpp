@@ -28,6 +28,8 @@
 
 #if ENABLE_SERVER_DIAGNOSTIC > 0
 uint32_t ProtocolStatus::protocolStatusCount = 0;
+std::atomic<uint32_t> ProtocolStatus::cacheHits{ 0 };
+std::atomic<uint32_t> ProtocolStatus::cacheMisses{ 0 };
 #endif
 
 namespace
@@ -43,8 +45,159 @@ namespace
 	constexpr uint8_t REQUEST_PLAYER_STATUS_INFO   = 1 << 6;
 	constexpr uint8_t REQUEST_SERVER_SOFTWARE_INFO = 1 << 7;
 
+	std::mutex snapshotLock;
+	StatusSnapshotPtr snapshot;
+	std::atomic<bool> snapshotDirty{ true };
+
+	std::string buildStatusString()
+	{
+		xmlDocPtr doc = xmlNewDoc(reinterpret_cast<const xmlChar*>("1.0"));
+		doc->children = xmlNewDocNode(doc, nullptr, reinterpret_cast<const xmlChar*>("tsqp"), nullptr);
+		xmlNodePtr root = doc->children;
+
+		char buffer[90];
+		xmlSetProp(root, reinterpret_cast<const xmlChar*>("version"), reinterpret_cast<const xmlChar*>("1.0"));
+
+		xmlNodePtr p = xmlNewNode(nullptr, reinterpret_cast<const xmlChar*>("serverinfo"));
+		sprintf(buffer, "%u", static_cast<uint32_t>(g_game.getUptime()));
+		xmlSetProp(p, reinterpret_cast<const xmlChar*>("uptime"), reinterpret_cast<const xmlChar*>(buffer));
+		xmlSetProp(p, reinterpret_cast<const xmlChar*>("ip"), reinterpret_cast<const xmlChar*>(otx::config::getString(otx::config::IP).c_str()));
+		xmlSetProp(p, reinterpret_cast<const xmlChar*>("servername"), reinterpret_cast<const xmlChar*>(otx::config::getString(otx::config::SERVER_NAME).c_str()));
+		sprintf(buffer, "%d", static_cast<int32_t>(otx::config::getInteger(otx::config::LOGIN_PORT)));
+		xmlSetProp(p, reinterpret_cast<const xmlChar*>("port"), reinterpret_cast<const xmlChar*>(buffer));
+		xmlSetProp(p, reinterpret_cast<const xmlChar*>("location"), reinterpret_cast<const xmlChar*>(otx::config::getString(otx::config::LOCATION).c_str()));
+		xmlSetProp(p, reinterpret_cast<const xmlChar*>("url"), reinterpret_cast<const xmlChar*>(otx::config::getString(otx::config::URL).c_str()));
+		xmlSetProp(p, reinterpret_cast<const xmlChar*>("server"), reinterpret_cast<const xmlChar*>(SOFTWARE_NAME));
+		xmlSetProp(p, reinterpret_cast<const xmlChar*>("version"), reinterpret_cast<const xmlChar*>(SOFTWARE_VERSION));
+		xmlSetProp(p, reinterpret_cast<const xmlChar*>("client"), reinterpret_cast<const xmlChar*>(CLIENT_VERSION_STRING));
+		xmlAddChild(root, p);
+
+		p = xmlNewNode(nullptr, reinterpret_cast<const xmlChar*>("owner"));
+		xmlSetProp(p, reinterpret_cast<const xmlChar*>("name"), reinterpret_cast<const xmlChar*>(otx::config::getString(otx::config::OWNER_NAME).c_str()));
+		xmlSetProp(p, reinterpret_cast<const xmlChar*>("email"), reinterpret_cast<const xmlChar*>(otx::config::getString(otx::config::OWNER_EMAIL).c_str()));
+		xmlAddChild(root, p);
+
+		p = xmlNewNode(nullptr, reinterpret_cast<const xmlChar*>("players"));
+
+		uint32_t realOnline = 0;
+		uint32_t uniqueOnline = 0;
+		std::map<uint32_t, uint32_t> listIP;
+		for (const auto& it : g_game.getPlayers()) {
+			uint32_t ipAddress = it.second->getIP();
+			if (ipAddress != 0 && it.second->getIdleTime() < 960000) {
+				auto& count = listIP[ipAddress];
+				if (count == 0) {
+					++uniqueOnline;
+				}
+
+				if (++count <= 4) {
+					++realOnline;
+				}
+			}
+		}
+
+		sprintf(buffer, "%d", realOnline);
+		xmlSetProp(p, reinterpret_cast<const xmlChar*>("online"), reinterpret_cast<const xmlChar*>(buffer));
+
+		sprintf(buffer, "%d", uniqueOnline);
+		xmlSetProp(p, reinterpret_cast<const xmlChar*>("unique"), reinterpret_cast<const xmlChar*>(buffer));
+
+		sprintf(buffer, "%d", static_cast<int32_t>(otx::config::getInteger(otx::config::MAX_PLAYERS)));
+		xmlSetProp(p, reinterpret_cast<const xmlChar*>("max"), reinterpret_cast<const xmlChar*>(buffer));
+
+		sprintf(buffer, "%d", g_game.getPlayersRecord());
+		xmlSetProp(p, reinterpret_cast<const xmlChar*>("peak"), reinterpret_cast<const xmlChar*>(buffer));
+
+		xmlAddChild(root, p);
+
+		p = xmlNewNode(nullptr, reinterpret_cast<const xmlChar*>("monsters"));
+		sprintf(buffer, "%d", g_game.getMonstersOnline());
+		xmlSetProp(p, reinterpret_cast<const xmlChar*>("total"), reinterpret_cast<const xmlChar*>(buffer));
+		xmlAddChild(root, p);
+
+		p = xmlNewNode(nullptr, reinterpret_cast<const xmlChar*>("npcs"));
+		sprintf(buffer, "%d", g_game.getNpcsOnline());
+		xmlSetProp(p, reinterpret_cast<const xmlChar*>("total"), reinterpret_cast<const xmlChar*>(buffer));
+		xmlAddChild(root, p);
+
+		p = xmlNewNode(nullptr, reinterpret_cast<const xmlChar*>("map"));
+		xmlSetProp(p, reinterpret_cast<const xmlChar*>("name"), reinterpret_cast<const xmlChar*>(otx::config::getString(otx::config::MAP_NAME).c_str()));
+		xmlSetProp(p, reinterpret_cast<const xmlChar*>("author"), reinterpret_cast<const xmlChar*>(otx::config::getString(otx::config::MAP_AUTHOR).c_str()));
+
+		uint32_t mapWidth, mapHeight;
+		g_game.getMapDimensions(mapWidth, mapHeight);
+		sprintf(buffer, "%u", mapWidth);
+		xmlSetProp(p, reinterpret_cast<const xmlChar*>("width"), reinterpret_cast<const xmlChar*>(buffer));
+		sprintf(buffer, "%u", mapHeight);
+
+		xmlSetProp(p, reinterpret_cast<const xmlChar*>("height"), reinterpret_cast<const xmlChar*>(buffer));
+		xmlAddChild(root, p);
+
+		xmlNewTextChild(root, nullptr, reinterpret_cast<const xmlChar*>("motd"), reinterpret_cast<const xmlChar*>(otx::config::getString(otx::config::MOTD).c_str()));
+
+		xmlChar* s = nullptr;
+		int32_t len = 0;
+		xmlDocDumpMemory(doc, &s, &len);
+
+		std::string xml;
+		if (s) {
+			xml = std::string(reinterpret_cast<char*>(s), len);
+		}
+
+		xmlFree(s);
+		xmlFreeDoc(doc);
+		return xml;
+	}
+
+	// any thread, returns nullptr when the snapshot has to be rebuilt
+	StatusSnapshotPtr getCachedSnapshot()
+	{
+		if (snapshotDirty.load(std::memory_order_relaxed)) {
+			return nullptr;
+		}
+
+		std::lock_guard<std::mutex> lockClass(snapshotLock);
+		if (!snapshot || otx::util::mstime() - snapshot->created >= otx::config::getInteger(otx::config::STATUS_CACHE_TIME)) {
+			return nullptr;
+		}
+		return snapshot;
+	}
+
+	// dispatcher thread
+	StatusSnapshotPtr updateSnapshot()
+	{
+		if (auto cached = getCachedSnapshot()) {
+			return cached;
+		}
+
+		snapshotDirty.store(false, std::memory_order_relaxed);
+
+		auto newSnapshot = std::make_shared<StatusSnapshot>();
+		newSnapshot->xml = buildStatusString();
+		for (const auto& it : g_game.getPlayers()) {
+			if (!it.second->isGhost()) {
+				newSnapshot->players.emplace_back(it.second->getName(), it.second->getLevel());
+			}
+		}
+
+		newSnapshot->created = otx::util::mstime();
+		newSnapshot->uptime = g_game.getUptime();
+		newSnapshot->playersOnline = g_game.getPlayersOnline();
+		newSnapshot->playersRecord = g_game.getPlayersRecord();
+		g_game.getMapDimensions(newSnapshot->mapWidth, newSnapshot->mapHeight);
+
+		std::lock_guard<std::mutex> lockClass(snapshotLock);
+		snapshot = std::move(newSnapshot);
+		return snapshot;
+	}
+
 } // namespace
 
+void ProtocolStatus::invalidateCache()
+{
+	snapshotDirty.store(true, std::memory_order_relaxed);
+}
+
 void ProtocolStatus::onRecvFirstMessage(NetworkMessage& msg)
 {
 	const int64_t timeNow = otx::util::mstime();
@@ -63,7 +216,19 @@ void ProtocolStatus::onRecvFirstMessage(NetworkMessage& msg)
 	switch (type) {
 		case 0xFF: {
 			if (msg.getString(4) == "info") {
-				addDispatcherTask([self = getThis()]() { self->sendStatusString(); });
+				// served right away from the network thread when possible
+				if (auto cached = getCachedSnapshot()) {
+#if ENABLE_SERVER_DIAGNOSTIC > 0
+					++cacheHits;
+#endif
+					sendStatusString(*cached);
+					return;
+				}
+
+#if ENABLE_SERVER_DIAGNOSTIC > 0
+				++cacheMisses;
+#endif
+				addDispatcherTask([self = getThis()]() { self->sendStatusString(*updateSnapshot()); });
 				return;
 			}
 
@@ -75,10 +240,20 @@ void ProtocolStatus::onRecvFirstMessage(NetworkMessage& msg)
 			std::string characterName;
 			if (requestedInfo & REQUEST_PLAYER_STATUS_INFO) {
 				characterName = msg.getString();
+			} else if (auto cached = getCachedSnapshot()) {
+				// player status needs a lookup in the game world, everything else is cached
+#if ENABLE_SERVER_DIAGNOSTIC > 0
+				++cacheHits;
+#endif
+				sendInfo(requestedInfo, characterName, *cached);
+				return;
 			}
 
+#if ENABLE_SERVER_DIAGNOSTIC > 0
+			++cacheMisses;
+#endif
 			addDispatcherTask(([self = getThis(), requestedInfo, characterName = std::move(characterName)]() {
-				self->sendInfo(requestedInfo, characterName);
+				self->sendInfo(requestedInfo, characterName, *updateSnapshot());
 			}));
 			return;
 		}
@@ -90,114 +265,18 @@ void ProtocolStatus::onRecvFirstMessage(NetworkMessage& msg)
 	disconnect();
 }
 
-void ProtocolStatus::sendStatusString()
+void ProtocolStatus::sendStatusString(const StatusSnapshot& status)
 {
 	auto output = OutputMessagePool::getOutputMessage();
 
 	setRawMessages(true);
 
-	xmlDocPtr doc = xmlNewDoc(reinterpret_cast<const xmlChar*>("1.0"));
-	doc->children = xmlNewDocNode(doc, nullptr, reinterpret_cast<const xmlChar*>("tsqp"), nullptr);
-	xmlNodePtr root = doc->children;
-
-	char buffer[90];
-	xmlSetProp(root, reinterpret_cast<const xmlChar*>("version"), reinterpret_cast<const xmlChar*>("1.0"));
-
-	xmlNodePtr p = xmlNewNode(nullptr, reinterpret_cast<const xmlChar*>("serverinfo"));
-	sprintf(buffer, "%u", static_cast<uint32_t>(g_game.getUptime()));
-	xmlSetProp(p, reinterpret_cast<const xmlChar*>("uptime"), reinterpret_cast<const xmlChar*>(buffer));
-	xmlSetProp(p, reinterpret_cast<const xmlChar*>("ip"), reinterpret_cast<const xmlChar*>(otx::config::getString(otx::config::IP).c_str()));
-	xmlSetProp(p, reinterpret_cast<const xmlChar*>("servername"), reinterpret_cast<const xmlChar*>(otx::config::getString(otx::config::SERVER_NAME).c_str()));
-	sprintf(buffer, "%d", static_cast<int32_t>(otx::config::getInteger(otx::config::LOGIN_PORT)));
-	xmlSetProp(p, reinterpret_cast<const xmlChar*>("port"), reinterpret_cast<const xmlChar*>(buffer));
-	xmlSetProp(p, reinterpret_cast<const xmlChar*>("location"), reinterpret_cast<const xmlChar*>(otx::config::getString(otx::config::LOCATION).c_str()));
-	xmlSetProp(p, reinterpret_cast<const xmlChar*>("url"), reinterpret_cast<const xmlChar*>(otx::config::getString(otx::config::URL).c_str()));
-	xmlSetProp(p, reinterpret_cast<const xmlChar*>("server"), reinterpret_cast<const xmlChar*>(SOFTWARE_NAME));
-	xmlSetProp(p, reinterpret_cast<const xmlChar*>("version"), reinterpret_cast<const xmlChar*>(SOFTWARE_VERSION));
-	xmlSetProp(p, reinterpret_cast<const xmlChar*>("client"), reinterpret_cast<const xmlChar*>(CLIENT_VERSION_STRING));
-	xmlAddChild(root, p);
-
-	p = xmlNewNode(nullptr, reinterpret_cast<const xmlChar*>("owner"));
-	xmlSetProp(p, reinterpret_cast<const xmlChar*>("name"), reinterpret_cast<const xmlChar*>(otx::config::getString(otx::config::OWNER_NAME).c_str()));
-	xmlSetProp(p, reinterpret_cast<const xmlChar*>("email"), reinterpret_cast<const xmlChar*>(otx::config::getString(otx::config::OWNER_EMAIL).c_str()));
-	xmlAddChild(root, p);
-
-	p = xmlNewNode(nullptr, reinterpret_cast<const xmlChar*>("players"));
-
-	uint32_t realOnline = 0;
-	uint32_t uniqueOnline = 0;
-	std::map<uint32_t, uint32_t> listIP;
-	for (const auto& it : g_game.getPlayers()) {
-		uint32_t ipAddress = it.second->getIP();
-		if (ipAddress != 0 && it.second->getIdleTime() < 960000) {
-			auto& count = listIP[ipAddress];
-			if (count == 0) {
-				++uniqueOnline;
-			}
-
-			if (++count <= 4) {
-				++realOnline;
-			}
-		}
-	}
-
-	sprintf(buffer, "%d", realOnline);
-	xmlSetProp(p, reinterpret_cast<const xmlChar*>("online"), reinterpret_cast<const xmlChar*>(buffer));
-
-	sprintf(buffer, "%d", uniqueOnline);
-	xmlSetProp(p, reinterpret_cast<const xmlChar*>("unique"), reinterpret_cast<const xmlChar*>(buffer));
-
-	sprintf(buffer, "%d", static_cast<int32_t>(otx::config::getInteger(otx::config::MAX_PLAYERS)));
-	xmlSetProp(p, reinterpret_cast<const xmlChar*>("max"), reinterpret_cast<const xmlChar*>(buffer));
-
-	sprintf(buffer, "%d", g_game.getPlayersRecord());
-	xmlSetProp(p, reinterpret_cast<const xmlChar*>("peak"), reinterpret_cast<const xmlChar*>(buffer));
-
-	xmlAddChild(root, p);
-
-	p = xmlNewNode(nullptr, reinterpret_cast<const xmlChar*>("monsters"));
-	sprintf(buffer, "%d", g_game.getMonstersOnline());
-	xmlSetProp(p, reinterpret_cast<const xmlChar*>("total"), reinterpret_cast<const xmlChar*>(buffer));
-	xmlAddChild(root, p);
-
-	p = xmlNewNode(nullptr, reinterpret_cast<const xmlChar*>("npcs"));
-	sprintf(buffer, "%d", g_game.getNpcsOnline());
-	xmlSetProp(p, reinterpret_cast<const xmlChar*>("total"), reinterpret_cast<const xmlChar*>(buffer));
-	xmlAddChild(root, p);
-
-	p = xmlNewNode(nullptr, reinterpret_cast<const xmlChar*>("map"));
-	xmlSetProp(p, reinterpret_cast<const xmlChar*>("name"), reinterpret_cast<const xmlChar*>(otx::config::getString(otx::config::MAP_NAME).c_str()));
-	xmlSetProp(p, reinterpret_cast<const xmlChar*>("author"), reinterpret_cast<const xmlChar*>(otx::config::getString(otx::config::MAP_AUTHOR).c_str()));
-
-	uint32_t mapWidth, mapHeight;
-	g_game.getMapDimensions(mapWidth, mapHeight);
-	sprintf(buffer, "%u", mapWidth);
-	xmlSetProp(p, reinterpret_cast<const xmlChar*>("width"), reinterpret_cast<const xmlChar*>(buffer));
-	sprintf(buffer, "%u", mapHeight);
-
-	xmlSetProp(p, reinterpret_cast<const xmlChar*>("height"), reinterpret_cast<const xmlChar*>(buffer));
-	xmlAddChild(root, p);
-
-	xmlNewTextChild(root, nullptr, reinterpret_cast<const xmlChar*>("motd"), reinterpret_cast<const xmlChar*>(otx::config::getString(otx::config::MOTD).c_str()));
-
-	xmlChar* s = nullptr;
-	int32_t len = 0;
-	xmlDocDumpMemory(doc, &s, &len);
-
-	std::string xml;
-	if (s) {
-		xml = std::string(reinterpret_cast<char*>(s), len);
-	}
-
-	xmlFree(s);
-	xmlFreeDoc(doc);
-
-	output->addBytes(xml.c_str(), xml.size());
+	output->addBytes(status.xml.c_str(), status.xml.size());
 	send(output);
 	disconnect();
 }
 
-void ProtocolStatus::sendInfo(uint16_t requestedInfo, const std::string& characterName)
+void ProtocolStatus::sendInfo(uint16_t requestedInfo, const std::string& characterName, const StatusSnapshot& status)
 {
 	auto output = OutputMessagePool::getOutputMessage();
 
@@ -222,44 +301,35 @@ void ProtocolStatus::sendInfo(uint16_t requestedInfo, const std::string& charact
 		output->addString(otx::config::getString(otx::config::MOTD).c_str());
 		output->addString(otx::config::getString(otx::config::LOCATION).c_str());
 		output->addString(otx::config::getString(otx::config::URL).c_str());
-		output->add<uint64_t>(g_game.getUptime());
+		output->add<uint64_t>(status.uptime);
 	}
 
 	if (requestedInfo & REQUEST_PLAYERS_INFO) {
 		output->addByte(0x20);
-		output->add<uint32_t>(g_game.getPlayersOnline());
+		output->add<uint32_t>(status.playersOnline);
 		output->add<uint32_t>(otx::config::getInteger(otx::config::MAX_PLAYERS));
-		output->add<uint32_t>(g_game.getPlayersRecord());
+		output->add<uint32_t>(status.playersRecord);
 	}
 
 	if (requestedInfo & REQUEST_MAP_INFO) {
 		output->addByte(0x30);
 		output->addString(otx::config::getString(otx::config::MAP_NAME).c_str());
 		output->addString(otx::config::getString(otx::config::MAP_AUTHOR).c_str());
-
-		uint32_t mapWidth, mapHeight;
-		g_game.getMapDimensions(mapWidth, mapHeight);
-		output->add<uint16_t>(mapWidth);
-		output->add<uint16_t>(mapHeight);
+		output->add<uint16_t>(status.mapWidth);
+		output->add<uint16_t>(status.mapHeight);
 	}
 
 	if (requestedInfo & REQUEST_EXT_PLAYERS_INFO) {
 		output->addByte(0x21);
-		std::list<std::pair<std::string, uint32_t>> players;
-		for (const auto& it : g_game.getPlayers()) {
-			if (!it.second->isGhost()) {
-				players.emplace_back(it.second->getName(), it.second->getLevel());
-			}
-		}
-
-		output->add<uint32_t>(players.size());
-		for (std::list<std::pair<std::string, uint32_t>>::iterator it = players.begin(); it != players.end(); ++it) {
-			output->addString(it->first);
-			output->add<uint32_t>(it->second);
+		output->add<uint32_t>(status.players.size());
+		for (const auto& it : status.players) {
+			output->addString(it.first);
+			output->add<uint32_t>(it.second);
 		}
 	}
 
 	if (requestedInfo & REQUEST_PLAYER_STATUS_INFO) {
+		// dispatcher thread only
 		output->addByte(0x22);
 
 		Player* p = nullptr;
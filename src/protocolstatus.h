@@ -23,6 +23,21 @@
 class ProtocolStatus;
 using ProtocolStatusPtr = std::shared_ptr<ProtocolStatus>;
 
+// pre-rendered server information, shared by status requests until it expires
+struct StatusSnapshot
+{
+	std::string xml;
+	std::vector<std::pair<std::string, uint32_t>> players;
+
+	int64_t created = 0;
+	uint64_t uptime = 0;
+	uint32_t playersOnline = 0;
+	uint32_t playersRecord = 0;
+	uint32_t mapWidth = 0;
+	uint32_t mapHeight = 0;
+};
+using StatusSnapshotPtr = std::shared_ptr<const StatusSnapshot>;
+
 class ProtocolStatus final : public Protocol
 {
 public:
@@ -34,6 +49,8 @@ public:
 
 #if ENABLE_SERVER_DIAGNOSTIC > 0
 	static uint32_t protocolStatusCount;
+	static std::atomic<uint32_t> cacheHits;
+	static std::atomic<uint32_t> cacheMisses;
 #endif
 
 	explicit ProtocolStatus(Connection_ptr connection) : Protocol(connection) {
@@ -49,8 +66,11 @@ public:
 
 	void onRecvFirstMessage(NetworkMessage& msg) override;
 
-	void sendStatusString();
-	void sendInfo(uint16_t requestedInfo, const std::string& characterName);
+	void sendStatusString(const StatusSnapshot& status);
+	void sendInfo(uint16_t requestedInfo, const std::string& characterName, const StatusSnapshot& status);
+
+	// forces the next request to rebuild the cached status
+	static void invalidateCache();
 
 	ProtocolStatusPtr getThis() {
 		return std::static_pointer_cast<ProtocolStatus>(shared_from_this());
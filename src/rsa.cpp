@@ -19,6 +19,40 @@
 
 #include "rsa.h"
 
+namespace
+{
+	// scratch values of a single decryption, allocated once per thread
+	struct RSAContext
+	{
+		RSAContext()
+		{
+			mpz_init2(c, 1024);
+			mpz_init2(v1, 1024);
+			mpz_init2(v2, 1024);
+			mpz_init2(u2, 1024);
+			mpz_init2(tmp, 1024);
+		}
+
+		~RSAContext()
+		{
+			mpz_clear(c);
+			mpz_clear(v1);
+			mpz_clear(v2);
+			mpz_clear(u2);
+			mpz_clear(tmp);
+		}
+
+		// non-copyable
+		RSAContext(const RSAContext&) = delete;
+		RSAContext& operator=(const RSAContext&) = delete;
+
+		mpz_t c, v1, v2, u2, tmp;
+	};
+
+	thread_local RSAContext rsaContext;
+
+} // namespace
+
 RSA::RSA()
 {
 	mpz_init2(m_p, 1024);
@@ -32,6 +66,8 @@ RSA::RSA()
 
 RSA::~RSA()
 {
+	shutdown();
+
 	mpz_clear(m_p);
 	mpz_clear(m_q);
 	mpz_clear(m_d);
@@ -59,8 +95,6 @@ bool RSA::initialize(const std::string& file)
 
 void RSA::initialize(const char* p, const char* q, const char* d)
 {
-	std::scoped_lock lockClass(rsaLock);
-
 	mpz_set_str(m_p, p, 10);
 	mpz_set_str(m_q, q, 10);
 	mpz_set_str(m_d, d, 10);
@@ -81,46 +115,67 @@ void RSA::initialize(const char* p, const char* q, const char* d)
 	mpz_clear(qm1);
 }
 
-void RSA::decrypt(char* msg)
+void RSA::start(size_t threads)
 {
-	std::scoped_lock lockClass(rsaLock);
-	mpz_t c, v1, v2, u2, tmp;
+	if (threads > 0 && !m_workers) {
+		m_workers = std::make_unique<boost::asio::thread_pool>(threads);
+	}
+}
 
-	mpz_init2(c, 1024);
-	mpz_init2(v1, 1024);
-	mpz_init2(v2, 1024);
-	mpz_init2(u2, 1024);
-	mpz_init2(tmp, 1024);
+void RSA::shutdown()
+{
+	if (m_workers) {
+		m_workers->join();
+		m_workers.reset();
+	}
+}
 
-	mpz_import(c, 128, 1, 1, 0, 0, msg);
+void RSA::decrypt(char* msg) const
+{
+	RSAContext& ctx = rsaContext;
+	mpz_import(ctx.c, 128, 1, 1, 0, 0, msg);
 
-	mpz_mod(tmp, c, m_p);
-	mpz_powm(v1, tmp, m_dp, m_p);
-	mpz_mod(tmp, c, m_q);
-	mpz_powm(v2, tmp, m_dq, m_q);
+	// chinese remainder theorem, m = v1 + p * ((v2 - v1) * p^-1 mod q)
+	mpz_mod(ctx.tmp, ctx.c, m_p);
+	mpz_powm(ctx.v1, ctx.tmp, m_dp, m_p);
+	mpz_mod(ctx.tmp, ctx.c, m_q);
+	mpz_powm(ctx.v2, ctx.tmp, m_dq, m_q);
 
-	mpz_sub(u2, v2, v1);
-	mpz_mul(tmp, u2, m_u);
+	mpz_sub(ctx.u2, ctx.v2, ctx.v1);
+	mpz_mul(ctx.tmp, ctx.u2, m_u);
+	mpz_mod(ctx.u2, ctx.tmp, m_q);
 
-	mpz_mod(u2, tmp, m_q);
-	if (mpz_cmp_si(u2, 0) < 0) {
-		mpz_add(tmp, u2, m_q);
-		mpz_set(u2, tmp);
-	}
+	mpz_mul(ctx.tmp, ctx.u2, m_p);
+	mpz_add(ctx.c, ctx.v1, ctx.tmp);
 
-	mpz_mul(tmp, u2, m_p);
-	mpz_set_ui(c, 0);
-	mpz_add(c, v1, tmp);
+	size_t count = (mpz_sizeinbase(ctx.c, 2) + 7) / 8;
+	memset(msg, 0, 128 - count);
+	mpz_export(&msg[128 - count], nullptr, 1, 1, 0, 0, ctx.c);
+}
+
+void RSA::encrypt(char* msg) const
+{
+	RSAContext& ctx = rsaContext;
+	mpz_import(ctx.c, 128, 1, 1, 0, 0, msg);
+	mpz_powm_ui(ctx.tmp, ctx.c, 65537, m_mod);
 
-	size_t count = (mpz_sizeinbase(c, 2) + 7) / 8;
+	size_t count = (mpz_sizeinbase(ctx.tmp, 2) + 7) / 8;
 	memset(msg, 0, 128 - count);
-	mpz_export(&msg[128 - count], nullptr, 1, 1, 0, 0, c);
+	mpz_export(&msg[128 - count], nullptr, 1, 1, 0, 0, ctx.tmp);
+}
+
+void RSA::decryptAsync(char* msg, std::function<void(void)>&& callback)
+{
+	if (!m_workers) {
+		decrypt(msg);
+		callback();
+		return;
+	}
 
-	mpz_clear(c);
-	mpz_clear(v1);
-	mpz_clear(v2);
-	mpz_clear(u2);
-	mpz_clear(tmp);
+	boost::asio::post(*m_workers, [this, msg, callback = std::move(callback)]() {
+		decrypt(msg);
+		callback();
+	});
 }
 
 void RSA::getPublicKey(char* buffer)
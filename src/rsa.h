@@ -19,20 +19,36 @@
 
 #include <gmp.h>
 
+// the OpenTibia key, its public half is what the clients ship with
+static constexpr const char* RSA_OTSERV_P = "14299623962416399520070177382898895550795403345466153217470516082934737582776038882967213386204600674145392845853859217990626450972452084065728686565928113";
+static constexpr const char* RSA_OTSERV_Q = "7630979195970404721891201847792002125535401292779123937207447574596692788513647179235335529307251350570728407373705564708871762033017096809910315212884101";
+static constexpr const char* RSA_OTSERV_D = "46730330223584118622160180015036832148732986808519344675210555262940258739805766860224610646919605860206328024326703361630109888417839241959507572247284807035235569619173792292786907845791904955103601652822519121908367187885509270025388641700821735345222087940578381210879116823013776808975766851829020659073";
+
 class RSA
 {
 public:
 	RSA();
 	~RSA();
 
+	// must be called before the workers are started
 	void initialize(const char* p, const char* q, const char* d);
 	bool initialize(const std::string& file);
 
-	void decrypt(char* msg);
+	void start(size_t threads);
+	void shutdown();
+
+	bool hasWorkers() const { return m_workers != nullptr; }
+
+	// thread-safe, every thread decrypts with its own context
+	void decrypt(char* msg) const;
+	// decrypts on a worker thread, callback is executed on that thread
+	void decryptAsync(char* msg, std::function<void(void)>&& callback);
+	// client side, with the public exponent, thread-safe as well
+	void encrypt(char* msg) const;
 
 	void getPublicKey(char* buffer);
 
 private:
-	std::recursive_mutex rsaLock;
+	std::unique_ptr<boost::asio::thread_pool> m_workers;
 	mpz_t m_p, m_q, m_u, m_d, m_dp, m_dq, m_mod;
 };
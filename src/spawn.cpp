@@ -220,11 +220,17 @@ void Spawns::startup()
 void Spawns::clear()
 {
 	started = false;
+	if (checkEvent != 0) {
+		g_scheduler.stopEvent(checkEvent);
+		checkEvent = 0;
+	}
+
 	for (SpawnList::iterator it = spawnList.begin(); it != spawnList.end(); ++it) {
 		delete (*it);
 	}
 
 	spawnList.clear();
+	pendingList.clear();
 	loaded = false;
 	filename = std::string();
 }
@@ -238,10 +244,57 @@ bool Spawns::isInZone(const Position& centerPos, int32_t radius, const Position&
 	return ((pos.x >= centerPos.x - radius) && (pos.x <= centerPos.x + radius) && (pos.y >= centerPos.y - radius) && (pos.y <= centerPos.y + radius));
 }
 
+void Spawns::addPending(Spawn* spawn)
+{
+	pendingList.push_back(spawn);
+	if (checkEvent == 0) {
+		checkEvent = addSchedulerTask(MINSPAWN_INTERVAL, [this]() { checkSpawns(); });
+	}
+}
+
+void Spawns::removePending(Spawn* spawn)
+{
+	auto it = std::find(pendingList.begin(), pendingList.end(), spawn);
+	if (it != pendingList.end()) {
+		*it = pendingList.back();
+		pendingList.pop_back();
+	}
+}
+
+void Spawns::checkSpawns()
+{
+	checkEvent = 0;
+
+	const int64_t timeNow = otx::util::mstime();
+	for (size_t i = 0; i < pendingList.size();) {
+		Spawn* spawn = pendingList[i];
+		if (timeNow < spawn->m_nextCheck) {
+			++i;
+			continue;
+		}
+
+		++checks;
+		if (spawn->checkSpawn(timeNow)) {
+			++i;
+			continue;
+		}
+
+		// the spawn may have moved within the list while placing monsters
+		spawn->m_pending = false;
+		removePending(spawn);
+	}
+
+	if (!pendingList.empty()) {
+		checkEvent = addSchedulerTask(MINSPAWN_INTERVAL, [this]() { checkSpawns(); });
+	}
+}
+
 void Spawn::startEvent(MonsterType* mType)
 {
-	if (m_checkSpawnEvent == 0) {
-		m_checkSpawnEvent = addSchedulerTask(getInterval() / g_game.spawnDivider(mType), [this]() { checkSpawn(); });
+	if (!m_pending) {
+		m_pending = true;
+		m_nextCheck = otx::util::mstime() + getInterval() / g_game.spawnDivider(mType);
+		Spawns::getInstance()->addPending(this);
 	}
 }
 
@@ -261,6 +314,11 @@ Spawn::~Spawn()
 
 bool Spawn::findPlayer(const Position& pos, bool blocked)
 {
+	if (!g_game.getMap()->hasPlayersNear(pos)) {
+		++Spawns::getInstance()->queriesSkipped;
+		return false;
+	}
+
 	SpectatorVec list;
 	g_game.getSpectators(list, pos, false, true);
 	for (Creature* spectator : list) {
@@ -300,6 +358,10 @@ bool Spawn::spawnMonster(uint32_t spawnId, MonsterType* mType, const Position& p
 	monster->addRef();
 	m_spawnedMap.insert(SpawnedPair(spawnId, monster));
 	m_spawnMap[spawnId].lastSpawn = otx::util::mstime();
+	if (!startup) {
+		++Spawns::getInstance()->respawned;
+	}
+
 	return true;
 }
 
@@ -310,11 +372,8 @@ void Spawn::startup()
 	}
 }
 
-void Spawn::checkSpawn()
+bool Spawn::checkSpawn(int64_t timeNow)
 {
-	const int64_t timeNow = otx::util::mstime();
-
-	m_checkSpawnEvent = 0;
 	for (auto it = m_spawnedMap.begin(); it != m_spawnedMap.end(); ) {
 		if (it->second->isRemoved()) {
 			if (it->first != 0) {
@@ -356,8 +415,11 @@ void Spawn::checkSpawn()
 	}
 
 	if (m_spawnedMap.size() < m_spawnMap.size()) {
-		m_checkSpawnEvent = addSchedulerTask(getInterval() / interval, [this]() { checkSpawn(); });
+		m_nextCheck = timeNow + getInterval() / interval;
+		return true;
 	}
+
+	return false;
 }
 
 bool Spawn::addMonster(const std::string& _name, const Position& _pos, Direction _dir, uint32_t _interval)
@@ -404,10 +466,10 @@ void Spawn::removeMonster(Monster* monster)
 
 void Spawn::stopEvent()
 {
-	if (m_checkSpawnEvent == 0) {
+	if (!m_pending) {
 		return;
 	}
 
-	g_scheduler.stopEvent(m_checkSpawnEvent);
-	m_checkSpawnEvent = 0;
+	m_pending = false;
+	Spawns::getInstance()->removePending(this);
 }
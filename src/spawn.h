@@ -44,10 +44,28 @@ public:
 	bool isLoaded() const { return loaded; }
 	bool isStarted() const { return started; }
 
+	void addPending(Spawn* spawn);
+	void removePending(Spawn* spawn);
+
+	size_t getPendingCount() const { return pendingList.size(); }
+	uint64_t getChecks() const { return checks; }
+	uint64_t getRespawned() const { return respawned; }
+	uint64_t getQueriesSkipped() const { return queriesSkipped; }
+
 private:
 	Spawns();
+	void checkSpawns();
+
 	SpawnList spawnList;
 
+	// spawns missing monsters, all checked from a single scheduler event
+	std::vector<Spawn*> pendingList;
+	uint32_t checkEvent = 0;
+
+	uint64_t checks = 0, respawned = 0, queriesSkipped = 0;
+
+	friend class Spawn;
+
 	typedef std::list<Npc*> NpcList;
 	NpcList npcList;
 
@@ -85,14 +103,15 @@ public:
 	bool isInSpawnZone(const Position& pos) const { return Spawns::getInstance()->isInZone(m_centerPos, m_radius, pos); }
 
 private:
-	void checkSpawn();
+	bool checkSpawn(int64_t timeNow);
 	bool spawnMonster(uint32_t spawnId, MonsterType* mType, const Position& pos, Direction dir, bool startup = false);
 
 	bool findPlayer(const Position& pos, bool blocked);
 
 	Position m_centerPos;
 	uint32_t m_interval = 60000;
-	uint32_t m_checkSpawnEvent = 0;
+	int64_t m_nextCheck = 0;
+	bool m_pending = false;
 	int32_t m_radius;
 	int32_t m_despawnRange;
 	int32_t m_despawnRadius;
@@ -100,6 +119,8 @@ private:
 	// map of creatures in the spawn
 	std::map<uint32_t, spawnBlock_t> m_spawnMap;
 
+	friend class Spawns;
+
 	// map of the spawned creatures
 	typedef std::multimap<uint32_t, Monster*, std::less<uint32_t>> SpawnedMap;
 	typedef SpawnedMap::value_type SpawnedPair;
@@ -21,6 +21,7 @@
 
 #include "chat.h"
 #include "configmanager.h"
+#include "databasetasks.h"
 #include "game.h"
 #include "house.h"
 #include "ioban.h"
@@ -28,6 +29,7 @@
 #include "iologindata.h"
 #include "npc.h"
 #include "player.h"
+#include "spawn.h"
 #include "teleport.h"
 #include "textlogger.h"
 #include "tools.h"
@@ -37,6 +39,7 @@
 
 #if ENABLE_SERVER_DIAGNOSTIC > 0
 #include "connection.h"
+#include "outputmessage.h"
 #include "protocollogin.h"
 #include "protocolold.h"
 #include "protocolstatus.h"
@@ -173,7 +176,7 @@ bool TalkActions::onPlayerSay(Creature* creature, uint16_t channelId, const std:
 		}
 
 		if (!player->hasCustomFlag(PlayerCustomFlag_GamemasterPrivileges)) {
-			player->setNextExAction(otx::util::mstime() + otx::config::getInteger(otx::config::CUSTOM_ACTIONS_DELAY_INTERVAL) - 10);
+			player->setNextExAction(otx::util::ticks() + otx::config::getInteger(otx::config::CUSTOM_ACTIONS_DELAY_INTERVAL) - 10);
 		}
 	}
 
@@ -1038,7 +1041,24 @@ bool TalkAction::diagnostics(Creature* creature, const std::string&)
 	s << "[World]" << std::endl
 	  << "Player: " << g_game.getPlayersOnline() << " (" << Player::playerCount << ')' << std::endl
 	  << "Npc: " << g_game.getNpcsOnline() << " (" << Npc::npcCount << ')' << std::endl
-	  << "Monster: " << g_game.getMonstersOnline() << " (" << Monster::monsterCount << ')';
+	  << "Npc dormant thinks: " << Npc::npcDormantThinks << std::endl
+	  << "Monster: " << g_game.getMonstersOnline() << " (" << Monster::monsterCount << ')' << std::endl
+	  << "Monster thinks: " << Monster::thinksFull << " full, " << Monster::thinksReduced << " reduced, "
+	  << Monster::thinksSkipped << " skipped" << std::endl
+	  << "Monster thinks last tick: " << Monster::lastThinkTick.full << " full, " << Monster::lastThinkTick.reduced << " reduced, "
+	  << Monster::lastThinkTick.skipped << " skipped" << std::endl
+	  << "Monster thinks per tick: ";
+	if (Monster::thinkTicks) {
+		s << Monster::thinksFull / Monster::thinkTicks << " full, " << Monster::thinksReduced / Monster::thinkTicks << " reduced, "
+		  << Monster::thinksSkipped / Monster::thinkTicks << " skipped over " << Monster::thinkTicks << " ticks";
+	} else {
+		s << "no ticks yet";
+	}
+	player->sendTextMessage(MSG_STATUS_CONSOLE_BLUE, s.str());
+
+	s.str("");
+	s << "[Player]" << std::endl
+	  << "Inventory index: " << (player->checkInventoryIndex() ? "consistent" : "out of sync");
 	player->sendTextMessage(MSG_STATUS_CONSOLE_BLUE, s.str());
 
 	s.str("");
@@ -1046,7 +1066,87 @@ bool TalkAction::diagnostics(Creature* creature, const std::string&)
 	  << "ProtocolGame: " << ProtocolGame::protocolGameCount << std::endl
 	  << "ProtocolLogin: " << ProtocolLogin::protocolLoginCount << std::endl
 	  << "ProtocolStatus: " << ProtocolStatus::protocolStatusCount << std::endl
-	  << "ProtocolOld: " << ProtocolOld::protocolOldCount;
+	  << "ProtocolOld: " << ProtocolOld::protocolOldCount << std::endl
+	  << "Commands: " << ProtocolGame::commandCount << " in " << ProtocolGame::commandBatches << " batches, "
+	  << ProtocolGame::commandsDropped << " dropped";
+	player->sendTextMessage(MSG_STATUS_CONSOLE_BLUE, s.str());
+
+	s.str("");
+	const OutputMessagePool& outputPool = OutputMessagePool::getInstance();
+	const uint64_t outputMessages = outputPool.getMessages(OUTPUTFLUSH_BATCH) + outputPool.getMessages(OUTPUTFLUSH_DELAY)
+		+ outputPool.getMessages(OUTPUTFLUSH_FULL);
+	const double clientSeconds = outputPool.getClientSeconds();
+	s << "[Output]" << std::endl
+	  << "Messages: " << outputPool.getMessages(OUTPUTFLUSH_BATCH) << " at batch end, " << outputPool.getMessages(OUTPUTFLUSH_DELAY)
+	  << " delayed, " << outputPool.getMessages(OUTPUTFLUSH_FULL) << " full" << std::endl
+	  << "Average size: " << (outputMessages ? outputPool.getBytes() / outputMessages : 0) << " bytes" << std::endl
+	  << "Per client: " << (clientSeconds > 0 ? outputMessages / clientSeconds : 0.) << " packets/s over "
+	  << static_cast<uint64_t>(clientSeconds) << " client seconds, " << outputPool.getAutosendCount() << " clients now";
+	player->sendTextMessage(MSG_STATUS_CONSOLE_BLUE, s.str());
+
+	s.str("");
+	s << "[Status]" << std::endl
+	  << "Cache hits: " << ProtocolStatus::cacheHits << std::endl
+	  << "Cache misses: " << ProtocolStatus::cacheMisses;
+	player->sendTextMessage(MSG_STATUS_CONSOLE_BLUE, s.str());
+
+	s.str("");
+	s << "[Logger]" << std::endl
+	  << "Written: " << Logger::getInstance()->getWritten() << std::endl
+	  << "Batches: " << Logger::getInstance()->getBatches() << std::endl
+	  << "Pending: " << Logger::getInstance()->getPending() << std::endl
+	  << "Overflows: " << Logger::getInstance()->getOverflows();
+	player->sendTextMessage(MSG_STATUS_CONSOLE_BLUE, s.str());
+
+	s.str("");
+	s << "[Spectators]" << std::endl
+	  << "Scans: " << g_game.getMap()->getSpectatorScans() << std::endl
+	  << "Cache hits: " << g_game.getMap()->getSpectatorCacheHits();
+	player->sendTextMessage(MSG_STATUS_CONSOLE_BLUE, s.str());
+
+	s.str("");
+	s << "[Spawns]" << std::endl
+	  << "Pending: " << Spawns::getInstance()->getPendingCount() << std::endl
+	  << "Checks: " << Spawns::getInstance()->getChecks() << std::endl
+	  << "Respawned: " << Spawns::getInstance()->getRespawned() << std::endl
+	  << "Spectator queries skipped: " << Spawns::getInstance()->getQueriesSkipped();
+	player->sendTextMessage(MSG_STATUS_CONSOLE_BLUE, s.str());
+
+	s.str("");
+	s << "[Bans]" << std::endl
+	  << "Cached: " << IOBan::getInstance()->getCachedCount();
+	player->sendTextMessage(MSG_STATUS_CONSOLE_BLUE, s.str());
+
+	s.str("");
+	s << "[Guilds]" << std::endl
+	  << "Cached guilds: " << IOGuild::getInstance()->getCachedGuilds() << std::endl
+	  << "Cached wars: " << IOGuild::getInstance()->getCachedWars() << std::endl
+	  << "Cached guild members: " << IOGuild::getInstance()->getCachedMembers() << std::endl
+	  << "Queries pending: " << g_databaseTasks.getPending() << std::endl
+	  << "Queries written behind: " << g_databaseTasks.getExecuted();
+	player->sendTextMessage(MSG_STATUS_CONSOLE_BLUE, s.str());
+
+	s.str("");
+	const PlayerStorageStatistics storage = IOLoginData::getInstance()->getStorageStatistics();
+	s << "[Player storage]" << std::endl
+	  << "Mode: " << (IOLoginData::getInstance()->isSnapshotStorage() ? "binary" : "relational") << std::endl
+	  << "Loads: " << storage.loads << ", avg " << (storage.loads ? storage.loadTime / storage.loads : 0) << " us in queries" << std::endl
+	  << "Saves: " << storage.saves << ", avg " << (storage.saves ? storage.saveTime / storage.saves : 0) << " us" << std::endl
+	  << "Logins placed: " << ProtocolGame::loginCount << ", avg " << (ProtocolGame::loginCount ? ProtocolGame::loginTime / ProtocolGame::loginCount : 0) << " us on the dispatcher";
+	player->sendTextMessage(MSG_STATUS_CONSOLE_BLUE, s.str());
+
+	s.str("");
+	s << "[Pools]";
+	auto addPool = [&s](const char* name, const ObjectPoolStatistics& stats) {
+		s << std::endl << name << ": " << stats.allocations << " allocations, " << stats.reused << " reused, "
+		  << (stats.allocations - stats.releases) << " live, " << stats.pooled << " pooled";
+	};
+	addPool("Item", Item::Pool::getStatistics());
+	addPool("Container", Container::Pool::getStatistics());
+	addPool("Monster", Monster::Pool::getStatistics());
+	addPool("Damage condition", ConditionDamage::Pool::getStatistics());
+	addPool("Generic condition", ConditionGeneric::Pool::getStatistics());
+	addPool("Speed condition", ConditionSpeed::Pool::getStatistics());
 	player->sendTextMessage(MSG_STATUS_CONSOLE_BLUE, s.str());
 
 	s.str("");
@@ -23,6 +23,8 @@
 #include "game.h"
 #include "tools.h"
 
+#include "otx/util.hpp"
+
 void Logger::open()
 {
 	std::string path = otx::config::getString(otx::config::OUTPUT_LOG);
@@ -32,57 +34,223 @@ void Logger::open()
 		path = getFilePath(FILE_TYPE_LOG, path);
 	}
 
-	m_files[LOGFILE_ADMIN] = fopen(getFilePath(FILE_TYPE_LOG, "admin.log").c_str(), "a");
+	const int64_t now = otx::util::mstime();
+	auto openFile = [this, now](LogFile_t type, const std::string& filePath, const char* mode) {
+		LogTarget& target = m_files[type];
+		target.file = fopen(filePath.c_str(), mode);
+		if (target.file) {
+			target.path = filePath;
+			target.opened = now;
+		}
+	};
+
+	openFile(LOGFILE_ADMIN, getFilePath(FILE_TYPE_LOG, "admin.log"), "a");
 	if (!path.empty()) {
-		m_files[LOGFILE_OUTPUT] = fopen(path.c_str(), (otx::config::getBoolean(otx::config::TRUNCATE_LOG) ? "w" : "a"));
+		openFile(LOGFILE_OUTPUT, path, (otx::config::getBoolean(otx::config::TRUNCATE_LOG) ? "w" : "a"));
+	}
+
+	openFile(LOGFILE_ASSERTIONS, getFilePath(FILE_TYPE_LOG, "client_assertions.log"), "a");
+
+	// boost::lockfree uses 16 bit indexes for fixed sized queues
+	const size_t capacity = std::clamp<int64_t>(otx::config::getInteger(otx::config::LOG_BUFFER_SIZE), 0, 65534);
+	if (capacity > 0) {
+		m_queue = std::make_unique<boost::lockfree::queue<LogEntry*, boost::lockfree::fixed_sized<true>>>(capacity);
+		m_running = true;
+		m_thread = std::thread(&Logger::threadMain, this);
 	}
 
-	m_files[LOGFILE_ASSERTIONS] = fopen(getFilePath(FILE_TYPE_LOG, "client_assertions.log").c_str(), "a");
 	m_loaded = true;
 }
 
 void Logger::close()
 {
 	m_loaded = false;
-	for (uint8_t i = 0; i <= LOGFILE_LAST; ++i) {
-		if (m_files[i]) {
-			fclose(m_files[i]);
+	if (m_running.exchange(false)) {
+		while (m_pushing != 0) {
+			std::this_thread::yield();
 		}
+
+		m_signal.notify_one();
+		m_thread.join();
 	}
+
+	std::lock_guard<std::mutex> lockClass(m_lock);
+	for (auto& target : m_files) {
+		if (target.file) {
+			fclose(target.file);
+			target.file = nullptr;
+		}
+	}
+
+	for (auto& it : m_extraFiles) {
+		if (it.second.file) {
+			fclose(it.second.file);
+		}
+	}
+
+	m_extraFiles.clear();
 }
 
 void Logger::iFile(LogFile_t file, std::string output, bool newLine)
 {
-	if (!m_loaded || !m_files[file]) {
+	if (!m_loaded || m_files[file].path.empty()) {
 		return;
 	}
 
-	internal(m_files[file], output, newLine);
-	fflush(m_files[file]);
+	if (newLine) {
+		output += "\n";
+	}
+
+	auto entry = new LogEntry;
+	entry->text = std::move(output);
+	entry->type = file;
+	push(entry);
 }
 
 void Logger::eFile(std::string file, std::string output, bool newLine)
 {
-	FILE* f = fopen(getFilePath(FILE_TYPE_LOG, file).c_str(), "a");
-	if (!f) {
-		return;
+	auto entry = new LogEntry;
+	entry->file = std::move(file);
+	entry->text = "[" + formatDate() + "] " + output;
+	if (newLine) {
+		entry->text += "\n";
+	}
+
+	push(entry);
+}
+
+void Logger::push(LogEntry* entry)
+{
+	// close() waits for the pushes it did not stop, so nothing lands in the queue after the last flush
+	++m_pushing;
+	if (m_running) {
+		// counted first, the writer may pop the entry as soon as it is in
+		if (++m_pending >= otx::config::getInteger(otx::config::LOG_BUFFER_SIZE) / 2) {
+			m_signal.notify_one();
+		}
+
+		if (m_queue->push(entry)) {
+			--m_pushing;
+			return;
+		}
+
+		--m_pending;
+		++m_overflows;
+	}
+
+	--m_pushing;
+
+	// no writer or the buffer is full, write it from the calling thread after what is already queued
+	std::lock_guard<std::mutex> lockClass(m_lock);
+	if (m_queue) {
+		flush();
+	}
+
+	LogTarget& target = getTarget(*entry);
+	write(target, entry->text);
+	if (target.file) {
+		fflush(target.file);
 	}
 
-	internal(f, "[" + formatDate() + "] " + output, newLine);
-	fclose(f);
+	if (!m_running && !entry->file.empty()) {
+		if (target.file) {
+			fclose(target.file);
+		}
+
+		m_extraFiles.erase(entry->file);
+	}
+
+	delete entry;
+}
+
+void Logger::threadMain()
+{
+	std::unique_lock<std::mutex> lockClass(m_lock);
+	while (m_running) {
+		m_signal.wait_for(lockClass, std::chrono::milliseconds(std::max<int64_t>(10, otx::config::getInteger(otx::config::LOG_FLUSH_INTERVAL))));
+		flush();
+	}
+
+	// write whatever is left before the files are closed
+	flush();
+}
+
+void Logger::flush()
+{
+	uint32_t count = 0;
+	LogEntry* entry;
+	while (m_queue->pop(entry)) {
+		write(getTarget(*entry), entry->text);
+		delete entry;
+		++count;
+	}
+
+	const int64_t now = otx::util::mstime();
+	for (auto& target : m_files) {
+		if (target.file) {
+			fflush(target.file);
+		}
+	}
+
+	// files such as player logs are kept open only while they are in use
+	for (auto it = m_extraFiles.begin(); it != m_extraFiles.end();) {
+		if (!it->second.file || now - it->second.lastWrite > 60000) {
+			if (it->second.file) {
+				fclose(it->second.file);
+			}
+
+			it = m_extraFiles.erase(it);
+		} else {
+			fflush(it->second.file);
+			++it;
+		}
+	}
+
+	if (count != 0) {
+		m_pending -= count;
+		m_written += count;
+		++m_batches;
+	}
 }
 
-void Logger::internal(FILE* file, std::string output, bool newLine)
+Logger::LogTarget& Logger::getTarget(const LogEntry& entry)
 {
-	if (!file) {
+	if (entry.file.empty()) {
+		return m_files[entry.type];
+	}
+
+	LogTarget& target = m_extraFiles[entry.file];
+	if (!target.file) {
+		target.path = getFilePath(FILE_TYPE_LOG, entry.file);
+		target.file = fopen(target.path.c_str(), "a");
+		target.opened = otx::util::mstime();
+	}
+	return target;
+}
+
+void Logger::write(LogTarget& target, const std::string& text)
+{
+	if (!target.file) {
 		return;
 	}
 
-	if (newLine) {
-		output += "\n";
+	fwrite(text.c_str(), 1, text.size(), target.file);
+	target.lastWrite = otx::util::mstime();
+
+	const int64_t rotateSize = otx::config::getInteger(otx::config::LOG_ROTATE_SIZE) * 1024 * 1024;
+	const int64_t rotateTime = otx::config::getInteger(otx::config::LOG_ROTATE_TIME) * 60 * 60 * 1000;
+	if ((rotateSize > 0 && ftell(target.file) >= rotateSize) || (rotateTime > 0 && target.lastWrite - target.opened >= rotateTime)) {
+		rotate(target);
 	}
+}
+
+void Logger::rotate(LogTarget& target)
+{
+	fclose(target.file);
+	std::rename(target.path.c_str(), (target.path + "." + formatDateEx(0, "%Y%m%d-%H%M%S")).c_str());
 
-	fprintf(file, "%s", output.c_str());
+	target.file = fopen(target.path.c_str(), "a");
+	target.opened = otx::util::mstime();
 }
 
 void Logger::log(const char* func, LogType_t type, std::string message, std::string channel /* = ""*/, bool newLine /* = true*/)
@@ -17,6 +17,8 @@
 
 #pragma once
 
+#include <boost/lockfree/queue.hpp>
+
 enum LogFile_t
 {
 	LOGFILE_FIRST = 0,
@@ -34,6 +36,13 @@ enum LogType_t
 	LOGTYPE_ERROR,
 };
 
+struct LogEntry
+{
+	std::string file; // empty for the fixed log files
+	std::string text;
+	LogFile_t type = LOGFILE_FIRST;
+};
+
 class Logger
 {
 public:
@@ -54,11 +63,45 @@ public:
 
 	void log(const char* func, LogType_t type, std::string message, std::string channel = "", bool newLine = true);
 
+	uint64_t getWritten() const { return m_written; }
+	uint64_t getBatches() const { return m_batches; }
+	uint64_t getOverflows() const { return m_overflows; }
+	uint32_t getPending() const { return m_pending; }
+
 private:
+	struct LogTarget
+	{
+		FILE* file = nullptr;
+		std::string path;
+		int64_t opened = 0;
+		int64_t lastWrite = 0;
+	};
+
 	Logger() { m_loaded = false; }
-	void internal(FILE* file, std::string output, bool newLine);
 
-	FILE* m_files[LOGFILE_LAST + 1];
+	void push(LogEntry* entry);
+	void threadMain();
+	void flush();
+
+	LogTarget& getTarget(const LogEntry& entry);
+	void write(LogTarget& target, const std::string& text);
+	void rotate(LogTarget& target);
+
+	LogTarget m_files[LOGFILE_LAST + 1];
+	std::map<std::string, LogTarget> m_extraFiles;
+
+	// filled by every thread, drained by the writer thread only
+	std::unique_ptr<boost::lockfree::queue<LogEntry*, boost::lockfree::fixed_sized<true>>> m_queue;
+	std::thread m_thread;
+	std::mutex m_lock; // held while the files are written to
+	std::condition_variable m_signal;
+
+	std::atomic<uint64_t> m_written{ 0 };
+	std::atomic<uint64_t> m_batches{ 0 };
+	std::atomic<uint64_t> m_overflows{ 0 };
+	std::atomic<uint32_t> m_pending{ 0 };
+	std::atomic<uint32_t> m_pushing{ 0 }; // pushes that may still reach the queue
+	std::atomic<bool> m_running{ false };
 	bool m_loaded;
 };
 
@@ -969,7 +969,7 @@ Cylinder* Tile::__queryDestination(int32_t&, const Thing*, Item** destItem,
 void Tile::__addThing(Creature* actor, int32_t, Thing* thing)
 {
 	if (Creature* creature = thing->getCreature()) {
-		g_game.clearSpectatorCache();
+		g_game.invalidateSpectatorCache(m_pos);
 		creature->setParent(this);
 
 		CreatureVector* creatures = makeCreatures();
@@ -1241,7 +1241,7 @@ void Tile::__removeThing(Thing* thing, uint32_t count)
 				return /* RET_NOTPOSSIBLE*/;
 			}
 
-			g_game.clearSpectatorCache();
+			g_game.invalidateSpectatorCache(m_pos);
 			creatures->erase(it);
 			--m_thingCount;
 		}
@@ -1589,7 +1589,7 @@ void Tile::__internalAddThing(uint32_t, Thing* thing)
 {
 	thing->setParent(this);
 	if (Creature* creature = thing->getCreature()) {
-		g_game.clearSpectatorCache();
+		g_game.invalidateSpectatorCache(m_pos);
 		CreatureVector* creatures = makeCreatures();
 		creatures->insert(creatures->begin(), creature);
 
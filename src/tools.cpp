@@ -311,6 +311,39 @@ std::string getLastXMLError()
 	return ss.str();
 }
 
+void parseXMLFiles(std::vector<XMLFile>& files)
+{
+	size_t threads = otx::config::getInteger(otx::config::LOAD_THREADS);
+	if (threads == 0) {
+		threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+	}
+
+	auto parse = [](XMLFile& file) {
+		file.doc = xmlParseFile(file.path.c_str());
+		if (!file.doc) {
+			file.error = getLastXMLError();
+		}
+	};
+
+	threads = std::min(threads, files.size());
+	if (threads <= 1) {
+		for (XMLFile& file : files) {
+			parse(file);
+		}
+		return;
+	}
+
+	// libxml2 has to be initialized before it is used from several threads
+	xmlInitParser();
+
+	boost::asio::thread_pool pool(threads);
+	for (XMLFile& file : files) {
+		boost::asio::post(pool, [&parse, &file]() { parse(file); });
+	}
+
+	pool.join();
+}
+
 bool utf8ToLatin1(char* inText, std::string& outText)
 {
 	outText = "";
@@ -416,6 +449,31 @@ std::mt19937& getRandomGenerator()
 	return generator;
 }
 
+void FastRandomGenerator::seed(uint64_t seed)
+{
+	// splitmix64 spreads the seed over the whole state, so it is never all zeros
+	for (uint32_t i = 0; i < 4; i += 2) {
+		uint64_t z = (seed += 0x9E3779B97F4A7C15ULL);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+		z ^= z >> 31;
+
+		m_state[i] = static_cast<uint32_t>(z);
+		m_state[i + 1] = static_cast<uint32_t>(z >> 32);
+	}
+}
+
+FastRandomGenerator& getFastRandomGenerator()
+{
+	static thread_local FastRandomGenerator generator((static_cast<uint64_t>(std::random_device()()) << 32) | std::random_device()());
+	return generator;
+}
+
+void seedFastRandomGenerator(uint64_t seed)
+{
+	getFastRandomGenerator().seed(seed);
+}
+
 int32_t normal_random(int32_t minNumber, int32_t maxNumber)
 {
 	static std::normal_distribution<float> normalRand(0.45f, 0.22f);
@@ -49,6 +49,45 @@ constexpr bool hasBitSet(uint32_t flag, uint32_t flags) noexcept {
 
 std::mt19937& getRandomGenerator();
 
+// xoshiro128**, small and fast enough for hot paths such as loot rolls
+class FastRandomGenerator
+{
+public:
+	using result_type = uint32_t;
+
+	explicit FastRandomGenerator(uint64_t seed) { this->seed(seed); }
+
+	void seed(uint64_t seed);
+
+	static constexpr result_type min() { return 0; }
+	static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+	result_type operator()() {
+		const uint32_t result = rotl(m_state[1] * 5, 7) * 9, t = m_state[1] << 9;
+		m_state[2] ^= m_state[0];
+		m_state[3] ^= m_state[1];
+		m_state[1] ^= m_state[2];
+		m_state[0] ^= m_state[3];
+		m_state[2] ^= t;
+		m_state[3] = rotl(m_state[3], 11);
+		return result;
+	}
+
+	// uniform value in [0, bound)
+	uint32_t next(uint32_t bound) {
+		return static_cast<uint32_t>((static_cast<uint64_t>((*this)()) * bound) >> 32);
+	}
+
+private:
+	static constexpr uint32_t rotl(uint32_t x, int k) { return (x << k) | (x >> (32 - k)); }
+
+	uint32_t m_state[4];
+};
+
+// per-thread generator seeded from std::random_device, seedFastRandomGenerator reseeds the calling thread only
+FastRandomGenerator& getFastRandomGenerator();
+void seedFastRandomGenerator(uint64_t seed);
+
 bool caseInsensitiveEqual(std::string_view str1, std::string_view str2);
 bool caseInsensitiveStartsWith(std::string_view str1, std::string_view str2);
 
@@ -97,6 +136,16 @@ bool readXMLContentString(xmlNodePtr node, std::string& value);
 bool parseXMLContentString(xmlNodePtr node, std::string& value);
 std::string getLastXMLError();
 
+struct XMLFile
+{
+	std::string path;
+	xmlDocPtr doc = nullptr;
+	std::string error;
+};
+
+// parses the files on a temporary worker pool, the documents still have to be freed by the caller
+void parseXMLFiles(std::vector<XMLFile>& files);
+
 std::string parseVocationString(StringVec vocStringVec);
 bool parseVocationNode(xmlNodePtr vocationNode, VocationMap& vocationMap, StringVec& vocStringMap, std::string& errorStr);
 std::vector<int32_t> parseStringInts(const std::string& str);
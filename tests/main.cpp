@@ -0,0 +1,46 @@
+////////////////////////////////////////////////////////////////////////
+// OpenTibia - an opensource roleplaying game
+////////////////////////////////////////////////////////////////////////
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+////////////////////////////////////////////////////////////////////////
+
+#define BOOST_TEST_MODULE otx
+#include "otpch.h"
+
+#include "configmanager.h"
+#include "item.h"
+#include "rsa.h"
+#include "tools.h"
+
+#include <boost/test/included/unit_test.hpp>
+
+// defined next to main() in otserv.cpp, which is not part of the tests
+RSA g_RSA;
+
+namespace
+{
+	struct ItemTypesFixture
+	{
+		ItemTypesFixture()
+		{
+			otx::config::setString(otx::config::DATA_DIRECTORY, OTX_TEST_DATA_DIRECTORY);
+			if (!Item::items.loadFromOtb(getFilePath(FILE_TYPE_OTHER, "items/items.otb")) || !Item::items.loadFromXml()) {
+				throw std::runtime_error("Unable to load the item types from " OTX_TEST_DATA_DIRECTORY);
+			}
+		}
+	};
+
+} // namespace
+
+BOOST_TEST_GLOBAL_FIXTURE(ItemTypesFixture);
@@ -0,0 +1,105 @@
+////////////////////////////////////////////////////////////////////////
+// OpenTibia - an opensource roleplaying game
+////////////////////////////////////////////////////////////////////////
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+////////////////////////////////////////////////////////////////////////
+
+#include "otpch.h"
+
+#include "ioguild.h"
+
+#include <boost/test/unit_test.hpp>
+
+namespace
+{
+	GuildWar makeWar(uint16_t limit, uint16_t guildKills = 0, uint16_t enemyKills = 0)
+	{
+		GuildWar war;
+		war.data.war = 1;
+		war.data.limit = limit;
+		war.data.frags[WAR_GUILD] = guildKills;
+		war.data.frags[WAR_ENEMY] = enemyKills;
+		return war;
+	}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(guild_wars)
+
+BOOST_AUTO_TEST_CASE(frags_count_per_side_until_the_limit)
+{
+	GuildWar war = makeWar(3);
+	BOOST_CHECK_EQUAL(war.addFrags(WAR_GUILD), WARFRAG_COUNTED);
+	BOOST_CHECK_EQUAL(war.addFrags(WAR_ENEMY), WARFRAG_COUNTED);
+	BOOST_CHECK_EQUAL(war.addFrags(WAR_ENEMY), WARFRAG_COUNTED);
+	BOOST_CHECK_EQUAL(war.data.frags[WAR_GUILD], 1);
+	BOOST_CHECK_EQUAL(war.data.frags[WAR_ENEMY], 2);
+	BOOST_CHECK(!war.ending);
+
+	BOOST_CHECK_EQUAL(war.addFrags(WAR_ENEMY), WARFRAG_WON);
+	BOOST_CHECK_EQUAL(war.data.frags[WAR_ENEMY], 3);
+	BOOST_CHECK(war.ending);
+}
+
+BOOST_AUTO_TEST_CASE(an_ending_war_pays_out_once)
+{
+	GuildWar war = makeWar(2, 1, 0);
+	BOOST_CHECK_EQUAL(war.addFrags(WAR_GUILD), WARFRAG_WON);
+
+	// kills landing before the scheduled finishWar neither count nor win again
+	BOOST_CHECK_EQUAL(war.addFrags(WAR_GUILD), WARFRAG_IGNORED);
+	BOOST_CHECK_EQUAL(war.addFrags(WAR_ENEMY, 5), WARFRAG_IGNORED);
+	BOOST_CHECK_EQUAL(war.data.frags[WAR_GUILD], 2);
+	BOOST_CHECK_EQUAL(war.data.frags[WAR_ENEMY], 0);
+}
+
+BOOST_AUTO_TEST_CASE(frags_taken_while_loading_are_replayed)
+{
+	// scored on the kill path while the war row was read, the way updateWar keeps them in m_loadingWars
+	std::array<uint16_t, WAR_LAST + 1> loading{};
+	loading[WAR_GUILD] += 2;
+	loading[WAR_ENEMY] += 1;
+
+	// the row already held kills written before the server cached the war
+	GuildWar war = makeWar(10, 4, 3);
+	BOOST_CHECK_EQUAL(war.addFrags(WAR_GUILD, loading[WAR_GUILD]), WARFRAG_COUNTED);
+	BOOST_CHECK_EQUAL(war.addFrags(WAR_ENEMY, loading[WAR_ENEMY]), WARFRAG_COUNTED);
+	BOOST_CHECK_EQUAL(war.data.frags[WAR_GUILD], 6);
+	BOOST_CHECK_EQUAL(war.data.frags[WAR_ENEMY], 4);
+	BOOST_CHECK(!war.ending);
+}
+
+BOOST_AUTO_TEST_CASE(a_replay_past_the_limit_stops_at_the_winning_frag)
+{
+	std::array<uint16_t, WAR_LAST + 1> loading{};
+	loading[WAR_GUILD] = 4;
+	loading[WAR_ENEMY] = 2;
+
+	GuildWar war = makeWar(5, 3, 1);
+	BOOST_CHECK_EQUAL(war.addFrags(WAR_GUILD, loading[WAR_GUILD]), WARFRAG_WON);
+	BOOST_CHECK_EQUAL(war.data.frags[WAR_GUILD], 5);
+
+	// the other side's frags came too late, the war is already won
+	BOOST_CHECK_EQUAL(war.addFrags(WAR_ENEMY, loading[WAR_ENEMY]), WARFRAG_IGNORED);
+	BOOST_CHECK_EQUAL(war.data.frags[WAR_ENEMY], 1);
+}
+
+BOOST_AUTO_TEST_CASE(no_frags_count_nothing)
+{
+	GuildWar war = makeWar(5);
+	BOOST_CHECK_EQUAL(war.addFrags(WAR_GUILD, 0), WARFRAG_IGNORED);
+	BOOST_CHECK_EQUAL(war.data.frags[WAR_GUILD], 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,235 @@
+////////////////////////////////////////////////////////////////////////
+// OpenTibia - an opensource roleplaying game
+////////////////////////////////////////////////////////////////////////
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+////////////////////////////////////////////////////////////////////////
+
+#include "otpch.h"
+
+#include "item.h"
+#include "monsters.h"
+#include "tools.h"
+
+#include <thread>
+
+#include <boost/test/unit_test.hpp>
+
+namespace
+{
+	constexpr uint32_t ROLLS = 200000;
+
+	// the first pickupable, non stackable item type of each kind
+	uint16_t findItemType(bool container)
+	{
+		for (uint32_t id = 100; id < Item::items.size(); ++id) {
+			const ItemType& it = Item::items[id];
+			if (it.id == id && it.pickupable && !it.stackable && !it.isDepot() && it.isContainer() == container) {
+				return id;
+			}
+		}
+		return 0;
+	}
+
+	LootBlock makeBlock(uint16_t id, uint32_t chance)
+	{
+		LootBlock block;
+		block.ids.push_back(id);
+		block.chance = chance;
+		return block;
+	}
+
+	// rolls one compiled block over and over, the share of rolls that dropped something
+	double rollFrequency(MonsterType& mType, const CompiledLoot& loot)
+	{
+		uint32_t drops = 0;
+		for (uint32_t i = 0; i < ROLLS; ++i) {
+			ItemList items = mType.createLoot(loot);
+			if (!items.empty()) {
+				++drops;
+			}
+
+			for (Item* item : items) {
+				delete item;
+			}
+		}
+
+		return static_cast<double>(drops) / ROLLS;
+	}
+
+	// the XML chance is out of MAX_LOOTCHANCE and scaled by the loot rate, five standard deviations
+	// of the observed share plus one roll of rounding apart
+	void checkFrequency(double observed, uint32_t chance, double rate)
+	{
+		const double expected = std::min(1., chance * rate / (MAX_LOOTCHANCE + 1)),
+			tolerance = 5 * std::sqrt(expected * (1 - expected) / ROLLS) + (rate + 1) / (MAX_LOOTCHANCE + 1);
+		BOOST_TEST_INFO("chance " << chance << ", rate " << rate);
+		BOOST_CHECK_SMALL(observed - expected, tolerance);
+	}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(loot)
+
+BOOST_AUTO_TEST_CASE(drop_rates_follow_the_xml_chances)
+{
+	const uint16_t plainId = findItemType(false);
+	BOOST_REQUIRE(plainId != 0);
+
+	seedFastRandomGenerator(0x10077);
+
+	MonsterType mType;
+	for (uint32_t chance : {MAX_LOOTCHANCE, 50000, 10000, 1000, 100}) {
+		mType.lootItems.push_back(makeBlock(plainId, chance));
+	}
+
+	for (double rate : {1., 2., 3.5}) {
+		mType.compileLoot(rate);
+		BOOST_REQUIRE_EQUAL(mType.compiledLoot.size(), mType.lootItems.size());
+		for (const CompiledLoot& loot : mType.compiledLoot) {
+			checkFrequency(rollFrequency(mType, loot), loot.block->chance, rate);
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(low_rates_do_not_wrap_the_roll)
+{
+	const uint16_t plainId = findItemType(false);
+	BOOST_REQUIRE(plainId != 0);
+
+	seedFastRandomGenerator(0x10078);
+
+	// below a rate of 1 the scaled roll went past 65535 and wrapped in the uint16_t it was kept in,
+	// a chance of 1000 at 0.5 then dropped about four times as often as it should
+	MonsterType mType;
+	for (uint32_t chance : {MAX_LOOTCHANCE, 40000, 1000}) {
+		mType.lootItems.push_back(makeBlock(plainId, chance));
+	}
+
+	for (double rate : {0.5, 0.1}) {
+		mType.compileLoot(rate);
+		for (const CompiledLoot& loot : mType.compiledLoot) {
+			checkFrequency(rollFrequency(mType, loot), loot.block->chance, rate);
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(chance_times_rate_past_the_roll_range_always_drops)
+{
+	const uint16_t plainId = findItemType(false);
+	BOOST_REQUIRE(plainId != 0);
+
+	// 40000 * 2 does not fit a uint16_t and 60000 * 2 is past the roll range, neither is cut short
+	MonsterType mType;
+	mType.lootItems.push_back(makeBlock(plainId, 40000));
+	mType.lootItems.push_back(makeBlock(plainId, 60000));
+	mType.compileLoot(2.);
+
+	BOOST_CHECK_EQUAL(mType.compiledLoot[0].threshold, 79999);
+	BOOST_CHECK_EQUAL(mType.compiledLoot[1].threshold, MAX_LOOTCHANCE + 1);
+	BOOST_CHECK_EQUAL(rollFrequency(mType, mType.compiledLoot[1]), 1.);
+}
+
+BOOST_AUTO_TEST_CASE(nested_loot_is_flattened_in_pre_order)
+{
+	const uint16_t plainId = findItemType(false), containerId = findItemType(true);
+	BOOST_REQUIRE(plainId != 0 && containerId != 0);
+
+	seedFastRandomGenerator(0x10079);
+
+	LootBlock bag = makeBlock(containerId, MAX_LOOTCHANCE);
+	bag.childLoot.push_back(makeBlock(plainId, 25000));
+	bag.childLoot.push_back(makeBlock(plainId, 2500));
+
+	MonsterType mType;
+	mType.lootItems.push_back(bag);
+	mType.lootItems.push_back(makeBlock(plainId, 5000));
+	mType.compileLoot(1.5);
+
+	// bag, its two children, then the block after the bag
+	const std::vector<CompiledLoot>& compiled = mType.compiledLoot;
+	BOOST_REQUIRE_EQUAL(compiled.size(), 4);
+	BOOST_CHECK_EQUAL(compiled[0].next, 4);
+	BOOST_CHECK_EQUAL(compiled[1].next, 2);
+	BOOST_CHECK_EQUAL(compiled[2].next, 3);
+	BOOST_CHECK_EQUAL(compiled[3].next, 4);
+	BOOST_CHECK_EQUAL(compiled[1].block->chance, 25000);
+	BOOST_CHECK_EQUAL(compiled[3].block->chance, 5000);
+
+	// child blocks are rolled on their own, at the same rate
+	for (uint32_t i = 1; i < compiled.size(); ++i) {
+		checkFrequency(rollFrequency(mType, compiled[i]), compiled[i].block->chance, 1.5);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(seeded_rolls_repeat)
+{
+	const uint16_t plainId = findItemType(false);
+	BOOST_REQUIRE(plainId != 0);
+
+	MonsterType mType;
+	mType.lootItems.push_back(makeBlock(plainId, 30000));
+	mType.compileLoot(1.);
+
+	auto drops = [&mType]() {
+		std::vector<bool> result;
+		for (uint32_t i = 0; i < 1000; ++i) {
+			ItemList items = mType.createLoot(mType.compiledLoot[0]);
+			result.push_back(!items.empty());
+			for (Item* item : items) {
+				delete item;
+			}
+		}
+		return result;
+	};
+
+	seedFastRandomGenerator(42);
+	const std::vector<bool> first = drops();
+
+	seedFastRandomGenerator(42);
+	BOOST_CHECK(drops() == first);
+}
+
+BOOST_AUTO_TEST_CASE(each_thread_keeps_its_own_generator)
+{
+	auto draw = [](size_t count) {
+		std::vector<uint32_t> values;
+		for (size_t i = 0; i < count; ++i) {
+			values.push_back(getFastRandomGenerator()());
+		}
+		return values;
+	};
+
+	seedFastRandomGenerator(42);
+	const std::vector<uint32_t> reference = draw(16);
+
+	// a thread reseeding and drawing in the middle leaves this thread's sequence alone
+	seedFastRandomGenerator(42);
+	std::vector<uint32_t> values = draw(8), other, same;
+	std::thread([&]() {
+		seedFastRandomGenerator(7);
+		other = draw(16);
+
+		seedFastRandomGenerator(42);
+		same = draw(16);
+	}).join();
+
+	const std::vector<uint32_t> rest = draw(8);
+	values.insert(values.end(), rest.begin(), rest.end());
+
+	BOOST_CHECK(values == reference);
+	BOOST_CHECK(same == reference);
+	BOOST_CHECK(other != reference);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,140 @@
+////////////////////////////////////////////////////////////////////////
+// OpenTibia - an opensource roleplaying game
+////////////////////////////////////////////////////////////////////////
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+////////////////////////////////////////////////////////////////////////
+
+#include "otpch.h"
+
+#include "container.h"
+#include "iologindata.h"
+#include "item.h"
+
+#include <boost/test/unit_test.hpp>
+
+namespace
+{
+	// the first pickupable item type of each kind
+	uint16_t findItemType(bool container)
+	{
+		for (uint32_t id = 100; id < Item::items.size(); ++id) {
+			const ItemType& it = Item::items[id];
+			if (it.id == id && it.pickupable && !it.isDepot() && it.isContainer() == container) {
+				return id;
+			}
+		}
+		return 0;
+	}
+
+	const Container* findContainer(const Container* container)
+	{
+		for (const Item* item : container->getItemList()) {
+			if (const Container* child = item->getContainer()) {
+				return child;
+			}
+		}
+		return nullptr;
+	}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(snapshot)
+
+BOOST_AUTO_TEST_CASE(items_read_back_as_written)
+{
+	const uint16_t plainId = findItemType(false), containerId = findItemType(true);
+	BOOST_REQUIRE(plainId != 0 && containerId != 0);
+
+	// a plain item and a container holding a plain item and another container
+	Item* plain = Item::CreateItem(plainId);
+	Item* inner = Item::CreateItem(containerId);
+	inner->getContainer()->__internalAddThing(Item::CreateItem(plainId));
+
+	Item* outer = Item::CreateItem(containerId);
+	outer->getContainer()->__internalAddThing(inner);
+	outer->getContainer()->__internalAddThing(Item::CreateItem(plainId));
+
+	PropWriteStream writeStream;
+	IOLoginData::serializeItem(writeStream, plain);
+	IOLoginData::serializeItem(writeStream, outer);
+	delete plain;
+	delete outer;
+
+	uint32_t size = 0;
+	const char* data = writeStream.getStream(size);
+
+	PropStream stream;
+	stream.init(data, size);
+
+	Item* readPlain = nullptr;
+	Item* readOuter = nullptr;
+	BOOST_REQUIRE(IOLoginData::unserializeItem(stream, readPlain));
+	BOOST_REQUIRE(IOLoginData::unserializeItem(stream, readOuter));
+	BOOST_CHECK_EQUAL(stream.size(), 0);
+
+	BOOST_REQUIRE(readPlain && readOuter);
+	BOOST_CHECK_EQUAL(readPlain->getID(), plainId);
+
+	const Container* container = readOuter->getContainer();
+	BOOST_REQUIRE(container);
+	BOOST_CHECK_EQUAL(container->size(), 2);
+
+	const Container* innerContainer = findContainer(container);
+	BOOST_REQUIRE(innerContainer);
+	BOOST_REQUIRE_EQUAL(innerContainer->size(), 1);
+	BOOST_CHECK_EQUAL(innerContainer->getItemByIndex(0)->getID(), plainId);
+
+	delete readPlain;
+	delete readOuter;
+}
+
+BOOST_AUTO_TEST_CASE(unknown_item_types_are_skipped_with_their_contents)
+{
+	const uint16_t plainId = findItemType(false);
+	BOOST_REQUIRE(plainId != 0);
+
+	// an item type nobody knows, written the way serializeItem sizes a record
+	PropWriteStream unknownStream;
+	unknownStream.addShort(0);
+	unknownStream.addByte(ATTR_END);
+
+	uint32_t unknownSize = 0;
+	const char* unknownData = unknownStream.getStream(unknownSize);
+
+	PropWriteStream writeStream;
+	writeStream.addLongString(std::string(unknownData, unknownSize));
+
+	Item* plain = Item::CreateItem(plainId);
+	IOLoginData::serializeItem(writeStream, plain);
+	delete plain;
+
+	uint32_t size = 0;
+	const char* data = writeStream.getStream(size);
+
+	PropStream stream;
+	stream.init(data, size);
+
+	Item* unknown = nullptr;
+	BOOST_REQUIRE(IOLoginData::unserializeItem(stream, unknown));
+	BOOST_CHECK(!unknown);
+
+	Item* readPlain = nullptr;
+	BOOST_REQUIRE(IOLoginData::unserializeItem(stream, readPlain));
+	BOOST_REQUIRE(readPlain);
+	BOOST_CHECK_EQUAL(readPlain->getID(), plainId);
+	BOOST_CHECK_EQUAL(stream.size(), 0);
+	delete readPlain;
+}
+
+BOOST_AUTO_TEST_SUITE_END()